@@ -1,3 +1,5 @@
+#define BUS_TRACE_IMPL
+
 #include <stdio.h>
 #include <sleep.h>
 #include <stdbool.h>
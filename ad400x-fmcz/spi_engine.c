@@ -37,6 +37,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************/
 
+#define BUS_TRACE_IMPL
+
 /******************************************************************************/
 /***************************** Include Files **********************************/
 /******************************************************************************/
@@ -160,7 +162,7 @@ int32_t spi_write_and_read(spi_desc *desc,
 	/*
 	 * Note:  This function works like a classic SPI
 	 */
-	spi_eng_msg *msg;
+	spi_eng_msg msg;
 	uint8_t i;
 	uint32_t spi_eng_msg_cmds[4];
 	uint32_t xfer_bytes_number;
@@ -179,30 +181,23 @@ int32_t spi_write_and_read(spi_desc *desc,
 	spi_eng_msg_cmds[2] = TRANSFER_BYTES_R_W(xfer_bytes_number);
 	spi_eng_msg_cmds[3] = CS_ASSERT;
 
-	msg = (spi_eng_msg *)malloc(sizeof(*msg));
-	if (!msg)
-		return -1;
-
-	msg->spi_msg_cmds = malloc(sizeof(spi_eng_msg_cmds));
-	msg->spi_msg_cmds = spi_eng_msg_cmds;
-	msg->msg_cmd_len = ARRAY_SIZE(spi_eng_msg_cmds);
+	msg.spi_msg_cmds = spi_eng_msg_cmds;
+	msg.msg_cmd_len = ARRAY_SIZE(spi_eng_msg_cmds);
 
 	// Init the rx and tx buffers with 0s
-	for (i = 0; i < ARRAY_SIZE(msg->tx_buf); i++) {
-		msg->tx_buf[i] = 0;
-		msg->rx_buf[i] = 0;
+	for (i = 0; i < ARRAY_SIZE(msg.tx_buf); i++) {
+		msg.tx_buf[i] = 0;
+		msg.rx_buf[i] = 0;
 	}
 
 	for (i = 0; i < bytes_number; i++)
-		msg->tx_buf[i/data_width_bytes] |= data[i] << (data_width - 8 - 8 * i);
+		msg.tx_buf[i/data_width_bytes] |= data[i] << (data_width - 8 - 8 * i);
 
-	ret = spi_eng_transfer_message(desc, msg);
+	ret = spi_eng_transfer_message(desc, &msg);
 	usleep(1000000); // 1s
 
 	for (i = 0; i < bytes_number; i++)
-		data[i] = msg->rx_buf[i / data_width_bytes]; //>> (data_width - 8 - 8 * i);
-
-	free(msg);
+		data[i] = msg.rx_buf[i / data_width_bytes]; //>> (data_width - 8 - 8 * i);
 
 	return ret;
 }
@@ -480,16 +475,14 @@ int32_t spi_eng_transfer_message(spi_desc *desc, spi_eng_msg *msg)
 {
 	spi_eng_transfer_fifo *xfer;
 	uint8_t words_number;
-	uint32_t size;
 	uint32_t i;
 	uint32_t data;
 
-	size = sizeof(*xfer->cmd_fifo) * (msg->msg_cmd_len + 3);
-
-	xfer = (spi_eng_transfer_fifo *)malloc(sizeof(*xfer) + size);
-	if (!xfer)
+	if (msg->msg_cmd_len > SPI_ENGINE_MAX_MSG_CMDS)
 		return -1;
 
+	xfer = &desc->xfer;
+
 	xfer->cmd_fifo_len = 0;
 	spi_eng_compile_message(desc, msg, xfer);
 
@@ -515,8 +508,6 @@ int32_t spi_eng_transfer_message(spi_desc *desc, spi_eng_msg *msg)
 		msg->rx_buf[i] = data;
 	}
 
-	free(xfer);
-
 	return 0;
 }
 
@@ -529,7 +520,7 @@ int32_t spi_eng_offload_load_msg(spi_eng_desc *desc, spi_eng_msg *msg)
 int32_t spi_eng_offload_load_msg(spi_desc *desc, spi_eng_msg *msg)
 #endif
 {
-	uint32_t i, size;
+	uint32_t i;
 	spi_eng_transfer_fifo *xfer;
 	uint8_t words_number;
 
@@ -539,12 +530,11 @@ int32_t spi_eng_offload_load_msg(spi_desc *desc, spi_eng_msg *msg)
 	if(desc->spi_offload_rx_support_en || desc->spi_offload_tx_support_en)
 		desc->offload_configured = 1;
 
-	size = sizeof(*xfer->cmd_fifo) * (msg->msg_cmd_len + 3);
-
-	xfer = (spi_eng_transfer_fifo *)malloc(sizeof(*xfer) + size);
-	if (!xfer)
+	if (msg->msg_cmd_len > SPI_ENGINE_MAX_MSG_CMDS)
 		return -1;
 
+	xfer = &desc->xfer;
+
 	xfer->cmd_fifo_len = 0;
 
 	spi_eng_compile_message(desc, msg, xfer);
@@ -558,8 +548,6 @@ int32_t spi_eng_offload_load_msg(spi_desc *desc, spi_eng_msg *msg)
 	for(i = 0; i < words_number; i++)
 		spi_eng_write(desc, SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0), msg->tx_buf[i]);
 
-	free(xfer);
-
 	return 0;
 }
 
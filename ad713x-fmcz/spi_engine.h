@@ -158,12 +158,22 @@
 #define	TRANSFER_R_W_CMD		5 << 28
 #define	TRANSFER_BYTES_R_W(x)		(TRANSFER_R_W_CMD | (x & 0xF))
 
+/* Maximum number of commands in a message */
+#define SPI_ENGINE_MAX_MSG_CMDS		32
+/* Message commands plus the clock divider, configuration and sync commands */
+#define SPI_ENGINE_CMD_FIFO_SIZE	(SPI_ENGINE_MAX_MSG_CMDS + 3)
+
 /* Size of an array in bytes */
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
+typedef struct {
+	uint32_t	cmd_fifo_len;
+	uint16_t	cmd_fifo[SPI_ENGINE_CMD_FIFO_SIZE];
+} spi_eng_transfer_fifo;
+
 typedef struct {
 	uint32_t	spi_baseaddr;
 	uint8_t		chip_select;
@@ -181,6 +191,8 @@ typedef struct {
 	uint32_t	tx_dma_startaddr;
 	uint8_t		offload_configured;
 	uint8_t		data_width_bytes;
+	/* Scratch command FIFO used to compile the messages */
+	spi_eng_transfer_fifo	xfer;
 #ifdef DUAL_SPI
 } spi_eng_desc;
 #else
@@ -212,11 +224,6 @@ typedef struct {
 	uint8_t		msg_cmd_len;
 } spi_eng_msg;
 
-typedef struct {
-	uint32_t	cmd_fifo_len;
-	uint16_t	cmd_fifo[];
-} spi_eng_transfer_fifo;
-
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -37,6 +37,8 @@
 * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************/
 
+#define BUS_TRACE_IMPL
+
 /******************************************************************************/
 /***************************** Include Files **********************************/
 /******************************************************************************/
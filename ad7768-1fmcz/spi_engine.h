@@ -159,12 +159,22 @@
 #define	TRANSFER_R_W_CMD		5 << 28
 #define	TRANSFER_BYTES_R_W(x)		(TRANSFER_R_W_CMD | (x & 0xF))
 
+/* Maximum number of commands in a message */
+#define SPI_ENGINE_MAX_MSG_CMDS		32
+/* Message commands plus the clock divider, configuration, transfer length and sync commands */
+#define SPI_ENGINE_CMD_FIFO_SIZE	(SPI_ENGINE_MAX_MSG_CMDS + 4)
+
 /* Size of an array in bytes */
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
+typedef struct {
+	uint32_t	cmd_fifo_len;
+	uint16_t	cmd_fifo[SPI_ENGINE_CMD_FIFO_SIZE];
+} spi_eng_transfer_fifo;
+
 typedef struct {
 	uint32_t	spi_baseaddr;
 	uint8_t		chip_select;
@@ -185,6 +195,8 @@ typedef struct {
 	uint8_t		offload_configured;
 	uint8_t		data_width;
 	uint8_t 	max_data_width;
+	/* Scratch command FIFO used to compile the messages */
+	spi_eng_transfer_fifo	xfer;
 #ifdef DUAL_SPI
 } spi_eng_desc;
 #else
@@ -218,11 +230,6 @@ typedef struct {
 	uint8_t		msg_cmd_len;
 } spi_eng_msg;
 
-typedef struct {
-	uint32_t	cmd_fifo_len;
-	uint16_t	cmd_fifo[];
-} spi_eng_transfer_fifo;
-
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -29,6 +29,22 @@ build_drivers() {
     make -C ./drivers -f Makefile
 }
 
+build_sim() {
+    for file in ./drivers/platform/sim/*.c ./util/util.c \
+        ./util/ring_buf.c ./util/scheduler.c ./util/timestamp.c \
+        ./util/profile.c \
+        ./drivers/adc/ad7124/ad7124.c ./drivers/accel/adxl372/adxl372.c
+    do
+        gcc -c -Wall -I./include -I./drivers/platform/sim \
+            -I./drivers/adc/ad7124 -I./drivers/accel/adxl372 \
+            -o /dev/null ${file}
+    done
+    gcc -c -Wall -DBUS_TRACE -I./include -I./drivers/platform/sim \
+        -o /dev/null ./util/bus_trace.c
+    gcc -c -Wall -DPROFILING -I./include -o /dev/null ./util/profile.c
+    make -C ./tests/sim run
+}
+
 build_doxygen() {
     sudo apt-get install -y graphviz
     # Install a recent version of doxygen
@@ -43,6 +43,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
 #include "util.h"
 #include "error.h"
@@ -86,19 +87,37 @@
 #define AXI_CLKGEN_REG_DRP_STATUS	0x74
 #define AXI_CLKGEN_DRP_STATUS_BUSY	BIT(16)
 
+#define MMCM_REG_CLKOUT5_2			0x07
 #define MMCM_REG_CLKOUT0_1			0x08
 #define MMCM_REG_CLKOUT0_2			0x09
 #define MMCM_REG_CLKOUT1_1			0x0A
 #define MMCM_REG_CLKOUT1_2			0x0B
+#define MMCM_REG_CLKOUT6_2			0x13
 #define MMCM_REG_CLK_FB1			0x14
 #define MMCM_REG_CLK_FB2			0x15
 #define MMCM_REG_CLK_DIV			0x16
 #define MMCM_REG_LOCK1				0x18
 #define MMCM_REG_LOCK2				0x19
 #define MMCM_REG_LOCK3				0x1a
+#define MMCM_REG_POWER				0x28
 #define MMCM_REG_FILTER1			0x4e
 #define MMCM_REG_FILTER2			0x4f
 
+#define MMCM_CLKOUT_NOCOUNT			BIT(6)
+#define MMCM_CLK_EDGE				BIT(7)
+#define MMCM_CLK_FRAC_EN			BIT(11)
+#define MMCM_CLK_DIV_NOCOUNT		BIT(12)
+
+#define AXI_CLKGEN_D_MAX			80
+#define AXI_CLKGEN_M_MAX			64
+#define AXI_CLKGEN_DOUT_MAX			128
+/* Fractional output dividers tried on each side of the ideal one, in 1/8 */
+#define AXI_CLKGEN_FRAC_DOUT_SPAN		16
+/* Fractional search stop, the integer error divided by this */
+#define AXI_CLKGEN_FRAC_ERR_DIV			8
+/* Fractional search stop, error in parts per billion of the target */
+#define AXI_CLKGEN_FRAC_ERR_PPB			1000
+
 static const uint32_t axi_clkgen_filter_table[] = {
 	0x01001990, 0x01001190, 0x01009890, 0x01001890,
 	0x01008890, 0x01009090, 0x01009090, 0x01009090,
@@ -154,6 +173,33 @@ enum axi_fpga_speed_grade {
 	AXI_FPGA_SPEED_3	= 30,
 };
 
+struct axi_clkgen_div_params {
+	uint32_t low;
+	uint32_t high;
+	uint32_t edge;
+	uint32_t nocount;
+	uint32_t frac_en;
+	uint32_t frac;
+	uint32_t frac_wf_f;
+	uint32_t frac_wf_r;
+	uint32_t frac_phase;
+};
+
+struct axi_clkgen_solver {
+	const struct axi_clkgen_limits *limits;
+	/* [Hz] */
+	uint32_t fin;
+	uint32_t fout;
+	/* [kHz], as the limits */
+	uint32_t fin_khz;
+	uint32_t fout_khz;
+	uint32_t d_min;
+	uint32_t d_max;
+	struct axi_clkgen_params best;
+	/* [Hz] */
+	uint32_t best_err;
+};
+
 /**
  * @brief axi_clkgen_write
  */
@@ -310,6 +356,195 @@ static void axi_clkgen_setup_ranges(struct axi_clkgen *axi_clkgen,
 		*fvco_max = 1600000;
 		*fvco_min = 800000;
 	}
+
+	/* The MMCMs of these families have fractional CLKOUT0 and CLKFBOUT */
+	axi_clkgen->frac_enable = (tech == AXI_FPGA_TECH_SERIES7 ||
+				   tech == AXI_FPGA_TECH_ULTRASCALE ||
+				   tech == AXI_FPGA_TECH_ULTRASCALE_PLUS);
+}
+
+/**
+ * @brief axi_clkgen_setup_limits
+ */
+static void axi_clkgen_setup_limits(struct axi_clkgen *axi_clkgen)
+{
+	struct axi_clkgen_limits *limits = &axi_clkgen->limits;
+	uint32_t pcore_version;
+
+	limits->fpfd_min = 10000;
+	limits->fpfd_max = 300000;
+	limits->fvco_min = 600000;
+	limits->fvco_max = 1200000;
+	axi_clkgen->frac_enable = false;
+
+	axi_clkgen_read(axi_clkgen, AXI_REG_VERSION, &pcore_version);
+	if (AXI_PCORE_VER_MAJOR(pcore_version) > 0x04)
+		axi_clkgen_setup_ranges(axi_clkgen,
+					&limits->fpfd_min, &limits->fpfd_max,
+					&limits->fvco_min, &limits->fvco_max);
+}
+
+/**
+ * @brief axi_clkgen_check_params
+ *
+ * Keep a setting if it is within the MMCM limits and closer to the target
+ * than the best one so far.
+ * @return true if the setting is exact.
+ */
+static bool axi_clkgen_check_params(struct axi_clkgen_solver *s,
+				    uint32_t d, uint32_t m, uint32_t dout)
+{
+	uint64_t fvco, f;
+	uint32_t err;
+
+	if (d < s->d_min || d > s->d_max)
+		return false;
+	/* A fractional divider can not be below 2 */
+	if (m < ((m & 0x7) ? 16 : 8) || m > AXI_CLKGEN_M_MAX * 8)
+		return false;
+	if (dout < ((dout & 0x7) ? 16 : 8) || dout > AXI_CLKGEN_DOUT_MAX * 8)
+		return false;
+
+	fvco = (uint64_t)s->fin_khz * m / (8 * d);
+	if (fvco < s->limits->fvco_min || fvco > s->limits->fvco_max)
+		return false;
+
+	f = DIV_ROUND_CLOSEST_ULL((uint64_t)s->fin * m, (uint64_t)d * dout);
+	if (f > s->fout)
+		err = min_t(uint64_t, f - s->fout, 0xffffffff);
+	else
+		err = s->fout - f;
+
+	if (err < s->best_err) {
+		s->best_err = err;
+		s->best.d = d;
+		s->best.m = m;
+		s->best.dout = dout;
+	}
+
+	return err == 0;
+}
+
+/**
+ * @brief axi_clkgen_solve_approx
+ *
+ * The best m / d for the output divider dout is the best rational
+ * approximation of fout * dout / fin, with the VCO kept in range.
+ * @return true if the setting is exact.
+ */
+static bool axi_clkgen_solve_approx(struct axi_clkgen_solver *s, uint32_t dout,
+				    uint32_t step)
+{
+	uint32_t m_max = AXI_CLKGEN_M_MAX * 8 / step;
+	uint64_t num, num_min, num_max;
+	uint32_t m, d, k;
+
+	num_min = 8ULL * s->limits->fvco_min / step;
+	num_max = 8ULL * s->limits->fvco_max / step;
+	num = clamp((uint64_t)s->fout_khz * (dout / step), num_min, num_max);
+	if (num > 0xffffffff)
+		return false;
+	rational_best_approximation(num, s->fin_khz, m_max, s->d_max, &m, &d);
+	if (!m || !d)
+		return false;
+	k = max(DIV_ROUND_UP(s->d_min, d), 1);
+
+	return axi_clkgen_check_params(s, d * k, m * k * step, dout);
+}
+
+/**
+ * @brief axi_clkgen_solve
+ *
+ * Search the settings with dividers in steps of 'step' eighths: 8 for
+ * integer dividers, 1 for fractional ones. For each output divider dout the
+ * MMCM must multiply the input by fout * dout / fin. An exact m / d exists
+ * when that ratio, reduced with the GCD, fits the limits, so all dividers
+ * are first checked that way. Otherwise the best m / d for each divider is
+ * its best rational approximation.
+ * @return true if an exact setting was found.
+ */
+static bool axi_clkgen_solve(struct axi_clkgen_solver *s, uint32_t step)
+{
+	uint32_t fin = s->fin_khz, fout = s->fout_khz;
+	uint32_t dout, dout_min, dout_max;
+	uint32_t m_max = AXI_CLKGEN_M_MAX * 8 / step;
+	uint32_t p, q, g, m, d, k;
+	uint64_t num;
+
+	/*
+	 * Output dividers keeping the VCO in range, in eighths, and the next
+	 * ones out: m / d may round the VCO back in range.
+	 */
+	dout_min = clamp_t(uint64_t, 8ULL * s->limits->fvco_min / fout / step * step,
+			   8, AXI_CLKGEN_DOUT_MAX * 8);
+	dout_max = clamp_t(uint64_t, DIV_ROUND_UP(DIV_ROUND_UP(8ULL *
+			   s->limits->fvco_max, fout), step) * step,
+			   8, AXI_CLKGEN_DOUT_MAX * 8);
+
+	/* fout / fin = p / q: m / d = p * dout / q, in units of 'step' */
+	g = greatest_common_divisor(fout, fin);
+	p = fout / g;
+	q = fin / g;
+	for (dout = dout_min; dout <= dout_max; dout += step) {
+		g = greatest_common_divisor(dout / step, q);
+		num = (uint64_t)p * (dout / step / g);
+		d = q / g;
+		if (num > m_max || d > s->d_max)
+			continue;
+		m = num;
+		k = max(DIV_ROUND_UP(s->d_min, d), 1);
+		if (axi_clkgen_check_params(s, d * k, m * k * step, dout))
+			return true;
+	}
+
+	for (dout = dout_min; dout <= dout_max; dout += step)
+		if (axi_clkgen_solve_approx(s, dout, step))
+			return true;
+
+	return false;
+}
+
+/**
+ * @brief axi_clkgen_solve_frac
+ *
+ * Search the fractional output dividers, after the integer ones. Only the
+ * AXI_CLKGEN_FRAC_DOUT_SPAN dividers on each side of the one putting the
+ * VCO mid-range are tried, closest first. Nearby dividers give independent
+ * rational approximations, so a few of them are enough: the search stops
+ * once the error is below the integer one divided by AXI_CLKGEN_FRAC_ERR_DIV
+ * or below AXI_CLKGEN_FRAC_ERR_PPB of the target. The best approximation is
+ * the exact m / d when there is one, no separate exact check is needed.
+ */
+static void axi_clkgen_solve_frac(struct axi_clkgen_solver *s)
+{
+	uint32_t dout, dout_mid, dout_min, dout_max;
+	uint32_t i, target;
+
+	dout_mid = ((uint64_t)s->limits->fvco_min + s->limits->fvco_max) * 4 /
+		   s->fout_khz;
+	dout_min = max_t(int64_t, (int64_t)dout_mid - AXI_CLKGEN_FRAC_DOUT_SPAN, 8);
+	dout_max = min_t(uint64_t, (uint64_t)dout_mid + AXI_CLKGEN_FRAC_DOUT_SPAN,
+			 AXI_CLKGEN_DOUT_MAX * 8);
+	if (dout_min > dout_max)
+		return;
+	dout_mid = clamp(dout_mid, dout_min, dout_max);
+
+	target = max_t(uint64_t, s->best_err / AXI_CLKGEN_FRAC_ERR_DIV,
+		       (uint64_t)s->fout * AXI_CLKGEN_FRAC_ERR_PPB / 1000000000);
+
+	for (i = 0; i <= 2 * AXI_CLKGEN_FRAC_DOUT_SPAN; i++) {
+		/* dout_mid, dout_mid + 1, dout_mid - 1, dout_mid + 2, ... */
+		if (i & 1)
+			dout = dout_mid + (i + 1) / 2;
+		else
+			dout = dout_mid - i / 2;
+		if (dout < dout_min || dout > dout_max)
+			continue;
+
+		if (axi_clkgen_solve_approx(s, dout, 1) ||
+		    s->best_err <= target)
+			return;
+	}
 }
 
 /**
@@ -318,84 +553,119 @@ static void axi_clkgen_setup_ranges(struct axi_clkgen *axi_clkgen,
 void axi_clkgen_calc_params(struct axi_clkgen *axi_clkgen,
 			    uint32_t fin,
 			    uint32_t fout,
-			    uint32_t *best_d,
-			    uint32_t *best_m,
-			    uint32_t *best_dout)
+			    struct axi_clkgen_params *params)
 {
-	uint32_t fpfd_min	= 10000;
-	uint32_t fpfd_max	= 300000;
-	uint32_t fvco_min	= 600000;
-	uint32_t fvco_max	= 1200000;
-	uint32_t	   d		= 0;
-	uint32_t	   d_min	= 0;
-	uint32_t	   d_max	= 0;
-	uint32_t	   _d_min	= 0;
-	uint32_t	   _d_max	= 0;
-	uint32_t	   m		= 0;
-	uint32_t	   m_min	= 0;
-	uint32_t	   m_max	= 0;
-	uint32_t	   dout		= 0;
-	uint32_t	   fvco		= 0;
-	int32_t		   f		= 0;
-	int32_t		   best_f	= 0;
-	uint32_t pcore_version;
+	struct axi_clkgen_solver s;
+
+	s.limits = &axi_clkgen->limits;
+	s.fin = fin;
+	s.fout = fout;
+	s.fin_khz = fin / 1000;
+	s.fout_khz = fout / 1000;
+	s.best_err = 0xffffffff;
+	s.best.d = 0;
+	s.best.m = 0;
+	s.best.dout = 0;
+
+	s.d_min = max(DIV_ROUND_UP(s.fin_khz, s.limits->fpfd_max), 1);
+	s.d_max = min(s.fin_khz / s.limits->fpfd_min, AXI_CLKGEN_D_MAX);
+
+	if (s.fin_khz && s.fout_khz && s.d_min <= s.d_max) {
+		/* Fractional dividers only if no integer setting is exact */
+		if (!axi_clkgen_solve(&s, 8) && axi_clkgen->frac_enable)
+			axi_clkgen_solve_frac(&s);
+	}
 
-	axi_clkgen_read(axi_clkgen, AXI_REG_VERSION, &pcore_version);
-	if (AXI_PCORE_VER_MAJOR(pcore_version) > 0x04)
-		axi_clkgen_setup_ranges(axi_clkgen, &fpfd_min, &fpfd_max,
-					&fvco_min, &fvco_max);
-
-	fin /= 1000;
-	fout /= 1000;
-
-	best_f = 0x7fffffff;
-	*best_d = 0;
-	*best_m = 0;
-	*best_dout = 0;
-
-	d_min = max(DIV_ROUND_UP(fin, fpfd_max), 1);
-	d_max = min(fin / fpfd_min, 80);
-
-	m_min = max(DIV_ROUND_UP(fvco_min, fin) * d_min, 1);
-	m_max = min(fvco_max * d_max / fin, 64);
-
-	for(m = m_min; m <= m_max; m++) {
-		_d_min = max(d_min, DIV_ROUND_UP(fin * m, fvco_max));
-		_d_max = min(d_max, fin * m / fvco_min);
-
-		for (d = _d_min; d <= _d_max; d++) {
-			fvco = fin * m / d;
-			dout = DIV_ROUND_CLOSEST(fvco, fout);
-			dout = clamp(dout, 1, 128);
-			f = fvco / dout;
-			if (abs(f - (int32_t)fout) < abs(best_f - (int32_t)fout)) {
-				best_f = f;
-				*best_d = d;
-				*best_m = m;
-				*best_dout = dout;
-				if (best_f == (int32_t)fout)
-					return;
-			}
+	*params = s.best;
+}
+
+/**
+ * @brief axi_clkgen_params_get
+ */
+static void axi_clkgen_params_get(struct axi_clkgen *clkgen, uint32_t rate,
+				  struct axi_clkgen_params *params)
+{
+	struct axi_clkgen_rate_config *entry;
+	uint32_t i;
+
+	for (i = 0; i < AXI_CLKGEN_RATE_CACHE_SIZE; i++) {
+		entry = &clkgen->rate_cache[i];
+		if (entry->rate == rate &&
+		    entry->parent_rate == clkgen->parent_rate) {
+			*params = entry->params;
+			return;
 		}
 	}
+
+	axi_clkgen_calc_params(clkgen, clkgen->parent_rate, rate, params);
+	if (!params->d || !params->m || !params->dout)
+		return;
+
+	entry = &clkgen->rate_cache[clkgen->rate_cache_next];
+	entry->parent_rate = clkgen->parent_rate;
+	entry->rate = rate;
+	entry->params = *params;
+	clkgen->rate_cache_next = (clkgen->rate_cache_next + 1) %
+				  AXI_CLKGEN_RATE_CACHE_SIZE;
 }
 
 /**
  * @brief axi_clkgen_calc_clk_params
  */
 void axi_clkgen_calc_clk_params(uint32_t divider,
-				uint32_t *low,
-				uint32_t *high,
-				uint32_t *edge,
-				uint32_t *nocount)
+				uint32_t frac_divider,
+				struct axi_clkgen_div_params *params)
 {
-	if (divider == 1)
-		*nocount = 1;
-	else
-		*nocount = 0;
-	*high = divider / 2;
-	*edge = divider % 2;
-	*low = divider - *high;
+	memset(params, 0, sizeof(*params));
+
+	if (divider == 1) {
+		params->nocount = 1;
+		return;
+	}
+
+	params->high = divider / 2;
+	params->edge = divider % 2;
+
+	if (frac_divider == 0) {
+		params->low = divider - params->high;
+		return;
+	}
+
+	params->frac_en = 1;
+	params->frac = frac_divider;
+	params->low = params->high;
+
+	if (params->edge == 0) {
+		params->high--;
+		params->frac_wf_r = 1;
+	}
+
+	if (params->edge == 0 || frac_divider == 1)
+		params->low--;
+	if (((params->edge == 0) ^ (frac_divider == 1)) ||
+	    (divider == 2 && frac_divider == 1))
+		params->frac_wf_f = 1;
+
+	params->frac_phase = params->edge * 4 + frac_divider / 2;
+}
+
+/**
+ * @brief axi_clkgen_write_div
+ */
+static void axi_clkgen_write_div(struct axi_clkgen *clkgen,
+				 uint32_t reg1, uint32_t reg2, uint32_t reg3,
+				 struct axi_clkgen_div_params *params)
+{
+	axi_clkgen_mmcm_write(clkgen, reg1,
+			      (params->high << 6) | params->low, 0xefff);
+	axi_clkgen_mmcm_write(clkgen, reg2,
+			      (params->frac << 12) | (params->frac_en << 11) |
+			      (params->frac_wf_r << 10) | (params->edge << 7) |
+			      (params->nocount << 6), reg3 ? 0x7fff : 0x03ff);
+	if (reg3)
+		axi_clkgen_mmcm_write(clkgen, reg3,
+				      (params->frac_phase << 11) |
+				      (params->frac_wf_f << 10), 0x3c00);
 }
 
 /**
@@ -418,49 +688,51 @@ static void axi_clkgen_mmcm_enable(struct axi_clkgen *clkgen,
 int32_t axi_clkgen_set_rate(struct axi_clkgen *clkgen,
 			    uint32_t rate)
 {
-	uint32_t d		 = 0;
-	uint32_t m		 = 0;
-	uint32_t dout	 = 0;
-	uint32_t nocount = 0;
-	uint32_t high	 = 0;
-	uint32_t edge	 = 0;
-	uint32_t low	 = 0;
+	struct axi_clkgen_params params;
+	struct axi_clkgen_div_params div;
+	uint32_t dout1;
 	uint32_t filter  = 0;
 	uint32_t lock	 = 0;
+	uint32_t power	 = 0;
 	uint32_t reg_val;
 
 	if (clkgen->parent_rate == 0 || rate == 0)
 		return 0;
 
-	axi_clkgen_calc_params(clkgen, clkgen->parent_rate, rate, &d, &m, &dout);
+	axi_clkgen_params_get(clkgen, rate, &params);
 
-	if (d == 0 || dout == 0 || m == 0)
+	if (params.d == 0 || params.dout == 0 || params.m == 0)
 		return 0;
 
-	filter = axi_clkgen_lookup_filter(m - 1);
-	lock = axi_clkgen_lookup_lock(m - 1);
+	/* The tables are indexed by the integer part of the multiplier */
+	filter = axi_clkgen_lookup_filter((params.m >> 3) - 1);
+	lock = axi_clkgen_lookup_lock((params.m >> 3) - 1);
+
+	if ((params.dout & 0x7) || (params.m & 0x7))
+		power = 0x9800;
 
 	axi_clkgen_mmcm_enable(clkgen, 0);
 
-	axi_clkgen_calc_clk_params(dout, &low, &high, &edge, &nocount);
-	axi_clkgen_mmcm_write(clkgen, MMCM_REG_CLKOUT0_1, (high << 6) | low, 0xefff);
-	axi_clkgen_mmcm_write(clkgen, MMCM_REG_CLKOUT0_2, (edge << 7) | (nocount << 6),
-			      0x03ff);
+	axi_clkgen_mmcm_write(clkgen, MMCM_REG_POWER, power, 0x9800);
+
+	axi_clkgen_calc_clk_params(params.dout >> 3, params.dout & 0x7, &div);
+	axi_clkgen_write_div(clkgen, MMCM_REG_CLKOUT0_1, MMCM_REG_CLKOUT0_2,
+			     MMCM_REG_CLKOUT5_2, &div);
 
-	dout *= 4;
-	axi_clkgen_calc_clk_params(dout, &low, &high, &edge, &nocount);
-	axi_clkgen_mmcm_write(clkgen, MMCM_REG_CLKOUT1_1, (high << 6) | low, 0xefff);
-	axi_clkgen_mmcm_write(clkgen, MMCM_REG_CLKOUT1_2, (edge << 7) | (nocount << 6),
-			      0x03ff);
+	/* CLKOUT1 runs at a quarter of CLKOUT0, it has no fractional divider */
+	dout1 = clamp(DIV_ROUND_CLOSEST(params.dout, 2), 1, AXI_CLKGEN_DOUT_MAX);
+	axi_clkgen_calc_clk_params(dout1, 0, &div);
+	axi_clkgen_write_div(clkgen, MMCM_REG_CLKOUT1_1, MMCM_REG_CLKOUT1_2,
+			     0, &div);
 
-	axi_clkgen_calc_clk_params(d, &low, &high, &edge, &nocount);
+	axi_clkgen_calc_clk_params(params.d, 0, &div);
 	axi_clkgen_mmcm_write(clkgen, MMCM_REG_CLK_DIV,
-			      (edge << 13) | (nocount << 12) | (high << 6) | low, 0x3fff);
+			      (div.edge << 13) | (div.nocount << 12) |
+			      (div.high << 6) | div.low, 0x3fff);
 
-	axi_clkgen_calc_clk_params(m, &low, &high, &edge, &nocount);
-	axi_clkgen_mmcm_write(clkgen, MMCM_REG_CLK_FB1, (high << 6) | low, 0xefff);
-	axi_clkgen_mmcm_write(clkgen, MMCM_REG_CLK_FB2, (edge << 7) | (nocount << 6),
-			      0x03ff);
+	axi_clkgen_calc_clk_params(params.m >> 3, params.m & 0x7, &div);
+	axi_clkgen_write_div(clkgen, MMCM_REG_CLK_FB1, MMCM_REG_CLK_FB2,
+			     MMCM_REG_CLKOUT6_2, &div);
 
 	axi_clkgen_mmcm_write(clkgen, MMCM_REG_LOCK1, lock & 0x3ff, 0x3ff);
 	axi_clkgen_mmcm_write(clkgen, MMCM_REG_LOCK2,
@@ -486,6 +758,36 @@ int32_t axi_clkgen_set_rate(struct axi_clkgen *clkgen,
 	return SUCCESS;
 }
 
+/**
+ * @brief axi_clkgen_get_div
+ *
+ * Read back a divider, in 1/8 steps if it has a fractional part.
+ */
+static uint32_t axi_clkgen_get_div(struct axi_clkgen *clkgen,
+				   uint32_t reg1, uint32_t reg2)
+{
+	uint32_t val1, val2;
+	uint32_t div;
+
+	axi_clkgen_mmcm_read(clkgen, reg2, &val2);
+	if (val2 & MMCM_CLKOUT_NOCOUNT)
+		return 8;
+
+	axi_clkgen_mmcm_read(clkgen, reg1, &val1);
+	div = ((val1 & 0x3f) + ((val1 >> 6) & 0x3f)) * 8;
+
+	/* Undo the high/low time adjustments of axi_clkgen_calc_clk_params() */
+	if (val2 & MMCM_CLK_FRAC_EN) {
+		if ((val2 & MMCM_CLK_EDGE) && ((val2 >> 12) & 0x7) != 1)
+			div += 8;
+		else
+			div += 16;
+		div += (val2 >> 12) & 0x7;
+	}
+
+	return div;
+}
+
 /**
  * @brief axi_clkgen_get_rate
  */
@@ -495,25 +797,27 @@ int32_t axi_clkgen_get_rate(struct axi_clkgen *clkgen, uint32_t *rate)
 	uint32_t reg;
 	uint64_t tmp;
 
-	axi_clkgen_mmcm_read(clkgen, MMCM_REG_CLKOUT0_1, &reg);
-	dout = (reg & 0x3f) + ((reg >> 6) & 0x3f);
+	dout = axi_clkgen_get_div(clkgen, MMCM_REG_CLKOUT0_1,
+				  MMCM_REG_CLKOUT0_2);
 	axi_clkgen_mmcm_read(clkgen, MMCM_REG_CLK_DIV, &reg);
-	d = (reg & 0x3f) + ((reg >> 6) & 0x3f);
-	axi_clkgen_mmcm_read(clkgen, MMCM_REG_CLK_FB1, &reg);
-	m = (reg & 0x3f) + ((reg >> 6) & 0x3f);
+	if (reg & MMCM_CLK_DIV_NOCOUNT)
+		d = 1;
+	else
+		d = (reg & 0x3f) + ((reg >> 6) & 0x3f);
+	m = axi_clkgen_get_div(clkgen, MMCM_REG_CLK_FB1, MMCM_REG_CLK_FB2);
 
 	if (d == 0 || dout == 0) {
 		*rate = 0;
 		return SUCCESS;
 	}
 
-	tmp = (uint64_t)(clkgen->parent_rate / d) * m;
-	tmp = tmp / dout;
+	tmp = (uint64_t)clkgen->parent_rate * m;
+	tmp = tmp / ((uint64_t)d * dout);
 
 	if (tmp > 0xffffffff)
 		*rate = 0xffffffff;
-
-	*rate = (uint32_t)tmp;
+	else
+		*rate = (uint32_t)tmp;
 
 	return SUCCESS;
 }
@@ -533,6 +837,10 @@ int32_t axi_clkgen_init(struct axi_clkgen **clk,
 	clkgen->base = init->base;
 	clkgen->name = init->name;
 	clkgen->parent_rate = init->parent_rate;
+	memset(clkgen->rate_cache, 0, sizeof(clkgen->rate_cache));
+	clkgen->rate_cache_next = 0;
+
+	axi_clkgen_setup_limits(clkgen);
 
 	*clk = clkgen;
 
@@ -43,14 +43,45 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define AXI_CLKGEN_RATE_CACHE_SIZE	4
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
+struct axi_clkgen_limits {
+	uint32_t	fpfd_min;
+	uint32_t	fpfd_max;
+	uint32_t	fvco_min;
+	uint32_t	fvco_max;
+};
+
+/* MMCM setting: m and dout are in 1/8 steps */
+struct axi_clkgen_params {
+	uint32_t	d;
+	uint32_t	m;
+	uint32_t	dout;
+};
+
+struct axi_clkgen_rate_config {
+	uint32_t	parent_rate;
+	uint32_t	rate;
+	struct axi_clkgen_params	params;
+};
+
 struct axi_clkgen {
 	const char	*name;
 	uint32_t	base;
 	uint32_t	parent_rate;
+	struct axi_clkgen_limits	limits;
+	/* Fractional CLKOUT0 and CLKFBOUT dividers */
+	bool		frac_enable;
+	struct axi_clkgen_rate_config	rate_cache[AXI_CLKGEN_RATE_CACHE_SIZE];
+	uint32_t	rate_cache_next;
 };
 
 struct axi_clkgen_init {
@@ -62,6 +93,10 @@ struct axi_clkgen_init {
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
+void axi_clkgen_calc_params(struct axi_clkgen *axi_clkgen,
+			    uint32_t fin,
+			    uint32_t fout,
+			    struct axi_clkgen_params *params);
 int32_t axi_clkgen_set_rate(struct axi_clkgen *clkgen, uint32_t rate);
 int32_t axi_clkgen_get_rate(struct axi_clkgen *clkgen, uint32_t *rate);
 int32_t axi_clkgen_init(struct axi_clkgen **clk,
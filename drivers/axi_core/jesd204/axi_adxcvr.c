@@ -81,11 +81,10 @@
 #define ADXCVR_DRP_PORT_ADDR_COMMON		0x00
 #define ADXCVR_DRP_PORT_ADDR_CHANNEL	0x20
 
-#define ADXCVR_DRP_PORT_COMMON(x)		(x)
-#define ADXCVR_DRP_PORT_CHANNEL(x)		(0x100 + (x))
-
 #define ADXCVR_BROADCAST				0xff
 
+#define ADXCVR_DRP_SPIN_POLLS			100
+
 /**
  * @brief adxcvr_write
  */
@@ -116,16 +115,26 @@ int32_t adxcvr_read(struct adxcvr *xcvr,
 int32_t adxcvr_drp_wait_idle(struct adxcvr *xcvr,
 			     uint32_t drp_addr)
 {
+	uint32_t spin = ADXCVR_DRP_SPIN_POLLS;
 	uint32_t val;
 	int32_t timeout = 20;
 
-	do {
+	for (;;) {
 		adxcvr_read(xcvr, ADXCVR_REG_DRP_STATUS(drp_addr), &val);
 		if (!(val & ADXCVR_DRP_STATUS_BUSY))
 			return ADXCVR_DRP_STATUS_RDATA(val);
 
+		/* A DRP access takes a few DRP clock cycles, poll before sleeping */
+		if (spin) {
+			spin--;
+			continue;
+		}
+
+		if (!timeout--)
+			break;
+
 		mdelay(1);
-	} while (timeout--);
+	}
 
 	printf("%s: %s: Timeout!", xcvr->name, __func__);
 
@@ -192,70 +201,293 @@ int32_t adxcvr_drp_write(struct adxcvr *xcvr,
 }
 
 /**
- * @brief adxcvr_clk_set_rate
+ * @brief adxcvr_lane_mask
  */
-int32_t adxcvr_clk_set_rate(struct adxcvr *xcvr,
-			    uint32_t rate,
-			    uint32_t parent_rate)
+static uint32_t adxcvr_lane_mask(struct adxcvr *xcvr)
 {
-	struct xilinx_xcvr_cpll_config cpll_conf;
-	struct xilinx_xcvr_qpll_config qpll_conf;
-	uint32_t out_div, clk25_div;
-	uint32_t i;
-	int32_t ret;
+	if (xcvr->num_lanes >= 32)
+		return 0xffffffff;
 
-	clk25_div = DIV_ROUND_CLOSEST(parent_rate, 25000);
+	return (1UL << xcvr->num_lanes) - 1;
+}
 
-	if (xcvr->cpll_enable)
-		ret = xilinx_xcvr_calc_cpll_config(&xcvr->xlx_xcvr, parent_rate, rate,
-						   &cpll_conf, &out_div);
-	else
-		ret = xilinx_xcvr_calc_qpll_config(&xcvr->xlx_xcvr, parent_rate, rate,
-						   &qpll_conf, &out_div);
+/**
+ * @brief adxcvr_drp_start
+ *
+ * Start a DRP access once the previous one on the same interface is done,
+ * without waiting for the new one to complete.
+ */
+static int32_t adxcvr_drp_start(struct adxcvr *xcvr,
+				uint32_t drp_addr,
+				uint32_t drp_sel,
+				uint32_t ctrl)
+{
+	int32_t ret;
+
+	ret = adxcvr_drp_wait_idle(xcvr, drp_addr);
 	if (ret < 0)
 		return ret;
 
-	for (i = 0; i < xcvr->num_lanes; i++) {
+	adxcvr_write(xcvr, ADXCVR_REG_DRP_SEL(drp_addr), drp_sel);
+	adxcvr_write(xcvr, ADXCVR_REG_DRP_CTRL(drp_addr), ctrl);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_drp_batch_init
+ */
+void adxcvr_drp_batch_init(struct adxcvr_drp_batch *batch,
+			   struct adxcvr *xcvr)
+{
+	batch->xcvr = xcvr;
+	batch->num_ops = 0;
+}
+
+/**
+ * @brief adxcvr_drp_batch_update
+ *
+ * Queue a masked write of a register on the channels (or the commons) of
+ * the lanes in lane_mask. The same write queued for other lanes is merged,
+ * unless a later write of the register on some of these lanes would then be
+ * issued after it instead of before.
+ */
+int32_t adxcvr_drp_batch_update(struct adxcvr_drp_batch *batch,
+				bool common,
+				uint32_t lane_mask,
+				uint32_t reg,
+				uint32_t mask,
+				uint32_t val)
+{
+	struct adxcvr_drp_op *op;
+	uint32_t i;
+	int32_t ret;
+
+	mask &= 0xffff;
+	val &= mask;
+
+	for (i = batch->num_ops; i > 0; i--) {
+		op = &batch->ops[i - 1];
+		if (op->common != common || op->reg != reg)
+			continue;
+
+		if (op->mask == mask && op->val == val) {
+			op->lane_mask |= lane_mask;
+			return SUCCESS;
+		}
+
+		if (op->lane_mask & lane_mask)
+			break;
+	}
 
-		if (xcvr->cpll_enable)
-			ret = xilinx_xcvr_cpll_write_config(&xcvr->xlx_xcvr,
-							    ADXCVR_DRP_PORT_CHANNEL(i),
-							    &cpll_conf);
-		else if (i % 4 == 0)
-			ret = xilinx_xcvr_qpll_write_config(&xcvr->xlx_xcvr,
-							    ADXCVR_DRP_PORT_COMMON(i),
-							    &qpll_conf);
+	if (batch->num_ops == ADXCVR_DRP_BATCH_SIZE) {
+		ret = adxcvr_drp_batch_commit(batch);
 		if (ret < 0)
 			return ret;
+	}
 
-		ret = xilinx_xcvr_write_out_div(&xcvr->xlx_xcvr,
-						ADXCVR_DRP_PORT_CHANNEL(i),
-						xcvr->tx_enable ? -1 : (int32_t)out_div,
-						xcvr->tx_enable ? (int32_t)out_div : -1);
+	op = &batch->ops[batch->num_ops++];
+	op->common = common;
+	op->lane_mask = lane_mask;
+	op->reg = reg;
+	op->mask = mask;
+	op->val = val;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_drp_batch_image
+ */
+int32_t adxcvr_drp_batch_image(struct adxcvr_drp_batch *batch,
+			       bool common,
+			       uint32_t lane_mask,
+			       const struct xilinx_xcvr_reg_image *image)
+{
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < image->num_regs; i++) {
+		ret = adxcvr_drp_batch_update(batch, common, lane_mask,
+					      image->regs[i].reg,
+					      image->regs[i].mask,
+					      image->regs[i].val);
 		if (ret < 0)
 			return ret;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_drp_batch_commit
+ *
+ * Writes are not waited for, each access only waits for the previous one on
+ * its interface. A write that sets every channel to the same value is
+ * broadcast. That covers masked writes too when the channels read back the
+ * same unmasked bits.
+ */
+int32_t adxcvr_drp_batch_commit(struct adxcvr_drp_batch *batch)
+{
+	struct adxcvr *xcvr = batch->xcvr;
+	uint32_t read_val[32];
+	uint32_t drp_addr, keep, val;
+	struct adxcvr_drp_op *op;
+	uint32_t i, lane;
+	bool broadcast;
+	int32_t ret;
+
+	for (i = 0; i < batch->num_ops; i++) {
+		op = &batch->ops[i];
+		op->lane_mask &= adxcvr_lane_mask(xcvr);
+
+		if (op->common)
+			drp_addr = ADXCVR_DRP_PORT_ADDR_COMMON;
+		else
+			drp_addr = ADXCVR_DRP_PORT_ADDR_CHANNEL;
+
+		broadcast = !op->common && xcvr->num_lanes > 1 &&
+			    op->lane_mask == adxcvr_lane_mask(xcvr);
+		keep = 0;
+
+		if (op->mask != 0xffff) {
+			for (lane = 0; lane < 32; lane++) {
+				if (!(op->lane_mask & BIT(lane)))
+					continue;
+
+				ret = adxcvr_drp_start(xcvr, drp_addr, lane,
+						       ADXCVR_DRP_CTRL_ADDR(op->reg));
+				if (ret < 0)
+					goto out;
+
+				ret = adxcvr_drp_wait_idle(xcvr, drp_addr);
+				if (ret < 0)
+					goto out;
+
+				read_val[lane] = ret & ~op->mask & 0xffff;
+				if (lane == find_first_set_bit(op->lane_mask))
+					keep = read_val[lane];
+				else if (read_val[lane] != keep)
+					broadcast = false;
+			}
+		}
 
-		if (!xcvr->tx_enable) {
-			ret = xilinx_xcvr_configure_cdr(&xcvr->xlx_xcvr,
-							ADXCVR_DRP_PORT_CHANNEL(i),
-							rate, out_div,
-							xcvr->lpm_enable);
+		if (broadcast) {
+			ret = adxcvr_drp_start(xcvr, drp_addr, ADXCVR_BROADCAST,
+					       ADXCVR_DRP_CTRL_WR |
+					       ADXCVR_DRP_CTRL_ADDR(op->reg) |
+					       ADXCVR_DRP_CTRL_WDATA(op->val | keep));
 			if (ret < 0)
-				return ret;
-
-			ret = xilinx_xcvr_write_rx_clk25_div(&xcvr->xlx_xcvr,
-							     ADXCVR_DRP_PORT_CHANNEL(i),
-							     clk25_div);
-		} else {
-			ret = xilinx_xcvr_write_tx_clk25_div(&xcvr->xlx_xcvr,
-							     ADXCVR_DRP_PORT_CHANNEL(i),
-							     clk25_div);
+				goto out;
+
+			continue;
 		}
 
-		if (ret < 0)
-			return ret;
+		for (lane = 0; lane < 32; lane++) {
+			if (!(op->lane_mask & BIT(lane)))
+				continue;
+
+			val = op->val;
+			if (op->mask != 0xffff)
+				val |= read_val[lane];
+
+			ret = adxcvr_drp_start(xcvr, drp_addr, lane,
+					       ADXCVR_DRP_CTRL_WR |
+					       ADXCVR_DRP_CTRL_ADDR(op->reg) |
+					       ADXCVR_DRP_CTRL_WDATA(val));
+			if (ret < 0)
+				goto out;
+		}
 	}
 
+	ret = adxcvr_drp_wait_idle(xcvr, ADXCVR_DRP_PORT_ADDR_COMMON);
+	if (ret < 0)
+		goto out;
+
+	ret = adxcvr_drp_wait_idle(xcvr, ADXCVR_DRP_PORT_ADDR_CHANNEL);
+	if (ret < 0)
+		goto out;
+
+	ret = SUCCESS;
+out:
+	batch->num_ops = 0;
+
+	return ret;
+}
+
+/**
+ * @brief adxcvr_rate_config_get
+ */
+static int32_t adxcvr_rate_config_get(struct adxcvr *xcvr,
+				      uint32_t rate,
+				      uint32_t parent_rate,
+				      struct xilinx_xcvr_rate_config **conf)
+{
+	struct xilinx_xcvr_rate_config *entry;
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < ADXCVR_RATE_CACHE_SIZE; i++) {
+		entry = &xcvr->rate_cache[i];
+		if (entry->valid &&
+		    entry->refclk_khz == parent_rate &&
+		    entry->lane_rate_khz == rate &&
+		    entry->cpll_enable == xcvr->cpll_enable &&
+		    entry->lpm_enable == xcvr->lpm_enable) {
+			*conf = entry;
+			return SUCCESS;
+		}
+	}
+
+	entry = &xcvr->rate_cache[xcvr->rate_cache_next];
+	ret = xilinx_xcvr_calc_rate_config(&xcvr->xlx_xcvr, parent_rate, rate,
+					   xcvr->cpll_enable, xcvr->tx_enable,
+					   xcvr->lpm_enable, entry);
+	if (ret < 0)
+		return ret;
+
+	xcvr->rate_cache_next = (xcvr->rate_cache_next + 1) %
+				ADXCVR_RATE_CACHE_SIZE;
+	*conf = entry;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_clk_set_rate
+ */
+int32_t adxcvr_clk_set_rate(struct adxcvr *xcvr,
+			    uint32_t rate,
+			    uint32_t parent_rate)
+{
+	struct xilinx_xcvr_rate_config *conf;
+	struct adxcvr_drp_batch batch;
+	uint32_t quad_mask = 0;
+	uint32_t i;
+	int32_t ret;
+
+	ret = adxcvr_rate_config_get(xcvr, rate, parent_rate, &conf);
+	if (ret < 0)
+		return ret;
+
+	/* One QPLL common per quad */
+	for (i = 0; i < xcvr->num_lanes && i < 32; i += 4)
+		quad_mask |= BIT(i);
+
+	adxcvr_drp_batch_init(&batch, xcvr);
+
+	ret = adxcvr_drp_batch_image(&batch, true, quad_mask, &conf->common);
+	if (ret < 0)
+		return ret;
+
+	ret = adxcvr_drp_batch_image(&batch, false, adxcvr_lane_mask(xcvr),
+				     &conf->channel);
+	if (ret < 0)
+		return ret;
+
+	ret = adxcvr_drp_batch_commit(&batch);
+	if (ret < 0)
+		return ret;
 
 	xcvr->lane_rate_khz = rate;
 
@@ -327,6 +559,8 @@ static void adxcvr_get_info(struct adxcvr *xcvr)
 int32_t adxcvr_init(struct adxcvr **ad_xcvr,
 		    const struct adxcvr_init *init)
 {
+	struct xilinx_xcvr_reg_image lpm_image;
+	struct adxcvr_drp_batch batch;
 	struct adxcvr *xcvr;
 	uint32_t synth_conf, xcvr_type;
 	uint32_t i;
@@ -341,6 +575,11 @@ int32_t adxcvr_init(struct adxcvr **ad_xcvr,
 	xcvr->out_clk_sel = init->out_clk_sel;
 	xcvr->cpll_enable = init->cpll_enable;
 	xcvr->lpm_enable = init->lpm_enable;
+	xcvr->xlx_xcvr.drp_image = NULL;
+
+	for (i = 0; i < ADXCVR_RATE_CACHE_SIZE; i++)
+		xcvr->rate_cache[i].valid = false;
+	xcvr->rate_cache_next = 0;
 
 	xcvr->lane_rate_khz = init->lane_rate_khz;
 	xcvr->ref_rate_khz = init->ref_rate_khz;
@@ -400,11 +639,17 @@ int32_t adxcvr_init(struct adxcvr **ad_xcvr,
 	xcvr->xlx_xcvr.ad_xcvr = xcvr;
 
 	if (!xcvr->tx_enable) {
-		for (i = 0; i < xcvr->num_lanes; i++) {
-			xilinx_xcvr_configure_lpm_dfe_mode(&xcvr->xlx_xcvr,
-							   ADXCVR_DRP_PORT_CHANNEL(i),
-							   xcvr->lpm_enable);
-		}
+		/* Same settings on every lane, record them once and batch them */
+		xcvr->xlx_xcvr.drp_image = &lpm_image;
+		lpm_image.num_regs = 0;
+		xilinx_xcvr_configure_lpm_dfe_mode(&xcvr->xlx_xcvr, 0,
+						   xcvr->lpm_enable);
+		xcvr->xlx_xcvr.drp_image = NULL;
+
+		adxcvr_drp_batch_init(&batch, xcvr);
+		adxcvr_drp_batch_image(&batch, false, adxcvr_lane_mask(xcvr),
+				       &lpm_image);
+		adxcvr_drp_batch_commit(&batch);
 	}
 
 	if (xcvr->lane_rate_khz && xcvr->ref_rate_khz)
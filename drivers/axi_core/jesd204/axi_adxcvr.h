@@ -49,6 +49,12 @@
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
+#define ADXCVR_DRP_PORT_COMMON(x)		(x)
+#define ADXCVR_DRP_PORT_CHANNEL(x)		(0x100 + (x))
+
+#define ADXCVR_RATE_CACHE_SIZE	4
+#define ADXCVR_DRP_BATCH_SIZE	16
+
 struct adxcvr {
 	const char *name;
 	uint32_t base;
@@ -61,6 +67,22 @@ struct adxcvr {
 	uint32_t sys_clk_sel;
 	uint32_t out_clk_sel;
 	struct xilinx_xcvr xlx_xcvr;
+	struct xilinx_xcvr_rate_config rate_cache[ADXCVR_RATE_CACHE_SIZE];
+	uint32_t rate_cache_next;
+};
+
+struct adxcvr_drp_op {
+	bool common;
+	uint32_t lane_mask;
+	uint16_t reg;
+	uint16_t mask;
+	uint16_t val;
+};
+
+struct adxcvr_drp_batch {
+	struct adxcvr *xcvr;
+	uint32_t num_ops;
+	struct adxcvr_drp_op ops[ADXCVR_DRP_BATCH_SIZE];
 };
 
 struct adxcvr_init {
@@ -85,6 +107,22 @@ int32_t adxcvr_drp_write(struct adxcvr *xcvr,
 			 uint32_t drp_port,
 			 uint32_t reg,
 			 uint32_t val);
+void adxcvr_drp_batch_init(struct adxcvr_drp_batch *batch,
+			   struct adxcvr *xcvr);
+int32_t adxcvr_drp_batch_update(struct adxcvr_drp_batch *batch,
+				bool common,
+				uint32_t lane_mask,
+				uint32_t reg,
+				uint32_t mask,
+				uint32_t val);
+int32_t adxcvr_drp_batch_image(struct adxcvr_drp_batch *batch,
+			       bool common,
+			       uint32_t lane_mask,
+			       const struct xilinx_xcvr_reg_image *image);
+int32_t adxcvr_drp_batch_commit(struct adxcvr_drp_batch *batch);
+int32_t adxcvr_clk_set_rate(struct adxcvr *xcvr,
+			    uint32_t rate,
+			    uint32_t parent_rate);
 int32_t adxcvr_status_error(struct adxcvr *xcvr);
 int32_t adxcvr_clk_enable(struct adxcvr *xcvr);
 int32_t adxcvr_clk_disable(struct adxcvr *xcvr);
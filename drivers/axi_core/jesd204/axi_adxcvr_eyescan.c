@@ -0,0 +1,405 @@
+/***************************************************************************//**
+ *   @file   axi_adxcvr_eyescan.c
+ *   @brief  Statistical eye scan of the ADI AXI-ADXCVR lanes.
+ *   @author DBogdan (dragos.bogdan@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include "util.h"
+#include "error.h"
+#include "delay.h"
+#include "xilinx_transceiver.h"
+#include "axi_adxcvr.h"
+#include "axi_adxcvr_eyescan.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define ADXCVR_EYESCAN_HORZ_FULL_RATE	32
+#define ADXCVR_EYESCAN_COUNT_MAX	0xffff
+#define ADXCVR_EYESCAN_POLL_US		10
+
+/**
+ * @brief adxcvr_eyescan_init
+ */
+int32_t adxcvr_eyescan_init(struct adxcvr_eyescan **eyescan,
+			    const struct adxcvr_eyescan_init *init)
+{
+	struct adxcvr *xcvr = init->xcvr;
+	struct adxcvr_eyescan *es;
+	uint32_t out_div, horz_max, vert_max;
+	uint32_t lane_mask, i;
+	int32_t ret;
+
+	if (!xcvr || xcvr->tx_enable || !init->horz_step || !init->vert_step ||
+	    init->prescale_min > init->prescale_max || init->prescale_max > 31)
+		return FAILURE;
+
+	if (xcvr->num_lanes < ADXCVR_EYESCAN_MAX_LANES)
+		lane_mask = (1UL << xcvr->num_lanes) - 1;
+	else
+		lane_mask = 0xffffffff;
+	if (init->lane_mask)
+		lane_mask &= init->lane_mask;
+	if (!lane_mask)
+		return FAILURE;
+
+	ret = xilinx_xcvr_read_out_div(&xcvr->xlx_xcvr,
+				       ADXCVR_DRP_PORT_CHANNEL(find_first_set_bit(lane_mask)),
+				       &out_div, NULL);
+	if (ret < 0)
+		return ret;
+
+	es = (struct adxcvr_eyescan *)calloc(1, sizeof(*es));
+	if (!es)
+		return FAILURE;
+
+	es->xcvr = xcvr;
+	es->lane_mask = lane_mask;
+	es->data_width = init->data_width;
+	es->prescale_min = init->prescale_min;
+	es->prescale_max = init->prescale_max;
+	es->prescale_step = init->prescale_step ? init->prescale_step : 1;
+	/* DFE mode needs both UT signs for the full eye */
+	es->ut_count = xcvr->lpm_enable ? 1 : 2;
+
+	for (i = 0; i < ADXCVR_EYESCAN_MAX_LANES; i++)
+		if (lane_mask & BIT(i))
+			es->num_lanes++;
+
+	/* The horizontal range grows with the RX output divider */
+	horz_max = ADXCVR_EYESCAN_HORZ_FULL_RATE * out_div;
+	horz_max -= horz_max % init->horz_step;
+	es->horz_step = init->horz_step;
+	es->horz_min = -(int32_t)horz_max;
+	es->num_horz = 2 * horz_max / init->horz_step + 1;
+
+	vert_max = ADXCVR_EYESCAN_VERT_MAX - ADXCVR_EYESCAN_VERT_MAX %
+		   init->vert_step;
+	es->vert_step = init->vert_step;
+	es->vert_min = -(int32_t)vert_max;
+	es->num_vert = 2 * vert_max / init->vert_step + 1;
+
+	es->points = (struct adxcvr_eyescan_point *)calloc(es->num_lanes *
+			es->num_vert * es->num_horz, sizeof(*es->points));
+	if (!es->points)
+		goto err;
+
+	for (i = 0; i < ADXCVR_EYESCAN_MAX_LANES; i++) {
+		if (!(lane_mask & BIT(i)))
+			continue;
+
+		ret = xilinx_xcvr_eyescan_setup(&xcvr->xlx_xcvr,
+						ADXCVR_DRP_PORT_CHANNEL(i),
+						es->data_width);
+		if (ret < 0) {
+			printf("%s: lane %"PRIu32": eye scan setup failed\n",
+			       xcvr->name, i);
+			goto err_disable;
+		}
+	}
+
+	*eyescan = es;
+
+	return SUCCESS;
+
+err_disable:
+	/* Leave the lanes that were already set up as they were before */
+	while (i--)
+		if (lane_mask & BIT(i))
+			xilinx_xcvr_eyescan_disable(&xcvr->xlx_xcvr,
+						    ADXCVR_DRP_PORT_CHANNEL(i));
+err:
+	free(es->points);
+	free(es);
+
+	return FAILURE;
+}
+
+/**
+ * @brief adxcvr_eyescan_wait
+ *
+ * Wait for the measurement of a lane, allowing twice the time the sample
+ * counter needs to saturate at the current lane rate.
+ */
+static int32_t adxcvr_eyescan_wait(struct adxcvr_eyescan *es, uint32_t lane,
+				   uint32_t prescale, uint32_t *errors, uint32_t *samples)
+{
+	struct xilinx_xcvr *xlx_xcvr = &es->xcvr->xlx_xcvr;
+	uint64_t bits, timeout_us;
+	bool done;
+	int32_t ret;
+
+	bits = ((uint64_t)ADXCVR_EYESCAN_COUNT_MAX * es->data_width) <<
+	       (1 + prescale);
+	timeout_us = 2 * bits * 1000 / max_t(uint32_t, es->xcvr->lane_rate_khz, 1) +
+		     1000;
+
+	do {
+		ret = xilinx_xcvr_eyescan_read(xlx_xcvr, ADXCVR_DRP_PORT_CHANNEL(lane),
+					       &done, errors, samples);
+		if (ret < 0)
+			return ret;
+		if (done)
+			return xilinx_xcvr_eyescan_stop(xlx_xcvr,
+							ADXCVR_DRP_PORT_CHANNEL(lane));
+
+		udelay(ADXCVR_EYESCAN_POLL_US);
+		timeout_us -= min_t(uint64_t, timeout_us, ADXCVR_EYESCAN_POLL_US);
+	} while (timeout_us);
+
+	printf("%s: lane %"PRIu32": eye scan timeout\n", es->xcvr->name, lane);
+	xilinx_xcvr_eyescan_stop(xlx_xcvr, ADXCVR_DRP_PORT_CHANNEL(lane));
+
+	return FAILURE;
+}
+
+/**
+ * @brief adxcvr_eyescan_measure
+ *
+ * Measure one offset on all the lanes at once: the measurements are started
+ * on every lane before waiting for the first one. Lanes that saw no error are
+ * measured again with a larger prescale, the others are done.
+ */
+static int32_t adxcvr_eyescan_measure(struct adxcvr_eyescan *es,
+				      uint32_t vert_idx, uint32_t horz_idx)
+{
+	struct xilinx_xcvr *xlx_xcvr = &es->xcvr->xlx_xcvr;
+	uint32_t errors[ADXCVR_EYESCAN_MAX_LANES];
+	uint32_t samples[ADXCVR_EYESCAN_MAX_LANES];
+	uint8_t prescale[ADXCVR_EYESCAN_MAX_LANES];
+	struct adxcvr_eyescan_point *pt;
+	uint32_t pending, err, smp;
+	uint32_t lane, idx, ut;
+	int32_t horz, vert;
+	int32_t ret;
+
+	horz = es->horz_min + (int32_t)(horz_idx * es->horz_step);
+	vert = es->vert_min + (int32_t)(vert_idx * es->vert_step);
+
+	for (lane = 0; lane < ADXCVR_EYESCAN_MAX_LANES; lane++)
+		prescale[lane] = es->prescale_min;
+
+	pending = es->lane_mask;
+	while (pending) {
+		for (lane = 0; lane < ADXCVR_EYESCAN_MAX_LANES; lane++) {
+			errors[lane] = 0;
+			samples[lane] = 0;
+		}
+
+		for (ut = 0; ut < es->ut_count; ut++) {
+			for (lane = 0; lane < ADXCVR_EYESCAN_MAX_LANES; lane++) {
+				if (!(pending & BIT(lane)))
+					continue;
+
+				ret = xilinx_xcvr_eyescan_start(xlx_xcvr,
+								ADXCVR_DRP_PORT_CHANNEL(lane),
+								horz, vert, ut, prescale[lane]);
+				if (ret < 0)
+					return ret;
+			}
+
+			for (lane = 0; lane < ADXCVR_EYESCAN_MAX_LANES; lane++) {
+				if (!(pending & BIT(lane)))
+					continue;
+
+				ret = adxcvr_eyescan_wait(es, lane, prescale[lane],
+							  &err, &smp);
+				if (ret < 0)
+					return ret;
+
+				errors[lane] += err;
+				samples[lane] += smp;
+			}
+		}
+
+		for (lane = 0, idx = 0; lane < ADXCVR_EYESCAN_MAX_LANES; lane++) {
+			if (!(es->lane_mask & BIT(lane)))
+				continue;
+
+			if (pending & BIT(lane)) {
+				if (!errors[lane] && prescale[lane] < es->prescale_max) {
+					prescale[lane] = min_t(uint32_t,
+							       prescale[lane] + es->prescale_step,
+							       es->prescale_max);
+				} else {
+					pt = adxcvr_eyescan_point_get(es, idx,
+								      vert_idx, horz_idx);
+					pt->errors = errors[lane];
+					pt->samples = samples[lane];
+					pt->prescale = prescale[lane];
+					pending &= ~BIT(lane);
+				}
+			}
+			idx++;
+		}
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_eyescan_run
+ */
+int32_t adxcvr_eyescan_run(struct adxcvr_eyescan *es)
+{
+	uint32_t v, h;
+	int32_t ret;
+
+	for (v = 0; v < es->num_vert; v++) {
+		for (h = 0; h < es->num_horz; h++) {
+			ret = adxcvr_eyescan_measure(es, v, h);
+			if (ret < 0)
+				return ret;
+		}
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_eyescan_point_get
+ *
+ * lane_idx counts the scanned lanes only.
+ */
+struct adxcvr_eyescan_point *adxcvr_eyescan_point_get(struct adxcvr_eyescan *es,
+		uint32_t lane_idx, uint32_t vert_idx, uint32_t horz_idx)
+{
+	if (lane_idx >= es->num_lanes || vert_idx >= es->num_vert ||
+	    horz_idx >= es->num_horz)
+		return NULL;
+
+	return &es->points[(lane_idx * es->num_vert + vert_idx) * es->num_horz +
+				  horz_idx];
+}
+
+/**
+ * @brief adxcvr_eyescan_point_bits
+ *
+ * Number of bits compared for a point, its BER is errors / bits.
+ */
+uint64_t adxcvr_eyescan_point_bits(const struct adxcvr_eyescan *es,
+				   const struct adxcvr_eyescan_point *pt)
+{
+	return ((uint64_t)pt->samples * es->data_width) << (1 + pt->prescale);
+}
+
+static uint8_t *adxcvr_eyescan_put_le(uint8_t *buf, uint32_t val,
+				      uint32_t bytes)
+{
+	while (bytes--) {
+		*buf++ = val & 0xff;
+		val >>= 8;
+	}
+
+	return buf;
+}
+
+/**
+ * @brief adxcvr_eyescan_export
+ *
+ * Serialize the BER maps, little endian:
+ *  0: "ESCN", version, number of lanes, data width, UT count
+ *  8: lane rate (kHz, 32 bit), scanned lane mask (32 bit)
+ * 16: horizontal min (16 bit signed), step and count (16 bit)
+ * 22: vertical min (16 bit signed), step and count (16 bit)
+ * 28: points, by lane, vertical then horizontal offset, each with its error
+ *     and sample counts (32 bit) and prescale (8 bit).
+ * With a NULL buf only the needed size is returned.
+ */
+int32_t adxcvr_eyescan_export(const struct adxcvr_eyescan *es,
+			      uint8_t *buf, uint32_t size)
+{
+	uint32_t len, num_points, i;
+	uint8_t *p = buf;
+
+	num_points = es->num_lanes * es->num_vert * es->num_horz;
+	len = ADXCVR_EYESCAN_EXPORT_HDR_SIZE +
+	      num_points * ADXCVR_EYESCAN_EXPORT_PT_SIZE;
+
+	if (!buf)
+		return len;
+	if (size < len)
+		return FAILURE;
+
+	*p++ = 'E';
+	*p++ = 'S';
+	*p++ = 'C';
+	*p++ = 'N';
+	*p++ = ADXCVR_EYESCAN_EXPORT_VERSION;
+	*p++ = es->num_lanes;
+	*p++ = es->data_width;
+	*p++ = es->ut_count;
+	p = adxcvr_eyescan_put_le(p, es->xcvr->lane_rate_khz, 4);
+	p = adxcvr_eyescan_put_le(p, es->lane_mask, 4);
+	p = adxcvr_eyescan_put_le(p, (uint32_t)es->horz_min, 2);
+	p = adxcvr_eyescan_put_le(p, es->horz_step, 2);
+	p = adxcvr_eyescan_put_le(p, es->num_horz, 2);
+	p = adxcvr_eyescan_put_le(p, (uint32_t)es->vert_min, 2);
+	p = adxcvr_eyescan_put_le(p, es->vert_step, 2);
+	p = adxcvr_eyescan_put_le(p, es->num_vert, 2);
+
+	for (i = 0; i < num_points; i++) {
+		p = adxcvr_eyescan_put_le(p, es->points[i].errors, 4);
+		p = adxcvr_eyescan_put_le(p, es->points[i].samples, 4);
+		*p++ = es->points[i].prescale;
+	}
+
+	return len;
+}
+
+/**
+ * @brief adxcvr_eyescan_remove
+ */
+int32_t adxcvr_eyescan_remove(struct adxcvr_eyescan *es)
+{
+	uint32_t i;
+
+	for (i = 0; i < ADXCVR_EYESCAN_MAX_LANES; i++)
+		if (es->lane_mask & BIT(i))
+			xilinx_xcvr_eyescan_disable(&es->xcvr->xlx_xcvr,
+						    ADXCVR_DRP_PORT_CHANNEL(i));
+
+	free(es->points);
+	free(es);
+
+	return SUCCESS;
+}
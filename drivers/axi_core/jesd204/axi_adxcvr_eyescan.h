@@ -0,0 +1,112 @@
+/***************************************************************************//**
+ *   @file   axi_adxcvr_eyescan.h
+ *   @brief  Statistical eye scan of the ADI AXI-ADXCVR lanes.
+ *   @author DBogdan (dragos.bogdan@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef AXI_ADXCVR_EYESCAN_H_
+#define AXI_ADXCVR_EYESCAN_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include "axi_adxcvr.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+#define ADXCVR_EYESCAN_MAX_LANES	32
+#define ADXCVR_EYESCAN_VERT_MAX		127
+
+/* Exported map: "ESCN" magic, version 1 */
+#define ADXCVR_EYESCAN_EXPORT_VERSION	1
+#define ADXCVR_EYESCAN_EXPORT_HDR_SIZE	28
+#define ADXCVR_EYESCAN_EXPORT_PT_SIZE	9
+
+struct adxcvr_eyescan_init {
+	struct adxcvr *xcvr;
+	/* Lanes to scan, 0 for all of them */
+	uint32_t lane_mask;
+	/* RX internal data width: 40 for the 4-byte 8b10b interface */
+	uint32_t data_width;
+	uint32_t horz_step;
+	uint32_t vert_step;
+	/* Points without errors are measured again with a larger prescale */
+	uint32_t prescale_min;
+	uint32_t prescale_max;
+	uint32_t prescale_step;
+};
+
+/* One point of the map: data_width << (1 + prescale) bits per sample */
+struct adxcvr_eyescan_point {
+	uint32_t errors;
+	uint32_t samples;
+	uint8_t prescale;
+};
+
+struct adxcvr_eyescan {
+	struct adxcvr *xcvr;
+	uint32_t lane_mask;
+	uint32_t num_lanes;
+	uint32_t data_width;
+	uint32_t ut_count;
+	int32_t horz_min;
+	uint32_t horz_step;
+	uint32_t num_horz;
+	int32_t vert_min;
+	uint32_t vert_step;
+	uint32_t num_vert;
+	uint32_t prescale_min;
+	uint32_t prescale_max;
+	uint32_t prescale_step;
+	/* num_lanes maps of num_vert rows of num_horz points */
+	struct adxcvr_eyescan_point *points;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+int32_t adxcvr_eyescan_init(struct adxcvr_eyescan **eyescan,
+			    const struct adxcvr_eyescan_init *init);
+int32_t adxcvr_eyescan_run(struct adxcvr_eyescan *es);
+struct adxcvr_eyescan_point *adxcvr_eyescan_point_get(struct adxcvr_eyescan *es,
+		uint32_t lane_idx, uint32_t vert_idx, uint32_t horz_idx);
+uint64_t adxcvr_eyescan_point_bits(const struct adxcvr_eyescan *es,
+				   const struct adxcvr_eyescan_point *pt);
+int32_t adxcvr_eyescan_export(const struct adxcvr_eyescan *es,
+			      uint8_t *buf, uint32_t size);
+int32_t adxcvr_eyescan_remove(struct adxcvr_eyescan *es);
+#endif
@@ -208,6 +208,27 @@ uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd)
 	return SUCCESS;
 }
 
+/**
+ * @brief axi_jesd204_rx_link_status_get
+ */
+int32_t axi_jesd204_rx_link_status_get(struct axi_jesd204_rx *jesd,
+				       uint32_t *status)
+{
+	uint32_t link_disabled;
+	uint32_t link_status;
+
+	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_STATE, &link_disabled);
+	if (link_disabled & 0x1) {
+		*status = 0;
+		return SUCCESS;
+	}
+
+	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_STATUS, &link_status);
+	*status = link_status & 0x3;
+
+	return SUCCESS;
+}
+
 /**
  * @brief axi_jesd204_rx_get_lane_errors
  */
@@ -217,6 +238,32 @@ int32_t axi_jesd204_rx_get_lane_errors(struct axi_jesd204_rx *jesd,
 	return axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_ERRORS(lane), errors);
 }
 
+/**
+ * @brief axi_jesd204_rx_lane_status_get
+ */
+int32_t axi_jesd204_rx_lane_status_get(struct axi_jesd204_rx *jesd,
+				       uint32_t lane, uint32_t *status)
+{
+	return axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_STATUS(lane), status);
+}
+
+/**
+ * @brief axi_jesd204_rx_sysref_status_get
+ */
+int32_t axi_jesd204_rx_sysref_status_get(struct axi_jesd204_rx *jesd,
+		uint32_t *status)
+{
+	uint32_t sysref_config;
+
+	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYSREF_CONF, &sysref_config);
+	if (sysref_config & JESD204_RX_REG_SYSREF_CONF_SYSREF_DISABLE) {
+		*status = 0;
+		return SUCCESS;
+	}
+
+	return axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYSREF_STATUS, status);
+}
+
 /**
  * @brief axi_jesd204_rx_laneinfo_read
  */
@@ -329,6 +376,18 @@ bool axi_jesd204_rx_check_lane_status(struct axi_jesd204_rx *jesd,
 	return true;
 }
 
+/**
+ * @brief axi_jesd204_rx_link_restart
+ */
+int32_t axi_jesd204_rx_link_restart(struct axi_jesd204_rx *jesd)
+{
+	axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x1);
+	mdelay(100);
+	axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x0);
+
+	return SUCCESS;
+}
+
 /**
  * @brief axi_jesd204_rx_watchdog
  */
@@ -348,11 +407,8 @@ int32_t axi_jesd204_rx_watchdog(struct axi_jesd204_rx *jesd)
 		for (i = 0; i < jesd->num_lanes; i++)
 			restart |= axi_jesd204_rx_check_lane_status(jesd, i);
 
-		if (restart) {
-			axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x1);
-			mdelay(100);
-			axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x0);
-		}
+		if (restart)
+			axi_jesd204_rx_link_restart(jesd);
 	}
 
 	return SUCCESS;
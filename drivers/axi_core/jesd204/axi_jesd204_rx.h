@@ -45,6 +45,22 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define AXI_JESD204_RX_LINK_STATUS_RESET	0
+#define AXI_JESD204_RX_LINK_STATUS_WAIT_PHY	1
+#define AXI_JESD204_RX_LINK_STATUS_CGS		2
+#define AXI_JESD204_RX_LINK_STATUS_DATA		3
+
+#define AXI_JESD204_RX_LANE_STATUS_CGS_MASK	0x3
+#define AXI_JESD204_RX_LANE_STATUS_CGS_INIT	0
+#define AXI_JESD204_RX_LANE_STATUS_IFS		0x10
+#define AXI_JESD204_RX_LANE_STATUS_ILAS		0x20
+
+#define AXI_JESD204_RX_SYSREF_STATUS_CAPTURED	0x1
+#define AXI_JESD204_RX_SYSREF_STATUS_ALIGN_ERR	0x2
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -81,8 +97,17 @@ struct jesd204_rx_init {
 int32_t axi_jesd204_rx_lane_clk_enable(struct axi_jesd204_rx *jesd);
 int32_t axi_jesd204_rx_lane_clk_disable(struct axi_jesd204_rx *jesd);
 uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd);
+int32_t axi_jesd204_rx_link_status_get(struct axi_jesd204_rx *jesd,
+				       uint32_t *status);
+int32_t axi_jesd204_rx_get_lane_errors(struct axi_jesd204_rx *jesd,
+				       uint32_t lane, uint32_t *errors);
+int32_t axi_jesd204_rx_lane_status_get(struct axi_jesd204_rx *jesd,
+				       uint32_t lane, uint32_t *status);
+int32_t axi_jesd204_rx_sysref_status_get(struct axi_jesd204_rx *jesd,
+		uint32_t *status);
 int32_t axi_jesd204_rx_laneinfo_read(struct axi_jesd204_rx *jesd,
 				     uint32_t lane);
+int32_t axi_jesd204_rx_link_restart(struct axi_jesd204_rx *jesd);
 int32_t axi_jesd204_rx_watchdog(struct axi_jesd204_rx *jesd);
 int32_t axi_jesd204_rx_init(struct axi_jesd204_rx **jesd204,
 			    const struct jesd204_rx_init *init);
@@ -0,0 +1,437 @@
+/***************************************************************************//**
+ *   @file   axi_jesd204_rx_monitor.c
+ *   @brief  Link health monitor for the JESD204 RX core.
+ *   @author DBogdan (dragos.bogdan@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "util.h"
+#include "error.h"
+#include "timestamp.h"
+#include "scheduler.h"
+#include "axi_jesd204_rx.h"
+#include "axi_jesd204_rx_monitor.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define JESD204_RX_VERSION_MINOR(x)	(((x) >> 8) & 0xff)
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+
+/**
+ * @brief Allocate a link monitor.
+ *
+ * Sampling is stopped until jesd204_rx_monitor_enable() is called.
+ * @param monitor - The link monitor.
+ * @param init - The initialization parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t jesd204_rx_monitor_init(struct jesd204_rx_monitor **monitor,
+				const struct jesd204_rx_monitor_init *init)
+{
+	struct jesd204_rx_monitor *mon;
+
+	if (!init->jesd || !init->jesd->num_lanes || !init->period_us)
+		return FAILURE;
+
+	mon = (struct jesd204_rx_monitor *)calloc(1, sizeof(*mon));
+	if (!mon)
+		return FAILURE;
+
+	mon->lanes = (struct jesd204_rx_monitor_lane *)calloc(init->jesd->num_lanes,
+			sizeof(*mon->lanes));
+	if (!mon->lanes) {
+		free(mon);
+		return FAILURE;
+	}
+
+	mon->jesd = init->jesd;
+	mon->period_us = init->period_us;
+	mon->auto_reinit = init->auto_reinit;
+	mon->reinit = init->reinit;
+	mon->reinit_ctx = init->reinit_ctx;
+	mon->has_errors = JESD204_RX_VERSION_MINOR(init->jesd->version) >= 2;
+
+	*monitor = mon;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by jesd204_rx_monitor_init().
+ * @param mon - The link monitor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t jesd204_rx_monitor_remove(struct jesd204_rx_monitor *mon)
+{
+	if (!mon)
+		return FAILURE;
+
+	free(mon->lanes);
+	free(mon);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Start or stop periodic sampling.
+ *
+ * The first sample is taken at the next jesd204_rx_monitor_poll() call.
+ * @param mon - The link monitor.
+ * @param enable - Start sampling if true, stop it otherwise.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t jesd204_rx_monitor_enable(struct jesd204_rx_monitor *mon, bool enable)
+{
+	if (enable && !mon->enabled) {
+		mon->next_ns = timestamp_ns();
+		mon->last_ns = 0;
+	}
+	mon->enabled = enable;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Change the sampling period.
+ * @param mon - The link monitor.
+ * @param period_us - The sampling period [us].
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t jesd204_rx_monitor_set_period(struct jesd204_rx_monitor *mon,
+				      uint32_t period_us)
+{
+	if (!period_us)
+		return FAILURE;
+
+	mon->period_us = period_us;
+	mon->next_ns = timestamp_ns();
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Update the averaged error rate of a lane.
+ *
+ * The average moves by 1/2^JESD204_RX_MONITOR_RATE_SHIFT of the difference
+ * per sample, rounded up so a lane without errors decays to zero.
+ * @param lane - The lane statistics.
+ * @param errors - Errors counted since the previous sample.
+ * @param elapsed_ns - Time since the previous sample [ns].
+ */
+static void jesd204_rx_monitor_rate_update(struct jesd204_rx_monitor_lane *lane,
+		uint32_t errors, uint64_t elapsed_ns)
+{
+	uint64_t elapsed_us = max_t(uint64_t, elapsed_ns / 1000, 1);
+	uint64_t rate;
+	uint32_t diff;
+
+	/* [errors / 1000 s], fits 64 bits for any 32-bit error count */
+	rate = (uint64_t)errors * 1000000000 / elapsed_us;
+	if (rate > UINT32_MAX)
+		rate = UINT32_MAX;
+
+	if (rate >= lane->error_rate) {
+		diff = rate - lane->error_rate;
+		lane->error_rate += diff >> JESD204_RX_MONITOR_RATE_SHIFT;
+	} else {
+		diff = lane->error_rate - rate;
+		lane->error_rate -= (diff + BIT(JESD204_RX_MONITOR_RATE_SHIFT) - 1) >>
+				    JESD204_RX_MONITOR_RATE_SHIFT;
+	}
+}
+
+/**
+ * @brief Restart the link, at most once per JESD204_RX_MONITOR_REINIT_HOLDOFF_US.
+ * @param mon - The link monitor.
+ * @param now_ns - Time of the current sample [ns].
+ */
+static void jesd204_rx_monitor_reinit(struct jesd204_rx_monitor *mon,
+				      uint64_t now_ns)
+{
+	struct jesd204_rx_monitor_stats *stats = &mon->stats;
+	int32_t ret;
+
+	if (mon->reinit_ns &&
+	    now_ns - mon->reinit_ns < JESD204_RX_MONITOR_REINIT_HOLDOFF_US * 1000ULL)
+		return;
+
+	if (mon->reinit)
+		ret = mon->reinit(mon->reinit_ctx);
+	else
+		ret = axi_jesd204_rx_link_restart(mon->jesd);
+
+	mon->reinit_ns = now_ns;
+	stats->reinits++;
+	if (ret != SUCCESS)
+		stats->reinit_errors++;
+
+	if (stats->link_up) {
+		stats->link_up = false;
+		stats->link_down_events++;
+		stats->last_down_ns = now_ns;
+	}
+}
+
+/**
+ * @brief Sample the link and lane status now.
+ *
+ * Reads the link state, the SYSREF status and, for each lane, the CGS/ILAS
+ * status and the error counter. Errors are only accounted while the link is
+ * in the DATA state; the counters are re-baselined when it gets there. If
+ * automatic re-initialization is enabled, a link that reached the DATA
+ * state once and then left it, or that has a lane back in CGS, is restarted.
+ * Without a time base (see timestamp.h) only the totals are counted: the
+ * error rates are not updated and the samples are assumed to be one period
+ * apart for the event times.
+ * @param mon - The link monitor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t jesd204_rx_monitor_sample(struct jesd204_rx_monitor *mon)
+{
+	struct jesd204_rx_monitor_stats *stats = &mon->stats;
+	struct jesd204_rx_monitor_lane *lane;
+	uint64_t period_ns = (uint64_t)mon->period_us * 1000;
+	uint64_t now_ns, elapsed_ns;
+	uint32_t link_status, sysref_status;
+	uint32_t status, count, errors;
+	bool has_timebase = timestamp_available();
+	bool link_up, desync = false;
+	uint32_t i;
+
+	if (has_timebase)
+		now_ns = timestamp_ns();
+	else
+		now_ns = mon->last_ns + period_ns;
+	elapsed_ns = mon->last_ns ? now_ns - mon->last_ns : period_ns;
+	mon->last_ns = now_ns;
+
+	axi_jesd204_rx_link_status_get(mon->jesd, &link_status);
+	axi_jesd204_rx_sysref_status_get(mon->jesd, &sysref_status);
+	link_up = (link_status == AXI_JESD204_RX_LINK_STATUS_DATA);
+
+	stats->samples++;
+	stats->link_status = link_status;
+	stats->sysref_status = sysref_status;
+	if (sysref_status & AXI_JESD204_RX_SYSREF_STATUS_ALIGN_ERR)
+		stats->sysref_align_errors++;
+
+	for (i = 0; i < mon->jesd->num_lanes; i++) {
+		lane = &mon->lanes[i];
+
+		axi_jesd204_rx_lane_status_get(mon->jesd, i, &status);
+		lane->status = status;
+		if (link_up && (status & AXI_JESD204_RX_LANE_STATUS_CGS_MASK) ==
+		    AXI_JESD204_RX_LANE_STATUS_CGS_INIT)
+			desync = true;
+
+		if (!mon->has_errors)
+			continue;
+
+		axi_jesd204_rx_get_lane_errors(mon->jesd, i, &count);
+		if (!stats->link_up) {
+			lane->last_count = count;
+			continue;
+		}
+
+		/* The counter restarts from zero when the link is reset */
+		if (count >= lane->last_count)
+			errors = count - lane->last_count;
+		else
+			errors = count;
+		lane->last_count = count;
+		lane->errors += errors;
+		if (has_timebase)
+			jesd204_rx_monitor_rate_update(lane, errors, elapsed_ns);
+	}
+
+	if (link_up && !stats->link_up) {
+		stats->up_since_ns = now_ns;
+		mon->link_seen = true;
+	} else if (!link_up && stats->link_up) {
+		stats->link_down_events++;
+		stats->last_down_ns = now_ns;
+	}
+	stats->link_up = link_up;
+
+	if (desync)
+		stats->lane_desync_events++;
+
+	if (mon->auto_reinit && mon->link_seen && (desync || !link_up))
+		jesd204_rx_monitor_reinit(mon, now_ns);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Sample the link if the sampling period elapsed.
+ *
+ * Meant to be called from the application main loop, see also
+ * jesd204_rx_monitor_task(). Periods that elapsed entirely between two calls
+ * are skipped, the error rates account for the actual time between samples.
+ * Without a time base, a sample is taken at each call.
+ * @param mon - The link monitor.
+ * @return 1 if a sample was taken, 0 if it was not due yet, negative error
+ *         code otherwise.
+ */
+int32_t jesd204_rx_monitor_poll(struct jesd204_rx_monitor *mon)
+{
+	uint64_t now, period_ns, late;
+	int32_t ret;
+
+	if (!mon->enabled)
+		return 0;
+
+	if (timestamp_available()) {
+		now = timestamp_ns();
+		if (now < mon->next_ns)
+			return 0;
+
+		period_ns = (uint64_t)mon->period_us * 1000;
+		late = (now - mon->next_ns) / period_ns;
+		mon->next_ns += (late + 1) * period_ns;
+	}
+
+	ret = jesd204_rx_monitor_sample(mon);
+
+	return ret < 0 ? ret : 1;
+}
+
+/**
+ * @brief Get the time until the next sample is due.
+ * @param mon - The link monitor.
+ * @return Time [us], one period if stopped or without a time base.
+ */
+static uint32_t jesd204_rx_monitor_due_us(struct jesd204_rx_monitor *mon)
+{
+	uint64_t now;
+
+	if (!mon->enabled || !timestamp_available())
+		return mon->period_us;
+
+	now = timestamp_ns();
+	if (now >= mon->next_ns)
+		return 0;
+
+	return DIV_ROUND_UP(mon->next_ns - now, 1000);
+}
+
+/**
+ * @brief Sample the link periodically from a scheduler task.
+ *
+ * Calls jesd204_rx_monitor_poll() and sleeps until the next sample is due,
+ * the task never ends. Sampling is still started and stopped with
+ * jesd204_rx_monitor_enable(), a stopped monitor is checked once per period.
+ * @param task - The scheduler task.
+ * @param ctx - The link monitor.
+ * @return TASK_WAITING or negative error code.
+ */
+int32_t jesd204_rx_monitor_task(struct sched_task *task, void *ctx)
+{
+	struct jesd204_rx_monitor *mon = ctx;
+	int32_t ret;
+
+	TASK_BEGIN(task);
+	for (;;) {
+		ret = jesd204_rx_monitor_poll(mon);
+		if (ret < 0)
+			return ret;
+		TASK_SLEEP_US(task, jesd204_rx_monitor_due_us(mon));
+	}
+	TASK_END(task);
+}
+
+/**
+ * @brief Get the link statistics.
+ * @param mon - The link monitor.
+ * @param stats - The statistics.
+ */
+void jesd204_rx_monitor_stats_get(struct jesd204_rx_monitor *mon,
+				  struct jesd204_rx_monitor_stats *stats)
+{
+	*stats = mon->stats;
+}
+
+/**
+ * @brief Get the statistics of a lane.
+ * @param mon - The link monitor.
+ * @param lane - The lane index.
+ * @param stats - The lane statistics.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t jesd204_rx_monitor_lane_get(struct jesd204_rx_monitor *mon,
+				    uint32_t lane,
+				    struct jesd204_rx_monitor_lane *stats)
+{
+	if (lane >= mon->jesd->num_lanes)
+		return FAILURE;
+
+	*stats = mon->lanes[lane];
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Clear the event counters and the lane error statistics.
+ *
+ * The last sampled state of the link and of the lanes is kept.
+ * @param mon - The link monitor.
+ */
+void jesd204_rx_monitor_stats_reset(struct jesd204_rx_monitor *mon)
+{
+	struct jesd204_rx_monitor_stats *stats = &mon->stats;
+	uint32_t i;
+
+	stats->samples = 0;
+	stats->link_down_events = 0;
+	stats->lane_desync_events = 0;
+	stats->sysref_align_errors = 0;
+	stats->reinits = 0;
+	stats->reinit_errors = 0;
+	stats->last_down_ns = 0;
+
+	for (i = 0; i < mon->jesd->num_lanes; i++) {
+		mon->lanes[i].errors = 0;
+		mon->lanes[i].error_rate = 0;
+	}
+}
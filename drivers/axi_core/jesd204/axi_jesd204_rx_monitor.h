@@ -0,0 +1,142 @@
+/***************************************************************************//**
+ *   @file   axi_jesd204_rx_monitor.h
+ *   @brief  Link health monitor for the JESD204 RX core.
+ *   @author DBogdan (dragos.bogdan@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef AXI_JESD204_RX_MONITOR_H_
+#define AXI_JESD204_RX_MONITOR_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "axi_jesd204_rx.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Error rates are averaged over about 2^RATE_SHIFT samples */
+#define JESD204_RX_MONITOR_RATE_SHIFT		3
+/* Minimum time between two automatic link restarts */
+#define JESD204_RX_MONITOR_REINIT_HOLDOFF_US	1000000
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+struct sched_task;
+
+struct jesd204_rx_monitor_lane {
+	/* Last value of the lane error counter */
+	uint32_t last_count;
+	/* Errors counted since the statistics were cleared */
+	uint32_t errors;
+	/* Averaged error rate [errors / 1000 s], 0 without a time base */
+	uint32_t error_rate;
+	/* Lane status register: CGS state, IFS and ILAS flags */
+	uint8_t status;
+};
+
+struct jesd204_rx_monitor_stats {
+	uint32_t samples;
+	/* Last link state, AXI_JESD204_RX_LINK_STATUS_* */
+	uint8_t link_status;
+	/* Last SYSREF status, AXI_JESD204_RX_SYSREF_STATUS_* */
+	uint8_t sysref_status;
+	bool link_up;
+	/* Times the link left the DATA state */
+	uint32_t link_down_events;
+	/* Times a lane lost code group synchronization in the DATA state */
+	uint32_t lane_desync_events;
+	/* Samples with the SYSREF alignment error flag set */
+	uint32_t sysref_align_errors;
+	/* Link restarts done by the monitor */
+	uint32_t reinits;
+	uint32_t reinit_errors;
+	/* Time [ns] the link entered and last left the DATA state */
+	uint64_t up_since_ns;
+	uint64_t last_down_ns;
+};
+
+struct jesd204_rx_monitor_init {
+	struct axi_jesd204_rx *jesd;
+	/* Sampling period [us] */
+	uint32_t period_us;
+	/* Restart the link when it goes down or a lane desyncs */
+	bool auto_reinit;
+	/* Link restart, axi_jesd204_rx_link_restart() if NULL */
+	int32_t (*reinit)(void *ctx);
+	void *reinit_ctx;
+};
+
+struct jesd204_rx_monitor {
+	struct axi_jesd204_rx *jesd;
+	uint32_t period_us;
+	bool enabled;
+	bool auto_reinit;
+	int32_t (*reinit)(void *ctx);
+	void *reinit_ctx;
+	/* The lane error counters exist from core version 1.2 */
+	bool has_errors;
+	/* The link reached the DATA state at least once */
+	bool link_seen;
+	uint64_t next_ns;
+	uint64_t last_ns;
+	uint64_t reinit_ns;
+	struct jesd204_rx_monitor_stats stats;
+	/* jesd->num_lanes entries */
+	struct jesd204_rx_monitor_lane *lanes;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+int32_t jesd204_rx_monitor_init(struct jesd204_rx_monitor **monitor,
+				const struct jesd204_rx_monitor_init *init);
+int32_t jesd204_rx_monitor_remove(struct jesd204_rx_monitor *mon);
+int32_t jesd204_rx_monitor_enable(struct jesd204_rx_monitor *mon, bool enable);
+int32_t jesd204_rx_monitor_set_period(struct jesd204_rx_monitor *mon,
+				      uint32_t period_us);
+int32_t jesd204_rx_monitor_sample(struct jesd204_rx_monitor *mon);
+int32_t jesd204_rx_monitor_poll(struct jesd204_rx_monitor *mon);
+int32_t jesd204_rx_monitor_task(struct sched_task *task, void *ctx);
+void jesd204_rx_monitor_stats_get(struct jesd204_rx_monitor *mon,
+				  struct jesd204_rx_monitor_stats *stats);
+int32_t jesd204_rx_monitor_lane_get(struct jesd204_rx_monitor *mon,
+				    uint32_t lane,
+				    struct jesd204_rx_monitor_lane *stats);
+void jesd204_rx_monitor_stats_reset(struct jesd204_rx_monitor *mon);
+#endif
@@ -194,6 +194,27 @@ uint32_t axi_jesd204_tx_status_read(struct axi_jesd204_tx *jesd)
 	return SUCCESS;
 }
 
+/**
+ * @brief axi_jesd204_tx_link_status_get
+ */
+int32_t axi_jesd204_tx_link_status_get(struct axi_jesd204_tx *jesd,
+				       uint32_t *status)
+{
+	uint32_t link_disabled;
+	uint32_t link_status;
+
+	axi_jesd204_tx_read(jesd, JESD204_TX_REG_LINK_STATE, &link_disabled);
+	if (link_disabled & 0x1) {
+		*status = 0;
+		return SUCCESS;
+	}
+
+	axi_jesd204_tx_read(jesd, JESD204_TX_REG_LINK_STATUS, &link_status);
+	*status = link_status & 0x3;
+
+	return SUCCESS;
+}
+
 /**
  * @brief axi_jesd204_tx_calc_ilas_chksum
  */
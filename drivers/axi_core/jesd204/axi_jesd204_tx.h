@@ -45,6 +45,14 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define AXI_JESD204_TX_LINK_STATUS_WAIT	0
+#define AXI_JESD204_TX_LINK_STATUS_CGS	1
+#define AXI_JESD204_TX_LINK_STATUS_ILAS	2
+#define AXI_JESD204_TX_LINK_STATUS_DATA	3
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -97,6 +105,8 @@ struct jesd204_tx_init {
 int32_t axi_jesd204_tx_lane_clk_enable(struct axi_jesd204_tx *jesd);
 int32_t axi_jesd204_tx_lane_clk_disable(struct axi_jesd204_tx *jesd);
 uint32_t axi_jesd204_tx_status_read(struct axi_jesd204_tx *jesd);
+int32_t axi_jesd204_tx_link_status_get(struct axi_jesd204_tx *jesd,
+				       uint32_t *status);
 int32_t axi_jesd204_tx_init(struct axi_jesd204_tx **jesd204,
 			    const struct jesd204_tx_init *init);
 int32_t axi_jesd204_tx_remove(struct axi_jesd204_tx *jesd);
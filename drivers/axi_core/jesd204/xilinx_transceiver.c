@@ -43,6 +43,7 @@
 /******************************************************************************/
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 #include <xil_io.h>
 #include "util.h"
@@ -107,6 +108,49 @@
 #define TX_CLK25_DIV			0x6a
 #define TX_CLK25_DIV_MASK		0x1f
 
+#define GTX2_ES_QUALIFIER_ADDR		0x2c
+#define GTX2_ES_QUAL_MASK_ADDR		0x31
+#define GTX2_ES_SDATA_MASK_ADDR		0x36
+#define GTX2_ES_PRESCALE_VERT_ADDR	0x3b
+#define GTX2_ES_PRESCALE_OFFSET		11
+#define GTX2_ES_PRESCALE_MASK		0xf800
+#define GTX2_ES_VERT_OFFSET_MASK	0x01ff
+#define GTX2_ES_VERT_NEG		(1 << 7)
+#define GTX2_ES_VERT_UT_SIGN		(1 << 8)
+#define GTX2_ES_HORZ_OFFSET_ADDR	0x3c
+#define GTX2_ES_HORZ_OFFSET_MASK	0x0fff
+#define GTX2_ES_CONTROL_ADDR		0x3d
+#define GTX2_PMA_RSV2_ADDR		0x82
+#define GTX2_PMA_RSV2_EYESCAN		(1 << 5)
+#define GTX2_ES_ERROR_COUNT_ADDR	0x14f
+#define GTX2_ES_SAMPLE_COUNT_ADDR	0x150
+#define GTX2_ES_CONTROL_STATUS_ADDR	0x151
+
+#define GTH34_ES_CONTROL_ADDR		0x3c
+#define GTH34_ES_PRESCALE_MASK		0x001f
+#define GTH34_ES_QUALIFIER_ADDR		0x3f
+#define GTH34_ES_QUAL_MASK_ADDR		0x44
+#define GTH34_ES_SDATA_MASK_ADDR	0x49
+#define GTH34_ES_HORZ_OFFSET_ADDR	0x4f
+#define GTH34_ES_HORZ_OFFSET_OFFSET	4
+#define GTH34_ES_HORZ_OFFSET_MASK	0xfff0
+#define GTH34_RX_EYESCAN_VS_ADDR	0x97
+#define GTH34_RX_EYESCAN_VS_MASK	0x07fc
+#define GTH34_RX_EYESCAN_VS_CODE_OFFSET	2
+#define GTH34_RX_EYESCAN_VS_UT_SIGN	(1 << 9)
+#define GTH34_RX_EYESCAN_VS_NEG_DIR	(1 << 10)
+#define GTH34_ES_ERROR_COUNT_ADDR	0x251
+#define GTH34_ES_SAMPLE_COUNT_ADDR	0x252
+#define GTH34_ES_CONTROL_STATUS_ADDR	0x253
+
+#define ES_CONTROL_MASK			0xfc00
+#define ES_CONTROL_RUN			(1 << 10)
+#define ES_ERRDET_EN			(1 << 9)
+#define ES_EYE_SCAN_EN			(1 << 8)
+#define ES_CONTROL_STATUS_DONE		(1 << 0)
+#define ES_HORZ_PHASE_UNIFICATION	(1 << 11)
+#define ES_MASK_WORDS			5
+
 /**
  * @brief xilinx_xcvr_write
  */
@@ -125,6 +169,36 @@ int32_t xilinx_xcvr_read(struct xilinx_xcvr *xcvr, uint32_t drp_port,
 	return adxcvr_drp_read(xcvr->ad_xcvr, drp_port, reg_addr, reg_val);
 }
 
+/**
+ * @brief xilinx_xcvr_image_add
+ */
+static int32_t xilinx_xcvr_image_add(struct xilinx_xcvr_reg_image *image,
+				     uint32_t reg, uint32_t mask, uint32_t val)
+{
+	struct xilinx_xcvr_drp_reg *entry;
+	uint32_t i;
+
+	for (i = 0; i < image->num_regs; i++)
+		if (image->regs[i].reg == reg)
+			break;
+
+	if (i == image->num_regs) {
+		if (i == XILINX_XCVR_REG_IMAGE_SIZE)
+			return FAILURE;
+
+		image->regs[i].reg = reg;
+		image->regs[i].mask = 0;
+		image->regs[i].val = 0;
+		image->num_regs++;
+	}
+
+	entry = &image->regs[i];
+	entry->val = (entry->val & ~mask) | (val & mask);
+	entry->mask |= mask;
+
+	return SUCCESS;
+}
+
 /**
  * @brief xilinx_xcvr_drp_read
  */
@@ -154,6 +228,9 @@ int32_t xilinx_xcvr_drp_write(struct xilinx_xcvr *xcvr,
 	uint32_t read_val;
 	int32_t ret;
 
+	if (xcvr->drp_image)
+		return xilinx_xcvr_image_add(xcvr->drp_image, reg, 0xffff, val);
+
 	ret = xilinx_xcvr_write(xcvr, drp_port, reg, val);
 	if (ret < 0) {
 		printf("%s: Failed to write reg %"PRIu32"-0x%"PRIX32": %"PRId32"\n",
@@ -179,6 +256,9 @@ int32_t xilinx_xcvr_drp_update(struct xilinx_xcvr *xcvr, uint32_t drp_port,
 	uint32_t read_val;
 	int32_t ret;
 
+	if (xcvr->drp_image)
+		return xilinx_xcvr_image_add(xcvr->drp_image, reg, mask, val);
+
 	ret = xilinx_xcvr_drp_read(xcvr, drp_port, reg, &read_val);
 	if (ret < 0)
 		return ret;
@@ -1144,9 +1224,9 @@ int32_t xilinx_xcvr_gtx2_read_out_div(struct xilinx_xcvr *xcvr,
 		return ret;
 
 	if (rx_out_div)
-		*rx_out_div = 1 << ((ret >> OUT_DIV_RX_OFFSET) & 7);
+		*rx_out_div = 1 << ((val >> OUT_DIV_RX_OFFSET) & 7);
 	if (tx_out_div)
-		*tx_out_div = 1 << ((ret >> OUT_DIV_TX_OFFSET) & 7);
+		*tx_out_div = 1 << ((val >> OUT_DIV_TX_OFFSET) & 7);
 
 	return SUCCESS;
 }
@@ -1319,3 +1399,353 @@ int32_t xilinx_xcvr_write_tx_clk25_div(struct xilinx_xcvr *xcvr,
 
 	return xilinx_xcvr_drp_update(xcvr, drp_port, reg, mask, div);
 }
+
+/**
+ * @brief xilinx_xcvr_calc_rate_config
+ *
+ * Compute the PLL, output divider, CDR and CLK25 settings for a lane rate and
+ * record them as DRP register images, one for the QPLL common port and one
+ * applied to every channel.
+ */
+int32_t xilinx_xcvr_calc_rate_config(struct xilinx_xcvr *xcvr,
+				     uint32_t refclk_khz, uint32_t lane_rate_khz,
+				     bool cpll_enable, bool tx_enable, bool lpm_enable,
+				     struct xilinx_xcvr_rate_config *conf)
+{
+	struct xilinx_xcvr_cpll_config cpll_conf;
+	struct xilinx_xcvr_qpll_config qpll_conf;
+	uint32_t out_div, clk25_div;
+	int32_t ret;
+
+	memset(conf, 0, sizeof(*conf));
+
+	clk25_div = DIV_ROUND_CLOSEST(refclk_khz, 25000);
+
+	if (cpll_enable)
+		ret = xilinx_xcvr_calc_cpll_config(xcvr, refclk_khz, lane_rate_khz,
+						   &cpll_conf, &out_div);
+	else
+		ret = xilinx_xcvr_calc_qpll_config(xcvr, refclk_khz, lane_rate_khz,
+						   &qpll_conf, &out_div);
+	if (ret < 0)
+		return ret;
+
+	if (!cpll_enable) {
+		xcvr->drp_image = &conf->common;
+		ret = xilinx_xcvr_qpll_write_config(xcvr, 0, &qpll_conf);
+		if (ret < 0)
+			goto out;
+	}
+
+	xcvr->drp_image = &conf->channel;
+
+	if (cpll_enable) {
+		ret = xilinx_xcvr_cpll_write_config(xcvr, 0, &cpll_conf);
+		if (ret < 0)
+			goto out;
+	}
+
+	ret = xilinx_xcvr_write_out_div(xcvr, 0,
+					tx_enable ? -1 : (int32_t)out_div,
+					tx_enable ? (int32_t)out_div : -1);
+	if (ret < 0)
+		goto out;
+
+	if (!tx_enable) {
+		ret = xilinx_xcvr_configure_cdr(xcvr, 0, lane_rate_khz, out_div,
+						lpm_enable);
+		if (ret < 0)
+			goto out;
+
+		ret = xilinx_xcvr_write_rx_clk25_div(xcvr, 0, clk25_div);
+	} else {
+		ret = xilinx_xcvr_write_tx_clk25_div(xcvr, 0, clk25_div);
+	}
+	if (ret < 0)
+		goto out;
+
+	conf->refclk_khz = refclk_khz;
+	conf->lane_rate_khz = lane_rate_khz;
+	conf->cpll_enable = cpll_enable;
+	conf->lpm_enable = lpm_enable;
+	conf->out_div = out_div;
+	conf->valid = true;
+
+out:
+	xcvr->drp_image = NULL;
+
+	return ret;
+}
+
+/**
+ * @brief xilinx_xcvr_write_reg_image
+ *
+ * Registers written as a whole skip the read-modify-write and no write is
+ * read back, so each register costs at most two DRP accesses.
+ */
+int32_t xilinx_xcvr_write_reg_image(struct xilinx_xcvr *xcvr,
+				    uint32_t drp_port, const struct xilinx_xcvr_reg_image *image)
+{
+	uint32_t read_val, val;
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < image->num_regs; i++) {
+		val = image->regs[i].val;
+
+		if (image->regs[i].mask != 0xffff) {
+			ret = xilinx_xcvr_drp_read(xcvr, drp_port,
+						   image->regs[i].reg, &read_val);
+			if (ret < 0)
+				return ret;
+
+			val |= read_val & ~image->regs[i].mask;
+		}
+
+		ret = xilinx_xcvr_write(xcvr, drp_port, image->regs[i].reg, val);
+		if (ret < 0) {
+			printf("%s: Failed to write reg %"PRIu32"-0x%"PRIX32": %"PRId32"\n",
+			       __func__, drp_port, (uint32_t)image->regs[i].reg, ret);
+			return ret;
+		}
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief xilinx_xcvr_eyescan_setup
+ *
+ * Enable the statistical eye scan of a channel: no qualifier, and only the
+ * data_width received bits are compared.
+ */
+int32_t xilinx_xcvr_eyescan_setup(struct xilinx_xcvr *xcvr,
+				  uint32_t drp_port, uint32_t data_width)
+{
+	uint32_t qual_addr, qual_mask_addr, sdata_mask_addr, control_addr;
+	uint32_t sdata_mask[ES_MASK_WORDS] = {0};
+	uint32_t val;
+	uint32_t i;
+	int32_t ret;
+
+	switch (xcvr->type) {
+	case XILINX_XCVR_TYPE_S7_GTX2:
+		ret = xilinx_xcvr_drp_read(xcvr, drp_port, GTX2_PMA_RSV2_ADDR, &val);
+		if (ret < 0)
+			return ret;
+		/* Takes effect only after a PMA reset, so it can't be set here */
+		if (!(val & GTX2_PMA_RSV2_EYESCAN)) {
+			printf("%s: PMA_RSV2[5] is not set, eye scan disabled\n",
+			       __func__);
+			return FAILURE;
+		}
+		qual_addr = GTX2_ES_QUALIFIER_ADDR;
+		qual_mask_addr = GTX2_ES_QUAL_MASK_ADDR;
+		sdata_mask_addr = GTX2_ES_SDATA_MASK_ADDR;
+		control_addr = GTX2_ES_CONTROL_ADDR;
+		break;
+	case XILINX_XCVR_TYPE_US_GTH3:
+	case XILINX_XCVR_TYPE_US_GTH4:
+	case XILINX_XCVR_TYPE_US_GTY4:
+		qual_addr = GTH34_ES_QUALIFIER_ADDR;
+		qual_mask_addr = GTH34_ES_QUAL_MASK_ADDR;
+		sdata_mask_addr = GTH34_ES_SDATA_MASK_ADDR;
+		control_addr = GTH34_ES_CONTROL_ADDR;
+		break;
+	default:
+		return FAILURE;
+	}
+
+	if (data_width == 0 || data_width > 40)
+		return FAILURE;
+
+	/*
+	 * The 80-bit sample data mask has bits [79:40] masked and the data in
+	 * the upper data_width bits of [39:0].
+	 */
+	for (i = 0; i < ES_MASK_WORDS * 16; i++)
+		if (i >= 40 || i < 40 - data_width)
+			sdata_mask[i / 16] |= 1 << (i % 16);
+
+	for (i = 0; i < ES_MASK_WORDS; i++) {
+		ret = xilinx_xcvr_drp_write(xcvr, drp_port, qual_addr + i, 0x0000);
+		if (ret < 0)
+			return ret;
+
+		ret = xilinx_xcvr_drp_write(xcvr, drp_port, qual_mask_addr + i,
+					    0xffff);
+		if (ret < 0)
+			return ret;
+
+		ret = xilinx_xcvr_drp_write(xcvr, drp_port, sdata_mask_addr + i,
+					    sdata_mask[i]);
+		if (ret < 0)
+			return ret;
+	}
+
+	return xilinx_xcvr_drp_update(xcvr, drp_port, control_addr,
+				      ES_CONTROL_MASK | ES_ERRDET_EN |
+				      ES_EYE_SCAN_EN,
+				      ES_ERRDET_EN | ES_EYE_SCAN_EN);
+}
+
+/**
+ * @brief xilinx_xcvr_eyescan_disable
+ */
+int32_t xilinx_xcvr_eyescan_disable(struct xilinx_xcvr *xcvr,
+				    uint32_t drp_port)
+{
+	switch (xcvr->type) {
+	case XILINX_XCVR_TYPE_S7_GTX2:
+		return xilinx_xcvr_drp_update(xcvr, drp_port, GTX2_ES_CONTROL_ADDR,
+					      ES_CONTROL_MASK | ES_ERRDET_EN |
+					      ES_EYE_SCAN_EN, 0);
+	case XILINX_XCVR_TYPE_US_GTH3:
+	case XILINX_XCVR_TYPE_US_GTH4:
+	case XILINX_XCVR_TYPE_US_GTY4:
+		return xilinx_xcvr_drp_update(xcvr, drp_port, GTH34_ES_CONTROL_ADDR,
+					      ES_CONTROL_MASK | ES_ERRDET_EN |
+					      ES_EYE_SCAN_EN, 0);
+	default:
+		return FAILURE;
+	}
+}
+
+/**
+ * @brief xilinx_xcvr_eyescan_start
+ *
+ * Start a measurement at the given horizontal (UI/32 units at full rate) and
+ * vertical (-127 to 127) offsets. The measurement ends when either counter
+ * saturates; one sample count stands for data_width << (1 + prescale) bits.
+ */
+int32_t xilinx_xcvr_eyescan_start(struct xilinx_xcvr *xcvr,
+				  uint32_t drp_port, int32_t horz_offset, int32_t vert_offset,
+				  uint32_t ut_sign, uint32_t prescale)
+{
+	uint32_t horz, vert, mag;
+	int32_t ret;
+
+	if (prescale > 31 || vert_offset > 127 || vert_offset < -127)
+		return FAILURE;
+
+	horz = horz_offset & 0x7ff;
+	if (horz_offset < 0)
+		horz |= ES_HORZ_PHASE_UNIFICATION;
+
+	mag = abs(vert_offset);
+
+	switch (xcvr->type) {
+	case XILINX_XCVR_TYPE_S7_GTX2:
+		vert = mag;
+		if (vert_offset < 0)
+			vert |= GTX2_ES_VERT_NEG;
+		if (ut_sign)
+			vert |= GTX2_ES_VERT_UT_SIGN;
+
+		ret = xilinx_xcvr_drp_update(xcvr, drp_port, GTX2_ES_PRESCALE_VERT_ADDR,
+					     GTX2_ES_PRESCALE_MASK | GTX2_ES_VERT_OFFSET_MASK,
+					     (prescale << GTX2_ES_PRESCALE_OFFSET) | vert);
+		if (ret < 0)
+			return ret;
+
+		ret = xilinx_xcvr_drp_update(xcvr, drp_port, GTX2_ES_HORZ_OFFSET_ADDR,
+					     GTX2_ES_HORZ_OFFSET_MASK, horz);
+		if (ret < 0)
+			return ret;
+
+		return xilinx_xcvr_drp_update(xcvr, drp_port, GTX2_ES_CONTROL_ADDR,
+					      ES_CONTROL_MASK, ES_CONTROL_RUN);
+	case XILINX_XCVR_TYPE_US_GTH3:
+	case XILINX_XCVR_TYPE_US_GTH4:
+	case XILINX_XCVR_TYPE_US_GTY4:
+		vert = mag << GTH34_RX_EYESCAN_VS_CODE_OFFSET;
+		if (vert_offset < 0)
+			vert |= GTH34_RX_EYESCAN_VS_NEG_DIR;
+		if (ut_sign)
+			vert |= GTH34_RX_EYESCAN_VS_UT_SIGN;
+
+		ret = xilinx_xcvr_drp_update(xcvr, drp_port, GTH34_RX_EYESCAN_VS_ADDR,
+					     GTH34_RX_EYESCAN_VS_MASK, vert);
+		if (ret < 0)
+			return ret;
+
+		ret = xilinx_xcvr_drp_update(xcvr, drp_port, GTH34_ES_HORZ_OFFSET_ADDR,
+					     GTH34_ES_HORZ_OFFSET_MASK,
+					     horz << GTH34_ES_HORZ_OFFSET_OFFSET);
+		if (ret < 0)
+			return ret;
+
+		return xilinx_xcvr_drp_update(xcvr, drp_port, GTH34_ES_CONTROL_ADDR,
+					      ES_CONTROL_MASK | GTH34_ES_PRESCALE_MASK,
+					      ES_CONTROL_RUN | prescale);
+	default:
+		return FAILURE;
+	}
+}
+
+/**
+ * @brief xilinx_xcvr_eyescan_read
+ *
+ * Check whether the current measurement is done and, if so, read its error
+ * and sample counters.
+ */
+int32_t xilinx_xcvr_eyescan_read(struct xilinx_xcvr *xcvr,
+				 uint32_t drp_port, bool *done, uint32_t *errors, uint32_t *samples)
+{
+	uint32_t status_addr, error_addr, sample_addr;
+	uint32_t val;
+	int32_t ret;
+
+	switch (xcvr->type) {
+	case XILINX_XCVR_TYPE_S7_GTX2:
+		status_addr = GTX2_ES_CONTROL_STATUS_ADDR;
+		error_addr = GTX2_ES_ERROR_COUNT_ADDR;
+		sample_addr = GTX2_ES_SAMPLE_COUNT_ADDR;
+		break;
+	case XILINX_XCVR_TYPE_US_GTH3:
+	case XILINX_XCVR_TYPE_US_GTH4:
+	case XILINX_XCVR_TYPE_US_GTY4:
+		status_addr = GTH34_ES_CONTROL_STATUS_ADDR;
+		error_addr = GTH34_ES_ERROR_COUNT_ADDR;
+		sample_addr = GTH34_ES_SAMPLE_COUNT_ADDR;
+		break;
+	default:
+		return FAILURE;
+	}
+
+	ret = xilinx_xcvr_drp_read(xcvr, drp_port, status_addr, &val);
+	if (ret < 0)
+		return ret;
+
+	*done = !!(val & ES_CONTROL_STATUS_DONE);
+	if (!*done)
+		return SUCCESS;
+
+	ret = xilinx_xcvr_drp_read(xcvr, drp_port, error_addr, errors);
+	if (ret < 0)
+		return ret;
+
+	return xilinx_xcvr_drp_read(xcvr, drp_port, sample_addr, samples);
+}
+
+/**
+ * @brief xilinx_xcvr_eyescan_stop
+ *
+ * Clearing the run bit returns the eye scan state machine to wait, ready for
+ * the next measurement.
+ */
+int32_t xilinx_xcvr_eyescan_stop(struct xilinx_xcvr *xcvr, uint32_t drp_port)
+{
+	switch (xcvr->type) {
+	case XILINX_XCVR_TYPE_S7_GTX2:
+		return xilinx_xcvr_drp_update(xcvr, drp_port, GTX2_ES_CONTROL_ADDR,
+					      ES_CONTROL_MASK, 0);
+	case XILINX_XCVR_TYPE_US_GTH3:
+	case XILINX_XCVR_TYPE_US_GTH4:
+	case XILINX_XCVR_TYPE_US_GTY4:
+		return xilinx_xcvr_drp_update(xcvr, drp_port, GTH34_ES_CONTROL_ADDR,
+					      ES_CONTROL_MASK, 0);
+	default:
+		return FAILURE;
+	}
+}
@@ -137,7 +137,22 @@ enum axi_fpga_dev_pack {
 	AXI_FPGA_DEV_FA,
 };
 
+#define XILINX_XCVR_REG_IMAGE_SIZE	12
+
+struct xilinx_xcvr_drp_reg {
+	uint16_t reg;
+	uint16_t mask;
+	uint16_t val;
+};
+
+struct xilinx_xcvr_reg_image {
+	uint32_t num_regs;
+	struct xilinx_xcvr_drp_reg regs[XILINX_XCVR_REG_IMAGE_SIZE];
+};
+
 struct xilinx_xcvr {
+	/* When set, DRP writes are recorded here instead of being issued */
+	struct xilinx_xcvr_reg_image *drp_image;
 	enum xilinx_xcvr_type type;
 	enum xilinx_xcvr_refclk_ppm refclk_ppm;
 	uint32_t encoding;
@@ -162,6 +177,17 @@ struct xilinx_xcvr_qpll_config {
 	uint32_t band;
 };
 
+struct xilinx_xcvr_rate_config {
+	bool valid;
+	uint32_t refclk_khz;
+	uint32_t lane_rate_khz;
+	bool cpll_enable;
+	bool lpm_enable;
+	uint32_t out_div;
+	struct xilinx_xcvr_reg_image common;
+	struct xilinx_xcvr_reg_image channel;
+};
+
 #define ENC_8B10B		810
 
 /******************************************************************************/
@@ -200,4 +226,20 @@ int32_t xilinx_xcvr_write_rx_clk25_div(struct xilinx_xcvr *xcvr,
 				       uint32_t drp_port, uint32_t div);
 int32_t xilinx_xcvr_write_tx_clk25_div(struct xilinx_xcvr *xcvr,
 				       uint32_t drp_port, uint32_t div);
+int32_t xilinx_xcvr_calc_rate_config(struct xilinx_xcvr *xcvr,
+				     uint32_t refclk_khz, uint32_t lane_rate_khz,
+				     bool cpll_enable, bool tx_enable, bool lpm_enable,
+				     struct xilinx_xcvr_rate_config *conf);
+int32_t xilinx_xcvr_write_reg_image(struct xilinx_xcvr *xcvr,
+				    uint32_t drp_port, const struct xilinx_xcvr_reg_image *image);
+int32_t xilinx_xcvr_eyescan_setup(struct xilinx_xcvr *xcvr,
+				  uint32_t drp_port, uint32_t data_width);
+int32_t xilinx_xcvr_eyescan_disable(struct xilinx_xcvr *xcvr,
+				    uint32_t drp_port);
+int32_t xilinx_xcvr_eyescan_start(struct xilinx_xcvr *xcvr,
+				  uint32_t drp_port, int32_t horz_offset, int32_t vert_offset,
+				  uint32_t ut_sign, uint32_t prescale);
+int32_t xilinx_xcvr_eyescan_read(struct xilinx_xcvr *xcvr,
+				 uint32_t drp_port, bool *done, uint32_t *errors, uint32_t *samples);
+int32_t xilinx_xcvr_eyescan_stop(struct xilinx_xcvr *xcvr, uint32_t drp_port);
 #endif
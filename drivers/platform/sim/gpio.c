@@ -0,0 +1,229 @@
+/***************************************************************************//**
+ *   @file   gpio.c
+ *   @brief  Implementation of simulated GPIO driver.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include "error.h"
+#include "gpio.h"
+#include "gpio_extra.h"
+#include "sim.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Modeled duration of one GPIO register access. */
+#define SIM_GPIO_ACCESS_NS	100
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Obtain the GPIO decriptor.
+ * @param desc - The GPIO descriptor.
+ * @param param - GPIO initialization parameters, extra may be NULL.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_get(struct gpio_desc **desc,
+		 const struct gpio_init_param *param)
+{
+	struct gpio_desc	*gdesc;
+	struct sim_gpio_desc	*sim_desc;
+	struct sim_gpio_init_param *sim_init;
+
+	if (!desc || !param)
+		return FAILURE;
+
+	gdesc = (struct gpio_desc *)calloc(1, sizeof(*gdesc));
+	sim_desc = (struct sim_gpio_desc *)calloc(1, sizeof(*sim_desc));
+	if (!gdesc || !sim_desc) {
+		free(gdesc);
+		free(sim_desc);
+		return FAILURE;
+	}
+
+	sim_init = param->extra;
+	if (sim_init) {
+		sim_desc->set = sim_init->set;
+		sim_desc->get = sim_init->get;
+		sim_desc->priv = sim_init->priv;
+	}
+	sim_desc->direction = GPIO_IN;
+
+	gdesc->number = param->number;
+	gdesc->extra = sim_desc;
+
+	*desc = gdesc;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by gpio_get().
+ * @param desc - The GPIO descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_remove(struct gpio_desc *desc)
+{
+	if (!desc)
+		return FAILURE;
+
+	free(desc->extra);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Enable the input direction of the specified GPIO.
+ * @param desc - The GPIO descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_direction_input(struct gpio_desc *desc)
+{
+	struct sim_gpio_desc *sim_desc;
+
+	if (!desc)
+		return FAILURE;
+
+	sim_desc = desc->extra;
+	sim_bus_account(&sim_stats_live()->gpio, 0, SIM_GPIO_ACCESS_NS);
+	sim_desc->direction = GPIO_IN;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Enable the output direction of the specified GPIO.
+ * @param desc - The GPIO descriptor.
+ * @param value - The value.
+ *                Example: GPIO_HIGH
+ *                         GPIO_LOW
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_direction_output(struct gpio_desc *desc,
+			      uint8_t value)
+{
+	struct sim_gpio_desc *sim_desc;
+
+	if (!desc)
+		return FAILURE;
+
+	sim_desc = desc->extra;
+	sim_desc->direction = GPIO_OUT;
+
+	return gpio_set_value(desc, value);
+}
+
+/**
+ * @brief Get the direction of the specified GPIO.
+ * @param desc - The GPIO descriptor.
+ * @param direction - The direction.
+ *                    Example: GPIO_OUT
+ *                             GPIO_IN
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_get_direction(struct gpio_desc *desc,
+			   uint8_t *direction)
+{
+	struct sim_gpio_desc *sim_desc;
+
+	if (!desc)
+		return FAILURE;
+
+	sim_desc = desc->extra;
+	sim_bus_account(&sim_stats_live()->gpio, 0, SIM_GPIO_ACCESS_NS);
+	*direction = sim_desc->direction;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Set the value of the specified GPIO.
+ * @param desc - The GPIO descriptor.
+ * @param value - The value.
+ *                Example: GPIO_HIGH
+ *                         GPIO_LOW
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_set_value(struct gpio_desc *desc,
+		       uint8_t value)
+{
+	struct sim_gpio_desc *sim_desc;
+
+	if (!desc)
+		return FAILURE;
+
+	sim_desc = desc->extra;
+	sim_bus_account(&sim_stats_live()->gpio, 0, SIM_GPIO_ACCESS_NS);
+	sim_desc->value = value;
+	if (sim_desc->set)
+		sim_desc->set(sim_desc->priv, value);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the value of the specified GPIO.
+ * @param desc - The GPIO descriptor.
+ * @param value - The value.
+ *                Example: GPIO_HIGH
+ *                         GPIO_LOW
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_get_value(struct gpio_desc *desc,
+		       uint8_t *value)
+{
+	struct sim_gpio_desc *sim_desc;
+
+	if (!desc)
+		return FAILURE;
+
+	sim_desc = desc->extra;
+	sim_bus_account(&sim_stats_live()->gpio, 0, SIM_GPIO_ACCESS_NS);
+	if (sim_desc->direction == GPIO_IN && sim_desc->get)
+		sim_desc->value = sim_desc->get(sim_desc->priv);
+	*value = sim_desc->value;
+
+	return SUCCESS;
+}
@@ -0,0 +1,83 @@
+/***************************************************************************//**
+ *   @file   gpio_extra.h
+ *   @brief  Header containing types used in the simulated GPIO driver.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef GPIO_EXTRA_H_
+#define GPIO_EXTRA_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct sim_gpio_init_param
+ * @brief Structure holding the optional model connected to a simulated GPIO.
+ */
+typedef struct sim_gpio_init_param {
+	/** Called when the GPIO is driven as output */
+	void		(*set)(void *priv, uint8_t value);
+	/** Called to sample the GPIO when configured as input */
+	uint8_t		(*get)(void *priv);
+	/** Model private data, it identifies the modeled line */
+	void		*priv;
+} sim_gpio_init_param;
+
+/**
+ * @struct sim_gpio_desc
+ * @brief Simulated platform specific GPIO descriptor
+ */
+typedef struct sim_gpio_desc {
+	/** Called when the GPIO is driven as output */
+	void		(*set)(void *priv, uint8_t value);
+	/** Called to sample the GPIO when configured as input */
+	uint8_t		(*get)(void *priv);
+	/** Model private data, it identifies the modeled line */
+	void		*priv;
+	/** GPIO direction */
+	uint8_t		direction;
+	/** Last value driven or sampled */
+	uint8_t		value;
+} sim_gpio_desc;
+
+#endif // GPIO_EXTRA_H_
@@ -0,0 +1,115 @@
+/***************************************************************************//**
+ *   @file   heap.c
+ *   @brief  Heap operation counters for the simulated platform.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Counts the heap operations of a host build in sim_stats. Link this file and
+ * wrap the allocator with:
+ *
+ *	-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stddef.h>
+#include "sim.h"
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Counted malloc().
+ * @param size - Allocation size.
+ * @return The allocated memory, NULL on failure.
+ */
+void *__wrap_malloc(size_t size)
+{
+	sim_stats_live()->heap_allocs++;
+
+	return __real_malloc(size);
+}
+
+/**
+ * @brief Counted calloc().
+ * @param nmemb - Number of elements.
+ * @param size - Element size.
+ * @return The allocated memory, NULL on failure.
+ */
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+	sim_stats_live()->heap_allocs++;
+
+	return __real_calloc(nmemb, size);
+}
+
+/**
+ * @brief Counted realloc().
+ * @param ptr - Memory to resize.
+ * @param size - New size.
+ * @return The reallocated memory, NULL on failure.
+ */
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	sim_stats_live()->heap_allocs++;
+
+	return __real_realloc(ptr, size);
+}
+
+/**
+ * @brief Counted free().
+ * @param ptr - Memory to release.
+ */
+void __wrap_free(void *ptr)
+{
+	if (ptr)
+		sim_stats_live()->heap_frees++;
+
+	__real_free(ptr);
+}
@@ -0,0 +1,185 @@
+/***************************************************************************//**
+ *   @file   i2c.c
+ *   @brief  Implementation of simulated I2C driver.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include "error.h"
+#include "i2c.h"
+#include "i2c_extra.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Clock used when the descriptor does not request a speed. */
+#define SIM_I2C_DEFAULT_HZ	100000
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Account an I2C transfer.
+ *
+ * Each byte, including the address byte, takes 9 clock cycles (8 data bits
+ * and the acknowledge bit), plus one cycle for the start condition and one
+ * for the stop condition. A transfer ended with a repeated start has no stop
+ * condition.
+ * @param desc - The I2C descriptor.
+ * @param bytes_number - Number of data bytes transferred.
+ * @param option - Non zero for a repeated start instead of a stop.
+ */
+static void i2c_account(struct i2c_desc *desc, uint8_t bytes_number,
+			uint8_t option)
+{
+	struct sim_i2c_desc *sim_desc = desc->extra;
+	uint64_t cycles = ((uint64_t)bytes_number + 1) * 9 + (option ? 1 : 2);
+	uint64_t time_ns;
+
+	time_ns = (cycles * 1000000000ull + desc->max_speed_hz - 1) /
+		  desc->max_speed_hz;
+
+	sim_bus_account(&sim_desc->stats, bytes_number, 0);
+	sim_bus_account(&sim_stats_live()->i2c, bytes_number, time_ns);
+	sim_desc->stats.time_ns += time_ns;
+}
+
+/**
+ * @brief Initialize the I2C communication peripheral.
+ * @param desc - The I2C descriptor.
+ * @param param - The structure that contains the I2C parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t i2c_init(struct i2c_desc **desc,
+		 const struct i2c_init_param *param)
+{
+	struct i2c_desc		*idesc;
+	struct sim_i2c_desc	*sim_desc;
+	struct sim_i2c_init_param *sim_init;
+
+	if (!desc || !param || !param->extra)
+		return FAILURE;
+
+	idesc = (struct i2c_desc *)calloc(1, sizeof(*idesc));
+	sim_desc = (struct sim_i2c_desc *)calloc(1, sizeof(*sim_desc));
+	if (!idesc || !sim_desc) {
+		free(idesc);
+		free(sim_desc);
+		return FAILURE;
+	}
+
+	sim_init = param->extra;
+	sim_desc->write = sim_init->write;
+	sim_desc->read = sim_init->read;
+	sim_desc->priv = sim_init->priv;
+
+	idesc->max_speed_hz = param->max_speed_hz ? param->max_speed_hz :
+			      SIM_I2C_DEFAULT_HZ;
+	idesc->slave_address = param->slave_address;
+	idesc->extra = sim_desc;
+
+	*desc = idesc;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by i2c_init().
+ * @param desc - The I2C descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t i2c_remove(struct i2c_desc *desc)
+{
+	if (!desc)
+		return FAILURE;
+
+	free(desc->extra);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Write data to a slave device.
+ * @param desc - The I2C descriptor.
+ * @param data - Buffer that stores the transmission data.
+ * @param bytes_number - Number of bytes to write.
+ * @param option - Non zero for a repeated start instead of a stop.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t i2c_write(struct i2c_desc *desc,
+		  uint8_t *data,
+		  uint8_t bytes_number,
+		  uint8_t option)
+{
+	struct sim_i2c_desc *sim_desc = desc->extra;
+
+	i2c_account(desc, bytes_number, option);
+
+	if (!sim_desc->write)
+		return FAILURE;
+
+	return sim_desc->write(sim_desc->priv, data, bytes_number);
+}
+
+/**
+ * @brief Read data from a slave device.
+ * @param desc - The I2C descriptor.
+ * @param data - Buffer that will store the received data.
+ * @param bytes_number - Number of bytes to read.
+ * @param option - Non zero for a repeated start instead of a stop.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t i2c_read(struct i2c_desc *desc,
+		 uint8_t *data,
+		 uint8_t bytes_number,
+		 uint8_t option)
+{
+	struct sim_i2c_desc *sim_desc = desc->extra;
+
+	i2c_account(desc, bytes_number, option);
+
+	if (!sim_desc->read)
+		return FAILURE;
+
+	return sim_desc->read(sim_desc->priv, data, bytes_number);
+}
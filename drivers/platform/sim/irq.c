@@ -0,0 +1,250 @@
+/***************************************************************************//**
+ *   @file   irq.c
+ *   @brief  Implementation of simulated IRQ driver.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include "error.h"
+#include "irq.h"
+#include "irq_extra.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Call the handler of a line if it can be delivered.
+ * @param sim_dev - The simulated controller.
+ * @param irq_id - Interrupt identifier.
+ */
+static void sim_irq_deliver(struct sim_irq_desc *sim_dev, uint32_t irq_id)
+{
+	struct sim_irq_line *line = &sim_dev->lines[irq_id];
+
+	if (!line->pending || !line->enabled || !sim_dev->global_enabled ||
+	    !line->handler)
+		return;
+
+	line->pending = false;
+	line->count++;
+	line->handler(line->data);
+}
+
+/**
+ * @brief Initialize the IRQ interrupts.
+ * @param desc - The IRQ descriptor.
+ * @param param - The structure that contains the IRQ parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_ctrl_init(struct irq_desc **desc,
+		      const struct irq_init_param *param)
+{
+	struct irq_desc *descriptor;
+	struct sim_irq_desc *sim_dev;
+
+	if (!desc || !param)
+		return FAILURE;
+
+	descriptor = (struct irq_desc *)calloc(1, sizeof *descriptor);
+	if (!descriptor)
+		return FAILURE;
+	sim_dev = (struct sim_irq_desc *)calloc(1, sizeof *sim_dev);
+	if (!sim_dev) {
+		free(descriptor);
+		return FAILURE;
+	}
+
+	descriptor->irq_id = param->irq_id;
+	descriptor->extra = sim_dev;
+
+	*desc = descriptor;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by irq_ctrl_init().
+ * @param desc - The IRQ descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_ctrl_remove(struct irq_desc *desc)
+{
+	if (!desc)
+		return FAILURE;
+
+	free(desc->extra);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Registers a generic IRQ handling function.
+ * @param desc - The IRQ descriptor.
+ * @param irq_id - Interrupt identifier.
+ * @param irq_handler - The IRQ handler.
+ * @param dev_instance - device instance.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_register(struct irq_desc *desc, uint32_t irq_id,
+		     void (*irq_handler)(void *data), void *dev_instance)
+{
+	struct sim_irq_desc *sim_dev = desc->extra;
+
+	if (irq_id >= SIM_IRQ_NUM)
+		return FAILURE;
+
+	sim_dev->lines[irq_id].handler = irq_handler;
+	sim_dev->lines[irq_id].data = dev_instance;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Unregisters a generic IRQ handling function.
+ * @param desc - The IRQ descriptor.
+ * @param irq_id - Interrupt identifier.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_unregister(struct irq_desc *desc, uint32_t irq_id)
+{
+	struct sim_irq_desc *sim_dev = desc->extra;
+
+	if (irq_id >= SIM_IRQ_NUM)
+		return FAILURE;
+
+	sim_dev->lines[irq_id].handler = NULL;
+	sim_dev->lines[irq_id].data = NULL;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Enable global interrupts.
+ *
+ * Lines asserted while interrupts were disabled are delivered now.
+ * @param desc - The IRQ descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_global_enable(struct irq_desc *desc)
+{
+	struct sim_irq_desc *sim_dev = desc->extra;
+	uint32_t i;
+
+	sim_dev->global_enabled = true;
+	for (i = 0; i < SIM_IRQ_NUM; i++)
+		sim_irq_deliver(sim_dev, i);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Disable global interrupts.
+ * @param desc - The IRQ descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_global_disable(struct irq_desc *desc)
+{
+	struct sim_irq_desc *sim_dev = desc->extra;
+
+	sim_dev->global_enabled = false;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Enable specific interrupt.
+ * @param desc - The IRQ descriptor.
+ * @param irq_id - Interrupt identifier.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_source_enable(struct irq_desc *desc, uint32_t irq_id)
+{
+	struct sim_irq_desc *sim_dev = desc->extra;
+
+	if (irq_id >= SIM_IRQ_NUM)
+		return FAILURE;
+
+	sim_dev->lines[irq_id].enabled = true;
+	sim_irq_deliver(sim_dev, irq_id);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Disable specific interrupt.
+ * @param desc - The IRQ descriptor.
+ * @param irq_id - Interrupt identifier.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_source_disable(struct irq_desc *desc, uint32_t irq_id)
+{
+	struct sim_irq_desc *sim_dev = desc->extra;
+
+	if (irq_id >= SIM_IRQ_NUM)
+		return FAILURE;
+
+	sim_dev->lines[irq_id].enabled = false;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Assert an interrupt line, as a register model would.
+ *
+ * The handler runs synchronously if the line and the controller are enabled,
+ * otherwise the line stays pending until it gets enabled.
+ * @param desc - The IRQ descriptor.
+ * @param irq_id - Interrupt identifier.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_irq_trigger(struct irq_desc *desc, uint32_t irq_id)
+{
+	struct sim_irq_desc *sim_dev = desc->extra;
+
+	if (irq_id >= SIM_IRQ_NUM)
+		return FAILURE;
+
+	sim_dev->lines[irq_id].pending = true;
+	sim_irq_deliver(sim_dev, irq_id);
+
+	return SUCCESS;
+}
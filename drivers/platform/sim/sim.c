@@ -0,0 +1,236 @@
+/***************************************************************************//**
+ *   @file   sim.c
+ *   @brief  Simulated platform core: virtual time, bus statistics and register models.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "error.h"
+#include "sim.h"
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+/** Simulated time since start-up (ns) */
+static uint64_t sim_now_ns;
+
+/** Global transaction counters */
+static struct sim_stats sim_stats;
+
+/** Modeled duration of one AXI register access (ns) */
+static uint32_t sim_axi_access_ns = SIM_AXI_ACCESS_NS;
+
+/** Register models mapped in the AXI address space */
+static struct sim_axi_model *sim_axi_models[SIM_AXI_MAX_MODELS];
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Get the current simulated time.
+ * @return Nanoseconds elapsed since start-up.
+ */
+uint64_t sim_time_ns(void)
+{
+	return sim_now_ns;
+}
+
+/**
+ * @brief Advance the simulated time.
+ * @param ns - Number of nanoseconds.
+ */
+void sim_time_advance(uint64_t ns)
+{
+	sim_now_ns += ns;
+}
+
+/**
+ * @brief Account a bus transaction and advance the simulated time.
+ * @param bus - Bus counters to update.
+ * @param bytes - Number of bytes transferred.
+ * @param time_ns - Modeled duration of the transaction.
+ */
+void sim_bus_account(struct sim_bus_stats *bus, uint32_t bytes,
+		     uint64_t time_ns)
+{
+	bus->transactions++;
+	bus->bytes += bytes;
+	bus->time_ns += time_ns;
+	sim_time_advance(time_ns);
+}
+
+/**
+ * @brief Get a snapshot of the global transaction counters.
+ * @param stats - Where to store the counters.
+ */
+void sim_stats_get(struct sim_stats *stats)
+{
+	memcpy(stats, &sim_stats, sizeof(*stats));
+}
+
+/**
+ * @brief Get a pointer to the live global transaction counters.
+ * @return Pointer to the counters updated by the platform drivers.
+ */
+struct sim_stats *sim_stats_live(void)
+{
+	return &sim_stats;
+}
+
+/**
+ * @brief Clear the global transaction counters.
+ *
+ * The simulated time is not affected.
+ */
+void sim_stats_reset(void)
+{
+	memset(&sim_stats, 0, sizeof(sim_stats));
+}
+
+/**
+ * @brief Print one line of the transaction counters report.
+ * @param name - Bus name.
+ * @param bus - Bus counters.
+ */
+static void sim_bus_print(const char *name, const struct sim_bus_stats *bus)
+{
+	printf("%-10s %10"PRIu32" xfers %12"PRIu64" bytes %12"PRIu64" ns\n",
+	       name, bus->transactions, bus->bytes, bus->time_ns);
+}
+
+/**
+ * @brief Print a transaction counters report.
+ * @param stats - Counters to print.
+ */
+void sim_stats_print(const struct sim_stats *stats)
+{
+	sim_bus_print("spi", &stats->spi);
+	sim_bus_print("i2c", &stats->i2c);
+	sim_bus_print("axi read", &stats->axi_read);
+	sim_bus_print("axi write", &stats->axi_write);
+	sim_bus_print("gpio", &stats->gpio);
+	printf("%-10s %10"PRIu32" calls %12s       %12"PRIu64" ns\n",
+	       "delay", stats->delay_calls, "", stats->delay_ns);
+	printf("%-10s %10"PRIu32" allocs %11"PRIu32" frees\n",
+	       "heap", stats->heap_allocs, stats->heap_frees);
+}
+
+/**
+ * @brief Set the modeled duration of one AXI register access.
+ * @param ns - Access time in nanoseconds.
+ */
+void sim_axi_set_access_time(uint32_t ns)
+{
+	sim_axi_access_ns = ns;
+}
+
+/**
+ * @brief Map a register model in the simulated AXI address space.
+ * @param model - The register model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_axi_register(struct sim_axi_model *model)
+{
+	uint32_t i;
+
+	if (!model || !model->size)
+		return FAILURE;
+
+	for (i = 0; i < SIM_AXI_MAX_MODELS; i++) {
+		if (!sim_axi_models[i]) {
+			sim_axi_models[i] = model;
+			return SUCCESS;
+		}
+	}
+
+	return FAILURE;
+}
+
+/**
+ * @brief Remove a register model from the simulated AXI address space.
+ * @param model - The register model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_axi_unregister(struct sim_axi_model *model)
+{
+	uint32_t i;
+
+	for (i = 0; i < SIM_AXI_MAX_MODELS; i++) {
+		if (sim_axi_models[i] == model) {
+			sim_axi_models[i] = NULL;
+			return SUCCESS;
+		}
+	}
+
+	return FAILURE;
+}
+
+/**
+ * @brief Find the register model that decodes the given address.
+ * @param addr - AXI address.
+ * @return The register model, NULL if the address is not mapped.
+ */
+struct sim_axi_model *sim_axi_find(uint32_t addr)
+{
+	struct sim_axi_model *model;
+	uint32_t i;
+
+	for (i = 0; i < SIM_AXI_MAX_MODELS; i++) {
+		model = sim_axi_models[i];
+		if (model && addr >= model->base &&
+		    addr - model->base < model->size)
+			return model;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Get the modeled duration of one AXI register access.
+ * @return Access time in nanoseconds.
+ */
+uint32_t sim_axi_access_time(void)
+{
+	return sim_axi_access_ns;
+}
@@ -0,0 +1,158 @@
+/***************************************************************************//**
+ *   @file   sim.h
+ *   @brief  Simulated platform core: virtual time, bus statistics and register models.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef SIM_H_
+#define SIM_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Maximum number of AXI register models mapped at the same time. */
+#define SIM_AXI_MAX_MODELS	16
+/* Default modeled duration of one AXI-Lite register access. */
+#define SIM_AXI_ACCESS_NS	100
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct sim_bus_stats
+ * @brief Transaction counters of one simulated bus.
+ */
+struct sim_bus_stats {
+	/** Number of transactions */
+	uint32_t	transactions;
+	/** Number of bytes transferred */
+	uint64_t	bytes;
+	/** Modeled bus time (ns) */
+	uint64_t	time_ns;
+};
+
+/**
+ * @struct sim_stats
+ * @brief Counters of every transaction issued through the simulated platform.
+ */
+struct sim_stats {
+	/** SPI transfers */
+	struct sim_bus_stats	spi;
+	/** I2C transfers */
+	struct sim_bus_stats	i2c;
+	/** AXI register reads */
+	struct sim_bus_stats	axi_read;
+	/** AXI register writes */
+	struct sim_bus_stats	axi_write;
+	/** GPIO accesses */
+	struct sim_bus_stats	gpio;
+	/** Number of udelay()/mdelay() calls */
+	uint32_t		delay_calls;
+	/** Time spent in udelay()/mdelay() (ns) */
+	uint64_t		delay_ns;
+	/** malloc()/calloc()/realloc() calls, counted when heap.c is linked */
+	uint32_t		heap_allocs;
+	/** free() calls, counted when heap.c is linked */
+	uint32_t		heap_frees;
+};
+
+/**
+ * @struct sim_axi_model
+ * @brief Register model mapped in the simulated AXI address space.
+ */
+struct sim_axi_model {
+	/** Base address of the mapped region */
+	uint32_t	base;
+	/** Size of the mapped region in bytes */
+	uint32_t	size;
+	/** Register read handler */
+	int32_t		(*read)(void *priv, uint32_t offset, uint32_t *data);
+	/** Register write handler */
+	int32_t		(*write)(void *priv, uint32_t offset, uint32_t data);
+	/** Model private data */
+	void		*priv;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Get the current simulated time. */
+uint64_t sim_time_ns(void);
+
+/* Advance the simulated time. */
+void sim_time_advance(uint64_t ns);
+
+/* Account a bus transaction and advance the simulated time. */
+void sim_bus_account(struct sim_bus_stats *bus, uint32_t bytes,
+		     uint64_t time_ns);
+
+/* Get a snapshot of the global transaction counters. */
+void sim_stats_get(struct sim_stats *stats);
+
+/* Get a pointer to the live global transaction counters. */
+struct sim_stats *sim_stats_live(void);
+
+/* Clear the global transaction counters. */
+void sim_stats_reset(void);
+
+/* Print a transaction counters report. */
+void sim_stats_print(const struct sim_stats *stats);
+
+/* Set the modeled duration of one AXI register access. */
+void sim_axi_set_access_time(uint32_t ns);
+
+/* Get the modeled duration of one AXI register access. */
+uint32_t sim_axi_access_time(void);
+
+/* Map a register model in the simulated AXI address space. */
+int32_t sim_axi_register(struct sim_axi_model *model);
+
+/* Remove a register model from the simulated AXI address space. */
+int32_t sim_axi_unregister(struct sim_axi_model *model);
+
+/* Find the register model that decodes the given address. */
+struct sim_axi_model *sim_axi_find(uint32_t addr);
+
+#endif // SIM_H_
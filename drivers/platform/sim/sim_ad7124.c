@@ -0,0 +1,356 @@
+/***************************************************************************//**
+ *   @file   sim_ad7124.c
+ *   @brief  Register model of the AD7124 ADC.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "sim.h"
+#include "sim_ad7124.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define COMM_REG_RD			(1 << 6)
+#define COMM_REG_RA(x)			((x) & 0x3F)
+
+#define REG_STATUS			0x00
+#define STATUS_RDY			(1 << 7)
+#define STATUS_POR_FLAG			(1 << 4)
+#define REG_ADC_CONTROL			0x01
+#define ADC_CTRL_DATA_STATUS		(1 << 10)
+#define ADC_CTRL_POWER_MODE(x)		(((x) >> 6) & 0x3)
+#define ADC_CTRL_MODE(x)		(((x) >> 2) & 0xF)
+#define ADC_CTRL_MODE_MASK		(0xF << 2)
+#define MODE_CONTINUOUS			0
+#define MODE_SINGLE			1
+#define MODE_STANDBY			2
+#define MODE_IDLE			4
+#define MODE_CAL_FIRST			5
+#define MODE_CAL_LAST			8
+#define REG_DATA			0x02
+#define REG_ID				0x05
+#define REG_ERROR			0x06
+#define REG_ERROR_EN			0x07
+#define ERREN_SPI_CRC_ERR_EN		(1 << 2)
+#define REG_MCLK_COUNT			0x08
+#define REG_FILTER_0			0x21
+#define FILTER_FS(x)			((x) & 0x7FF)
+
+#define CRC8_POLYNOMIAL			0x07
+#define RESET_ONES			8
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+/** Master clock of each power mode (Hz) */
+static const uint32_t sim_ad7124_mclk_hz[4] = {
+	76800, 153600, 614400, 614400
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Get the size of a register.
+ * @param reg - Register address.
+ * @return Register size in bytes.
+ */
+static uint8_t sim_ad7124_reg_size(uint8_t reg)
+{
+	switch (reg) {
+	case REG_STATUS:
+	case REG_ID:
+	case REG_MCLK_COUNT:
+		return 1;
+	case REG_ADC_CONTROL:
+	case 0x04:
+		return 2;
+	case REG_DATA:
+	case 0x03:
+	case REG_ERROR:
+	case REG_ERROR_EN:
+		return 3;
+	default:
+		return (reg < REG_FILTER_0) ? 2 : 3;
+	}
+}
+
+/**
+ * @brief Compute the CRC-8 used on the AD7124 serial interface.
+ * @param buf - Data buffer.
+ * @param size - Number of bytes.
+ * @return The checksum.
+ */
+static uint8_t sim_ad7124_crc8(const uint8_t *buf, uint32_t size)
+{
+	uint8_t crc = 0;
+	uint8_t i;
+
+	while (size--) {
+		crc ^= *buf++;
+		for (i = 0; i < 8; i++)
+			crc = (crc & 0x80) ? (crc << 1) ^ CRC8_POLYNOMIAL :
+			      crc << 1;
+	}
+
+	return crc;
+}
+
+/**
+ * @brief Put the register model in its power-on state.
+ * @param dev - The register model.
+ */
+void sim_ad7124_reset(struct sim_ad7124 *dev)
+{
+	uint32_t i;
+
+	memset(dev->regs, 0, sizeof(dev->regs));
+	dev->regs[REG_STATUS] = STATUS_RDY | STATUS_POR_FLAG;
+	dev->regs[REG_ID] = SIM_AD7124_ID;
+	dev->regs[REG_ERROR_EN] = 0x40;
+	dev->regs[0x09] = 0x8001;
+	for (i = 0x0A; i <= 0x18; i++)
+		dev->regs[i] = 0x0001;
+	for (i = 0x19; i <= 0x20; i++)
+		dev->regs[i] = 0x0860;
+	for (i = 0x21; i <= 0x28; i++)
+		dev->regs[i] = 0x060180;
+	for (i = 0x29; i <= 0x30; i++)
+		dev->regs[i] = 0x800000;
+	for (i = 0x31; i <= 0x38; i++)
+		dev->regs[i] = 0x500000;
+	dev->converting = false;
+	dev->ones = 0;
+}
+
+/**
+ * @brief Allocate and reset an AD7124 register model.
+ * @param dev - The register model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_ad7124_init(struct sim_ad7124 **dev)
+{
+	struct sim_ad7124 *d;
+
+	d = (struct sim_ad7124 *)calloc(1, sizeof(*d));
+	if (!d)
+		return FAILURE;
+
+	sim_ad7124_reset(d);
+
+	*dev = d;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the register model.
+ * @param dev - The register model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_ad7124_remove(struct sim_ad7124 *dev)
+{
+	free(dev);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Start a conversion or calibration in the current mode.
+ * @param dev - The register model.
+ */
+static void sim_ad7124_start(struct sim_ad7124 *dev)
+{
+	uint32_t ctrl = dev->regs[REG_ADC_CONTROL];
+	uint32_t mode = ADC_CTRL_MODE(ctrl);
+	uint32_t fs = FILTER_FS(dev->regs[REG_FILTER_0]);
+	uint64_t mclk = sim_ad7124_mclk_hz[ADC_CTRL_POWER_MODE(ctrl)];
+
+	dev->converting = (mode == MODE_CONTINUOUS || mode == MODE_SINGLE ||
+			   (mode >= MODE_CAL_FIRST && mode <= MODE_CAL_LAST));
+	dev->regs[REG_STATUS] |= STATUS_RDY;
+	dev->ready_ns = sim_time_ns() +
+			(32ull * (fs ? fs : 1) * 1000000000ull) / mclk;
+}
+
+/**
+ * @brief Update the status register with the conversion state.
+ * @param dev - The register model.
+ */
+static void sim_ad7124_update(struct sim_ad7124 *dev)
+{
+	uint32_t mode;
+
+	if (!dev->converting || sim_time_ns() < dev->ready_ns)
+		return;
+
+	dev->converting = false;
+	mode = ADC_CTRL_MODE(dev->regs[REG_ADC_CONTROL]);
+	if (mode >= MODE_CAL_FIRST && mode <= MODE_CAL_LAST) {
+		dev->regs[REG_ADC_CONTROL] &= ~ADC_CTRL_MODE_MASK;
+		dev->regs[REG_ADC_CONTROL] |= MODE_IDLE << 2;
+	}
+	dev->regs[REG_STATUS] &= ~STATUS_RDY;
+}
+
+/**
+ * @brief Handle a register read.
+ * @param dev - The register model.
+ * @param reg - Register address.
+ * @return Register value.
+ */
+static uint32_t sim_ad7124_read(struct sim_ad7124 *dev, uint8_t reg)
+{
+	uint32_t val;
+
+	sim_ad7124_update(dev);
+	val = dev->regs[reg];
+
+	switch (reg) {
+	case REG_STATUS:
+		dev->regs[REG_STATUS] &= ~STATUS_POR_FLAG;
+		break;
+	case REG_DATA:
+		val = dev->data;
+		if (ADC_CTRL_MODE(dev->regs[REG_ADC_CONTROL]) == MODE_SINGLE) {
+			dev->regs[REG_ADC_CONTROL] &= ~ADC_CTRL_MODE_MASK;
+			dev->regs[REG_ADC_CONTROL] |= MODE_STANDBY << 2;
+		}
+		sim_ad7124_start(dev);
+		break;
+	default:
+		break;
+	}
+
+	return val;
+}
+
+/**
+ * @brief Handle a register write.
+ * @param dev - The register model.
+ * @param reg - Register address.
+ * @param val - Register value.
+ */
+static void sim_ad7124_write(struct sim_ad7124 *dev, uint8_t reg,
+			     uint32_t val)
+{
+	switch (reg) {
+	case REG_STATUS:
+	case REG_DATA:
+	case REG_ID:
+	case REG_ERROR:
+	case REG_MCLK_COUNT:
+		return;
+	case REG_ADC_CONTROL:
+		dev->regs[reg] = val;
+		sim_ad7124_start(dev);
+		return;
+	default:
+		dev->regs[reg] = val;
+		return;
+	}
+}
+
+/**
+ * @brief SPI transfer handler.
+ *
+ * Decodes the communications register byte and the register data that
+ * follows, appending the status byte and the checksum when enabled. Eight
+ * 0xFF bytes in a row reset the device.
+ * @param priv - The register model.
+ * @param data - The transfer buffer, overwritten with the read data.
+ * @param bytes_number - Number of bytes in the transfer.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_ad7124_xfer(void *priv, uint8_t *data, uint16_t bytes_number)
+{
+	struct sim_ad7124 *dev = priv;
+	uint8_t buf[8];
+	uint8_t comm, reg, size, len;
+	uint32_t val = 0;
+	uint32_t i;
+
+	for (i = 0; i < bytes_number; i++)
+		dev->ones = (data[i] == 0xFF) ? dev->ones + 1 : 0;
+	if (dev->ones >= RESET_ONES) {
+		sim_ad7124_reset(dev);
+		return SUCCESS;
+	}
+
+	comm = data[0];
+	reg = COMM_REG_RA(comm);
+	if (reg >= SIM_AD7124_NUM_REGS)
+		return FAILURE;
+	size = sim_ad7124_reg_size(reg);
+
+	if (!(comm & COMM_REG_RD)) {
+		if (bytes_number < size + 1)
+			return FAILURE;
+		for (i = 0; i < size; i++)
+			val = (val << 8) | data[1 + i];
+		sim_ad7124_write(dev, reg, val);
+
+		return SUCCESS;
+	}
+
+	val = sim_ad7124_read(dev, reg);
+	buf[0] = comm;
+	for (i = 0; i < size; i++)
+		buf[1 + i] = val >> (8 * (size - 1 - i));
+	len = size + 1;
+	if (reg == REG_DATA &&
+	    (dev->regs[REG_ADC_CONTROL] & ADC_CTRL_DATA_STATUS))
+		buf[len++] = dev->regs[REG_STATUS];
+	if (dev->regs[REG_ERROR_EN] & ERREN_SPI_CRC_ERR_EN) {
+		buf[len] = sim_ad7124_crc8(buf, len);
+		len++;
+	}
+
+	for (i = 1; i < len && i < bytes_number; i++)
+		data[i] = buf[i];
+
+	return SUCCESS;
+}
@@ -0,0 +1,97 @@
+/***************************************************************************//**
+ *   @file   sim_ad7124.h
+ *   @brief  Register model of the AD7124 ADC.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef SIM_AD7124_H_
+#define SIM_AD7124_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define SIM_AD7124_NUM_REGS	0x39
+#define SIM_AD7124_ID		0x14
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct sim_ad7124
+ * @brief AD7124 register model state.
+ *
+ * Conversions complete after the period set by the filter and power mode of
+ * the first setup, the result being taken from the data member.
+ */
+struct sim_ad7124 {
+	/** Register file */
+	uint32_t	regs[SIM_AD7124_NUM_REGS];
+	/** Conversion result returned by the next data register read */
+	uint32_t	data;
+	/** Simulated time when the running conversion completes */
+	uint64_t	ready_ns;
+	/** A conversion or calibration is running */
+	bool		converting;
+	/** Number of consecutive 0xFF bytes received (reset detection) */
+	uint32_t	ones;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Allocate and reset an AD7124 register model. */
+int32_t sim_ad7124_init(struct sim_ad7124 **dev);
+
+/* Free the register model. */
+int32_t sim_ad7124_remove(struct sim_ad7124 *dev);
+
+/* Put the register model in its power-on state. */
+void sim_ad7124_reset(struct sim_ad7124 *dev);
+
+/* SPI transfer handler (struct sim_spi_init_param xfer). */
+int32_t sim_ad7124_xfer(void *priv, uint8_t *data, uint16_t bytes_number);
+
+#endif // SIM_AD7124_H_
@@ -0,0 +1,413 @@
+/***************************************************************************//**
+ *   @file   sim_ad9361.c
+ *   @brief  Register model of the AD9361 RF transceiver.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "sim.h"
+#include "sim_ad9361.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define AD9361_WRITE			(1 << 15)
+#define AD9361_CNT(cmd)			((((cmd) >> 12) & 0x7) + 1)
+#define AD9361_ADDR(cmd)		((cmd) & 0x3FF)
+
+#define REG_SPI_CONF			0x000
+#define SOFT_RESET			((1 << 7) | (1 << 0))
+#define REG_ENSM_MODE			0x013
+#define FDD_MODE			(1 << 0)
+#define REG_ENSM_CONFIG_1		0x014
+#define FORCE_RX_ON			(1 << 6)
+#define FORCE_TX_ON			(1 << 5)
+#define FORCE_ALERT_STATE		(1 << 2)
+#define TO_ALERT			(1 << 0)
+#define REG_CALIBRATION_CTRL		0x016
+#define REG_STATE			0x017
+#define ENSM_STATE_ALERT		0x5
+#define ENSM_STATE_TX			0x6
+#define ENSM_STATE_RX			0x8
+#define ENSM_STATE_FDD			0xA
+#define REG_PRODUCT_ID			0x037
+#define REG_CH_1_OVERFLOW		0x05E
+#define BBPLL_LOCK			(1 << 7)
+#define REG_TX_FILTER_COEF_ADDR		0x060
+#define REG_RX_FILTER_COEF_ADDR		0x0F0
+#define FILTER_WRITE_DATA_1		1
+#define FILTER_WRITE_DATA_2		2
+#define FILTER_READ_DATA_1		3
+#define FILTER_READ_DATA_2		4
+#define FILTER_CONF			5
+#define FIR_WRITE			(1 << 2)
+#define FIR_SELECT(x)			(((x) >> 3) & 0x3)
+#define REG_RX1_MANUAL_LMT_FULL_GAIN	0x109
+#define REG_RX2_MANUAL_LMT_FULL_GAIN	0x10C
+#define REG_GAIN_TABLE_ADDRESS		0x130
+#define REG_GAIN_TABLE_WRITE_DATA1	0x131
+#define REG_GAIN_TABLE_READ_DATA1	0x134
+#define REG_GAIN_TABLE_CONFIG		0x137
+#define WRITE_GAIN_TABLE		(1 << 2)
+#define RECEIVER_SELECT(x)		(((x) >> 3) & 0x3)
+#define REG_RX_BBF_R2346		0x1E6
+#define REG_RX_BBF_C3_MSB		0x1EB
+#define REG_RX_BBF_C3_LSB		0x1EC
+#define REG_RX_CAL_STATUS		0x244
+#define REG_RX_CP_OVERRANGE_VCO_LOCK	0x247
+#define REG_TX_CAL_STATUS		0x284
+#define REG_TX_CP_OVERRANGE_VCO_LOCK	0x287
+#define REG_GAIN_RX1			0x2B0
+#define REG_GAIN_RX2			0x2B5
+#define CP_CAL_VALID			(1 << 7)
+#define VCO_LOCK			(1 << 1)
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+/** Default duration of the REG_CALIBRATION_CTRL calibrations, bit 0 first */
+static const uint64_t sim_ad9361_cal_time_ns[8] = {
+	2000000,	/* BB DC offset */
+	20000000,	/* RF DC offset */
+	1000000,	/* TX monitor */
+	5000000,	/* RX gain step */
+	2000000,	/* TX quadrature */
+	2000000,	/* RX quadrature */
+	500000,		/* TX baseband filter tune */
+	500000,		/* RX baseband filter tune */
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Put the register model in its power-on state.
+ * @param dev - The register model.
+ */
+void sim_ad9361_reset(struct sim_ad9361 *dev)
+{
+	memset(dev->regs, 0, sizeof(dev->regs));
+	memset(dev->cal_done_ns, 0, sizeof(dev->cal_done_ns));
+	dev->regs[REG_PRODUCT_ID] = SIM_AD9361_PRODUCT_ID;
+	/* Rx baseband filter tune results of a typical part */
+	dev->regs[REG_RX_BBF_R2346] = 0x01;
+	dev->regs[REG_RX_BBF_C3_MSB] = 0x63;
+	dev->regs[REG_RX_BBF_C3_LSB] = 0x70;
+}
+
+/**
+ * @brief Allocate and reset an AD9361 register model.
+ * @param dev - The register model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_ad9361_init(struct sim_ad9361 **dev)
+{
+	struct sim_ad9361 *d;
+
+	d = (struct sim_ad9361 *)calloc(1, sizeof(*d));
+	if (!d)
+		return FAILURE;
+
+	memcpy(d->cal_time_ns, sim_ad9361_cal_time_ns, sizeof(d->cal_time_ns));
+	d->resetb = 1;
+	sim_ad9361_reset(d);
+
+	*dev = d;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the register model.
+ * @param dev - The register model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_ad9361_remove(struct sim_ad9361 *dev)
+{
+	free(dev);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Map a FIR filter block register to a coefficient memory.
+ * @param base - Base address of the filter block.
+ * @return Index of the first coefficient memory of the block.
+ */
+static uint32_t sim_ad9361_fir_bank(uint32_t base)
+{
+	return (base == REG_RX_FILTER_COEF_ADDR) ? 2 : 0;
+}
+
+/**
+ * @brief Update the FIR coefficient read-back registers.
+ * @param dev - The register model.
+ * @param base - Base address of the filter block.
+ */
+static void sim_ad9361_fir_readback(struct sim_ad9361 *dev, uint32_t base)
+{
+	uint8_t sel = FIR_SELECT(dev->regs[base + FILTER_CONF]);
+	uint8_t addr = dev->regs[base] % SIM_AD9361_FIR_TAPS;
+	int16_t coef;
+
+	coef = dev->fir_coef[sim_ad9361_fir_bank(base) + (sel == 2)][addr];
+	dev->regs[base + FILTER_READ_DATA_1] = coef & 0xFF;
+	dev->regs[base + FILTER_READ_DATA_2] = (uint16_t)coef >> 8;
+}
+
+/**
+ * @brief Handle a write to a FIR filter block register.
+ * @param dev - The register model.
+ * @param base - Base address of the filter block.
+ * @param offs - Register offset in the block.
+ */
+static void sim_ad9361_fir_write(struct sim_ad9361 *dev, uint32_t base,
+				 uint32_t offs)
+{
+	uint8_t conf = dev->regs[base + FILTER_CONF];
+	uint8_t sel = FIR_SELECT(conf);
+	uint8_t addr = dev->regs[base] % SIM_AD9361_FIR_TAPS;
+	uint32_t bank = sim_ad9361_fir_bank(base);
+	int16_t coef;
+
+	if (offs == FILTER_CONF && (conf & FIR_WRITE)) {
+		coef = dev->regs[base + FILTER_WRITE_DATA_1] |
+		       (dev->regs[base + FILTER_WRITE_DATA_2] << 8);
+		if (sel & 1)
+			dev->fir_coef[bank][addr] = coef;
+		if (sel & 2)
+			dev->fir_coef[bank + 1][addr] = coef;
+	}
+
+	if (offs == 0 || offs == FILTER_CONF)
+		sim_ad9361_fir_readback(dev, base);
+}
+
+/**
+ * @brief Handle a write to a gain table register.
+ * @param dev - The register model.
+ * @param reg - Register address.
+ */
+static void sim_ad9361_gt_write(struct sim_ad9361 *dev, uint32_t reg)
+{
+	uint8_t conf = dev->regs[REG_GAIN_TABLE_CONFIG];
+	uint8_t sel = RECEIVER_SELECT(conf);
+	uint8_t addr = dev->regs[REG_GAIN_TABLE_ADDRESS] % SIM_AD9361_GT_SIZE;
+	uint32_t i;
+
+	if (reg == REG_GAIN_TABLE_CONFIG && (conf & WRITE_GAIN_TABLE)) {
+		for (i = 0; i < 3; i++) {
+			if (sel & 1)
+				dev->gain_table[0][addr][i] =
+					dev->regs[REG_GAIN_TABLE_WRITE_DATA1 + i];
+			if (sel & 2)
+				dev->gain_table[1][addr][i] =
+					dev->regs[REG_GAIN_TABLE_WRITE_DATA1 + i];
+		}
+	}
+
+	if (reg == REG_GAIN_TABLE_ADDRESS || reg == REG_GAIN_TABLE_CONFIG)
+		for (i = 0; i < 3; i++)
+			dev->regs[REG_GAIN_TABLE_READ_DATA1 + i] =
+				dev->gain_table[sel == 2][addr][i];
+}
+
+/**
+ * @brief Handle a register write.
+ * @param dev - The register model.
+ * @param reg - Register address.
+ * @param val - Register value.
+ */
+static void sim_ad9361_write(struct sim_ad9361 *dev, uint32_t reg,
+			     uint8_t val)
+{
+	uint64_t now = sim_time_ns();
+	uint8_t state;
+	uint32_t i;
+
+	switch (reg) {
+	case REG_SPI_CONF:
+		if ((val & SOFT_RESET) == SOFT_RESET)
+			sim_ad9361_reset(dev);
+		return;
+	case REG_PRODUCT_ID:
+	case REG_STATE:
+	case REG_GAIN_TABLE_READ_DATA1:
+	case REG_GAIN_TABLE_READ_DATA1 + 1:
+	case REG_GAIN_TABLE_READ_DATA1 + 2:
+		/* Read-only, writes are used by the driver as bus delays */
+		return;
+	case REG_CALIBRATION_CTRL:
+		for (i = 0; i < 8; i++)
+			if (val & (1 << i))
+				dev->cal_done_ns[i] = now + dev->cal_time_ns[i];
+		break;
+	case REG_ENSM_CONFIG_1:
+		state = dev->regs[REG_STATE];
+		if (val & (FORCE_RX_ON | FORCE_TX_ON)) {
+			if (dev->regs[REG_ENSM_MODE] & FDD_MODE)
+				state = ENSM_STATE_FDD;
+			else
+				state = (val & FORCE_TX_ON) ? ENSM_STATE_TX :
+					ENSM_STATE_RX;
+		} else if (val & (FORCE_ALERT_STATE | TO_ALERT)) {
+			state = ENSM_STATE_ALERT;
+		}
+		dev->regs[REG_STATE] = state;
+		break;
+	default:
+		break;
+	}
+
+	dev->regs[reg] = val;
+
+	if (reg >= REG_TX_FILTER_COEF_ADDR &&
+	    reg <= REG_TX_FILTER_COEF_ADDR + FILTER_CONF)
+		sim_ad9361_fir_write(dev, REG_TX_FILTER_COEF_ADDR,
+				     reg - REG_TX_FILTER_COEF_ADDR);
+	else if (reg >= REG_RX_FILTER_COEF_ADDR &&
+		 reg <= REG_RX_FILTER_COEF_ADDR + FILTER_CONF)
+		sim_ad9361_fir_write(dev, REG_RX_FILTER_COEF_ADDR,
+				     reg - REG_RX_FILTER_COEF_ADDR);
+	else if (reg >= REG_GAIN_TABLE_ADDRESS && reg <= REG_GAIN_TABLE_CONFIG)
+		sim_ad9361_gt_write(dev, reg);
+}
+
+/**
+ * @brief Handle a register read.
+ * @param dev - The register model.
+ * @param reg - Register address.
+ * @return Register value.
+ */
+static uint8_t sim_ad9361_read(struct sim_ad9361 *dev, uint32_t reg)
+{
+	uint64_t now = sim_time_ns();
+	uint8_t val = dev->regs[reg];
+	uint32_t i;
+
+	switch (reg) {
+	case REG_CALIBRATION_CTRL:
+		/* Calibration bits self-clear once the calibration is done */
+		for (i = 0; i < 8; i++)
+			if ((val & (1 << i)) && now >= dev->cal_done_ns[i])
+				val &= ~(1 << i);
+		dev->regs[reg] = val;
+		break;
+	case REG_CH_1_OVERFLOW:
+		val |= BBPLL_LOCK;
+		break;
+	case REG_RX_CAL_STATUS:
+	case REG_TX_CAL_STATUS:
+		val |= CP_CAL_VALID;
+		break;
+	case REG_RX_CP_OVERRANGE_VCO_LOCK:
+	case REG_TX_CP_OVERRANGE_VCO_LOCK:
+		val |= VCO_LOCK;
+		break;
+	case REG_GAIN_RX1:
+		/* Gain index in use, the manual gain as there is no AGC model */
+		val = dev->regs[REG_RX1_MANUAL_LMT_FULL_GAIN];
+		break;
+	case REG_GAIN_RX2:
+		val = dev->regs[REG_RX2_MANUAL_LMT_FULL_GAIN];
+		break;
+	default:
+		break;
+	}
+
+	return val;
+}
+
+/**
+ * @brief SPI transfer handler.
+ *
+ * Decodes one instruction word followed by 1 to 8 data bytes, the register
+ * address decrementing after each byte.
+ * @param priv - The register model.
+ * @param data - The transfer buffer, overwritten with the read data.
+ * @param bytes_number - Number of bytes in the transfer.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_ad9361_xfer(void *priv, uint8_t *data, uint16_t bytes_number)
+{
+	struct sim_ad9361 *dev = priv;
+	uint16_t cmd;
+	uint32_t reg, cnt, i;
+
+	if (!dev->resetb || bytes_number < 3)
+		return FAILURE;
+
+	cmd = (data[0] << 8) | data[1];
+	cnt = AD9361_CNT(cmd);
+	reg = AD9361_ADDR(cmd);
+	if (bytes_number < cnt + 2)
+		return FAILURE;
+
+	dev->instructions++;
+	for (i = 0; i < cnt; i++, reg = (reg - 1) & 0x3FF) {
+		if (cmd & AD9361_WRITE)
+			sim_ad9361_write(dev, reg, data[2 + i]);
+		else
+			data[2 + i] = sim_ad9361_read(dev, reg);
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief RESETB line handler.
+ *
+ * The device is held in reset while the line is low.
+ * @param priv - The register model.
+ * @param value - Line level.
+ */
+void sim_ad9361_resetb_set(void *priv, uint8_t value)
+{
+	struct sim_ad9361 *dev = priv;
+
+	if (!value)
+		sim_ad9361_reset(dev);
+	dev->resetb = value;
+}
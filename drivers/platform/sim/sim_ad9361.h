@@ -0,0 +1,107 @@
+/***************************************************************************//**
+ *   @file   sim_ad9361.h
+ *   @brief  Register model of the AD9361 RF transceiver.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef SIM_AD9361_H_
+#define SIM_AD9361_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define SIM_AD9361_NUM_REGS		1024
+#define SIM_AD9361_GT_SIZE		128
+#define SIM_AD9361_FIR_TAPS		128
+#define SIM_AD9361_PRODUCT_ID		0x0A
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct sim_ad9361
+ * @brief AD9361 register model state.
+ *
+ * Calibrations complete after a modeled duration, all synthesizers report
+ * lock and the gain table and FIR coefficient memories are fully modeled so
+ * that read-back verification works.
+ */
+struct sim_ad9361 {
+	/** Register file */
+	uint8_t		regs[SIM_AD9361_NUM_REGS];
+	/** RX gain tables [receiver][index][word] */
+	uint8_t		gain_table[2][SIM_AD9361_GT_SIZE][3];
+	/** FIR coefficients [TX1, TX2, RX1, RX2][tap] */
+	int16_t		fir_coef[4][SIM_AD9361_FIR_TAPS];
+	/** Duration of each REG_CALIBRATION_CTRL calibration bit (ns) */
+	uint64_t	cal_time_ns[8];
+	/** Simulated time when each running calibration completes */
+	uint64_t	cal_done_ns[8];
+	/** Level of the RESETB line */
+	uint8_t		resetb;
+	/** Number of SPI instructions decoded */
+	uint32_t	instructions;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Allocate and reset an AD9361 register model. */
+int32_t sim_ad9361_init(struct sim_ad9361 **dev);
+
+/* Free the register model. */
+int32_t sim_ad9361_remove(struct sim_ad9361 *dev);
+
+/* Put the register model in its power-on state. */
+void sim_ad9361_reset(struct sim_ad9361 *dev);
+
+/* SPI transfer handler (struct sim_spi_init_param xfer). */
+int32_t sim_ad9361_xfer(void *priv, uint8_t *data, uint16_t bytes_number);
+
+/* RESETB line handler (struct sim_gpio_init_param set). */
+void sim_ad9361_resetb_set(void *priv, uint8_t value);
+
+#endif // SIM_AD9361_H_
@@ -0,0 +1,282 @@
+/***************************************************************************//**
+ *   @file   sim_adxl372.c
+ *   @brief  Register model of the ADXL372 accelerometer.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "error.h"
+#include "sim.h"
+#include "sim_adxl372.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define SPI_READ			0x01
+#define SPI_ADDR(x)			(((x) >> 1) & 0x7F)
+
+#define REG_DEVID			0x00
+#define REG_DEVID_MST			0x01
+#define REG_PARTID			0x02
+#define REG_REVID			0x03
+#define REG_STATUS_1			0x04
+#define STATUS_1_DATA_RDY		(1 << 0)
+#define REG_X_DATA_H			0x08
+#define REG_Z_DATA_L			0x0D
+#define REG_TIMING			0x3D
+#define TIMING_ODR(x)			(((x) >> 5) & 0x7)
+#define REG_POWER_CTL			0x3F
+#define POWER_CTL_MODE(x)		((x) & 0x3)
+#define REG_RESET			0x41
+#define RESET_CODE			0x52
+#define REG_FIFO_DATA			0x42
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Put the register model in its power-on state.
+ * @param dev - The register model.
+ */
+void sim_adxl372_reset(struct sim_adxl372 *dev)
+{
+	memset(dev->regs, 0, sizeof(dev->regs));
+	dev->regs[REG_DEVID] = 0xAD;
+	dev->regs[REG_DEVID_MST] = 0x1D;
+	dev->regs[REG_PARTID] = 0xFA;
+	dev->regs[REG_REVID] = 0x02;
+	dev->i2c_addr = 0;
+}
+
+/**
+ * @brief Allocate and reset an ADXL372 register model.
+ * @param dev - The register model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_adxl372_init(struct sim_adxl372 **dev)
+{
+	struct sim_adxl372 *d;
+
+	d = (struct sim_adxl372 *)calloc(1, sizeof(*d));
+	if (!d)
+		return FAILURE;
+
+	sim_adxl372_reset(d);
+
+	*dev = d;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the register model.
+ * @param dev - The register model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_adxl372_remove(struct sim_adxl372 *dev)
+{
+	free(dev);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Latch a new sample if one is due at the current simulated time.
+ * @param dev - The register model.
+ */
+static void sim_adxl372_update(struct sim_adxl372 *dev)
+{
+	uint64_t now = sim_time_ns();
+	uint32_t odr, i;
+
+	if (!POWER_CTL_MODE(dev->regs[REG_POWER_CTL]) ||
+	    now < dev->next_sample_ns)
+		return;
+
+	/* ODR codes 0 to 4 select 400 Hz to 6400 Hz */
+	odr = TIMING_ODR(dev->regs[REG_TIMING]);
+	if (odr > 4)
+		odr = 4;
+
+	for (i = 0; i < 3; i++) {
+		dev->regs[REG_X_DATA_H + 2 * i] = (dev->sample[i] >> 4) & 0xFF;
+		dev->regs[REG_X_DATA_H + 2 * i + 1] =
+			(dev->sample[i] & 0xF) << 4;
+	}
+	dev->regs[REG_STATUS_1] |= STATUS_1_DATA_RDY;
+	dev->next_sample_ns = now + (2500000 >> odr);
+}
+
+/**
+ * @brief Handle a register read.
+ * @param dev - The register model.
+ * @param reg - Register address.
+ * @return Register value.
+ */
+static uint8_t sim_adxl372_read(struct sim_adxl372 *dev, uint8_t reg)
+{
+	if (reg >= SIM_ADXL372_NUM_REGS)
+		return 0;
+
+	sim_adxl372_update(dev);
+	if (reg >= REG_X_DATA_H && reg <= REG_Z_DATA_L)
+		dev->regs[REG_STATUS_1] &= ~STATUS_1_DATA_RDY;
+
+	return dev->regs[reg];
+}
+
+/**
+ * @brief Handle a register write.
+ * @param dev - The register model.
+ * @param reg - Register address.
+ * @param val - Register value.
+ */
+static void sim_adxl372_write(struct sim_adxl372 *dev, uint8_t reg,
+			      uint8_t val)
+{
+	if (reg >= SIM_ADXL372_NUM_REGS || reg <= REG_Z_DATA_L ||
+	    reg == REG_FIFO_DATA)
+		return;
+
+	if (reg == REG_RESET) {
+		if (val == RESET_CODE)
+			sim_adxl372_reset(dev);
+		return;
+	}
+
+	dev->regs[reg] = val;
+	if (reg == REG_POWER_CTL)
+		dev->next_sample_ns = sim_time_ns();
+}
+
+/**
+ * @brief Access consecutive registers.
+ *
+ * The address auto-increments, except for the FIFO data register.
+ * @param dev - The register model.
+ * @param reg - First register address.
+ * @param data - Data buffer.
+ * @param count - Number of registers.
+ * @param read - Read (true) or write (false) access.
+ * @return The address following the last register accessed.
+ */
+static uint8_t sim_adxl372_access(struct sim_adxl372 *dev, uint8_t reg,
+				  uint8_t *data, uint32_t count, bool read)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		if (read)
+			data[i] = sim_adxl372_read(dev, reg);
+		else
+			sim_adxl372_write(dev, reg, data[i]);
+		if (reg != REG_FIFO_DATA)
+			reg++;
+	}
+
+	return reg;
+}
+
+/**
+ * @brief SPI transfer handler.
+ * @param priv - The register model.
+ * @param data - The transfer buffer, overwritten with the read data.
+ * @param bytes_number - Number of bytes in the transfer.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_adxl372_spi_xfer(void *priv, uint8_t *data,
+			     uint16_t bytes_number)
+{
+	struct sim_adxl372 *dev = priv;
+
+	if (bytes_number < 2)
+		return FAILURE;
+
+	sim_adxl372_access(dev, SPI_ADDR(data[0]), &data[1], bytes_number - 1,
+			   data[0] & SPI_READ);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief I2C write handler.
+ *
+ * The first byte sets the register address pointer, the following bytes
+ * are written starting at that address.
+ * @param priv - The register model.
+ * @param data - The transmitted data.
+ * @param bytes_number - Number of bytes.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_adxl372_i2c_write(void *priv, uint8_t *data,
+			      uint8_t bytes_number)
+{
+	struct sim_adxl372 *dev = priv;
+
+	if (!bytes_number)
+		return FAILURE;
+
+	dev->i2c_addr = sim_adxl372_access(dev, data[0], &data[1],
+					   bytes_number - 1, false);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief I2C read handler.
+ * @param priv - The register model.
+ * @param data - The received data.
+ * @param bytes_number - Number of bytes.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_adxl372_i2c_read(void *priv, uint8_t *data,
+			     uint8_t bytes_number)
+{
+	struct sim_adxl372 *dev = priv;
+
+	dev->i2c_addr = sim_adxl372_access(dev, dev->i2c_addr, data,
+					   bytes_number, true);
+
+	return SUCCESS;
+}
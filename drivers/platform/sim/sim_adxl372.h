@@ -0,0 +1,102 @@
+/***************************************************************************//**
+ *   @file   sim_adxl372.h
+ *   @brief  Register model of the ADXL372 accelerometer.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef SIM_ADXL372_H_
+#define SIM_ADXL372_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define SIM_ADXL372_NUM_REGS	0x43
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct sim_adxl372
+ * @brief ADXL372 register model state.
+ *
+ * While in a measurement mode a new sample, taken from the sample member, is
+ * latched at the output data rate set in the TIMING register.
+ */
+struct sim_adxl372 {
+	/** Register file */
+	uint8_t		regs[SIM_ADXL372_NUM_REGS];
+	/** X, Y, Z acceleration (12-bit, two's complement) of the next sample */
+	int16_t		sample[3];
+	/** Simulated time when the next sample is latched */
+	uint64_t	next_sample_ns;
+	/** Register address pointer of the I2C interface */
+	uint8_t		i2c_addr;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Allocate and reset an ADXL372 register model. */
+int32_t sim_adxl372_init(struct sim_adxl372 **dev);
+
+/* Free the register model. */
+int32_t sim_adxl372_remove(struct sim_adxl372 *dev);
+
+/* Put the register model in its power-on state. */
+void sim_adxl372_reset(struct sim_adxl372 *dev);
+
+/* SPI transfer handler (struct sim_spi_init_param xfer). */
+int32_t sim_adxl372_spi_xfer(void *priv, uint8_t *data,
+			     uint16_t bytes_number);
+
+/* I2C write handler (struct sim_i2c_init_param write). */
+int32_t sim_adxl372_i2c_write(void *priv, uint8_t *data,
+			      uint8_t bytes_number);
+
+/* I2C read handler (struct sim_i2c_init_param read). */
+int32_t sim_adxl372_i2c_read(void *priv, uint8_t *data,
+			     uint8_t bytes_number);
+
+#endif // SIM_ADXL372_H_
@@ -0,0 +1,244 @@
+/***************************************************************************//**
+ *   @file   sim_axi_core.c
+ *   @brief  Register models of the AXI ADC, DAC and DMAC cores.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include "error.h"
+#include "sim_axi_core.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* ADC and DAC common registers */
+#define REG_RSTN			0x0040
+#define RSTN_MASK			0x3
+#define REG_CLK_FREQ			0x0054
+#define REG_CLK_RATIO			0x0058
+#define REG_STATUS			0x005C
+#define ADC_REG_CHAN_STATUS(c)		(0x0404 + (c) * 0x40)
+
+/* DMAC registers */
+#define DMAC_REG_IRQ_PENDING		0x084
+#define DMAC_IRQ_SOT			(1 << 0)
+#define DMAC_IRQ_EOT			(1 << 1)
+#define DMAC_REG_TRANSFER_ID		0x404
+#define DMAC_REG_START_TRANSFER		0x408
+#define DMAC_REG_X_LENGTH		0x418
+#define DMAC_REG_Y_LENGTH		0x41C
+#define DMAC_REG_TRANSFER_DONE		0x428
+#define DMAC_MAX_TRANSFERS		4
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Complete the queued DMAC transfer if it is due.
+ * @param core - The core model.
+ */
+static void sim_axi_dmac_update(struct sim_axi_core *core)
+{
+	if (!core->dma_busy || sim_time_ns() < core->dma_done_ns)
+		return;
+
+	core->dma_busy = false;
+	core->regs[DMAC_REG_IRQ_PENDING / 4] |= DMAC_IRQ_SOT | DMAC_IRQ_EOT;
+	core->regs[DMAC_REG_TRANSFER_DONE / 4] |= 1u << core->dma_id;
+	core->regs[DMAC_REG_TRANSFER_ID / 4] =
+		(core->dma_id + 1) % DMAC_MAX_TRANSFERS;
+}
+
+/**
+ * @brief Queue a DMAC transfer with the programmed length.
+ * @param core - The core model.
+ */
+static void sim_axi_dmac_start(struct sim_axi_core *core)
+{
+	uint64_t bytes;
+
+	bytes = ((uint64_t)core->regs[DMAC_REG_X_LENGTH / 4] + 1) *
+		((uint64_t)core->regs[DMAC_REG_Y_LENGTH / 4] + 1);
+
+	core->dma_id = core->regs[DMAC_REG_TRANSFER_ID / 4];
+	core->regs[DMAC_REG_TRANSFER_DONE / 4] &= ~(1u << core->dma_id);
+	core->dma_done_ns = sim_time_ns() +
+			    bytes * 1000000000ull / core->dma_bytes_per_s;
+	core->dma_busy = true;
+}
+
+/**
+ * @brief Register read handler.
+ * @param priv - The core model.
+ * @param offset - Register offset.
+ * @param data - Register value.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t sim_axi_core_read(void *priv, uint32_t offset, uint32_t *data)
+{
+	struct sim_axi_core *core = priv;
+
+	if (core->type == SIM_AXI_DMAC)
+		sim_axi_dmac_update(core);
+
+	*data = core->regs[offset / 4];
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Register write handler.
+ * @param priv - The core model.
+ * @param offset - Register offset.
+ * @param data - Register value.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t sim_axi_core_write(void *priv, uint32_t offset, uint32_t data)
+{
+	struct sim_axi_core *core = priv;
+	uint32_t *reg = &core->regs[offset / 4];
+
+	if (core->type == SIM_AXI_DMAC) {
+		sim_axi_dmac_update(core);
+		switch (offset) {
+		case DMAC_REG_IRQ_PENDING:
+			*reg &= ~data;
+			return SUCCESS;
+		case DMAC_REG_TRANSFER_ID:
+		case DMAC_REG_TRANSFER_DONE:
+			return SUCCESS;
+		case DMAC_REG_START_TRANSFER:
+			/* The transfer is queued at once, the bit reads 0 */
+			if (data & 1)
+				sim_axi_dmac_start(core);
+			return SUCCESS;
+		default:
+			*reg = data;
+			return SUCCESS;
+		}
+	}
+
+	switch (offset) {
+	case REG_CLK_FREQ:
+	case REG_CLK_RATIO:
+		return SUCCESS;
+	case REG_STATUS:
+		return SUCCESS;
+	case REG_RSTN:
+		*reg = data;
+		core->regs[REG_STATUS / 4] = ((data & RSTN_MASK) == RSTN_MASK);
+		return SUCCESS;
+	default:
+		break;
+	}
+
+	/* Channel status bits are write-one-to-clear on the ADC core */
+	if (core->type == SIM_AXI_ADC && offset >= ADC_REG_CHAN_STATUS(0) &&
+	    (offset - ADC_REG_CHAN_STATUS(0)) % 0x40 == 0)
+		*reg &= ~data;
+	else
+		*reg = data;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Allocate an AXI core model and map it in the AXI address space.
+ * @param core - The core model.
+ * @param type - Modeled core.
+ * @param base - Base address of the core.
+ * @param clock_hz - Interface clock reported by ADC and DAC cores.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_axi_core_init(struct sim_axi_core **core,
+			  enum sim_axi_core_type type, uint32_t base,
+			  uint64_t clock_hz)
+{
+	struct sim_axi_core *c;
+
+	c = (struct sim_axi_core *)calloc(1, sizeof(*c));
+	if (!c)
+		return FAILURE;
+
+	c->type = type;
+	c->clock_hz = clock_hz;
+	c->dma_bytes_per_s = SIM_AXI_DMAC_BYTES_PER_S;
+	/* Clock frequency is reported in 16.16 format relative to 100 MHz */
+	c->regs[REG_CLK_FREQ / 4] = (clock_hz << 16) / 100000000;
+	c->regs[REG_CLK_RATIO / 4] = 1;
+
+	c->model.base = base;
+	c->model.size = SIM_AXI_CORE_SIZE;
+	c->model.read = sim_axi_core_read;
+	c->model.write = sim_axi_core_write;
+	c->model.priv = c;
+
+	if (type == SIM_AXI_DMAC) {
+		c->regs[REG_CLK_FREQ / 4] = 0;
+		c->regs[REG_CLK_RATIO / 4] = 0;
+	}
+
+	if (sim_axi_register(&c->model) != SUCCESS) {
+		free(c);
+		return FAILURE;
+	}
+
+	*core = c;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Unmap and free the AXI core model.
+ * @param core - The core model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_axi_core_remove(struct sim_axi_core *core)
+{
+	if (!core)
+		return FAILURE;
+
+	sim_axi_unregister(&core->model);
+	free(core);
+
+	return SUCCESS;
+}
@@ -0,0 +1,114 @@
+/***************************************************************************//**
+ *   @file   sim_axi_core.h
+ *   @brief  Register models of the AXI ADC, DAC and DMAC cores.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef SIM_AXI_CORE_H_
+#define SIM_AXI_CORE_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sim.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define SIM_AXI_CORE_SIZE		0x1000
+#define SIM_AXI_DMAC_BYTES_PER_S	400000000ull
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @enum sim_axi_core_type
+ * @brief Modeled AXI cores
+ */
+enum sim_axi_core_type {
+	/** AXI ADC core (axi_adc_core) */
+	SIM_AXI_ADC,
+	/** AXI DAC core (axi_dac_core) */
+	SIM_AXI_DAC,
+	/** AXI DMA controller (axi_dmac) */
+	SIM_AXI_DMAC
+};
+
+/**
+ * @struct sim_axi_core
+ * @brief AXI core register model state.
+ *
+ * ADC and DAC cores report a locked interface once out of reset. DMAC
+ * transfers complete after the time needed to move the programmed length at
+ * dma_bytes_per_s; no data is moved.
+ */
+struct sim_axi_core {
+	/** Address space mapping */
+	struct sim_axi_model	model;
+	/** Modeled core */
+	enum sim_axi_core_type	type;
+	/** Register file */
+	uint32_t		regs[SIM_AXI_CORE_SIZE / 4];
+	/** Interface clock reported by the ADC and DAC cores (Hz) */
+	uint64_t		clock_hz;
+	/** DMAC transfer bandwidth */
+	uint64_t		dma_bytes_per_s;
+	/** Simulated time when the queued DMAC transfer completes */
+	uint64_t		dma_done_ns;
+	/** Identifier of the queued DMAC transfer */
+	uint32_t		dma_id;
+	/** A DMAC transfer is in progress */
+	bool			dma_busy;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Allocate an AXI core model and map it in the AXI address space. */
+int32_t sim_axi_core_init(struct sim_axi_core **core,
+			  enum sim_axi_core_type type, uint32_t base,
+			  uint64_t clock_hz);
+
+/* Unmap and free the AXI core model. */
+int32_t sim_axi_core_remove(struct sim_axi_core *core);
+
+#endif // SIM_AXI_CORE_H_
@@ -0,0 +1,147 @@
+/***************************************************************************//**
+ *   @file   spi.c
+ *   @brief  Implementation of simulated SPI driver.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#define BUS_TRACE_IMPL
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include "error.h"
+#include "spi.h"
+#include "spi_extra.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Clock used when the descriptor does not request a speed. */
+#define SIM_SPI_DEFAULT_HZ	1000000
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize the SPI communication peripheral.
+ * @param desc - The SPI descriptor.
+ * @param param - The structure that contains the SPI parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t spi_init(struct spi_desc **desc,
+		 const struct spi_init_param *param)
+{
+	struct spi_desc		*sdesc;
+	struct sim_spi_desc	*sim_desc;
+	struct sim_spi_init_param *sim_init;
+
+	if (!desc || !param || !param->extra)
+		return FAILURE;
+
+	sdesc = (struct spi_desc *)calloc(1, sizeof(*sdesc));
+	sim_desc = (struct sim_spi_desc *)calloc(1, sizeof(*sim_desc));
+	if (!sdesc || !sim_desc) {
+		free(sdesc);
+		free(sim_desc);
+		return FAILURE;
+	}
+
+	sim_init = param->extra;
+	sim_desc->xfer = sim_init->xfer;
+	sim_desc->priv = sim_init->priv;
+	sim_desc->overhead_ns = sim_init->overhead_ns;
+
+	sdesc->max_speed_hz = param->max_speed_hz ? param->max_speed_hz :
+			      SIM_SPI_DEFAULT_HZ;
+	sdesc->chip_select = param->chip_select;
+	sdesc->mode = param->mode;
+	sdesc->extra = sim_desc;
+
+	*desc = sdesc;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by spi_init().
+ * @param desc - The SPI descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t spi_remove(struct spi_desc *desc)
+{
+	if (!desc)
+		return FAILURE;
+
+	free(desc->extra);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Write and read data to/from SPI.
+ *
+ * The transfer is forwarded to the register model and accounted with the
+ * time it would take on the wire at the descriptor clock rate.
+ * @param desc - The SPI descriptor.
+ * @param data - The buffer with the transmitted/received data.
+ * @param bytes_number - Number of bytes to write/read.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t spi_write_and_read(struct spi_desc *desc,
+			   uint8_t *data,
+			   uint16_t bytes_number)
+{
+	struct sim_spi_desc *sim_desc = desc->extra;
+	uint64_t time_ns;
+
+	time_ns = ((uint64_t)bytes_number * 8 * 1000000000ull +
+		   desc->max_speed_hz - 1) / desc->max_speed_hz;
+	time_ns += sim_desc->overhead_ns;
+
+	sim_bus_account(&sim_desc->stats, bytes_number, 0);
+	sim_bus_account(&sim_stats_live()->spi, bytes_number, time_ns);
+	sim_desc->stats.time_ns += time_ns;
+
+	if (!sim_desc->xfer)
+		return FAILURE;
+
+	return sim_desc->xfer(sim_desc->priv, data, bytes_number);
+}
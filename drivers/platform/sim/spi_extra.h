@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ *   @file   spi_extra.h
+ *   @brief  Header containing types used in the simulated SPI driver.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef SPI_EXTRA_H_
+#define SPI_EXTRA_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include "sim.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct sim_spi_init_param
+ * @brief Structure holding the register model behind a simulated SPI device.
+ */
+typedef struct sim_spi_init_param {
+	/** Register model transfer handler (full duplex, in place) */
+	int32_t		(*xfer)(void *priv, uint8_t *data,
+				uint16_t bytes_number);
+	/** Register model private data */
+	void		*priv;
+	/** Chip select setup and hold overhead per transfer (ns) */
+	uint32_t	overhead_ns;
+} sim_spi_init_param;
+
+/**
+ * @struct sim_spi_desc
+ * @brief Simulated platform specific SPI descriptor
+ */
+typedef struct sim_spi_desc {
+	/** Register model transfer handler */
+	int32_t			(*xfer)(void *priv, uint8_t *data,
+					uint16_t bytes_number);
+	/** Register model private data */
+	void			*priv;
+	/** Chip select setup and hold overhead per transfer (ns) */
+	uint32_t		overhead_ns;
+	/** Transfers issued on this device */
+	struct sim_bus_stats	stats;
+} sim_spi_desc;
+
+#endif // SPI_EXTRA_H_
@@ -0,0 +1,364 @@
+/***************************************************************************//**
+ *   @file   xilinx/timer.c
+ *   @brief  Implementation of Xilinx timer driver.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <xparameters.h>
+#include <stdlib.h>
+#include "error.h"
+#include "util.h"
+#include "timer.h"
+#include "timer_extra.h"
+#ifdef XPAR_XSCUTIMER_NUM_INSTANCES
+#include <xscutimer.h>
+#endif
+#ifdef XPAR_XTMRCTR_NUM_INSTANCES
+#include <xtmrctr.h>
+#endif
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#ifdef XSCUTIMER_H
+/* The private timers are clocked at half the CPU clock. */
+#define XIL_TIMER_PS_CLK_HZ	(XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+#define XIL_TIMER_PS_PRESCALER_MAX	255
+#endif
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+#ifdef XSCUTIMER_H
+/**
+ * @brief Program the private timer prescaler closest to a counting frequency.
+ * @param desc - The timer descriptor.
+ * @param freq_hz - Requested counting frequency.
+ */
+static void xil_timer_ps_freq_set(struct timer_desc *desc, uint32_t freq_hz)
+{
+	struct xil_timer_desc *xdesc = desc->extra;
+	uint32_t prescaler;
+
+	prescaler = DIV_ROUND_CLOSEST(XIL_TIMER_PS_CLK_HZ, freq_hz);
+	prescaler = clamp_t(uint32_t, prescaler, 1,
+			    XIL_TIMER_PS_PRESCALER_MAX + 1) - 1;
+
+	XScuTimer_SetPrescaler(xdesc->instance, prescaler);
+	desc->freq_hz = XIL_TIMER_PS_CLK_HZ / (prescaler + 1);
+}
+#endif
+
+/**
+ * @brief Read the hardware counter, converted to counting up.
+ * @param xdesc - The Xilinx timer descriptor.
+ * @return The counter value, without the offset set by timer_counter_set().
+ */
+static uint32_t xil_timer_raw_get(struct xil_timer_desc *xdesc)
+{
+	switch (xdesc->type) {
+	case TIMER_PS:
+#ifdef XSCUTIMER_H
+		/* Counts down from 0xFFFFFFFF and reloads */
+		return ~XScuTimer_GetCounterValue((XScuTimer *)xdesc->instance);
+#endif
+		break;
+	case TIMER_PL:
+#ifdef XTMRCTR_H
+		return XTmrCtr_GetValue(xdesc->instance, 0);
+#endif
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Initialize hardware timer and the handler structure associated with
+ *        it.
+ *
+ * The counter always counts up and wraps at 32 bits. For TIMER_PS the
+ * closest prescaler is selected and desc->freq_hz holds the frequency
+ * actually used. For TIMER_PL, freq_hz must be the clock of the AXI Timer.
+ * @param [out] desc - Pointer to the reference of the device handler.
+ * @param [in] param - Initialization structure.
+ * @return 0 in case of success, negative error code otherwise
+ */
+int32_t timer_init(struct timer_desc **desc,
+		   struct timer_init_param *param)
+{
+	struct timer_desc *dev;
+	struct xil_timer_desc *xdesc;
+	struct xil_timer_init_param *xinit;
+#ifdef XSCUTIMER_H
+	XScuTimer_Config *config;
+#endif
+	int32_t status;
+
+	if (!desc || !param || !param->extra || !param->freq_hz)
+		return FAILURE;
+
+	dev = (struct timer_desc *)calloc(1, sizeof(*dev));
+	if (!dev)
+		return FAILURE;
+	xdesc = (struct xil_timer_desc *)calloc(1, sizeof(*xdesc));
+	if (!xdesc) {
+		free(dev);
+		return FAILURE;
+	}
+
+	xinit = param->extra;
+	xdesc->type = xinit->type;
+	dev->freq_hz = param->freq_hz;
+	dev->load_value = param->load_value;
+	dev->extra = xdesc;
+
+	switch (xdesc->type) {
+	case TIMER_PS:
+#ifdef XSCUTIMER_H
+		xdesc->instance = calloc(1, sizeof(XScuTimer));
+		if (!xdesc->instance)
+			goto error;
+
+		config = XScuTimer_LookupConfig(xinit->device_id);
+		if (!config)
+			goto ps_error;
+
+		status = XScuTimer_CfgInitialize(xdesc->instance, config,
+						 config->BaseAddr);
+		if (status != SUCCESS)
+			goto ps_error;
+
+		XScuTimer_Stop(xdesc->instance);
+		xil_timer_ps_freq_set(dev, param->freq_hz);
+		XScuTimer_EnableAutoReload((XScuTimer *)xdesc->instance);
+		XScuTimer_LoadTimer((XScuTimer *)xdesc->instance, 0xFFFFFFFF);
+
+		break;
+ps_error:
+		free(xdesc->instance);
+#endif
+		goto error;
+	case TIMER_PL:
+#ifdef XTMRCTR_H
+		xdesc->instance = calloc(1, sizeof(XTmrCtr));
+		if (!xdesc->instance)
+			goto error;
+
+		status = XTmrCtr_Initialize(xdesc->instance, xinit->device_id);
+		if (status != SUCCESS && status != XST_DEVICE_IS_STARTED)
+			goto pl_error;
+
+		XTmrCtr_Stop(xdesc->instance, 0);
+		XTmrCtr_SetOptions(xdesc->instance, 0, XTC_AUTO_RELOAD_OPTION);
+		XTmrCtr_SetResetValue(xdesc->instance, 0, 0);
+		XTmrCtr_Reset(xdesc->instance, 0);
+
+		break;
+pl_error:
+		free(xdesc->instance);
+#endif
+		goto error;
+	default:
+		goto error;
+	}
+
+	xdesc->offset = param->load_value - xil_timer_raw_get(xdesc);
+
+	*desc = dev;
+
+	return SUCCESS;
+
+error:
+	free(xdesc);
+	free(dev);
+
+	return FAILURE;
+}
+
+/**
+ * @brief Free the memory allocated by timer_setup().
+ * @param [in] desc - Pointer to the device handler.
+ * @return 0 in case of success, negative error code otherwise
+ */
+int32_t timer_remove(struct timer_desc *desc)
+{
+	struct xil_timer_desc *xdesc;
+
+	if (!desc)
+		return FAILURE;
+
+	timer_stop(desc);
+
+	xdesc = desc->extra;
+	free(xdesc->instance);
+	free(xdesc);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Start a timer.
+ * @param [in] desc - Pointer to the device handler.
+ * @return 0 in case of success, negative error code otherwise
+ */
+int32_t timer_start(struct timer_desc *desc)
+{
+	struct xil_timer_desc *xdesc = desc->extra;
+
+	switch (xdesc->type) {
+	case TIMER_PS:
+#ifdef XSCUTIMER_H
+		XScuTimer_Start(xdesc->instance);
+#endif
+		break;
+	case TIMER_PL:
+#ifdef XTMRCTR_H
+		XTmrCtr_Start(xdesc->instance, 0);
+#endif
+		break;
+	default:
+
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Stop a timer from counting.
+ * @param [in] desc - Pointer to the device handler.
+ * @return 0 in case of success, negative error code otherwise
+ */
+int32_t timer_stop(struct timer_desc *desc)
+{
+	struct xil_timer_desc *xdesc = desc->extra;
+
+	switch (xdesc->type) {
+	case TIMER_PS:
+#ifdef XSCUTIMER_H
+		XScuTimer_Stop(xdesc->instance);
+#endif
+		break;
+	case TIMER_PL:
+#ifdef XTMRCTR_H
+		XTmrCtr_Stop(xdesc->instance, 0);
+#endif
+		break;
+	default:
+
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the value of the counter register for the timer.
+ * @param [in]  desc    - Pointer to the device handler.
+ * @param [out] counter - Pointer to the counter value.
+ * @return 0 in case of success, error code otherwise.
+ */
+int32_t timer_counter_get(struct timer_desc *desc, uint32_t *counter)
+{
+	struct xil_timer_desc *xdesc = desc->extra;
+
+	*counter = xil_timer_raw_get(xdesc) + xdesc->offset;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Set the timer counter register value.
+ * @param [in] desc    - Pointer to the device handler.
+ * @param [in] new_val - The new value of the counter register.
+ * @return 0 in case of success, error code otherwise.
+ */
+int32_t timer_counter_set(struct timer_desc *desc, uint32_t new_val)
+{
+	struct xil_timer_desc *xdesc = desc->extra;
+
+	xdesc->offset = new_val - xil_timer_raw_get(xdesc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the timer clock frequency.
+ * @param [in]  desc    - Pointer to the device handler.
+ * @param [out] freq_hz - The value in Hz of the timer clock.
+ * @return 0 in case of success, error code otherwise.
+ */
+int32_t timer_count_clk_get(struct timer_desc *desc, uint32_t *freq_hz)
+{
+	*freq_hz = desc->freq_hz;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Set the timer clock frequency.
+ *
+ * Only TIMER_PS can change its counting frequency; the closest prescaler is
+ * selected. The counter value is kept.
+ * @param [in] desc    - Pointer to the device handler.
+ * @param [in] freq_hz - The value in Hz of the new timer clock.
+ * @return 0 in case of success, error code otherwise.
+ */
+int32_t timer_count_clk_set(struct timer_desc *desc, uint32_t freq_hz)
+{
+	struct xil_timer_desc *xdesc = desc->extra;
+
+	if (!freq_hz || xdesc->type != TIMER_PS)
+		return FAILURE;
+
+#ifdef XSCUTIMER_H
+	xil_timer_ps_freq_set(desc, freq_hz);
+
+	return SUCCESS;
+#else
+	return FAILURE;
+#endif
+}
@@ -36,7 +36,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "error.h"
-#include "fifo.h"
+#include "delay.h"
 #include "irq.h"
 #include "uart.h"
 #include "uart_extra.h"
@@ -50,128 +50,210 @@
 /******************************************************************************/
 
 /**
- * @brief Save received data into fifo.
- * @param desc - Instance descriptor containing a fifo element.
- * @return SUCCESS in case of success, FAILURE otherwise.
+ * @brief Read data from UART device.
+ *
+ * Waits until bytes_number bytes were received, taking them from the receive
+ * ring as they become available.
+ * @param desc - Instance of UART.
+ * @param data - Pointer to buffer containing data.
+ * @param bytes_number - Number of bytes to read.
+ * @return Number of bytes read.
  */
-static int32_t uart_fifo_insert(struct uart_desc *desc)
+int32_t uart_read(struct uart_desc *desc, uint8_t *data, uint32_t bytes_number)
+{
+	uint32_t received = 0;
+
+	while (received < bytes_number)
+		received += uart_read_nonblocking(desc, data + received,
+						  bytes_number - received);
+
+	return bytes_number;
+}
+
+/**
+ * @brief Read the data already received, without waiting.
+ * @param desc - Instance of UART.
+ * @param data - Pointer to buffer containing data.
+ * @param bytes_number - Maximum number of bytes to read.
+ * @return Number of bytes read, 0 if nothing was received.
+ */
+int32_t uart_read_nonblocking(struct uart_desc *desc, uint8_t *data,
+			      uint32_t bytes_number)
 {
-	int32_t ret;
 	struct xil_uart_desc *xil_uart_desc = desc->extra;
-	struct irq_desc	*irq_desc = xil_uart_desc->irq_desc;
 
-	if (xil_uart_desc->bytes_received > 0) {
-		ret = irq_source_disable(irq_desc, xil_uart_desc->irq_id);
-		if (ret < 0)
-			return ret;
-		ret = fifo_insert(&xil_uart_desc->fifo, xil_uart_desc->buff,
-				  xil_uart_desc->bytes_received);
-		if (ret < 0)
-			return ret;
-		xil_uart_desc->bytes_received = 0;
-		switch(xil_uart_desc->type) {
-		case UART_PS:
+	return ring_buf_read(&xil_uart_desc->rx_ring, data, bytes_number);
+}
+
+/**
+ * @brief Send the next chunk of queued data.
+ *
+ * Called from the interrupt handler once a chunk was sent, or with the UART
+ * interrupt disabled to start transmitting.
+ * @param xil_uart_desc - Xilinx UART descriptor.
+ */
+static void uart_tx_next(struct xil_uart_desc *xil_uart_desc)
+{
+	uint32_t len;
+
+	len = ring_buf_read(&xil_uart_desc->tx_ring, xil_uart_desc->tx_buff,
+			    UART_BUFF_LENGTH);
+	if (!len) {
+		xil_uart_desc->tx_busy = false;
+		if (xil_uart_desc->tx_done)
+			xil_uart_desc->tx_done(xil_uart_desc->tx_done_ctx);
+		return;
+	}
+
+	xil_uart_desc->tx_busy = true;
+	switch(xil_uart_desc->type) {
+	case UART_PS:
 #ifdef XUARTPS_H
-			XUartPs_Recv(xil_uart_desc->instance, (u8*)(xil_uart_desc->buff),
-				     UART_BUFF_LENGTH);
-			break;
+		XUartPs_Send(xil_uart_desc->instance, xil_uart_desc->tx_buff,
+			     len);
+		break;
 #endif // XUARTPS_H
-		case UART_PL:
+	case UART_PL:
 
-			break;
-		default:
-			return FAILURE;
-			break;
-		}
-		ret = irq_source_enable(irq_desc, xil_uart_desc->irq_id);
-		if (ret < 0)
-			return ret;
+		break;
+	default:
+		break;
 	}
-
-	return SUCCESS;
 }
 
 /**
- * @brief Read byte from fifo.
- * @param desc - Instance descriptor containing a fifo element
- * @param data - read value.
- * @return SUCCESS in case of success, FAILURE otherwise.
+ * @brief Queue data for transmission without waiting.
+ *
+ * Data is sent in the background, from the transmit interrupt. Only the
+ * bytes that fit in the transmit ring are queued.
+ * @param desc - Instance of UART.
+ * @param data - Pointer to buffer containing data.
+ * @param bytes_number - Number of bytes to write.
+ * @return Number of bytes queued, negative error code otherwise.
  */
-static int32_t uart_read_byte(struct uart_desc *desc, uint8_t *data)
+int32_t uart_write_nonblocking(struct uart_desc *desc, const uint8_t *data,
+			       uint32_t bytes_number)
 {
 	struct xil_uart_desc *xil_uart_desc = desc->extra;
+	uint32_t len;
 	int32_t ret;
 
-	while (xil_uart_desc->fifo == NULL) {
-		/* nothing in fifo, wait until something is received */
-		ret = uart_fifo_insert(desc);
-		if (ret < 0)
-			return ret;
-	}
+	if (xil_uart_desc->type != UART_PS)
+		return FAILURE;
 
-	*data = xil_uart_desc->fifo->data[xil_uart_desc->fifo_read_offset];
-	xil_uart_desc->fifo_read_offset++;
+	len = ring_buf_space(&xil_uart_desc->tx_ring);
+	if (len > bytes_number)
+		len = bytes_number;
+	ring_buf_write(&xil_uart_desc->tx_ring, data, len);
 
-	if (xil_uart_desc->fifo->len - xil_uart_desc->fifo_read_offset <= 0) {
-		xil_uart_desc->fifo_read_offset = 0;
-		xil_uart_desc->fifo = fifo_remove(xil_uart_desc->fifo);
+	if (!xil_uart_desc->tx_busy && len) {
+		ret = irq_source_disable(xil_uart_desc->irq_desc,
+					 xil_uart_desc->irq_id);
+		if (ret < 0)
+			return ret;
+		if (!xil_uart_desc->tx_busy)
+			uart_tx_next(xil_uart_desc);
+		ret = irq_source_enable(xil_uart_desc->irq_desc,
+					xil_uart_desc->irq_id);
+		if (ret < 0)
+			return ret;
 	}
 
-	return SUCCESS;
+	return len;
 }
 
 /**
- * @brief Read data from UART device.
+ * @brief Write data to UART device.
+ *
+ * Waits only while the transmit ring is full; the function returns as soon
+ * as all the data is queued. Use uart_flush() to wait for the transmission
+ * to end.
  * @param desc - Instance of UART.
  * @param data - Pointer to buffer containing data.
  * @param bytes_number - Number of bytes to read.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-int32_t uart_read(struct uart_desc *desc, uint8_t *data, uint32_t bytes_number)
+int32_t uart_write(struct uart_desc *desc, const uint8_t *data,
+		   uint32_t bytes_number)
 {
-	ssize_t ret;
-	for (uint32_t i = 0; i < bytes_number; i++) {
-		ret = uart_read_byte(desc, &data[i]);
+	struct xil_uart_desc *xil_uart_desc = desc->extra;
+	uint32_t queued = 0;
+	int32_t ret;
+
+	/* Transmission is not implemented for the PL UART */
+	if (xil_uart_desc->type == UART_PL)
+		return SUCCESS;
+
+	while (queued < bytes_number) {
+		ret = uart_write_nonblocking(desc, data + queued,
+					     bytes_number - queued);
 		if (ret < 0)
 			return ret;
+		queued += ret;
 	}
 
-	return bytes_number;
+	return SUCCESS;
 }
 
 /**
- * @brief Write data to UART device.
+ * @brief Wait until all queued data was transmitted.
+ *
+ * The wait is bounded to twice the time needed to send a full transmit ring
+ * at the configured baud rate, so a stalled transmitter is reported instead
+ * of hanging the caller.
  * @param desc - Instance of UART.
- * @param data - Pointer to buffer containing data.
- * @param bytes_number - Number of bytes to read.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-int32_t uart_write(struct uart_desc *desc, const uint8_t *data,
-		   uint32_t bytes_number)
+int32_t uart_flush(struct uart_desc *desc)
 {
 	struct xil_uart_desc *xil_uart_desc = desc->extra;
-	size_t total_sent;
+	uint64_t timeout_us;
+
+	if (!desc->baud_rate)
+		return FAILURE;
+
+	/* 10 bits per character: start, 8 data bits and stop */
+	timeout_us = 2ULL * 10 * (UART_TX_RING_SIZE + UART_BUFF_LENGTH) *
+		     1000000 / desc->baud_rate;
+
+	while (xil_uart_desc->tx_busy ||
+	       ring_buf_level(&xil_uart_desc->tx_ring)) {
+		if (timeout_us < UART_FLUSH_POLL_US)
+			return FAILURE;
+		udelay(UART_FLUSH_POLL_US);
+		timeout_us -= UART_FLUSH_POLL_US;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Move received data to the receive ring and restart reception.
+ * @param xil_uart_desc - Xilinx UART descriptor.
+ * @param data_len - Number of bytes received in buff.
+ */
+static void uart_rx_push(struct xil_uart_desc *xil_uart_desc, uint32_t data_len)
+{
+	uint32_t written;
+
+	written = ring_buf_write(&xil_uart_desc->rx_ring,
+				 (uint8_t *)xil_uart_desc->buff, data_len);
+	if (written < data_len)
+		xil_uart_desc->total_error_count++;
 
 	switch(xil_uart_desc->type) {
 	case UART_PS:
 #ifdef XUARTPS_H
-		total_sent = XUartPs_Send(xil_uart_desc->instance, (u8*)data,
-					  bytes_number);
-		while (XUartPs_IsSending(xil_uart_desc->instance));
-		if (total_sent < bytes_number)
-			return FAILURE;
-
+		XUartPs_Recv(xil_uart_desc->instance, (u8*)(xil_uart_desc->buff),
+			     UART_BUFF_LENGTH);
 		break;
 #endif // XUARTPS_H
 	case UART_PL:
 
 		break;
 	default:
-		return FAILURE;
 		break;
 	}
-
-	return SUCCESS;
 }
 
 /**
@@ -196,7 +278,11 @@ static void uart_irq_handler(void *call_back_ref, uint32_t event,
 		 * timeout just indicates the data stopped for configured character time
 		 */
 		case XUARTPS_EVENT_RECV_TOUT:
-			xil_uart_desc->bytes_received = data_len;
+			uart_rx_push(xil_uart_desc, data_len);
+			break;
+		/* All of the queued chunk has been sent */
+		case XUARTPS_EVENT_SENT_DATA:
+			uart_tx_next(xil_uart_desc);
 			break;
 		/*
 		 * Data was received with an error, keep the data but determine
@@ -307,6 +393,12 @@ int32_t uart_init(struct uart_desc **desc, struct uart_init_param *param)
 	xil_uart_desc->type = xil_uart_init_param->type;
 	if (!(xil_uart_desc->instance))
 		goto error_free_xil_uart_desc;
+	ring_buf_init(&xil_uart_desc->rx_ring, xil_uart_desc->rx_ring_buff,
+		      UART_RX_RING_SIZE);
+	ring_buf_init(&xil_uart_desc->tx_ring, xil_uart_desc->tx_ring_buff,
+		      UART_TX_RING_SIZE);
+	xil_uart_desc->tx_done = xil_uart_init_param->tx_done;
+	xil_uart_desc->tx_done_ctx = xil_uart_init_param->tx_done_ctx;
 
 	switch(xil_uart_desc->type) {
 	case UART_PS:
@@ -380,6 +472,8 @@ error_free_descriptor:
 int32_t uart_remove(struct uart_desc *desc)
 {
 	struct xil_uart_desc *xil_uart_desc = desc->extra;
+
+	uart_flush(desc);
 	free(xil_uart_desc->instance);
 	free(xil_uart_desc);
 	free(desc);
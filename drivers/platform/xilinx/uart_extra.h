@@ -44,11 +44,19 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 
+#include <stdbool.h>
+#include "uart.h"
+#include "ring_buf.h"
+
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
 
 #define UART_BUFF_LENGTH 256
+#define UART_RX_RING_SIZE 4096
+#define UART_TX_RING_SIZE 4096
+/** uart_flush() polling period */
+#define UART_FLUSH_POLL_US 100
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -77,6 +85,10 @@ struct xil_uart_init_param {
 	uint32_t			irq_id;
 	/** Interrupt Request Descriptor */
 	struct irq_desc		*irq_desc;
+	/** Called from interrupt context when all queued data was sent */
+	void				(*tx_done)(void *ctx);
+	/** Argument of tx_done */
+	void				*tx_done_ctx;
 };
 
 /**
@@ -90,18 +102,43 @@ struct xil_uart_desc {
 	uint32_t			irq_id;
 	/** Interrupt Request Descriptor */
 	struct irq_desc		*irq_desc;
-	/** FIFO */
-	struct fifo_element	*fifo;
-	/** FIFO read offset */
-	uint32_t 			fifo_read_offset;
+	/** Received data, filled from the interrupt handler */
+	struct ring_buf		rx_ring;
+	/** Receive ring storage */
+	uint8_t				rx_ring_buff[UART_RX_RING_SIZE];
 	/** UART Buffer */
 	char 				buff[UART_BUFF_LENGTH];
-	/** Number of bytes received */
-	uint32_t 			bytes_received;
+	/** Data waiting to be sent, drained from the interrupt handler */
+	struct ring_buf		tx_ring;
+	/** Transmit ring storage */
+	uint8_t				tx_ring_buff[UART_TX_RING_SIZE];
+	/** Chunk being sent */
+	uint8_t				tx_buff[UART_BUFF_LENGTH];
+	/** A transmission is in progress */
+	volatile bool		tx_busy;
+	/** Called from interrupt context when all queued data was sent */
+	void				(*tx_done)(void *ctx);
+	/** Argument of tx_done */
+	void				*tx_done_ctx;
 	/** Total number of errors */
 	uint32_t 			total_error_count;
 	/** UART Instance */
 	void				*instance;
 };
 
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Read the data already received, without waiting. */
+int32_t uart_read_nonblocking(struct uart_desc *desc, uint8_t *data,
+			      uint32_t bytes_number);
+
+/* Queue data for transmission without waiting. */
+int32_t uart_write_nonblocking(struct uart_desc *desc, const uint8_t *data,
+			       uint32_t bytes_number);
+
+/* Wait until all queued data was transmitted. */
+int32_t uart_flush(struct uart_desc *desc);
+
 #endif
@@ -145,6 +145,8 @@ uint32_t TALISE_resetDevice(taliseDevice_t *device)
 	IF_ERR_RETURN_U32(retVal);
 
 	device->devStateInfo.devState = TAL_STATE_POWERONRESET;
+	/* SPI streaming is disabled by the reset */
+	device->devStateInfo.spiStreaming = 0;
 
 	return (uint32_t)retVal;
 }
@@ -2424,6 +2426,7 @@ uint32_t TALISE_setSpiSettings(taliseDevice_t *device, taliseSpiSettings_t *spi)
 		IF_ERR_RETURN_U32(retVal);
 	}
 
+	device->devStateInfo.spiStreaming = 0;
 	if (spi->enSpiStreaming > 0) {
 		/* Allow SPI streaming mode: SPI message ends when chip select de-asserts */
 		halError = talSpiWriteByte(device->devHalInfo,
@@ -2431,6 +2434,9 @@ uint32_t TALISE_setSpiSettings(taliseDevice_t *device, taliseSpiSettings_t *spi)
 		retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
 					  TALACT_ERR_RESET_SPI);
 		IF_ERR_RETURN_U32(retVal);
+
+		/* Burst reads and writes rely on ascending addresses */
+		device->devStateInfo.spiStreaming = (spi->autoIncAddrUp > 0) ? 1 : 0;
 	} else {
 		/* Force single instruction mode */
 		halError = talSpiWriteByte(device->devHalInfo,
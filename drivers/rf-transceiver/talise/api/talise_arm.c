@@ -698,7 +698,10 @@ uint32_t TALISE_readArmMem(taliseDevice_t *device, uint32_t address,
 	adiHalErr_t halError = ADIHAL_OK;
 	uint8_t dataMem;
 	uint32_t i;
+	uint32_t offset;
+	uint32_t len;
 	uint8_t autoIncBit = 0;
+	uint8_t dmaSetup[3];
 
 	static const uint8_t READ_MEM_BIT = 0x80;
 	static const uint8_t LEGACY_MODE_BIT = 0x20;
@@ -738,28 +741,58 @@ uint32_t TALISE_readArmMem(taliseDevice_t *device, uint32_t address,
 	autoIncBit = (autoIncrement > 0) ? 1: 0;
 
 	/* setting up ARM read for legacy mode with autoincrement bit setting */
-	halError = talSpiWriteByte(device->devHalInfo, TALISE_ADDR_ARM_DMA_CTL,
-				   READ_MEM_BIT | (dataMem << 6)  | LEGACY_MODE_BIT | (autoIncBit <<
-						   1)); /* set to read */
-	retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
-				  TALACT_ERR_RESET_SPI);
-	IF_ERR_RETURN_U32(retVal);
+	dmaSetup[0] = READ_MEM_BIT | (dataMem << 6)  | LEGACY_MODE_BIT |
+		      (autoIncBit << 1); /* set to read */
+	dmaSetup[1] = (uint8_t)((address) >> 2); /* write address[9:2] */
+	dmaSetup[2] = (uint8_t)(address >> 10); /* write address[17:10] */
+
+	if (device->devStateInfo.spiStreaming > 0) {
+		/* DMA_CTL, DMA_ADDR0 and DMA_ADDR1 are consecutive registers */
+		halError = talSpiWriteStream(device->devHalInfo, TALISE_ADDR_ARM_DMA_CTL,
+					     dmaSetup, sizeof(dmaSetup));
+		retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
+					  TALACT_ERR_RESET_SPI);
+		IF_ERR_RETURN_U32(retVal);
+	} else {
+		halError = talSpiWriteByte(device->devHalInfo, TALISE_ADDR_ARM_DMA_CTL,
+					   dmaSetup[0]);
+		retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
+					  TALACT_ERR_RESET_SPI);
+		IF_ERR_RETURN_U32(retVal);
 
-	halError = talSpiWriteByte(device->devHalInfo, TALISE_ADDR_ARM_DMA_ADDR0,
-				   (uint8_t)((address) >> 2)); /* write address[9:2] */
-	retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
-				  TALACT_ERR_RESET_SPI);
-	IF_ERR_RETURN_U32(retVal);
+		halError = talSpiWriteByte(device->devHalInfo, TALISE_ADDR_ARM_DMA_ADDR0,
+					   dmaSetup[1]);
+		retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
+					  TALACT_ERR_RESET_SPI);
+		IF_ERR_RETURN_U32(retVal);
 
-	halError = talSpiWriteByte(device->devHalInfo, TALISE_ADDR_ARM_DMA_ADDR1,
-				   (uint8_t)(address >> 10)); /* write address[17:10] */
-	retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
-				  TALACT_ERR_RESET_SPI);
-	IF_ERR_RETURN_U32(retVal);
+		halError = talSpiWriteByte(device->devHalInfo, TALISE_ADDR_ARM_DMA_ADDR1,
+					   dmaSetup[2]);
+		retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
+					  TALACT_ERR_RESET_SPI);
+		IF_ERR_RETURN_U32(retVal);
+	}
 
 	/* start read-back at correct byte offset */
 	/* without address auto increment set, 0x4 must be added to the address for correct indexing */
-	if (autoIncrement > 0) {
+	if ((autoIncrement > 0) && (device->devStateInfo.spiStreaming > 0)) {
+		/* burst read up to the end of each 32-bit word, the ARM address
+		 * increments once DMA_DATA3 has been read */
+		for (i = 0; i < bytesToRead; i += len) {
+			offset = (address + i) & 0x3;
+			len = 4 - offset;
+			if (len > bytesToRead - i) {
+				len = bytesToRead - i;
+			}
+
+			halError = talSpiReadStream(device->devHalInfo,
+						    (uint16_t)(TALISE_ADDR_ARM_DMA_DATA0 + offset),
+						    &returnData[i], len);
+			retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
+						  TALACT_ERR_RESET_SPI);
+			IF_ERR_RETURN_U32(retVal);
+		}
+	} else if (autoIncrement > 0) {
 		for (i = 0; i < bytesToRead; i++) {
 			halError = talSpiReadByte(device->devHalInfo,
 						  (uint16_t)(TALISE_ADDR_ARM_DMA_DATA0 + (((address & 0x3) + i) % 4)),
@@ -1025,14 +1058,26 @@ uint32_t TALISE_readArmCmdStatus(taliseDevice_t *device, uint16_t *errorWord,
 	*errorWord = 0;
 	*statusWord = 0;
 
-	/* read in the entire 64-bit status register into a byte array and parse one byte at a time */
-	for (i = 0; i < 8; i++) {
-		halError = talSpiReadByte(device->devHalInfo, TALISE_ADDR_ARM_CMD_STATUS_0 + i,
-					  &bytes[i]);
+	/* read in the entire 64-bit status register into a byte array, in one
+	 * burst when SPI streaming is enabled */
+	if (device->devStateInfo.spiStreaming > 0) {
+		halError = talSpiReadStream(device->devHalInfo, TALISE_ADDR_ARM_CMD_STATUS_0,
+					    bytes, sizeof(bytes));
 		retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
 					  TALACT_ERR_RESET_SPI);
 		IF_ERR_RETURN_U32(retVal);
+	} else {
+		for (i = 0; i < 8; i++) {
+			halError = talSpiReadByte(device->devHalInfo, TALISE_ADDR_ARM_CMD_STATUS_0 + i,
+						  &bytes[i]);
+			retVal = talApiErrHandler(device,TAL_ERRHDL_HAL_SPI, halError, retVal,
+						  TALACT_ERR_RESET_SPI);
+			IF_ERR_RETURN_U32(retVal);
+		}
+	}
 
+	/* parse the status one byte at a time */
+	for (i = 0; i < 8; i++) {
 		/* assigning each pending bit from every opcode to a weighted position in statusWord */
 		*statusWord |= (uint16_t)(((bytes[i] & 0x10) >> 3) | (bytes[i] & 0x01)) <<
 			       (i * 2);
@@ -68,6 +68,36 @@ adiHalErr_t talSpiReadBytes(void *devHalInfo, uint16_t *addr, uint8_t *readdata,
 	return halError;
 }
 
+adiHalErr_t talSpiWriteStream(void *devHalInfo, uint16_t addr, uint8_t *data,
+			      uint32_t count)
+{
+	adiHalErr_t halError = ADIHAL_OK;
+
+	halError = ADIHAL_spiWriteStream(devHalInfo, addr, data, count);
+	if (halError == ADIHAL_WAIT_TIMEOUT) {
+		ADIHAL_setTimeout(devHalInfo, HAL_TIMEOUT_DEFAULT * HAL_TIMEOUT_MULT);
+		halError = ADIHAL_spiWriteStream(devHalInfo, addr, data, count);
+	}
+
+	ADIHAL_setTimeout(devHalInfo, HAL_TIMEOUT_DEFAULT);
+	return halError;
+}
+
+adiHalErr_t talSpiReadStream(void *devHalInfo, uint16_t addr,
+			     uint8_t *readdata, uint32_t count)
+{
+	adiHalErr_t halError = ADIHAL_OK;
+
+	halError = ADIHAL_spiReadStream(devHalInfo, addr, readdata, count);
+	if (halError == ADIHAL_WAIT_TIMEOUT) {
+		ADIHAL_setTimeout(devHalInfo, HAL_TIMEOUT_DEFAULT * HAL_TIMEOUT_MULT);
+		halError = ADIHAL_spiReadStream(devHalInfo, addr, readdata, count);
+	}
+
+	ADIHAL_setTimeout(devHalInfo, HAL_TIMEOUT_DEFAULT);
+	return halError;
+}
+
 adiHalErr_t talSpiReadField(void *devHalInfo, uint16_t addr, uint8_t *fieldVal,
 			    uint8_t mask, uint8_t startBit)
 {
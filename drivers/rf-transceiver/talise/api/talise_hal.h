@@ -161,6 +161,46 @@ adiHalErr_t talSpiWriteBytes(void *devHalInfo, uint16_t *addr, uint8_t *data,
 adiHalErr_t talSpiReadBytes(void *devHalInfo, uint16_t *addr, uint8_t *readdata,
 			    uint32_t count);
 
+/**
+ * \brief Wrapper function for ADIHAL_spiWriteStream with error handling
+ *
+ * The device must have SPI streaming enabled with ascending addresses, see
+ * device->devStateInfo.spiStreaming
+ *
+ * \dep_begin
+ * \dep{devHalInfo}
+ * \dep_end
+ *
+ * \param devHalInfo Pointer to device HAL information container
+ * \param addr 16-bit SPI address of the first register
+ * \param data Pointer to byte array to be written starting at addr
+ * \param count Number of consecutive registers to be written
+ *
+ * \retval Returns adiHalErr_t enumerated type
+ */
+adiHalErr_t talSpiWriteStream(void *devHalInfo, uint16_t addr, uint8_t *data,
+			      uint32_t count);
+
+/**
+ * \brief Wrapper function for ADIHAL_spiReadStream with error handling
+ *
+ * The device must have SPI streaming enabled with ascending addresses, see
+ * device->devStateInfo.spiStreaming
+ *
+ * \dep_begin
+ * \dep{devHalInfo}
+ * \dep_end
+ *
+ * \param devHalInfo Pointer to device HAL information container
+ * \param addr 16-bit SPI address of the first register
+ * \param readdata Pointer to byte array for storing read data starting at addr
+ * \param count Number of consecutive registers to be read
+ *
+ * \retval Returns adiHalErr_t enumerated type
+ */
+adiHalErr_t talSpiReadStream(void *devHalInfo, uint16_t addr,
+			     uint8_t *readdata, uint32_t count);
+
 #ifdef __cplusplus
 }
 #endif
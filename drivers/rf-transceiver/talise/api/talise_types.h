@@ -326,7 +326,7 @@ typedef struct {
  */
 typedef struct {
 	uint8_t MSBFirst;                           /*!< 1 = MSBFirst, 0 = LSBFirst */
-	uint8_t enSpiStreaming;                     /*!< Not Recommended - most registers in Talise API are not consecutive */
+	uint8_t enSpiStreaming;                     /*!< Used with autoIncAddrUp for burst ARM memory and mailbox reads, most other registers in Talise API are not consecutive */
 	uint8_t autoIncAddrUp;                      /*!< For SPI Streaming, set address increment direction. 1= next addr = addr+1, 0:addr = addr-1 */
 	uint8_t fourWireMode;                       /*!< 1: Use 4-wire SPI, 0: 3-wire SPI (SDIO pin is bidirectional). NOTE: ADI's FPGA platform always uses 4-wire mode */
 	taliseCmosPadDrvStr_t
@@ -419,6 +419,7 @@ typedef struct {
 	uint32_t orxBandwidth_Hz;                   /*!< ORx Bandwidth from the current profile */
 	uint32_t swTest;                            /*!< Software testmode signal */
 	uint8_t deviceSiRev;                        /*!< Talise silicon rev read during TALISE_initialize */
+	uint8_t spiStreaming;                       /*!< 1 if SPI streaming with ascending addresses is enabled, set by TALISE_setSpiSettings */
 	talErrFunctionTable_t
 	talErrFunctionTable;  /*!< Talise  callback function table */
 	talFrequencyHoppingRange_t talFhmFreqRange; /*!< Talise FHM frequency range */
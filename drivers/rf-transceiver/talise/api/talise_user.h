@@ -28,7 +28,7 @@ extern "C" {
 #define SETARMGPIO_TIMEOUT_US        1000000
 #define SETARMGPIO_INTERVAL_US        100000
 #define SETRFPLL_TIMEOUT_US          1000000
-#define SETRFPLL_INTERVAL_US          100000
+#define SETRFPLL_INTERVAL_US            1000
 #define GETRFPLL_TIMEOUT_US          1000000
 #define GETRFPLL_INTERVAL_US          100000
 #define SETFREQHOP_MODE_TIMEOUT_US   1000000
@@ -44,7 +44,7 @@ extern "C" {
 #define GETINITCALSTATUS_TIMEOUT_US  1000000
 #define GETINITCALSTATUS_INTERVAL_US  100000
 #define RADIOON_TIMEOUT_US           1000000
-#define RADIOON_INTERVAL_US           100000
+#define RADIOON_INTERVAL_US             1000
 #define READARMCFG_TIMEOUT_US        1000000
 #define READARMCFG_INTERVAL_US        100000
 #define WRITEARMCFG_TIMEOUT_US       1000000
@@ -52,7 +52,7 @@ extern "C" {
 #define RADIOOFF_TIMEOUT_US          1000000
 #define RADIOOFF_INTERVAL_US          100000
 #define ENTRACKINGCALS_TIMEOUT_US    1000000
-#define ENTRACKINGCALS_INTERVAL_US    100000
+#define ENTRACKINGCALS_INTERVAL_US      1000
 #define RESCHEDULETRACKINGCALS_TIMEOUT_US 1000000
 #define RESCHEDULETRACKINGCALS_INTERVAL_US 100000
 #define PAUSERESUMETRACKINGCALS_TIMEOUT_US 1000000
@@ -405,6 +405,7 @@ static const char * const  ad9361_phy_xml =
 	"<debug-attribute name=\"adi,frequency-division-duplex-independent-mode-enable\" />"
 	"<debug-attribute name=\"adi,frequency-division-duplex-mode-enable\" />"
 	"<debug-attribute name=\"direct_reg_access\" />"
+	"<debug-attribute name=\"rfpll_retune_stats\" />"
 	"</device>";
 
 /******************************************************************************/
@@ -1941,6 +1942,40 @@ static ssize_t get_calib_mode(void *device, char *buf, size_t len,
 	return (ssize_t) snprintf(buf, len, "%s", en_dis ? "auto" : "manual");
 }
 
+/**
+ * get_rfpll_retune_stats().
+ * Needs HAVE_RETUNE_TIMING in the project config.h.
+ * @device:	Physical instance of a iio_axi_adc device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_rfpll_retune_stats(void *device, char *buf, size_t len,
+				      const struct iio_ch_info *channel)
+{
+	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
+	struct ad9361_rfpll_stats stats;
+	uint64_t avg_ns;
+
+#ifndef HAVE_RETUNE_TIMING
+	/* The retune times would read 0 */
+	return -ENODEV;
+#endif
+	ad9361_get_rfpll_stats(ad9361_phy, &stats);
+	avg_ns = stats.retunes ? stats.total_ns / stats.retunes : 0;
+
+	return (ssize_t) snprintf(buf, len,
+				  "retunes %"PRIu32" hits %"PRIu32" misses %"PRIu32
+				  " regs_written %"PRIu32" regs_skipped %"PRIu32
+				  " last_ns %"PRIu64" min_ns %"PRIu64
+				  " max_ns %"PRIu64" avg_ns %"PRIu64"",
+				  stats.retunes, stats.hits, stats.misses,
+				  stats.regs_written, stats.regs_skipped,
+				  stats.last_ns, stats.min_ns, stats.max_ns,
+				  avg_ns);
+}
+
 /**
  * set_trx_rate_governor().
  * @device:	Physical instance of a iio_axi_dac device.
@@ -2157,6 +2192,25 @@ static ssize_t set_filter_fir_config(void *device, char *buf, size_t len,
 	return len;
 }
 
+/**
+ * set_rfpll_retune_stats().
+ * Any written value clears the RF PLL retune statistics.
+ * @device:	Physical instance of a iio_axi_dac device.
+ * @buf:	Value to be written to attribute.
+ * @len:	Length of the data in "buf".
+ * @channel:	Channel properties.
+ * Return: Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_rfpll_retune_stats(void *device, char *buf, size_t len,
+				      const struct iio_ch_info *channel)
+{
+	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
+
+	ad9361_clear_rfpll_stats(ad9361_phy);
+
+	return len;
+}
+
 static struct iio_attribute iio_attr_rf_port_select = {
 	.name = "rf_port_select",
 	.show = get_rf_port_select,
@@ -2470,6 +2524,12 @@ static struct iio_attribute iio_attr_calib_mode = {
 	.store = set_calib_mode,
 };
 
+static struct iio_attribute iio_attr_rfpll_retune_stats = {
+	.name = "rfpll_retune_stats",
+	.show = get_rfpll_retune_stats,
+	.store = set_rfpll_retune_stats,
+};
+
 static struct iio_attribute *global_attributes[] = {
 	&iio_attr_dcxo_tune_coarse,
 	&iio_attr_rx_path_rates,
@@ -2489,6 +2549,7 @@ static struct iio_attribute *global_attributes[] = {
 	&iio_attr_ensm_mode,
 	&iio_attr_filter_fir_config,
 	&iio_attr_calib_mode,
+	&iio_attr_rfpll_retune_stats,
 	NULL,
 };
 
@@ -0,0 +1,476 @@
+/***************************************************************************//**
+ *   @file   iio_ad9361_telem.c
+ *   @brief  Implementation of iio_ad9361_telem
+ *   Buffered IIO device streaming the records of "ad9361_telem".
+ *   @author Cristian Pop (cristian.pop@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include "error.h"
+#include "iio_ad9361_telem.h"
+#include "util.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * struct iio_ad9361_telem_ch - Location of a channel in a telemetry record.
+ * @offset:	Offset of the channel in "struct ad9361_telem_record".
+ * @size:	Channel storage size, in bytes.
+ */
+struct iio_ad9361_telem_ch {
+	uint8_t offset;
+	uint8_t size;
+};
+
+/**
+ * Telemetry channels, in scan index order. Storage sizes decrease with the
+ * index, so packing the enabled channels keeps every one of them naturally
+ * aligned.
+ */
+static const struct iio_ad9361_telem_ch iio_ad9361_telem_scan[] = {
+	{ offsetof(struct ad9361_telem_record, timestamp), 8 },
+	{ offsetof(struct ad9361_telem_record, rssi[0]), 2 },
+	{ offsetof(struct ad9361_telem_record, rssi[1]), 2 },
+	{ offsetof(struct ad9361_telem_record, gain_index[0]), 1 },
+	{ offsetof(struct ad9361_telem_record, gain_index[1]), 1 },
+	{ offsetof(struct ad9361_telem_record, agc_state[0]), 1 },
+	{ offsetof(struct ad9361_telem_record, agc_state[1]), 1 },
+};
+
+static const char * const ad9361_telem_xml =
+	"<device id=\"ad9361-telemetry\" name=\"ad9361-telemetry\" >"
+	"<channel id=\"timestamp\" type=\"input\" >"
+	"<scan-element index=\"0\" format=\"le:S64/64&gt;&gt;0\" />"
+	"</channel>"
+	"<channel id=\"rssi0\" type=\"input\" >"
+	"<scan-element index=\"1\" format=\"le:U9/16&gt;&gt;0\" scale=\"0.250000\" />"
+	"</channel>"
+	"<channel id=\"rssi1\" type=\"input\" >"
+	"<scan-element index=\"2\" format=\"le:U9/16&gt;&gt;0\" scale=\"0.250000\" />"
+	"</channel>"
+	"<channel id=\"gain0\" type=\"input\" >"
+	"<scan-element index=\"3\" format=\"le:U7/8&gt;&gt;0\" />"
+	"</channel>"
+	"<channel id=\"gain1\" type=\"input\" >"
+	"<scan-element index=\"4\" format=\"le:U7/8&gt;&gt;0\" />"
+	"</channel>"
+	"<channel id=\"agc0\" type=\"input\" >"
+	"<scan-element index=\"5\" format=\"le:U3/8&gt;&gt;0\" />"
+	"</channel>"
+	"<channel id=\"agc1\" type=\"input\" >"
+	"<scan-element index=\"6\" format=\"le:U3/8&gt;&gt;0\" />"
+	"</channel>"
+	"<attribute name=\"sampling_frequency\" />"
+	"<debug-attribute name=\"telemetry_stats\" />"
+	"</device>";
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * iio_ad9361_telem_init() - Init and create iio_ad9361_telem.
+ * @iio_telem:	Pointer to iio_ad9361_telem.
+ * @init:	Init parameters.
+ * Return: SUCCESS in case of success or negative value otherwise.
+ */
+ssize_t iio_ad9361_telem_init(struct iio_ad9361_telem **iio_telem,
+			      struct iio_ad9361_telem_init_par *init)
+{
+	struct iio_ad9361_telem *telem;
+
+	if (!init || !init->telem)
+		return FAILURE;
+
+	telem = (struct iio_ad9361_telem *)calloc(1, sizeof(*telem));
+	if (!telem)
+		return FAILURE;
+
+	telem->telem = init->telem;
+
+	*iio_telem = telem;
+
+	return SUCCESS;
+}
+
+/**
+ * iio_ad9361_telem_remove() - Free the resources allocated by
+ * iio_ad9361_telem_init().
+ * @iio_telem:	Pointer to iio_ad9361_telem.
+ * Return: SUCCESS in case of success or negative value otherwise.
+ */
+ssize_t iio_ad9361_telem_remove(struct iio_ad9361_telem *iio_telem)
+{
+	free(iio_telem);
+
+	return SUCCESS;
+}
+
+/**
+ * get_sampling_frequency().
+ * @device:	Physical instance of a iio_ad9361_telem device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_sampling_frequency(void *device, char *buf, size_t len,
+				      const struct iio_ch_info *channel)
+{
+	struct iio_ad9361_telem *iio_telem = (struct iio_ad9361_telem *)device;
+
+	return snprintf(buf, len, "%"PRIu32"",
+			1000000 / iio_telem->telem->period_us);
+}
+
+/**
+ * get_telemetry_stats().
+ * @device:	Physical instance of a iio_ad9361_telem device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_telemetry_stats(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel)
+{
+	struct iio_ad9361_telem *iio_telem = (struct iio_ad9361_telem *)device;
+	struct ad9361_telem_stats stats;
+
+	ad9361_telem_stats_get(iio_telem->telem, &stats);
+
+	return snprintf(buf, len, "samples %"PRIu32" overflows %"PRIu32
+			" missed %"PRIu32" errors %"PRIu32" level %"PRIu32"",
+			stats.samples, stats.overflows, stats.missed,
+			stats.errors, ad9361_telem_level(iio_telem->telem));
+}
+
+/**
+ * set_sampling_frequency().
+ * @device:	Physical instance of a iio_ad9361_telem device.
+ * @buf:	Value to be written to attribute.
+ * @len:	Length of the data in "buf".
+ * @channel:	Channel properties.
+ * Return: Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_sampling_frequency(void *device, char *buf, size_t len,
+				      const struct iio_ch_info *channel)
+{
+	struct iio_ad9361_telem *iio_telem = (struct iio_ad9361_telem *)device;
+	uint32_t freq = srt_to_uint32(buf);
+	ssize_t ret;
+
+	if (!freq || freq > 1000000)
+		return -EINVAL;
+
+	ret = ad9361_telem_set_period(iio_telem->telem, 1000000 / freq);
+	if (ret < 0)
+		return ret;
+
+	return len;
+}
+
+/**
+ * set_telemetry_stats().
+ * Any written value clears the telemetry statistics.
+ * @device:	Physical instance of a iio_ad9361_telem device.
+ * @buf:	Value to be written to attribute.
+ * @len:	Length of the data in "buf".
+ * @channel:	Channel properties.
+ * Return: Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_telemetry_stats(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel)
+{
+	struct iio_ad9361_telem *iio_telem = (struct iio_ad9361_telem *)device;
+
+	ad9361_telem_stats_reset(iio_telem->telem);
+
+	return len;
+}
+
+static struct iio_attribute iio_attr_sampling_frequency = {
+	.name = "sampling_frequency",
+	.show = get_sampling_frequency,
+	.store = set_sampling_frequency,
+};
+
+static struct iio_attribute iio_attr_telemetry_stats = {
+	.name = "telemetry_stats",
+	.show = get_telemetry_stats,
+	.store = set_telemetry_stats,
+};
+
+static struct iio_attribute *iio_ad9361_telem_attributes[] = {
+	&iio_attr_sampling_frequency,
+	&iio_attr_telemetry_stats,
+	NULL,
+};
+
+/**
+ * The channels have no attributes, they are only read through the buffer.
+ */
+static struct iio_attribute *iio_ad9361_telem_ch_attributes[] = {
+	NULL,
+};
+
+static struct iio_channel iio_channel_timestamp = {
+	.name = "timestamp",
+	.attributes = iio_ad9361_telem_ch_attributes,
+	.ch_out = false,
+};
+
+static struct iio_channel iio_channel_rssi0 = {
+	.name = "rssi0",
+	.attributes = iio_ad9361_telem_ch_attributes,
+	.ch_out = false,
+};
+
+static struct iio_channel iio_channel_rssi1 = {
+	.name = "rssi1",
+	.attributes = iio_ad9361_telem_ch_attributes,
+	.ch_out = false,
+};
+
+static struct iio_channel iio_channel_gain0 = {
+	.name = "gain0",
+	.attributes = iio_ad9361_telem_ch_attributes,
+	.ch_out = false,
+};
+
+static struct iio_channel iio_channel_gain1 = {
+	.name = "gain1",
+	.attributes = iio_ad9361_telem_ch_attributes,
+	.ch_out = false,
+};
+
+static struct iio_channel iio_channel_agc0 = {
+	.name = "agc0",
+	.attributes = iio_ad9361_telem_ch_attributes,
+	.ch_out = false,
+};
+
+static struct iio_channel iio_channel_agc1 = {
+	.name = "agc1",
+	.attributes = iio_ad9361_telem_ch_attributes,
+	.ch_out = false,
+};
+
+static struct iio_channel *iio_ad9361_telem_channels[] = {
+	&iio_channel_timestamp,
+	&iio_channel_rssi0,
+	&iio_channel_rssi1,
+	&iio_channel_gain0,
+	&iio_channel_gain1,
+	&iio_channel_agc0,
+	&iio_channel_agc1,
+	NULL,
+};
+
+/**
+ * iio_ad9361_telem_get_xml() - Get xml corresponding to the telemetry device.
+ * @xml:	Xml containing description of a device.
+ * @iio_dev:	Structure describing a device, channels and attributes.
+ * Return: SUCCESS in case of success or negative value otherwise.
+ */
+ssize_t iio_ad9361_telem_get_xml(char **xml, struct iio_device *iio_dev)
+{
+	*xml = calloc(1, strlen(ad9361_telem_xml) + 1);
+	if (!(*xml))
+		return -ENOMEM;
+
+	memcpy(*xml, ad9361_telem_xml, strlen(ad9361_telem_xml));
+
+	return SUCCESS;
+}
+
+/**
+ * iio_ad9361_telem_create_device() - Create structure describing a device,
+ * channels and attributes.
+ * @device:	Device name.
+ * Return: iio_device or NULL, in case of failure.
+ */
+struct iio_device *iio_ad9361_telem_create_device(const char *device_name)
+{
+	struct iio_device *iio_telem_device;
+
+	iio_telem_device = calloc(1, sizeof(struct iio_device));
+	if (!iio_telem_device)
+		return NULL;
+	iio_telem_device->name = device_name;
+	iio_telem_device->num_ch = ARRAY_SIZE(iio_ad9361_telem_scan);
+	iio_telem_device->channels = iio_ad9361_telem_channels;
+	iio_telem_device->attributes = iio_ad9361_telem_attributes;
+
+	return iio_telem_device;
+}
+
+/**
+ * iio_ad9361_telem_pack() - Pack the enabled channels of a record.
+ * The scan is padded to the size of its largest channel, as Linux IIO
+ * buffers are, so consecutive scans stay aligned.
+ * @rec:	Telemetry record, NULL to only compute the scan size.
+ * @ch_mask:	Enabled channels mask.
+ * @scan:	Where the packed channels are stored.
+ * Return: Scan size in bytes.
+ */
+static uint32_t iio_ad9361_telem_pack(const struct ad9361_telem_record *rec,
+				      uint32_t ch_mask, uint8_t *scan)
+{
+	uint32_t i, len = 0, align = 1;
+
+	for (i = 0; i < ARRAY_SIZE(iio_ad9361_telem_scan); i++) {
+		if (!(ch_mask & BIT(i)))
+			continue;
+		if (rec)
+			memcpy(&scan[len],
+			       (const uint8_t *)rec + iio_ad9361_telem_scan[i].offset,
+			       iio_ad9361_telem_scan[i].size);
+		len += iio_ad9361_telem_scan[i].size;
+		if (iio_ad9361_telem_scan[i].size > align)
+			align = iio_ad9361_telem_scan[i].size;
+	}
+
+	while (len % align) {
+		if (rec)
+			scan[len] = 0;
+		len++;
+	}
+
+	return len;
+}
+
+/**
+ * iio_ad9361_telem_transfer_dev_to_mem() - Wait for the telemetry records
+ * of a buffer refill.
+ * Sampling is started on the first refill and keeps running after it. The
+ * sampler is polled until enough records are in its ring, so the records
+ * taken by the application between two refills are streamed first.
+ * @iio_inst:		Physical instance of a iio_ad9361_telem device.
+ * @bytes_count:	Number of bytes to transfer.
+ * @ch_mask:		Opened channels mask.
+ * Return: bytes_count or negative value in case of error.
+ */
+ssize_t iio_ad9361_telem_transfer_dev_to_mem(void *iio_inst,
+		size_t bytes_count, uint32_t ch_mask)
+{
+	struct iio_ad9361_telem *iio_telem;
+	struct ad9361_telem *telem;
+	uint32_t scan_size, nb_records;
+	ssize_t ret;
+
+	if (!iio_inst)
+		return FAILURE;
+
+	iio_telem = (struct iio_ad9361_telem *)iio_inst;
+	telem = iio_telem->telem;
+
+	scan_size = iio_ad9361_telem_pack(NULL, ch_mask, NULL);
+	if (!scan_size)
+		return -EINVAL;
+
+	nb_records = DIV_ROUND_UP(bytes_count, scan_size);
+	if (nb_records > telem->ring.size / sizeof(struct ad9361_telem_record))
+		return -EINVAL;
+
+	if (!telem->enabled)
+		ad9361_telem_enable(telem, true);
+
+	while (ad9361_telem_level(telem) < nb_records) {
+		ret = ad9361_telem_poll(telem);
+		if (ret < 0)
+			return ret;
+	}
+
+	iio_telem->scan_len = 0;
+	iio_telem->scan_pos = 0;
+
+	return bytes_count;
+}
+
+/**
+ * iio_ad9361_telem_read_dev() - Read chunk of telemetry records to pbuf.
+ * Call "iio_ad9361_telem_transfer_dev_to_mem" first.
+ * Records are taken from the ring one at a time, so a scan may be split
+ * between two consecutive calls.
+ * @iio_inst:		Physical instance of a iio_ad9361_telem device.
+ * @pbuf:		Buffer where value is stored.
+ * @offset:		Offset to the remaining data after reading n chunks.
+ * @bytes_count:	Number of bytes to read.
+ * @ch_mask:		Opened channels mask.
+ * Return: Number of bytes read or negative value in case of error.
+ */
+ssize_t iio_ad9361_telem_read_dev(void *iio_inst, char *pbuf, size_t offset,
+				  size_t bytes_count, uint32_t ch_mask)
+{
+	struct iio_ad9361_telem *iio_telem;
+	struct ad9361_telem_record rec;
+	size_t i, n;
+
+	if (!iio_inst)
+		return FAILURE;
+
+	if (!pbuf)
+		return FAILURE;
+
+	iio_telem = (struct iio_ad9361_telem *)iio_inst;
+
+	for (i = 0; i < bytes_count; i += n) {
+		if (iio_telem->scan_pos == iio_telem->scan_len) {
+			if (!ad9361_telem_read(iio_telem->telem, &rec, 1))
+				break;
+			iio_telem->scan_len = iio_ad9361_telem_pack(&rec, ch_mask,
+					      iio_telem->scan);
+			iio_telem->scan_pos = 0;
+		}
+		n = min(bytes_count - i,
+			(size_t)(iio_telem->scan_len - iio_telem->scan_pos));
+		memcpy(&pbuf[i], &iio_telem->scan[iio_telem->scan_pos], n);
+		iio_telem->scan_pos += n;
+	}
+
+	return i;
+}
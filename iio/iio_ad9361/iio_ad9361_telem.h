@@ -0,0 +1,86 @@
+/***************************************************************************//**
+*   @file   iio_ad9361_telem.h
+*   @brief  Header file of iio_ad9361_telem
+*   @author Cristian Pop (cristian.pop@analog.com)
+********************************************************************************
+* Copyright 2020(c) Analog Devices, Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*  - Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*  - Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in
+*    the documentation and/or other materials provided with the
+*    distribution.
+*  - Neither the name of Analog Devices, Inc. nor the names of its
+*    contributors may be used to endorse or promote products derived
+*    from this software without specific prior written permission.
+*  - The use of this software may or may not infringe the patent rights
+*    of one or more patent holders.  This license does not release you
+*    from the requirement that you obtain separate licenses from these
+*    patent holders to use this software.
+*  - Use of the software either in source or binary form, must be run
+*    on or directly connected to an Analog Devices Inc. component.
+*
+* THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+* IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef IIO_AD9361_TELEM_H_
+#define IIO_AD9361_TELEM_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include "iio_types.h"
+#include "ad9361_telem.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct iio_ad9361_telem_init_par {
+	struct ad9361_telem *telem;
+};
+
+struct iio_ad9361_telem {
+	struct ad9361_telem *telem;
+	/* Enabled channels of the record being read */
+	uint8_t scan[sizeof(struct ad9361_telem_record)];
+	uint32_t scan_len;
+	uint32_t scan_pos;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Init iio_ad9361_telem. */
+ssize_t iio_ad9361_telem_init(struct iio_ad9361_telem **iio_telem,
+			      struct iio_ad9361_telem_init_par *init);
+/* Free the resources allocated by iio_ad9361_telem_init(). */
+ssize_t iio_ad9361_telem_remove(struct iio_ad9361_telem *iio_telem);
+/* Create iio_device. */
+struct iio_device *iio_ad9361_telem_create_device(const char *device_name);
+/* Get an xml describing the telemetry device */
+ssize_t iio_ad9361_telem_get_xml(char** xml, struct iio_device *iio_dev);
+/* Wait for the telemetry records of a buffer refill. */
+ssize_t iio_ad9361_telem_transfer_dev_to_mem(void *iio_inst,
+		size_t bytes_count, uint32_t ch_mask);
+/* Read telemetry records to pbuf. It should be called after
+ * "iio_ad9361_telem_transfer_dev_to_mem()" */
+ssize_t iio_ad9361_telem_read_dev(void *iio_inst, char *pbuf, size_t offset,
+				  size_t bytes_count, uint32_t ch_mask);
+
+#endif /* IIO_AD9361_TELEM_H_ */
@@ -0,0 +1,630 @@
+/***************************************************************************//**
+ *   @file   iio_axi_jesd204_rx_monitor.c
+ *   @brief  Implementation of iio_axi_jesd204_rx_monitor
+ *   IIO device exposing the statistics of "jesd204_rx_monitor".
+ *   @author Cristian Pop (cristian.pop@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include "error.h"
+#include "timestamp.h"
+#include "iio_axi_jesd204_rx_monitor.h"
+#include "util.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+static const char * const iio_jesd_link_status_label[] = {
+	"reset",
+	"wait_phy",
+	"cgs",
+	"data",
+};
+
+static const char * const iio_jesd_cgs_state_label[] = {
+	"init",
+	"check",
+	"data",
+	"unknown",
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * iio_axi_jesd204_rx_monitor_init() - Init and create
+ * iio_axi_jesd204_rx_monitor.
+ * Sampling of the link monitor is started.
+ * @iio_monitor:	Pointer to iio_axi_jesd204_rx_monitor.
+ * @init:		Init parameters.
+ * Return: SUCCESS in case of success or negative value otherwise.
+ */
+ssize_t iio_axi_jesd204_rx_monitor_init(struct iio_axi_jesd204_rx_monitor
+					**iio_monitor,
+					struct iio_axi_jesd204_rx_monitor_init_par *init)
+{
+	struct iio_axi_jesd204_rx_monitor *monitor;
+
+	if (!init || !init->monitor)
+		return FAILURE;
+
+	monitor = (struct iio_axi_jesd204_rx_monitor *)calloc(1,
+			sizeof(*monitor));
+	if (!monitor)
+		return FAILURE;
+
+	monitor->monitor = init->monitor;
+	jesd204_rx_monitor_enable(monitor->monitor, true);
+
+	*iio_monitor = monitor;
+
+	return SUCCESS;
+}
+
+/**
+ * iio_axi_jesd204_rx_monitor_remove() - Free the resources allocated by
+ * iio_axi_jesd204_rx_monitor_init().
+ * @iio_monitor:	Pointer to iio_axi_jesd204_rx_monitor.
+ * Return: SUCCESS in case of success or negative value otherwise.
+ */
+ssize_t iio_axi_jesd204_rx_monitor_remove(struct iio_axi_jesd204_rx_monitor
+		*iio_monitor)
+{
+	free(iio_monitor);
+
+	return SUCCESS;
+}
+
+/**
+ * iio_jesd_monitor_get() - Get the link monitor, sampled if a period elapsed.
+ * The monitor is sampled by jesd204_rx_monitor_task(), it is also polled on
+ * each attribute read so a sample that is due is not missed. Without a time
+ * base the reads would set the sampling rate, so the monitor is not sampled
+ * and the totals are reported as they are.
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * Return: The link monitor.
+ */
+static struct jesd204_rx_monitor *iio_jesd_monitor_get(void *device)
+{
+	struct iio_axi_jesd204_rx_monitor *iio_monitor;
+
+	iio_monitor = (struct iio_axi_jesd204_rx_monitor *)device;
+	if (timestamp_available())
+		jesd204_rx_monitor_poll(iio_monitor->monitor);
+
+	return iio_monitor->monitor;
+}
+
+/**
+ * get_link_status().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_link_status(void *device, char *buf, size_t len,
+			       const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_monitor_stats stats;
+
+	jesd204_rx_monitor_stats_get(iio_jesd_monitor_get(device), &stats);
+
+	return snprintf(buf, len, "%s",
+			iio_jesd_link_status_label[stats.link_status & 0x3]);
+}
+
+/**
+ * get_link_down_events().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_link_down_events(void *device, char *buf, size_t len,
+				    const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_monitor_stats stats;
+
+	jesd204_rx_monitor_stats_get(iio_jesd_monitor_get(device), &stats);
+
+	return snprintf(buf, len, "%"PRIu32"", stats.link_down_events);
+}
+
+/**
+ * get_reinit_count().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_reinit_count(void *device, char *buf, size_t len,
+				const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_monitor_stats stats;
+
+	jesd204_rx_monitor_stats_get(iio_jesd_monitor_get(device), &stats);
+
+	return snprintf(buf, len, "%"PRIu32"", stats.reinits);
+}
+
+/**
+ * get_auto_reinit().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_auto_reinit(void *device, char *buf, size_t len,
+			       const struct iio_ch_info *channel)
+{
+	struct iio_axi_jesd204_rx_monitor *iio_monitor;
+
+	iio_monitor = (struct iio_axi_jesd204_rx_monitor *)device;
+
+	return snprintf(buf, len, "%d", iio_monitor->monitor->auto_reinit);
+}
+
+/**
+ * set_auto_reinit().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Value to be written to attribute.
+ * @len:	Length of the data in "buf".
+ * @channel:	Channel properties.
+ * Return: Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_auto_reinit(void *device, char *buf, size_t len,
+			       const struct iio_ch_info *channel)
+{
+	struct iio_axi_jesd204_rx_monitor *iio_monitor;
+
+	iio_monitor = (struct iio_axi_jesd204_rx_monitor *)device;
+	iio_monitor->monitor->auto_reinit = srt_to_uint32(buf) != 0;
+
+	return len;
+}
+
+/**
+ * get_sampling_frequency().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_sampling_frequency(void *device, char *buf, size_t len,
+				      const struct iio_ch_info *channel)
+{
+	struct iio_axi_jesd204_rx_monitor *iio_monitor;
+
+	iio_monitor = (struct iio_axi_jesd204_rx_monitor *)device;
+
+	return snprintf(buf, len, "%"PRIu32"",
+			1000000 / iio_monitor->monitor->period_us);
+}
+
+/**
+ * set_sampling_frequency().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Value to be written to attribute.
+ * @len:	Length of the data in "buf".
+ * @channel:	Channel properties.
+ * Return: Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_sampling_frequency(void *device, char *buf, size_t len,
+				      const struct iio_ch_info *channel)
+{
+	struct iio_axi_jesd204_rx_monitor *iio_monitor;
+	uint32_t freq = srt_to_uint32(buf);
+	ssize_t ret;
+
+	if (!freq || freq > 1000000)
+		return -EINVAL;
+
+	iio_monitor = (struct iio_axi_jesd204_rx_monitor *)device;
+	ret = jesd204_rx_monitor_set_period(iio_monitor->monitor,
+					    1000000 / freq);
+	if (ret < 0)
+		return ret;
+
+	return len;
+}
+
+/**
+ * get_monitor_stats().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_monitor_stats(void *device, char *buf, size_t len,
+				 const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_monitor_stats stats;
+
+	jesd204_rx_monitor_stats_get(iio_jesd_monitor_get(device), &stats);
+
+	return snprintf(buf, len, "samples %"PRIu32" link_down %"PRIu32
+			" lane_desync %"PRIu32" sysref_align %"PRIu32
+			" reinits %"PRIu32" reinit_errors %"PRIu32"",
+			stats.samples, stats.link_down_events,
+			stats.lane_desync_events, stats.sysref_align_errors,
+			stats.reinits, stats.reinit_errors);
+}
+
+/**
+ * set_monitor_stats().
+ * Any written value clears the monitor statistics.
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Value to be written to attribute.
+ * @len:	Length of the data in "buf".
+ * @channel:	Channel properties.
+ * Return: Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_monitor_stats(void *device, char *buf, size_t len,
+				 const struct iio_ch_info *channel)
+{
+	struct iio_axi_jesd204_rx_monitor *iio_monitor;
+
+	iio_monitor = (struct iio_axi_jesd204_rx_monitor *)device;
+	jesd204_rx_monitor_stats_reset(iio_monitor->monitor);
+
+	return len;
+}
+
+/**
+ * get_lane_errors().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_lane_errors(void *device, char *buf, size_t len,
+			       const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_monitor_lane lane;
+	ssize_t ret;
+
+	ret = jesd204_rx_monitor_lane_get(iio_jesd_monitor_get(device),
+					  channel->ch_num, &lane);
+	if (ret < 0)
+		return ret;
+
+	return snprintf(buf, len, "%"PRIu32"", lane.errors);
+}
+
+/**
+ * get_lane_error_rate().
+ * Averaged error rate, in errors per second.
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_lane_error_rate(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_monitor_lane lane;
+	ssize_t ret;
+
+	ret = jesd204_rx_monitor_lane_get(iio_jesd_monitor_get(device),
+					  channel->ch_num, &lane);
+	if (ret < 0)
+		return ret;
+
+	return snprintf(buf, len, "%"PRIu32".%03"PRIu32"",
+			lane.error_rate / 1000, lane.error_rate % 1000);
+}
+
+/**
+ * get_lane_cgs_state().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_lane_cgs_state(void *device, char *buf, size_t len,
+				  const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_monitor_lane lane;
+	ssize_t ret;
+
+	ret = jesd204_rx_monitor_lane_get(iio_jesd_monitor_get(device),
+					  channel->ch_num, &lane);
+	if (ret < 0)
+		return ret;
+
+	return snprintf(buf, len, "%s", iio_jesd_cgs_state_label[lane.status &
+			AXI_JESD204_RX_LANE_STATUS_CGS_MASK]);
+}
+
+/**
+ * get_lane_ilas().
+ * @device:	Physical instance of a iio_axi_jesd204_rx_monitor device.
+ * @buf:	Where value is stored.
+ * @len:	Maximum length of value to be stored in buf.
+ * @channel:	Channel properties.
+ * Return: Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_lane_ilas(void *device, char *buf, size_t len,
+			     const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_monitor_lane lane;
+	ssize_t ret;
+
+	ret = jesd204_rx_monitor_lane_get(iio_jesd_monitor_get(device),
+					  channel->ch_num, &lane);
+	if (ret < 0)
+		return ret;
+
+	return snprintf(buf, len, "%d",
+			!!(lane.status & AXI_JESD204_RX_LANE_STATUS_ILAS));
+}
+
+static struct iio_attribute iio_attr_link_status = {
+	.name = "link_status",
+	.show = get_link_status,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_link_down_events = {
+	.name = "link_down_events",
+	.show = get_link_down_events,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_reinit_count = {
+	.name = "reinit_count",
+	.show = get_reinit_count,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_auto_reinit = {
+	.name = "auto_reinit",
+	.show = get_auto_reinit,
+	.store = set_auto_reinit,
+};
+
+static struct iio_attribute iio_attr_sampling_frequency = {
+	.name = "sampling_frequency",
+	.show = get_sampling_frequency,
+	.store = set_sampling_frequency,
+};
+
+static struct iio_attribute iio_attr_monitor_stats = {
+	.name = "monitor_stats",
+	.show = get_monitor_stats,
+	.store = set_monitor_stats,
+};
+
+static struct iio_attribute *iio_jesd_monitor_attributes[] = {
+	&iio_attr_link_status,
+	&iio_attr_link_down_events,
+	&iio_attr_reinit_count,
+	&iio_attr_auto_reinit,
+	&iio_attr_sampling_frequency,
+	&iio_attr_monitor_stats,
+	NULL,
+};
+
+static struct iio_attribute iio_attr_lane_errors = {
+	.name = "errors",
+	.show = get_lane_errors,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_lane_error_rate = {
+	.name = "error_rate",
+	.show = get_lane_error_rate,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_lane_cgs_state = {
+	.name = "cgs_state",
+	.show = get_lane_cgs_state,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_lane_ilas = {
+	.name = "ilas",
+	.show = get_lane_ilas,
+	.store = NULL,
+};
+
+static struct iio_attribute *iio_jesd_lane_attributes[] = {
+	&iio_attr_lane_errors,
+	&iio_attr_lane_error_rate,
+	&iio_attr_lane_cgs_state,
+	&iio_attr_lane_ilas,
+	NULL,
+};
+
+/**
+ * iio_jesd_monitor_xml_write() - Generate the xml of the device.
+ * @xml:	Where the xml is written, NULL to only get its length.
+ * @size:	Size of "xml".
+ * @iio_dev:	Structure describing a device, channels and attributes.
+ * Return: Length of the xml, without the terminating null byte.
+ */
+static size_t iio_jesd_monitor_xml_write(char *xml, size_t size,
+		struct iio_device *iio_dev)
+{
+	struct iio_attribute **attr;
+	size_t len = 0;
+	uint16_t i;
+
+#define XML_APPEND(...) \
+	len += snprintf(xml ? xml + len : NULL, xml ? size - len : 0, __VA_ARGS__)
+
+	XML_APPEND("<device id=\"%s\" name=\"%s\" >", iio_dev->name,
+		   iio_dev->name);
+	for (i = 0; i < iio_dev->num_ch; i++) {
+		XML_APPEND("<channel id=\"%s\" type=\"input\" >",
+			   iio_dev->channels[i]->name);
+		for (attr = iio_dev->channels[i]->attributes; *attr; attr++)
+			XML_APPEND("<attribute name=\"%s\" filename=\"in_%s_%s\" />",
+				   (*attr)->name, iio_dev->channels[i]->name,
+				   (*attr)->name);
+		XML_APPEND("</channel>");
+	}
+	/* The statistics are listed as a debug attribute */
+	for (attr = iio_dev->attributes; *attr; attr++)
+		XML_APPEND("<%s name=\"%s\" />",
+			   *attr == &iio_attr_monitor_stats ?
+			   "debug-attribute" : "attribute", (*attr)->name);
+	XML_APPEND("</device>");
+
+#undef XML_APPEND
+
+	return len;
+}
+
+/**
+ * iio_axi_jesd204_rx_monitor_get_xml() - Get xml corresponding to the link
+ * monitor device.
+ * @xml:	Xml containing description of a device.
+ * @iio_dev:	Structure describing a device, channels and attributes.
+ * Return: SUCCESS in case of success or negative value otherwise.
+ */
+ssize_t iio_axi_jesd204_rx_monitor_get_xml(char **xml,
+		struct iio_device *iio_dev)
+{
+	size_t len;
+
+	if (!xml || !iio_dev)
+		return FAILURE;
+
+	len = iio_jesd_monitor_xml_write(NULL, 0, iio_dev);
+	*xml = calloc(1, len + 1);
+	if (!(*xml))
+		return -ENOMEM;
+
+	iio_jesd_monitor_xml_write(*xml, len + 1, iio_dev);
+
+	return SUCCESS;
+}
+
+/**
+ * iio_axi_jesd204_rx_monitor_delete_device() - Delete iio_device.
+ * @iio_device:	Structure describing a device, channels and attributes.
+ * Return: SUCCESS in case of success or negative value otherwise.
+ */
+ssize_t iio_axi_jesd204_rx_monitor_delete_device(struct iio_device
+		*iio_device)
+{
+	uint16_t i = 0;
+
+	if (!iio_device)
+		return FAILURE;
+
+	if (iio_device->channels) {
+		while (iio_device->channels[i]) {
+			free(iio_device->channels[i]->name);
+			free(iio_device->channels[i]);
+			i++;
+		}
+		free(iio_device->channels);
+	}
+	free(iio_device);
+
+	return SUCCESS;
+}
+
+/**
+ * iio_axi_jesd204_rx_monitor_create_device() - Create structure describing a
+ * device, channels and attributes.
+ * @device_name:	Device name.
+ * @num_lanes:		Number of lanes of the link, one channel per lane.
+ * Return: iio_device or NULL, in case of failure.
+ */
+struct iio_device *iio_axi_jesd204_rx_monitor_create_device(
+	const char *device_name, uint16_t num_lanes)
+{
+	struct iio_device *iio_device;
+	const uint8_t num_ch_digits = 3;
+	char ch_lane[] = "lane";
+	uint16_t i;
+
+	if (!device_name)
+		return NULL;
+
+	iio_device = (struct iio_device *)calloc(1, sizeof(struct iio_device));
+	if (!iio_device)
+		return NULL;
+
+	iio_device->name = device_name;
+	iio_device->num_ch = num_lanes;
+	iio_device->attributes = iio_jesd_monitor_attributes;
+	iio_device->channels = calloc(num_lanes + 1, sizeof(struct iio_channel *));
+	if (!iio_device->channels)
+		goto error;
+
+	for (i = 0; i < num_lanes; i++) {
+		iio_device->channels[i] = calloc(1, sizeof(struct iio_channel));
+		if (!iio_device->channels[i])
+			goto error;
+		iio_device->channels[i]->name = calloc(1, sizeof(ch_lane) +
+						       num_ch_digits);
+		if (!iio_device->channels[i]->name)
+			goto error;
+		sprintf(iio_device->channels[i]->name, "%s%d", ch_lane, i);
+		iio_device->channels[i]->attributes = iio_jesd_lane_attributes;
+		iio_device->channels[i]->ch_out = false;
+	}
+
+	return iio_device;
+
+error:
+	iio_axi_jesd204_rx_monitor_delete_device(iio_device);
+
+	return NULL;
+}
@@ -0,0 +1,82 @@
+/***************************************************************************//**
+*   @file   iio_axi_jesd204_rx_monitor.h
+*   @brief  Header file of iio_axi_jesd204_rx_monitor
+*   @author Cristian Pop (cristian.pop@analog.com)
+********************************************************************************
+* Copyright 2020(c) Analog Devices, Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*  - Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*  - Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in
+*    the documentation and/or other materials provided with the
+*    distribution.
+*  - Neither the name of Analog Devices, Inc. nor the names of its
+*    contributors may be used to endorse or promote products derived
+*    from this software without specific prior written permission.
+*  - The use of this software may or may not infringe the patent rights
+*    of one or more patent holders.  This license does not release you
+*    from the requirement that you obtain separate licenses from these
+*    patent holders to use this software.
+*  - Use of the software either in source or binary form, must be run
+*    on or directly connected to an Analog Devices Inc. component.
+*
+* THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+* IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef IIO_AXI_JESD204_RX_MONITOR_H_
+#define IIO_AXI_JESD204_RX_MONITOR_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include "iio_types.h"
+#include "axi_jesd204_rx_monitor.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct iio_axi_jesd204_rx_monitor_init_par {
+	struct jesd204_rx_monitor *monitor;
+};
+
+struct iio_axi_jesd204_rx_monitor {
+	struct jesd204_rx_monitor *monitor;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Init iio_axi_jesd204_rx_monitor. */
+ssize_t iio_axi_jesd204_rx_monitor_init(struct iio_axi_jesd204_rx_monitor
+					**iio_monitor,
+					struct iio_axi_jesd204_rx_monitor_init_par *init);
+/* Free the resources allocated by iio_axi_jesd204_rx_monitor_init(). */
+ssize_t iio_axi_jesd204_rx_monitor_remove(struct iio_axi_jesd204_rx_monitor
+		*iio_monitor);
+/* Create iio_device, with one channel per lane. */
+struct iio_device *iio_axi_jesd204_rx_monitor_create_device(
+	const char *device_name, uint16_t num_lanes);
+/* Delete iio_device. */
+ssize_t iio_axi_jesd204_rx_monitor_delete_device(struct iio_device
+		*iio_device);
+/* Get an xml describing the link monitor device */
+ssize_t iio_axi_jesd204_rx_monitor_get_xml(char** xml,
+		struct iio_device *iio_dev);
+
+#endif /* IIO_AXI_JESD204_RX_MONITOR_H_ */
@@ -56,4 +56,12 @@ int32_t axi_io_read(uint32_t base, uint32_t offset, uint32_t *data);
 /* AXI IO Write data */
 int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data);
 
+#if defined(BUS_TRACE) && !defined(BUS_TRACE_IMPL)
+#include "bus_trace.h"
+#define axi_io_read(base, offset, data) \
+	bus_trace_axi_io_read(base, offset, data, __func__, __LINE__)
+#define axi_io_write(base, offset, data) \
+	bus_trace_axi_io_write(base, offset, data, __func__, __LINE__)
+#endif
+
 #endif // AXI_IO_H_
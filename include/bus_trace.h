@@ -0,0 +1,204 @@
+/***************************************************************************//**
+ *   @file   bus_trace.h
+ *   @brief  Bus transaction tracing of SPI, AXI and delay calls.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef BUS_TRACE_H_
+#define BUS_TRACE_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+/*
+ * Tracing is enabled by building with -DBUS_TRACE. spi.h, axi_io.h and
+ * delay.h then route every call of spi_write_and_read(), axi_io_read(),
+ * axi_io_write(), mdelay() and udelay() through the bus_trace_*() wrappers,
+ * which record it together with its call site. Without BUS_TRACE nothing is
+ * traced and the calls are not touched.
+ *
+ * Files implementing the traced functions (platform drivers) and
+ * bus_trace.c define BUS_TRACE_IMPL before their includes, so that they see
+ * the plain functions. The project local platform layers, which declare
+ * these functions in their own headers with their own descriptor types,
+ * define BUS_TRACE_IMPL as well and are not traced.
+ */
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Number of events kept in the trace ring */
+#ifndef BUS_TRACE_RING_SIZE
+#define BUS_TRACE_RING_SIZE	256
+#endif
+
+/** Number of distinct call sites that can be accounted */
+#ifndef BUS_TRACE_MAX_SITES
+#define BUS_TRACE_MAX_SITES	128
+#endif
+
+#ifdef BUS_TRACE
+
+/** Tag the following bus accesses with a boot phase name */
+#define BUS_TRACE_PHASE(name)	bus_trace_phase(name)
+
+#else
+
+#define BUS_TRACE_PHASE(name)
+
+#endif // BUS_TRACE
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct spi_desc;
+struct timer_desc;
+
+/**
+ * @enum bus_trace_type
+ * @brief Traced operations.
+ */
+enum bus_trace_type {
+	/** spi_write_and_read() */
+	BUS_TRACE_SPI,
+	/** axi_io_read() */
+	BUS_TRACE_AXI_READ,
+	/** axi_io_write() */
+	BUS_TRACE_AXI_WRITE,
+	/** udelay() and mdelay() */
+	BUS_TRACE_DELAY,
+	/** Number of traced operations */
+	BUS_TRACE_TYPE_NUM
+};
+
+/**
+ * @struct bus_trace_event
+ * @brief One traced operation, as stored in the trace ring.
+ */
+struct bus_trace_event {
+	/** Calling function */
+	const char		*func;
+	/** Calling line */
+	uint32_t		line;
+	/** Traced operation */
+	enum bus_trace_type	type;
+	/** Bytes transferred, or requested delay in microseconds */
+	uint32_t		bytes;
+	/** Start of the operation since bus_trace_init() (ns) */
+	uint64_t		start_ns;
+	/** Duration of the operation (ns) */
+	uint32_t		elapsed_ns;
+	/** Boot phase active when the operation was issued */
+	const char		*phase;
+};
+
+/**
+ * @struct bus_trace_site
+ * @brief Accumulated statistics of one call site.
+ */
+struct bus_trace_site {
+	/** Calling function */
+	const char		*func;
+	/** Calling line */
+	uint32_t		line;
+	/** Traced operation */
+	enum bus_trace_type	type;
+	/** Number of calls */
+	uint32_t		count;
+	/** Total bytes transferred, or requested delay in microseconds */
+	uint64_t		bytes;
+	/** Total duration of the calls (ns) */
+	uint64_t		time_ns;
+	/** Start of the first call (ns) */
+	uint64_t		first_ns;
+	/** End of the last call (ns) */
+	uint64_t		last_ns;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+#ifdef BUS_TRACE
+
+/* Start tracing, using an up-counting timer as time base. */
+int32_t bus_trace_init(struct timer_desc *timer);
+
+/* Clear the trace ring and the call site statistics. */
+void bus_trace_reset(void);
+
+/* Tag the following bus accesses with a boot phase name. */
+void bus_trace_phase(const char *name);
+
+/* Get the accumulated statistics of all call sites. */
+const struct bus_trace_site *bus_trace_sites(uint32_t *nb_sites);
+
+/* Get an event from the trace ring, 0 being the oldest one kept. */
+const struct bus_trace_event *bus_trace_event_get(uint32_t index);
+
+/* Print the per-function timeline and the per-call-site statistics. */
+void bus_trace_report(void);
+
+/* Print the events kept in the trace ring. */
+void bus_trace_dump(void);
+
+/* Traced spi_write_and_read(). */
+int32_t bus_trace_spi_write_and_read(struct spi_desc *desc, uint8_t *data,
+				     uint16_t bytes_number,
+				     const char *func, uint32_t line);
+
+/* Traced axi_io_read(). */
+int32_t bus_trace_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data,
+			      const char *func, uint32_t line);
+
+/* Traced axi_io_write(). */
+int32_t bus_trace_axi_io_write(uint32_t base, uint32_t offset, uint32_t data,
+			       const char *func, uint32_t line);
+
+/* Traced udelay(). */
+void bus_trace_udelay(uint32_t usecs, const char *func, uint32_t line);
+
+/* Traced mdelay(). */
+void bus_trace_mdelay(uint32_t msecs, const char *func, uint32_t line);
+
+#endif // BUS_TRACE
+
+#endif // BUS_TRACE_H_
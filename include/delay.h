@@ -56,4 +56,10 @@ void udelay(uint32_t usecs);
 /* Generate miliseconds delay. */
 void mdelay(uint32_t msecs);
 
+#if defined(BUS_TRACE) && !defined(BUS_TRACE_IMPL)
+#include "bus_trace.h"
+#define udelay(usecs)	bus_trace_udelay(usecs, __func__, __LINE__)
+#define mdelay(msecs)	bus_trace_mdelay(msecs, __func__, __LINE__)
+#endif
+
 #endif // DELAY_H_
@@ -0,0 +1,162 @@
+/***************************************************************************//**
+ *   @file   profile.h
+ *   @brief  Code section timing with latency histograms.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timestamp.h"
+
+/*
+ * Profiling is enabled by building with -DPROFILING, otherwise the PROF_*
+ * macros expand to nothing. A section is defined once and then timed either
+ * explicitly or for the rest of the enclosing block:
+ *
+ *	PROF_SECTION(dma_wait);
+ *
+ *	PROF_START(dma_wait);
+ *	axi_dmac_transfer(...);
+ *	PROF_STOP(dma_wait);
+ *
+ *	{
+ *		PROF_SCOPE(dma_wait);
+ *		...
+ *	}
+ *
+ * prof_report() prints every section timed so far.
+ */
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Histogram bins, bin n counts durations in [2^n, 2^(n+1)) ns */
+#define PROF_HIST_BINS	32
+
+#ifdef PROFILING
+
+/** Define a section at file scope. */
+#define PROF_SECTION(sec)						\
+	static struct prof_section sec = { .name = #sec }
+
+/** Start timing a section. */
+#define PROF_START(sec)							\
+	uint64_t prof_start_##sec = timestamp_ns()
+
+/** Stop timing a section started with PROF_START(). */
+#define PROF_STOP(sec)							\
+	prof_section_add(&sec, timestamp_ns() - prof_start_##sec)
+
+/** Time a section until the end of the enclosing block. */
+#define PROF_SCOPE(sec)							\
+	struct prof_scope prof_scope_##sec				\
+	__attribute__((cleanup(prof_scope_end))) = {			\
+		.section = &sec,					\
+		.start_ns = timestamp_ns()				\
+	}
+
+#else
+
+#define PROF_SECTION(sec)	extern int prof_unused_##sec
+#define PROF_START(sec)		do {} while (0)
+#define PROF_STOP(sec)		do {} while (0)
+#define PROF_SCOPE(sec)		do {} while (0)
+
+#endif // PROFILING
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct prof_section
+ * @brief Timing statistics of a code section.
+ */
+struct prof_section {
+	/** Section name */
+	const char		*name;
+	/** Number of timed runs */
+	uint32_t		count;
+	/** Total time (ns) */
+	uint64_t		total_ns;
+	/** Shortest run (ns) */
+	uint64_t		min_ns;
+	/** Longest run (ns) */
+	uint64_t		max_ns;
+	/** Run time histogram */
+	uint32_t		hist[PROF_HIST_BINS];
+	/** Section is in the report list */
+	bool			listed;
+	/** Next section in the report list */
+	struct prof_section	*next;
+};
+
+/**
+ * @struct prof_scope
+ * @brief Section timed by PROF_SCOPE().
+ */
+struct prof_scope {
+	/** Timed section */
+	struct prof_section	*section;
+	/** Start of the run (ns) */
+	uint64_t		start_ns;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Account one run of a section. */
+void prof_section_add(struct prof_section *sec, uint64_t elapsed_ns);
+
+/* Clear the statistics of a section. */
+void prof_section_reset(struct prof_section *sec);
+
+/* End of a PROF_SCOPE() block. */
+void prof_scope_end(struct prof_scope *scope);
+
+/* Print the statistics of every section timed so far. */
+void prof_report(void);
+
+#endif // PROFILE_H_
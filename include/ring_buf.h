@@ -0,0 +1,99 @@
+/***************************************************************************//**
+ *   @file   ring_buf.h
+ *   @brief  Lock-free single-producer single-consumer byte ring buffer.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef RING_BUF_H_
+#define RING_BUF_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct ring_buf
+ * @brief Fixed capacity byte ring shared by one producer and one consumer.
+ *
+ * The producer (typically an interrupt handler) only moves head and the
+ * consumer only moves tail, so no locking is needed between them. Both
+ * indexes run freely and are masked with the power of two capacity.
+ */
+struct ring_buf {
+	/** Storage */
+	uint8_t			*buff;
+	/** Capacity in bytes, power of two */
+	uint32_t		size;
+	/** Total bytes written, updated by the producer */
+	volatile uint32_t	head;
+	/** Total bytes read, updated by the consumer */
+	volatile uint32_t	tail;
+	/** Writes that did not fit entirely, updated by the producer */
+	volatile uint32_t	overflow_count;
+	/** Bytes dropped because the ring was full, updated by the producer */
+	volatile uint32_t	overflow_bytes;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Initialize a ring over caller provided storage. */
+int32_t ring_buf_init(struct ring_buf *ring, uint8_t *buff, uint32_t size);
+
+/* Drop the ring contents. Not to be used while producer or consumer run. */
+void ring_buf_reset(struct ring_buf *ring);
+
+/* Get the number of bytes available for reading. */
+uint32_t ring_buf_level(struct ring_buf *ring);
+
+/* Get the number of bytes that can be written. */
+uint32_t ring_buf_space(struct ring_buf *ring);
+
+/* Write bytes to the ring (producer side). */
+uint32_t ring_buf_write(struct ring_buf *ring, const uint8_t *data,
+			uint32_t len);
+
+/* Read bytes from the ring (consumer side). */
+uint32_t ring_buf_read(struct ring_buf *ring, uint8_t *data, uint32_t len);
+
+#endif // RING_BUF_H_
@@ -0,0 +1,246 @@
+/***************************************************************************//**
+ *   @file   scheduler.h
+ *   @brief  Cooperative task scheduler and non-blocking wait primitives.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "error.h"
+#include "timestamp.h"
+
+/*
+ * Tasks are plain functions that the scheduler calls repeatedly. A task
+ * body is written between TASK_BEGIN() and TASK_END() and gives the CPU back
+ * with one of the TASK_* wait macros; the next call resumes after that macro.
+ * Local variables are not preserved across a wait, keep the task state in
+ * its context structure. Wait macros can not be used inside a switch
+ * statement of the task body.
+ *
+ *	static int32_t dev_task(struct sched_task *t, void *ctx)
+ *	{
+ *		struct dev *dev = ctx;
+ *
+ *		TASK_BEGIN(t);
+ *		dev_start_cal(dev);
+ *		TASK_POLL(t, dev_cal_done(dev), 100, 100000, dev->ret);
+ *		if (dev->ret)
+ *			return dev->ret;
+ *		TASK_SLEEP_US(t, 500);
+ *		TASK_END(t);
+ *	}
+ */
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Task is waiting, call it again */
+#define TASK_WAITING	0
+/** Task finished */
+#define TASK_DONE	1
+
+/** Start of a task body. */
+#define TASK_BEGIN(t)		switch ((t)->resume) { case 0:
+
+/** End of a task body. */
+#define TASK_END(t)		} (t)->resume = 0; return TASK_DONE
+
+/** Give the CPU to the other tasks. */
+#define TASK_YIELD(t)							\
+	do {								\
+		(t)->resume = __LINE__;					\
+		return TASK_WAITING;					\
+	case __LINE__:;							\
+	} while (0)
+
+/** Wait until cond is true. cond is evaluated on every scheduler pass. */
+#define TASK_WAIT_UNTIL(t, cond)					\
+	do {								\
+		(t)->resume = __LINE__;					\
+	case __LINE__:							\
+		if (!(cond))						\
+			return TASK_WAITING;				\
+	} while (0)
+
+/** Sleep for the given number of microseconds. */
+#define TASK_SLEEP_US(t, usecs)						\
+	do {								\
+		sched_task_sleep(t, usecs);				\
+		TASK_YIELD(t);						\
+	} while (0)
+
+/** Wait until any of the mask bits is set in the event, then clear them. */
+#define TASK_WAIT_EVENT(t, ev, mask)					\
+	TASK_WAIT_UNTIL(t, sched_event_take(ev, mask))
+
+/**
+ * Evaluate cond every period_us until it is true or timeout_us elapsed.
+ * ret is set to SUCCESS or FAILURE (timeout).
+ */
+#define TASK_POLL(t, cond, period_us, timeout_us, ret)			\
+	do {								\
+		(t)->deadline_ns = sched_task_now(t) +			\
+				   (uint64_t)(timeout_us) * 1000;	\
+		(t)->resume = __LINE__;					\
+	case __LINE__:							\
+		if (cond) {						\
+			(ret) = SUCCESS;				\
+		} else if (sched_task_now(t) >= (t)->deadline_ns) {	\
+			(ret) = FAILURE;				\
+		} else {						\
+			sched_task_sleep(t, period_us);			\
+			return TASK_WAITING;				\
+		}							\
+	} while (0)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct timer_desc;
+struct scheduler;
+struct sched_task;
+
+/**
+ * @brief Task body.
+ * @param task - The task, to be passed to the TASK_* macros.
+ * @param ctx - Task context.
+ * @return TASK_WAITING, TASK_DONE or a negative error code, which also ends
+ *         the task.
+ */
+typedef int32_t (*sched_task_fn)(struct sched_task *task, void *ctx);
+
+/**
+ * @struct sched_task
+ * @brief Task state. Owned by the caller, must stay valid until the task ends.
+ */
+struct sched_task {
+	/** Task body */
+	sched_task_fn		run;
+	/** Task context */
+	void			*ctx;
+	/** Resume point inside the task body */
+	uint32_t		resume;
+	/** Do not run the task before this time (ns) */
+	uint64_t		wake_ns;
+	/** Timeout of TASK_POLL() (ns) */
+	uint64_t		deadline_ns;
+	/** Value returned by the task when it ended */
+	int32_t			ret;
+	/** Task did not end yet */
+	bool			active;
+	/** Scheduler running the task */
+	struct scheduler	*sched;
+	/** Next task in the scheduler list */
+	struct sched_task	*next;
+};
+
+/**
+ * @struct sched_event
+ * @brief Event flags, may be set from interrupt handlers.
+ */
+struct sched_event {
+	/** Pending flags */
+	volatile uint32_t	flags;
+};
+
+/**
+ * @struct scheduler_init_param
+ * @brief Scheduler initialization parameters.
+ */
+struct scheduler_init_param {
+	/** Started, up-counting timer used as time base */
+	struct timer_desc	*timer;
+};
+
+/**
+ * @struct scheduler
+ * @brief Scheduler descriptor.
+ */
+struct scheduler {
+	/** Time base */
+	struct timestamp_counter clock;
+	/** Task list */
+	struct sched_task	*tasks;
+	/** First error returned by a task during scheduler_run() */
+	int32_t			error;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Initialize the scheduler. */
+int32_t scheduler_init(struct scheduler **sched,
+		       struct scheduler_init_param *param);
+
+/* Free the resources allocated by scheduler_init(). */
+int32_t scheduler_remove(struct scheduler *sched);
+
+/* Get the time elapsed since scheduler_init(). */
+uint64_t scheduler_now(struct scheduler *sched);
+
+/* Add a task to the scheduler. */
+int32_t scheduler_task_add(struct scheduler *sched, struct sched_task *task,
+			   sched_task_fn run, void *ctx);
+
+/* Run every ready task once. */
+uint32_t scheduler_run_once(struct scheduler *sched);
+
+/* Run the tasks until all of them ended. */
+int32_t scheduler_run(struct scheduler *sched);
+
+/* Get the time elapsed since scheduler_init(), from a task. */
+uint64_t sched_task_now(struct sched_task *task);
+
+/* Do not run the task for the given number of microseconds. */
+void sched_task_sleep(struct sched_task *task, uint32_t usecs);
+
+/* Set event flags. Can be called from interrupt handlers. */
+void sched_event_set(struct sched_event *ev, uint32_t mask);
+
+/* Clear and return the event flags selected by mask. */
+uint32_t sched_event_take(struct sched_event *ev, uint32_t mask);
+
+#endif // SCHEDULER_H_
@@ -118,4 +118,11 @@ int32_t spi_write_and_read(struct spi_desc *desc,
 			   uint8_t *data,
 			   uint16_t bytes_number);
 
+#if defined(BUS_TRACE) && !defined(BUS_TRACE_IMPL)
+#include "bus_trace.h"
+#define spi_write_and_read(desc, data, bytes_number) \
+	bus_trace_spi_write_and_read(desc, data, bytes_number, \
+				     __func__, __LINE__)
+#endif
+
 #endif // SPI_H_
@@ -0,0 +1,95 @@
+/***************************************************************************//**
+ *   @file   timestamp.h
+ *   @brief  64-bit monotonic timestamps.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef TIMESTAMP_H_
+#define TIMESTAMP_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct timer_desc;
+
+/**
+ * @struct timestamp_counter
+ * @brief 64-bit extension of the 32-bit counter of an up-counting timer.
+ */
+struct timestamp_counter {
+	/** Started, up-counting time base, NULL if none */
+	struct timer_desc	*timer;
+	/** Last counter value read from the time base */
+	uint32_t		last_count;
+	/** Time base ticks elapsed since timestamp_counter_init() */
+	uint64_t		ticks;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Start extending the counter of a timer to 64 bits. */
+int32_t timestamp_counter_init(struct timestamp_counter *tc,
+			       struct timer_desc *timer);
+
+/* Get the time elapsed since timestamp_counter_init(). */
+uint64_t timestamp_counter_ns(struct timestamp_counter *tc);
+
+/* Select the timer used as time base. */
+int32_t timestamp_init(struct timer_desc *timer);
+
+/* Check if a time base is available. */
+bool timestamp_available(void);
+
+/* Get the monotonic time in nanoseconds. */
+uint64_t timestamp_ns(void);
+
+/* Get the monotonic time in microseconds. */
+uint64_t timestamp_us(void);
+
+/* Get the time elapsed since a previous timestamp_ns() value. */
+uint64_t timestamp_elapsed_ns(uint64_t start_ns);
+
+#endif // TIMESTAMP_H_
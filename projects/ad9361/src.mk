@@ -22,11 +22,26 @@ SRCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.c			\
 	$(DRIVERS)/axi_core/jesd204/axi_jesd204_rx.c			\
 	$(DRIVERS)/axi_core/jesd204/axi_jesd204_tx.c			\
 	$(DRIVERS)/axi_core/jesd204/xilinx_transceiver.c		\
-	$(NO-OS)/util/util.c
+	$(NO-OS)/util/util.c						\
+	$(NO-OS)/util/timestamp.c
 SRCS +=	$(PLATFORM_DRIVERS)/axi_io.c					\
 	$(PLATFORM_DRIVERS)/spi.c					\
 	$(PLATFORM_DRIVERS)/gpio.c					\
-	$(PLATFORM_DRIVERS)/delay.c
+	$(PLATFORM_DRIVERS)/delay.c					\
+	$(PLATFORM_DRIVERS)/timer.c
+ifeq (y,$(strip $(FREQ_HOP)))
+SRCS += $(PROJECT)/src/ad9361_hop.c
+endif
+ifeq (y,$(strip $(TELEMETRY)))
+SRCS += $(PROJECT)/src/ad9361_telem.c					\
+	$(NO-OS)/util/ring_buf.c
+endif
+ifeq (y,$(strip $(BIST_VERIFY)))
+SRCS += $(PROJECT)/src/ad9361_bist.c
+endif
+ifeq (y,$(strip $(SCHEDULER)))
+SRCS += $(NO-OS)/util/scheduler.c
+endif
 INCS := $(PROJECT)/src/common.h						\
 	$(PROJECT)/src/config.h
 INCS += $(PROJECT)/src/ad9361.h						\
@@ -42,10 +57,26 @@ INCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.h			\
 	$(DRIVERS)/axi_core/jesd204/axi_jesd204_tx.h			\
 	$(DRIVERS)/axi_core/jesd204/xilinx_transceiver.h
 INCS +=	$(PLATFORM_DRIVERS)/spi_extra.h					\
-	$(PLATFORM_DRIVERS)/gpio_extra.h
+	$(PLATFORM_DRIVERS)/gpio_extra.h				\
+	$(PLATFORM_DRIVERS)/timer_extra.h
 INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/spi.h						\
 	$(INCLUDE)/gpio.h						\
 	$(INCLUDE)/error.h						\
 	$(INCLUDE)/delay.h						\
-	$(INCLUDE)/util.h
+	$(INCLUDE)/util.h						\
+	$(INCLUDE)/timestamp.h						\
+	$(INCLUDE)/timer.h
+ifeq (y,$(strip $(FREQ_HOP)))
+INCS += $(PROJECT)/src/ad9361_hop.h
+endif
+ifeq (y,$(strip $(TELEMETRY)))
+INCS += $(PROJECT)/src/ad9361_telem.h					\
+	$(INCLUDE)/ring_buf.h
+endif
+ifeq (y,$(strip $(BIST_VERIFY)))
+INCS += $(PROJECT)/src/ad9361_bist.h
+endif
+ifeq (y,$(strip $(SCHEDULER)))
+INCS += $(INCLUDE)/scheduler.h
+endif
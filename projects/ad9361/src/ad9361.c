@@ -52,6 +52,10 @@
 #include "ad9361_util.h"
 #include "util.h"
 #include "config.h"
+#include "timestamp.h"
+#ifdef HAVE_SCHEDULER
+#include "scheduler.h"
+#endif
 
 #define diff_abs(x, y) ((x) > (y) ? (x - y) : (y - x))
 
@@ -580,14 +584,11 @@ int32_t ad9361_spi_readm(struct spi_desc *spi, uint32_t reg,
 {
 	int32_t ret = 0;
 	uint16_t cmd;
-	uint8_t *rbuffer;
+	uint8_t rbuffer[2 + MAX_MBYTE_SPI];
 	if (num > MAX_MBYTE_SPI)
 		return -EINVAL;
 
 	cmd = AD_READ | AD_CNT(num) | AD_ADDR(reg);
-	rbuffer = malloc(num + 2);
-	if(!rbuffer)
-		return -ENOMEM;
 	rbuffer[0] = cmd >> 8;
 	rbuffer[1] = cmd & 0xFF;
 	ret = spi_write_and_read(spi, &rbuffer[0], 2 + num);
@@ -596,8 +597,6 @@ int32_t ad9361_spi_readm(struct spi_desc *spi, uint32_t reg,
 		dev_err(&spi->dev, "Read Error %"PRId32, ret);
 	else
 		memcpy(rbuf, &rbuffer[2], num);
-
-	free(rbuffer);
 #ifdef _DEBUG
 	{
 		int32_t i;
@@ -782,6 +781,103 @@ static int32_t ad9361_spi_writem(struct spi_desc *spi,
 	return 0;
 }
 
+/**
+ * Append a SPI write instruction to a prebuilt message list.
+ * @param msgs The message list.
+ * @param pos The current length of the message list.
+ * @param reg The first register address, following ones are decrementing.
+ * @param tbuf The data to write.
+ * @param num The number of bytes to write, at most MAX_MBYTE_SPI.
+ * @return The new length of the message list.
+ */
+static uint32_t ad9361_spi_batch_add(uint8_t *msgs, uint32_t pos,
+				     uint32_t reg, const uint8_t *tbuf,
+				     uint32_t num)
+{
+	uint16_t cmd;
+
+	cmd = AD_WRITE | AD_CNT(num) | AD_ADDR(reg);
+	msgs[pos++] = cmd >> 8;
+	msgs[pos++] = cmd & 0xFF;
+	memcpy(&msgs[pos], tbuf, num);
+
+	return pos + num;
+}
+
+/**
+ * Send a message list built with ad9361_spi_batch_add().
+ * @param spi
+ * @param msgs The message list.
+ * @param len The length of the message list.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_spi_write_batch(struct spi_desc *spi,
+				      const uint8_t *msgs, uint32_t len)
+{
+	uint8_t buf[2 + MAX_MBYTE_SPI];
+	uint32_t pos, num;
+	int32_t ret;
+
+	for (pos = 0; pos < len; pos += num + 2) {
+		num = ((msgs[pos] >> 4) & 0x7) + 1;
+		/* The SPI transfer overwrites the buffer with the read data */
+		memcpy(buf, &msgs[pos], num + 2);
+		ret = spi_write_and_read(spi, buf, num + 2);
+		if (ret < 0) {
+			dev_err(&spi->dev, "Write Error %"PRId32, ret);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Write FIR filter coefficients using batched SPI transfers.
+ * @param spi
+ * @param offs The RX/TX filter register offset.
+ * @param fir_conf The filter configuration, with FIR_START_CLK set.
+ * @param ntaps Number of filter Taps.
+ * @param coef The coefficients, 16 bit little endian.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_fir_write_taps(struct spi_desc *spi, uint32_t offs,
+				     uint32_t fir_conf, uint32_t ntaps,
+				     const uint8_t *coef)
+{
+	uint8_t msgs[AD9361_FIR_BATCH_TAPS * 14], data[3], strobe, zero = 0;
+	uint32_t val, len = 0;
+	int32_t ret;
+
+	strobe = fir_conf | FIR_WRITE;
+
+	for (val = 0; val < ntaps; val++) {
+		data[0] = coef[2 * val + 1];
+		data[1] = coef[2 * val];
+		data[2] = val;
+		len = ad9361_spi_batch_add(msgs, len,
+					   REG_TX_FILTER_COEF_WRITE_DATA_2 + offs,
+					   data, 3);
+		len = ad9361_spi_batch_add(msgs, len, REG_TX_FILTER_CONF + offs,
+					   &strobe, 1);
+		len = ad9361_spi_batch_add(msgs, len,
+					   REG_TX_FILTER_COEF_READ_DATA_2 + offs,
+					   &zero, 1);
+		len = ad9361_spi_batch_add(msgs, len,
+					   REG_TX_FILTER_COEF_READ_DATA_2 + offs,
+					   &zero, 1);
+
+		if (len == sizeof(msgs) || val == ntaps - 1) {
+			ret = ad9361_spi_write_batch(spi, msgs, len);
+			if (ret < 0)
+				return ret;
+			len = 0;
+		}
+	}
+
+	return 0;
+}
+
 /**
  * Validate RF BW frequency.
  * @param phy The AD9361 state structure.
@@ -889,6 +985,9 @@ int32_t ad9361_1rx1tx_channel_map(struct ad9361_rf_phy *phy, bool tx,
  */
 int32_t ad9361_reset(struct ad9361_rf_phy *phy)
 {
+	ad9361_rfpll_shadow_flush(phy);
+	clk_invalidate(phy, BIT(BB_REFCLK) | BIT(RX_REFCLK) | BIT(TX_REFCLK));
+
 	if (phy->gpio_desc_resetb) {
 		gpio_set_value(phy->gpio_desc_resetb, 0);
 		mdelay(1);
@@ -1143,6 +1242,35 @@ void ad9361_get_bist_tone(struct ad9361_rf_phy *phy,
 	*mask = phy->bist_tone_mask;
 }
 
+/**
+ * Read the calibration done bit once.
+ * @param phy The AD9361 state structure.
+ * @param reg The register address.
+ * @param mask The bit mask.
+ * @param done_state The done state [0,1].
+ * @return 1 if done, 0 if not, negative error code otherwise.
+ */
+static int32_t ad9361_cal_done(struct ad9361_rf_phy *phy, uint32_t reg,
+			       uint32_t mask, uint32_t done_state)
+{
+	int32_t state = ad9361_spi_readf(phy->spi, reg, mask);
+
+	if (state < 0)
+		return state;
+
+	return (uint32_t)state == done_state;
+}
+
+/**
+ * Get the period at which a calibration done bit is checked.
+ * @param reg The register address.
+ * @return The period [us].
+ */
+static uint32_t ad9361_cal_done_period_us(uint32_t reg)
+{
+	return (reg == REG_CALIBRATION_CTRL) ? 1200 : 120;
+}
+
 /**
  * Check the calibration done bit.
  * @param phy The AD9361 state structure.
@@ -1154,18 +1282,13 @@ void ad9361_get_bist_tone(struct ad9361_rf_phy *phy,
 static int32_t ad9361_check_cal_done(struct ad9361_rf_phy *phy, uint32_t reg,
 				     uint32_t mask, uint32_t done_state)
 {
-	uint32_t timeout = 20000; /* RFDC_CAL can take long */
-	uint32_t state;
+	uint32_t timeout = AD9361_CAL_DONE_POLLS; /* RFDC_CAL can take long */
 
 	do {
-		state = ad9361_spi_readf(phy->spi, reg, mask);
-		if (state == done_state)
+		if (ad9361_cal_done(phy, reg, mask, done_state) > 0)
 			return 0;
 
-		if (reg == REG_CALIBRATION_CTRL)
-			udelay(1200);
-		else
-			udelay(120);
+		udelay(ad9361_cal_done_period_us(reg));
 	} while (timeout--);
 
 	dev_err(&phy->spi->dev, "Calibration TIMEOUT (0x%"PRIX32", 0x%"PRIX32")", reg,
@@ -1174,6 +1297,40 @@ static int32_t ad9361_check_cal_done(struct ad9361_rf_phy *phy, uint32_t reg,
 	return -ETIMEDOUT;
 }
 
+#ifdef HAVE_SCHEDULER
+/**
+ * Check the calibration done bit from a scheduler task.
+ *
+ * Non-blocking form of ad9361_check_cal_done(), with the same poll period
+ * and timeout. The other tasks run while the calibration is in progress.
+ * @param task The scheduler task.
+ * @param ctx The wait parameters (struct ad9361_cal_wait). The result is
+ *            also left in its ret field.
+ * @return TASK_WAITING, TASK_DONE or negative error code.
+ */
+int32_t ad9361_check_cal_done_task(struct sched_task *task, void *ctx)
+{
+	struct ad9361_cal_wait *w = ctx;
+	uint32_t period_us = ad9361_cal_done_period_us(w->reg);
+
+	TASK_BEGIN(task);
+	TASK_POLL(task, (w->state = ad9361_cal_done(w->phy, w->reg, w->mask,
+			 w->done_state)) != 0, period_us,
+		  AD9361_CAL_DONE_POLLS * period_us, w->ret);
+	if (w->state < 0) {
+		w->ret = w->state;
+	} else if (w->ret != SUCCESS) {
+		dev_err(&w->phy->spi->dev,
+			"Calibration TIMEOUT (0x%"PRIX32", 0x%"PRIX32")",
+			w->reg, w->mask);
+		w->ret = -ETIMEDOUT;
+	}
+	if (w->ret < 0)
+		return w->ret;
+	TASK_END(task);
+}
+#endif
+
 /**
  * Run an AD9361 calibration and check the calibration done bit.
  * @param phy The AD9361 state structure.
@@ -1231,8 +1388,77 @@ uint64_t ad9361_from_clk(uint32_t freq)
 	return ((uint64_t)freq << 1);
 }
 
+/**
+ * Build the SPI message list that programs a gain table.
+ * @param cache The cache entry to fill.
+ * @param tab The gain table.
+ * @param index_max The number of gain table entries.
+ * @param lna The external LNA control bit added to every entry.
+ * @param dest The destination [GT_RX1, GT_RX2].
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_gt_build(struct ad9361_gt_cache *cache,
+			       const uint8_t(*tab)[3], uint32_t index_max,
+			       uint32_t lna, uint32_t dest)
+{
+	uint8_t *msgs;
+	uint8_t buf[4];
+	uint32_t i, pos = 0;
+
+	/*
+	 * 3 bytes to start the clock, 15 bytes per entry and 12 bytes to clear
+	 * the write bit, wait and stop the clock.
+	 */
+	msgs = realloc(cache->msgs, 3 + index_max * 15 + 12);
+	if (!msgs)
+		return -ENOMEM;
+	cache->msgs = msgs;
+
+	buf[0] = START_GAIN_TABLE_CLOCK | RECEIVER_SELECT(dest);
+	pos = ad9361_spi_batch_add(msgs, pos, REG_GAIN_TABLE_CONFIG, buf, 1);
+
+	for (i = 0; i < index_max; i++) {
+		/* Data 3, Data 2, Data 1 and Index in one decrementing burst */
+		buf[0] = tab[i][2]; /* DC Cal bit & Dig Gain Word */
+		buf[1] = tab[i][1]; /* TIA & LPF Word */
+		buf[2] = tab[i][0] | lna; /* Ext LNA, Int LNA, & Mixer Gain Word */
+		buf[3] = i; /* Gain Table Index */
+		pos = ad9361_spi_batch_add(msgs, pos,
+					   REG_GAIN_TABLE_WRITE_DATA3, buf, 4);
+		buf[0] = START_GAIN_TABLE_CLOCK | WRITE_GAIN_TABLE |
+			 RECEIVER_SELECT(dest);
+		pos = ad9361_spi_batch_add(msgs, pos, REG_GAIN_TABLE_CONFIG,
+					   buf, 1);
+		buf[0] = 0; /* Dummy Write to delay 3 ADCCLK/16 cycles */
+		pos = ad9361_spi_batch_add(msgs, pos, REG_GAIN_TABLE_READ_DATA1,
+					   buf, 1);
+		/* Dummy Write to delay ~1u */
+		pos = ad9361_spi_batch_add(msgs, pos, REG_GAIN_TABLE_READ_DATA1,
+					   buf, 1);
+	}
+
+	buf[0] = START_GAIN_TABLE_CLOCK | RECEIVER_SELECT(dest);
+	pos = ad9361_spi_batch_add(msgs, pos, REG_GAIN_TABLE_CONFIG,
+				   buf, 1); /* Clear Write Bit */
+	buf[0] = 0; /* Dummy Write to delay ~1u */
+	pos = ad9361_spi_batch_add(msgs, pos, REG_GAIN_TABLE_READ_DATA1,
+				   buf, 1);
+	pos = ad9361_spi_batch_add(msgs, pos, REG_GAIN_TABLE_READ_DATA1,
+				   buf, 1);
+	pos = ad9361_spi_batch_add(msgs, pos, REG_GAIN_TABLE_CONFIG,
+				   buf, 1); /* Stop Gain Table Clock */
+
+	cache->len = pos;
+
+	return 0;
+}
+
 /**
  * Load the gain table for the selected frequency range and receiver.
+ *
+ * The SPI message list of each band is built on first use and replayed on
+ * the following band changes, as long as the table type, the external LNA
+ * setting and the destination are unchanged.
  * @param phy The AD9361 state structure.
  * @param freq The frequency value [Hz].
  * @param dest The destination [GT_RX1, GT_RX2].
@@ -1242,9 +1468,12 @@ static int32_t ad9361_load_gt(struct ad9361_rf_phy *phy, uint64_t freq,
 			      uint32_t dest)
 {
 	struct spi_desc *spi = phy->spi;
+	struct ad9361_gt_cache *cache;
 	const uint8_t(*tab)[3];
 	enum rx_gain_table_name band;
-	uint32_t index_max, i, lna;
+	uint32_t index_max, lna;
+	bool split;
+	int32_t ret;
 
 	dev_dbg(&phy->spi->dev, "%s: frequency %"PRIu64, __func__, freq);
 
@@ -1260,7 +1489,8 @@ static int32_t ad9361_load_gt(struct ad9361_rf_phy *phy, uint64_t freq,
 	ad9361_spi_writef(spi, REG_AGC_CONFIG_2,
 			  AGC_USE_FULL_GAIN_TABLE, !phy->pdata->split_gt);
 
-	if (has_split_gt && phy->pdata->split_gt) {
+	split = has_split_gt && phy->pdata->split_gt;
+	if (split) {
 		tab = &split_gain_table[band][0];
 		index_max = SIZE_SPLIT_TABLE;
 	} else {
@@ -1271,34 +1501,20 @@ static int32_t ad9361_load_gt(struct ad9361_rf_phy *phy, uint64_t freq,
 	lna = phy->pdata->elna_ctrl.elna_in_gaintable_all_index_en ?
 	      EXT_LNA_CTRL : 0;
 
-	ad9361_spi_write(spi, REG_GAIN_TABLE_CONFIG, START_GAIN_TABLE_CLOCK |
-			 RECEIVER_SELECT(dest)); /* Start Gain Table Clock */
+	cache = &phy->gt_cache[band];
+	if (!cache->msgs || cache->split != split || cache->lna != lna ||
+	    cache->dest != dest) {
+		ret = ad9361_gt_build(cache, tab, index_max, lna, dest);
+		if (ret < 0)
+			return ret;
+		cache->split = split;
+		cache->lna = lna;
+		cache->dest = dest;
+	}
 
-	for (i = 0; i < index_max; i++) {
-		ad9361_spi_write(spi, REG_GAIN_TABLE_ADDRESS, i); /* Gain Table Index */
-		ad9361_spi_write(spi, REG_GAIN_TABLE_WRITE_DATA1,
-				 tab[i][0] | lna); /* Ext LNA, Int LNA, & Mixer Gain Word */
-		ad9361_spi_write(spi, REG_GAIN_TABLE_WRITE_DATA2,
-				 tab[i][1]); /* TIA & LPF Word */
-		ad9361_spi_write(spi, REG_GAIN_TABLE_WRITE_DATA3,
-				 tab[i][2]); /* DC Cal bit & Dig Gain Word */
-		ad9361_spi_write(spi, REG_GAIN_TABLE_CONFIG,
-				 START_GAIN_TABLE_CLOCK |
-				 WRITE_GAIN_TABLE |
-				 RECEIVER_SELECT(dest)); /* Gain Table Index */
-		ad9361_spi_write(spi, REG_GAIN_TABLE_READ_DATA1,
-				 0); /* Dummy Write to delay 3 ADCCLK/16 cycles */
-		ad9361_spi_write(spi, REG_GAIN_TABLE_READ_DATA1,
-				 0); /* Dummy Write to delay ~1u */
-	}
-
-	ad9361_spi_write(spi, REG_GAIN_TABLE_CONFIG, START_GAIN_TABLE_CLOCK |
-			 RECEIVER_SELECT(dest)); /* Clear Write Bit */
-	ad9361_spi_write(spi, REG_GAIN_TABLE_READ_DATA1,
-			 0); /* Dummy Write to delay ~1u */
-	ad9361_spi_write(spi, REG_GAIN_TABLE_READ_DATA1,
-			 0); /* Dummy Write to delay ~1u */
-	ad9361_spi_write(spi, REG_GAIN_TABLE_CONFIG, 0); /* Stop Gain Table Clock */
+	ret = ad9361_spi_write_batch(spi, cache->msgs, cache->len);
+	if (ret < 0)
+		return ret;
 
 	phy->current_table = band;
 
@@ -1494,21 +1710,45 @@ static uint32_t ad9361_rfvco_tableindex(uint32_t freq)
 }
 
 /**
- * Initialize the RFPLL VCO.
+ * Select the RFPLL VCO table.
+ *
+ * In FDD mode with RX LO == TX LO frequency the TDD table is used to reduce
+ * VCO pulling.
  * @param phy The AD9361 state structure.
  * @param tx Set true for TX_RFPLL.
+ * @return true if the TDD table is used.
+ */
+static bool ad9361_rfpll_use_tdd_table(struct ad9361_rf_phy *phy, bool tx)
+{
+	bool tdd_table;
+
+	tdd_table = !((phy->pdata->fdd && !phy->pdata->fdd_independent_mode)
+		      && (phy->current_tx_lo_freq != phy->current_rx_lo_freq));
+
+	if (tx)
+		phy->current_tx_use_tdd_table = tdd_table;
+	else
+		phy->current_rx_use_tdd_table = tdd_table;
+
+	return tdd_table;
+}
+
+/**
+ * Compute the RFPLL VCO and loop filter settings.
+ * @param phy The AD9361 state structure.
  * @param vco_freq The VCO frequency [Hz].
  * @param ref_clk The reference clock frequency [Hz].
+ * @param tdd_table Set true to use the TDD VCO table.
+ * @param regs The register values, in the ad9361_rfpll_regs[] order.
  * @return 0 in case of success
  */
 static int32_t ad9361_rfpll_vco_init(struct ad9361_rf_phy *phy,
-				     bool tx, uint64_t vco_freq,
-				     uint32_t ref_clk)
+				     uint64_t vco_freq, uint32_t ref_clk,
+				     bool tdd_table, uint8_t *regs)
 {
-	struct spi_desc *spi = phy->spi;
 	const struct SynthLUT(*tab);
 	int32_t i = 0;
-	uint32_t range, offs = 0;
+	uint32_t range;
 
 	range = ad9361_rfvco_tableindex(ref_clk);
 
@@ -1518,23 +1758,10 @@ static int32_t ad9361_rfpll_vco_init(struct ad9361_rf_phy *phy,
 
 	do_div(&vco_freq, 1000000UL); /* vco_freq in MHz */
 
-	if ((phy->pdata->fdd && !phy->pdata->fdd_independent_mode)
-	    && (phy->current_tx_lo_freq != phy->current_rx_lo_freq)) {
-		tab = &SynthLUT_FDD[range][0];
-		if (tx)
-			phy->current_tx_use_tdd_table = false;
-		else
-			phy->current_rx_use_tdd_table = false;
-	} else {
+	if (tdd_table)
 		tab = &SynthLUT_TDD[range][0];
-		if (tx)
-			phy->current_tx_use_tdd_table = true;
-		else
-			phy->current_rx_use_tdd_table = true;
-	}
-
-	if (tx)
-		offs = REG_TX_VCO_OUTPUT - REG_RX_VCO_OUTPUT;
+	else
+		tab = &SynthLUT_FDD[range][0];
 
 	while (i < SYNTH_LUT_SIZE && tab[i].VCO_MHz > vco_freq)
 		i++;
@@ -1542,37 +1769,18 @@ static int32_t ad9361_rfpll_vco_init(struct ad9361_rf_phy *phy,
 	dev_dbg(&phy->spi->dev, "%s : freq %d MHz : index %"PRId32,
 		__func__, tab[i].VCO_MHz, i);
 
-	ad9361_spi_write(spi, REG_RX_VCO_OUTPUT + offs,
-			 VCO_OUTPUT_LEVEL(tab[i].VCO_Output_Level) |
-			 PORB_VCO_LOGIC);
-	ad9361_spi_writef(spi, REG_RX_ALC_VARACTOR + offs,
-			  VCO_VARACTOR(~0), tab[i].VCO_Varactor);
-	ad9361_spi_write(spi, REG_RX_VCO_BIAS_1 + offs,
-			 VCO_BIAS_REF(tab[i].VCO_Bias_Ref) |
-			 VCO_BIAS_TCF(tab[i].VCO_Bias_Tcf));
-
-	ad9361_spi_write(spi, REG_RX_FORCE_VCO_TUNE_1 + offs,
-			 VCO_CAL_OFFSET(tab[i].VCO_Cal_Offset));
-	ad9361_spi_write(spi, REG_RX_VCO_VARACTOR_CTRL_1 + offs,
-			 VCO_VARACTOR_REFERENCE(
-				 tab[i].VCO_Varactor_Reference));
-
-	ad9361_spi_write(spi, REG_RX_VCO_CAL_REF + offs, VCO_CAL_REF_TCF(0));
-
-	ad9361_spi_write(spi, REG_RX_VCO_VARACTOR_CTRL_0 + offs,
-			 VCO_VARACTOR_OFFSET(0) |
-			 VCO_VARACTOR_REFERENCE_TCF(7));
-
-	ad9361_spi_writef(spi, REG_RX_CP_CURRENT + offs, CHARGE_PUMP_CURRENT(~0),
-			  tab[i].Charge_Pump_Current);
-	ad9361_spi_write(spi, REG_RX_LOOP_FILTER_1 + offs,
-			 LOOP_FILTER_C2(tab[i].LF_C2) |
-			 LOOP_FILTER_C1(tab[i].LF_C1));
-	ad9361_spi_write(spi, REG_RX_LOOP_FILTER_2 + offs,
-			 LOOP_FILTER_R1(tab[i].LF_R1) |
-			 LOOP_FILTER_C3(tab[i].LF_C3));
-	ad9361_spi_write(spi, REG_RX_LOOP_FILTER_3 + offs,
-			 LOOP_FILTER_R3(tab[i].LF_R3));
+	regs[0] = VCO_VARACTOR_REFERENCE(tab[i].VCO_Varactor_Reference);
+	regs[1] = VCO_VARACTOR_OFFSET(0) | VCO_VARACTOR_REFERENCE_TCF(7);
+	regs[2] = VCO_CAL_REF_TCF(0);
+	regs[3] = VCO_BIAS_REF(tab[i].VCO_Bias_Ref) |
+		  VCO_BIAS_TCF(tab[i].VCO_Bias_Tcf);
+	regs[4] = LOOP_FILTER_R3(tab[i].LF_R3);
+	regs[5] = LOOP_FILTER_R1(tab[i].LF_R1) | LOOP_FILTER_C3(tab[i].LF_C3);
+	regs[6] = LOOP_FILTER_C2(tab[i].LF_C2) | LOOP_FILTER_C1(tab[i].LF_C1);
+	regs[7] = CHARGE_PUMP_CURRENT(tab[i].Charge_Pump_Current);
+	regs[8] = VCO_OUTPUT_LEVEL(tab[i].VCO_Output_Level) | PORB_VCO_LOGIC;
+	regs[9] = VCO_VARACTOR(tab[i].VCO_Varactor);
+	regs[10] = VCO_CAL_OFFSET(tab[i].VCO_Cal_Offset);
 
 	return 0;
 }
@@ -2704,6 +2912,7 @@ static int32_t ad9361_txrx_synth_cp_calib(struct ad9361_rf_phy *phy,
 	ad9361_spi_write(phy->spi, REG_RX_VCO_PD_OVERRIDES + offs, 0x02);
 	ad9361_spi_write(phy->spi, REG_RX_CP_CURRENT + offs, 0x80);
 	ad9361_spi_write(phy->spi, REG_RX_CP_CONFIG + offs, CP_OFFSET_OFF);
+	ad9361_rfpll_shadow_flush(phy);
 
 	/* see Table 70 Example Calibration Times for RF VCO Cal */
 	if (phy->pdata->fdd) {
@@ -2740,29 +2949,27 @@ static int32_t ad9361_txrx_synth_cp_calib(struct ad9361_rf_phy *phy,
 }
 
 /**
- * Perform a baseband DC offset calibration.
+ * Configure the baseband DC offset calibration.
  * @param phy The AD9361 state structure.
- * @return 0 in case of success, negative error code otherwise.
+ * @return None.
  */
-static int32_t ad9361_bb_dc_offset_calib(struct ad9361_rf_phy *phy)
+static void ad9361_bb_dc_offset_setup(struct ad9361_rf_phy *phy)
 {
 	dev_dbg(&phy->spi->dev, "%s", __func__);
 
 	ad9361_spi_write(phy->spi, REG_BB_DC_OFFSET_COUNT, 0x3F);
 	ad9361_spi_write(phy->spi, REG_BB_DC_OFFSET_SHIFT, BB_DC_M_SHIFT(0xF));
 	ad9361_spi_write(phy->spi, REG_BB_DC_OFFSET_ATTEN, BB_DC_OFFSET_ATTEN(1));
-
-	return ad9361_run_calibration(phy, BBDC_CAL);
 }
 
 /**
- * Perform a RF DC offset calibration.
+ * Configure the RF DC offset calibration.
  * @param phy The AD9361 state structure.
- * @param ref_clk_hz The RX LO frequency [Hz].
- * @return 0 in case of success, negative error code otherwise.
+ * @param rx_freq The RX LO frequency [Hz].
+ * @return None.
  */
-static int32_t ad9361_rf_dc_offset_calib(struct ad9361_rf_phy *phy,
-		uint64_t rx_freq)
+static void ad9361_rf_dc_offset_setup(struct ad9361_rf_phy *phy,
+				      uint64_t rx_freq)
 {
 	struct spi_desc *spi = phy->spi;
 
@@ -2802,8 +3009,6 @@ static int32_t ad9361_rf_dc_offset_calib(struct ad9361_rf_phy *phy,
 				 INVERT_RX1_RF_DC_CGOUT_WORD |
 				 INVERT_RX2_RF_DC_CGOUT_WORD);
 	}
-
-	return ad9361_run_calibration(phy, RFDC_CAL);
 }
 
 /**
@@ -2856,106 +3061,157 @@ static int32_t __ad9361_update_rf_bandwidth(struct ad9361_rf_phy *phy,
 }
 
 /**
- * TX Quad Calib.
+ * Start a calibration without waiting for it to complete.
  * @param phy The AD9361 state structure.
- * @param phase phase
- * @param rxnco_word Rx NCO word.
- * @param decim decim
- * @param res res
+ * @param mask The calibration bit mask [TX_QUAD_CAL, RFDC_CAL, BBDC_CAL].
  * @return 0 in case of success, negative error code otherwise.
  */
-static int32_t __ad9361_tx_quad_calib(struct ad9361_rf_phy *phy, uint32_t phase,
-				      uint32_t rxnco_word, uint32_t decim, uint8_t *res)
+static int32_t ad9361_cal_hw_start(struct ad9361_rf_phy *phy, uint32_t mask)
 {
+	struct ad9361_cal_state *st = &phy->cal_state;
 	int32_t ret;
 
-	ad9361_spi_write(phy->spi, REG_QUAD_CAL_NCO_FREQ_PHASE_OFFSET,
-			 RX_NCO_FREQ(rxnco_word) | RX_NCO_PHASE_OFFSET(phase));
-	ad9361_spi_write(phy->spi, REG_QUAD_CAL_CTRL,
-			 SETTLE_MAIN_ENABLE | DC_OFFSET_ENABLE | QUAD_CAL_SOFT_RESET |
-			 GAIN_ENABLE | PHASE_ENABLE | M_DECIM(decim));
-	ad9361_spi_write(phy->spi, REG_QUAD_CAL_CTRL,
-			 SETTLE_MAIN_ENABLE | DC_OFFSET_ENABLE |
-			 GAIN_ENABLE | PHASE_ENABLE | M_DECIM(decim));
-
-	ret =  ad9361_run_calibration(phy, TX_QUAD_CAL);
+	ret = ad9361_spi_write(phy->spi, REG_CALIBRATION_CTRL, mask);
 	if (ret < 0)
 		return ret;
 
-	if (res)
-		*res = ad9361_spi_read(phy->spi,
-				       (phy->pdata->rx1tx1_mode_use_tx_num == 2) ?
-				       REG_QUAD_CAL_STATUS_TX2 : REG_QUAD_CAL_STATUS_TX1) &
-		       (TX1_LO_CONV | TX1_SSB_CONV);
+	st->mask = mask;
+	st->poll_ns = timestamp_available() ? timestamp_ns() : 0;
+	st->elapsed_us = 0;
+	st->wait_us = 0;
 
 	return 0;
 }
 
 /**
- * Loop through all possible phase offsets in case the QUAD CAL doesn't converge.
+ * Get the expected duration of a calibration.
  * @param phy The AD9361 state structure.
- * @param rxnco_word Rx NCO word.
- * @return 0 in case of success, negative error code otherwise.
+ * @param mask The calibration bit mask.
+ * @return Pointer to the expected duration [us].
  */
-static int32_t ad9361_tx_quad_phase_search(struct ad9361_rf_phy *phy,
-		uint32_t rxnco_word, uint8_t decim)
+static uint32_t *ad9361_cal_expected(struct ad9361_rf_phy *phy, uint32_t mask)
 {
-	int32_t i, ret;
-	uint8_t field[64], val;
-	uint32_t start;
+	if (mask == RFDC_CAL)
+		return &phy->cal_state.rfdc_cal_us;
 
-	dev_dbg(&phy->spi->dev, "%s", __func__);
+	if (mask == BBDC_CAL)
+		return &phy->cal_state.bbdc_cal_us;
 
-	for (i = 0; i < (int64_t)(ARRAY_SIZE(field) / 2); i++) {
-		ret =  __ad9361_tx_quad_calib(phy, i, rxnco_word, decim, &val);
-		if (ret < 0)
-			return ret;
+	return &phy->cal_state.tx_quad_cal_us;
+}
 
-		/* Handle 360/0 wrap around */
-		field[i] = field[i + 32] = !((val & TX1_LO_CONV) && (val & TX1_SSB_CONV));
+/**
+ * Check if the calibration started with ad9361_cal_hw_start() is done.
+ *
+ * The caller is expected to wait wait_us before the next call. The first
+ * check is done a bit before the expected duration, the following ones every
+ * sixteenth of it. The expected duration follows the measured ones, taken
+ * halfway between the last two checks, so it also decreases when the
+ * calibrations complete at the first check. The time between the checks is
+ * measured when a time base is available, as the caller may wait longer
+ * than asked, otherwise wait_us is assumed.
+ * @param phy The AD9361 state structure.
+ * @param wait_us The time to wait before the next call [us].
+ * @return 0 if done, -EINPROGRESS if still running, negative error code
+ *         otherwise.
+ */
+static int32_t ad9361_cal_hw_poll(struct ad9361_rf_phy *phy, uint32_t *wait_us)
+{
+	struct ad9361_cal_state *st = &phy->cal_state;
+	uint32_t *expected = ad9361_cal_expected(phy, st->mask);
+	uint32_t prev_us = st->elapsed_us;
+	uint64_t now_ns;
+	int32_t ret;
+
+	if (timestamp_available()) {
+		now_ns = timestamp_ns();
+		st->elapsed_us += (now_ns - st->poll_ns) / 1000;
+		st->poll_ns = now_ns;
+	} else {
+		st->elapsed_us += st->wait_us;
 	}
 
-	ret = ad9361_find_opt(field, ARRAY_SIZE(field), &start);
+	ret = ad9361_spi_read(phy->spi, REG_CALIBRATION_CTRL);
+	if (ret < 0)
+		return ret;
 
-	phy->last_tx_quad_cal_phase = (start + ret / 2) & 0x1F;
+	if (!(ret & st->mask)) {
+		/* Not learned when done at the check right after the start */
+		if (st->wait_us)
+			*expected = (3 * *expected +
+				     (prev_us + st->elapsed_us) / 2) / 4;
+		st->wait_us = 0;
+		*wait_us = 0;
+		return 0;
+	}
 
-#ifdef _DEBUG
-	for (i = 0; i < 64; i++) {
-		printk("%c", (field[i] ? '#' : 'o'));
+	if (st->elapsed_us > AD9361_CAL_TIMEOUT_US) {
+		dev_err(&phy->spi->dev, "Calibration TIMEOUT (0x%"PRIX32", 0x%"PRIX32")",
+			(uint32_t)REG_CALIBRATION_CTRL, st->mask);
+		return -ETIMEDOUT;
 	}
-#ifdef WIN32
-	printk(" RX_NCO_PHASE_OFFSET(%d, 0x%X) \n", phy->last_tx_quad_cal_phase,
-	       phy->last_tx_quad_cal_phase);
-#else
-	printk(" RX_NCO_PHASE_OFFSET(%"PRIu32", 0x%"PRIX32") \n",
-	       phy->last_tx_quad_cal_phase,
-	       phy->last_tx_quad_cal_phase);
-#endif
-#endif
 
-	ret = __ad9361_tx_quad_calib(phy, phy->last_tx_quad_cal_phase, rxnco_word,
-				     decim, NULL);
-	if (ret < 0)
-		return ret;
+	st->wait_us = st->elapsed_us ? *expected / 16 :
+		      *expected - *expected / 8;
+	st->wait_us = max_t(uint32_t, st->wait_us, AD9361_CAL_POLL_MIN_US);
+	*wait_us = st->wait_us;
 
-	return 0;
+	return -EINPROGRESS;
 }
 
 /**
- * Perform a TX quadrature calibration.
+ * Start one TX quadrature calibration run.
  * @param phy The AD9361 state structure.
- * @param bw The bandwidth [Hz].
+ * @param phase The RX NCO phase offset.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t __ad9361_tx_quad_calib_start(struct ad9361_rf_phy *phy,
+		uint32_t phase)
+{
+	struct ad9361_cal_state *st = &phy->cal_state;
+
+	ad9361_spi_write(phy->spi, REG_QUAD_CAL_NCO_FREQ_PHASE_OFFSET,
+			 RX_NCO_FREQ(st->rxnco_word) | RX_NCO_PHASE_OFFSET(phase));
+	ad9361_spi_write(phy->spi, REG_QUAD_CAL_CTRL,
+			 SETTLE_MAIN_ENABLE | DC_OFFSET_ENABLE | QUAD_CAL_SOFT_RESET |
+			 GAIN_ENABLE | PHASE_ENABLE | M_DECIM(st->decim));
+	ad9361_spi_write(phy->spi, REG_QUAD_CAL_CTRL,
+			 SETTLE_MAIN_ENABLE | DC_OFFSET_ENABLE |
+			 GAIN_ENABLE | PHASE_ENABLE | M_DECIM(st->decim));
+
+	return ad9361_cal_hw_start(phy, TX_QUAD_CAL);
+}
+
+/**
+ * Get the convergence status of the last TX quadrature calibration run.
+ * @param phy The AD9361 state structure.
+ * @return The TX1_LO_CONV and TX1_SSB_CONV status bits.
+ */
+static uint8_t ad9361_tx_quad_calib_status(struct ad9361_rf_phy *phy)
+{
+	return ad9361_spi_read(phy->spi,
+			       (phy->pdata->rx1tx1_mode_use_tx_num == 2) ?
+			       REG_QUAD_CAL_STATUS_TX2 : REG_QUAD_CAL_STATUS_TX1) &
+	       (TX1_LO_CONV | TX1_SSB_CONV);
+}
+
+/**
+ * Prepare a TX quadrature calibration.
+ * @param phy The AD9361 state structure.
+ * @param bw_rx The RX bandwidth [Hz].
+ * @param bw_tx The TX bandwidth [Hz].
  * @param rx_phase The optional RX phase value overwrite (set to zero).
  * @return 0 in case of success, negative error code otherwise.
  */
-static int32_t ad9361_tx_quad_calib(struct ad9361_rf_phy *phy,
-				    uint32_t bw_rx, uint32_t bw_tx,
-				    int32_t rx_phase)
+static int32_t ad9361_tx_quad_calib_setup(struct ad9361_rf_phy *phy,
+		uint32_t bw_rx, uint32_t bw_tx,
+		int32_t rx_phase)
 {
+	struct ad9361_cal_state *st = &phy->cal_state;
 	struct spi_desc *spi = phy->spi;
 	uint32_t clktf, clkrf;
 	int32_t txnco_word, rxnco_word, txnco_freq, ret;
-	uint8_t __rx_phase = 0, reg_inv_bits = 0, val, decim;
+	uint8_t __rx_phase = 0, decim;
 	const uint8_t(*tab)[3];
 	uint32_t index_max, i, lpf_tia_mask;
 
@@ -3040,11 +3296,24 @@ static int32_t ad9361_tx_quad_calib(struct ad9361_rf_phy *phy,
 
 	txnco_freq = clktf * (txnco_word + 1) / 32;
 
+	st->rxnco_word = rxnco_word;
+	st->decim = decim;
+	st->rx_phase = __rx_phase;
+	st->txnco_freq = txnco_freq;
+	st->bw_rx = bw_rx;
+	st->bw_tx = bw_tx;
+	st->reg_inv_bits = 0;
+
 	if (txnco_freq > (int64_t)(bw_rx / 4) || txnco_freq > (int64_t)(bw_tx / 4)) {
 		/* Make sure the BW during calibration is wide enough */
 		ret = __ad9361_update_rf_bandwidth(phy, txnco_freq * 8, txnco_freq * 8);
-		if (ret < 0)
-			goto out_restore;
+		if (ret < 0) {
+			/* Restore synthesizer powerdown configuration */
+			if (phy->pdata->lo_powerdown_managed_en &&
+			    (phy->cached_synth_pd[0] & TX_LO_POWER_DOWN))
+				ad9361_synth_lo_powerdown(phy, LO_DONTCARE, LO_DONTCARE);
+			return ret;
+		}
 	}
 
 	if (phy->pdata->rx1rx2_phase_inversion_en ||
@@ -3052,7 +3321,7 @@ static int32_t ad9361_tx_quad_calib(struct ad9361_rf_phy *phy,
 
 		ad9361_spi_writef(spi, REG_PARALLEL_PORT_CONF_2, INVERT_RX2, 0);
 
-		reg_inv_bits = ad9361_spi_read(spi, REG_INVERT_BITS);
+		st->reg_inv_bits = ad9361_spi_read(spi, REG_INVERT_BITS);
 
 		ad9361_spi_write(spi, REG_INVERT_BITS,
 				 INVERT_RX1_RF_DC_CGOUT_WORD |
@@ -3088,89 +3357,193 @@ static int32_t ad9361_tx_quad_calib(struct ad9361_rf_phy *phy,
 	ad9361_spi_write(spi, REG_QUAD_SETTLE_COUNT, 0xF0);
 	ad9361_spi_write(spi, REG_TX_QUAD_LPF_GAIN, 0x00);
 
-	ret = __ad9361_tx_quad_calib(phy, __rx_phase, rxnco_word, decim, &val);
-
-	dev_dbg(dev, "LO leakage: %d Quadrature Calibration: %d : rx_phase %d",
-		!!(val & TX1_LO_CONV), !!(val & TX1_SSB_CONV), __rx_phase);
-
-	/* Calibration failed -> try last phase offset */
-	if (val != (TX1_LO_CONV | TX1_SSB_CONV)) {
-		if (phy->last_tx_quad_cal_phase < 31)
-			ret = __ad9361_tx_quad_calib(phy, phy->last_tx_quad_cal_phase,
-						     rxnco_word, decim, &val);
-	} else {
-		phy->last_tx_quad_cal_phase = __rx_phase;
-	}
+	return 0;
+}
 
-	/* Calibration failed -> loop through all 32 phase offsets */
-	if (val != (TX1_LO_CONV | TX1_SSB_CONV))
-		ret = ad9361_tx_quad_phase_search(phy, rxnco_word, decim);
+/**
+ * Restore the configuration changed by ad9361_tx_quad_calib_setup().
+ * @param phy The AD9361 state structure.
+ * @return None.
+ */
+static void ad9361_tx_quad_calib_finish(struct ad9361_rf_phy *phy)
+{
+	struct ad9361_cal_state *st = &phy->cal_state;
+	struct spi_desc *spi = phy->spi;
 
 	if (phy->pdata->rx1rx2_phase_inversion_en ||
 	    (phy->pdata->port_ctrl.pp_conf[1] & INVERT_RX2)) {
 		ad9361_spi_writef(spi, REG_PARALLEL_PORT_CONF_2, INVERT_RX2, 1);
-		ad9361_spi_write(spi, REG_INVERT_BITS, reg_inv_bits);
+		ad9361_spi_write(spi, REG_INVERT_BITS, st->reg_inv_bits);
 	}
 
-	if (txnco_freq > (int64_t)(bw_rx / 4) || txnco_freq > (int64_t)(bw_tx / 4)) {
+	if (st->txnco_freq > (int64_t)(st->bw_rx / 4) ||
+	    st->txnco_freq > (int64_t)(st->bw_tx / 4)) {
 		__ad9361_update_rf_bandwidth(phy,
 					     phy->current_rx_bw_Hz,
 					     phy->current_tx_bw_Hz);
 	}
 
-out_restore:
 	/* Restore synthesizer powerdown configuration */
 	if (phy->pdata->lo_powerdown_managed_en &&
 	    (phy->cached_synth_pd[0] & TX_LO_POWER_DOWN))
 		ad9361_synth_lo_powerdown(phy, LO_DONTCARE, LO_DONTCARE);
-
-	return ret;
 }
 
 /**
- * Setup RX tracking calibrations.
+ * Advance the TX quadrature calibration after a calibration run completed.
+ *
+ * The calibration is first run with the expected RX NCO phase offset. If it
+ * doesn't converge, it is retried with the last good phase offset and then
+ * all the 32 possible phase offsets are tried.
  * @param phy The AD9361 state structure.
- * @param bbdc_track Set true, will enable the BBDC tracking.
- * @param rfdc_track Set true, will enable the RFDC tracking.
- * @param rxquad_track Set true, will enable the RXQUAD tracking.
- * @return 0 in case of success, negative error code otherwise.
+ * @return 0 when done, -EINPROGRESS if a new calibration run was started,
+ *         negative error code otherwise.
  */
-int32_t ad9361_tracking_control(struct ad9361_rf_phy *phy, bool bbdc_track,
-				bool rfdc_track, bool rxquad_track)
+static int32_t ad9361_tx_quad_calib_step(struct ad9361_rf_phy *phy)
 {
-	struct spi_desc *spi = phy->spi;
-	uint32_t qtrack = 0;
+	struct ad9361_cal_state *st = &phy->cal_state;
+	uint8_t val = 0, conv = TX1_LO_CONV | TX1_SSB_CONV;
+	uint32_t start;
+	int32_t ret;
 
-	dev_dbg(&spi->dev, "%s : bbdc_track=%d, rfdc_track=%d, rxquad_track=%d",
-		__func__, bbdc_track, rfdc_track, rxquad_track);
+	if (st->step != AD9361_CAL_STEP_QUAD_FINAL)
+		val = ad9361_tx_quad_calib_status(phy);
 
-	ad9361_spi_write(spi, REG_CALIBRATION_CONFIG_2,
-			 CALIBRATION_CONFIG2_DFLT | K_EXP_PHASE(0x15));
-	ad9361_spi_write(spi, REG_CALIBRATION_CONFIG_3,
-			 PREVENT_POS_LOOP_GAIN | K_EXP_AMPLITUDE(0x15));
+	switch (st->step) {
+	case AD9361_CAL_STEP_QUAD_FIRST:
+		dev_dbg(dev, "LO leakage: %d Quadrature Calibration: %d : rx_phase %d",
+			!!(val & TX1_LO_CONV), !!(val & TX1_SSB_CONV), st->rx_phase);
 
-	ad9361_spi_write(spi, REG_DC_OFFSET_CONFIG2,
-			 USE_WAIT_COUNTER_FOR_RF_DC_INIT_CAL |
-			 DC_OFFSET_UPDATE(phy->pdata->dc_offset_update_events) |
-			 (bbdc_track ? ENABLE_BB_DC_OFFSET_TRACKING : 0) |
-			 (rfdc_track ? ENABLE_RF_OFFSET_TRACKING : 0));
+		if (val == conv) {
+			phy->last_tx_quad_cal_phase = st->rx_phase;
+			return 0;
+		}
 
-	ad9361_spi_writef(spi, REG_RX_QUAD_GAIN2,
-			  CORRECTION_WORD_DECIMATION_M(~0),
-			  phy->pdata->qec_tracking_slow_mode_en ? 4 : 0);
+		/* Calibration failed -> try last phase offset */
+		if (phy->last_tx_quad_cal_phase < 31) {
+			st->step = AD9361_CAL_STEP_QUAD_RETRY;
+			ret = __ad9361_tx_quad_calib_start(phy,
+							   phy->last_tx_quad_cal_phase);
+			return ret < 0 ? ret : -EINPROGRESS;
+		}
+		break;
+	case AD9361_CAL_STEP_QUAD_RETRY:
+		if (val == conv)
+			return 0;
+		break;
+	case AD9361_CAL_STEP_QUAD_SEARCH:
+		/* Handle 360/0 wrap around */
+		st->field[st->phase] = st->field[st->phase + 32] = !((val & TX1_LO_CONV) &&
+				       (val & TX1_SSB_CONV));
+		if (++st->phase < 32) {
+			ret = __ad9361_tx_quad_calib_start(phy, st->phase);
+			return ret < 0 ? ret : -EINPROGRESS;
+		}
 
-	if (rxquad_track) {
-		if (phy->pdata->rx2tx2)
-			qtrack = ENABLE_TRACKING_MODE_CH1 | ENABLE_TRACKING_MODE_CH2;
-		else
-			qtrack = (phy->pdata->rx1tx1_mode_use_rx_num == 1) ?
-				 ENABLE_TRACKING_MODE_CH1 : ENABLE_TRACKING_MODE_CH2;
-	}
+		ret = ad9361_find_opt(st->field, ARRAY_SIZE(st->field), &start);
+		phy->last_tx_quad_cal_phase = (start + ret / 2) & 0x1F;
 
-	ad9361_spi_write(spi, REG_CALIBRATION_CONFIG_1,
-			 ENABLE_PHASE_CORR | ENABLE_GAIN_CORR |
-			 FREE_RUN_MODE | ENABLE_CORR_WORD_DECIMATION |
-			 qtrack);
+#ifdef _DEBUG
+		for (start = 0; start < 64; start++) {
+			printk("%c", (st->field[start] ? '#' : 'o'));
+		}
+#ifdef WIN32
+		printk(" RX_NCO_PHASE_OFFSET(%d, 0x%X) \n", phy->last_tx_quad_cal_phase,
+		       phy->last_tx_quad_cal_phase);
+#else
+		printk(" RX_NCO_PHASE_OFFSET(%"PRIu32", 0x%"PRIX32") \n",
+		       phy->last_tx_quad_cal_phase,
+		       phy->last_tx_quad_cal_phase);
+#endif
+#endif
+
+		st->step = AD9361_CAL_STEP_QUAD_FINAL;
+		ret = __ad9361_tx_quad_calib_start(phy,
+						   phy->last_tx_quad_cal_phase);
+		return ret < 0 ? ret : -EINPROGRESS;
+	default:
+		return 0;
+	}
+
+	/* Calibration failed -> loop through all 32 phase offsets */
+	dev_dbg(&phy->spi->dev, "%s: phase search", __func__);
+	st->step = AD9361_CAL_STEP_QUAD_SEARCH;
+	st->phase = 0;
+	ret = __ad9361_tx_quad_calib_start(phy, st->phase);
+
+	return ret < 0 ? ret : -EINPROGRESS;
+}
+
+/**
+ * Perform a TX quadrature calibration.
+ * @param phy The AD9361 state structure.
+ * @param bw The bandwidth [Hz].
+ * @param rx_phase The optional RX phase value overwrite (set to zero).
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_tx_quad_calib(struct ad9361_rf_phy *phy,
+				    uint32_t bw_rx, uint32_t bw_tx,
+				    int32_t rx_phase)
+{
+	struct ad9361_cal_state *st = &phy->cal_state;
+	int32_t ret;
+
+	ret = ad9361_tx_quad_calib_setup(phy, bw_rx, bw_tx, rx_phase);
+	if (ret < 0)
+		return ret;
+
+	st->cal = TX_QUAD_CAL;
+	st->restore = false;
+	st->step = AD9361_CAL_STEP_QUAD_FIRST;
+	st->ret = __ad9361_tx_quad_calib_start(phy, st->rx_phase);
+
+	return ad9361_calib_complete(phy);
+}
+
+/**
+ * Setup RX tracking calibrations.
+ * @param phy The AD9361 state structure.
+ * @param bbdc_track Set true, will enable the BBDC tracking.
+ * @param rfdc_track Set true, will enable the RFDC tracking.
+ * @param rxquad_track Set true, will enable the RXQUAD tracking.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_tracking_control(struct ad9361_rf_phy *phy, bool bbdc_track,
+				bool rfdc_track, bool rxquad_track)
+{
+	struct spi_desc *spi = phy->spi;
+	uint32_t qtrack = 0;
+
+	dev_dbg(&spi->dev, "%s : bbdc_track=%d, rfdc_track=%d, rxquad_track=%d",
+		__func__, bbdc_track, rfdc_track, rxquad_track);
+
+	ad9361_spi_write(spi, REG_CALIBRATION_CONFIG_2,
+			 CALIBRATION_CONFIG2_DFLT | K_EXP_PHASE(0x15));
+	ad9361_spi_write(spi, REG_CALIBRATION_CONFIG_3,
+			 PREVENT_POS_LOOP_GAIN | K_EXP_AMPLITUDE(0x15));
+
+	ad9361_spi_write(spi, REG_DC_OFFSET_CONFIG2,
+			 USE_WAIT_COUNTER_FOR_RF_DC_INIT_CAL |
+			 DC_OFFSET_UPDATE(phy->pdata->dc_offset_update_events) |
+			 (bbdc_track ? ENABLE_BB_DC_OFFSET_TRACKING : 0) |
+			 (rfdc_track ? ENABLE_RF_OFFSET_TRACKING : 0));
+
+	ad9361_spi_writef(spi, REG_RX_QUAD_GAIN2,
+			  CORRECTION_WORD_DECIMATION_M(~0),
+			  phy->pdata->qec_tracking_slow_mode_en ? 4 : 0);
+
+	if (rxquad_track) {
+		if (phy->pdata->rx2tx2)
+			qtrack = ENABLE_TRACKING_MODE_CH1 | ENABLE_TRACKING_MODE_CH2;
+		else
+			qtrack = (phy->pdata->rx1tx1_mode_use_rx_num == 1) ?
+				 ENABLE_TRACKING_MODE_CH1 : ENABLE_TRACKING_MODE_CH2;
+	}
+
+	ad9361_spi_write(spi, REG_CALIBRATION_CONFIG_1,
+			 ENABLE_PHASE_CORR | ENABLE_GAIN_CORR |
+			 FREE_RUN_MODE | ENABLE_CORR_WORD_DECIMATION |
+			 qtrack);
 
 	return 0;
 }
@@ -3270,6 +3643,8 @@ static int32_t ad9361_trx_ext_lo_control(struct ad9361_rf_phy *phy,
 					RX_LO_GEN_POWER_MODE(val));
 	}
 
+	phy->rfpll_cache.div_valid = false;
+
 	return ret;
 }
 
@@ -4425,6 +4800,9 @@ int32_t ad9361_set_trx_clock_chain(struct ad9361_rf_phy *phy,
 	if (!rx_path_clks || !tx_path_clks)
 		return -EINVAL;
 
+	/* Calibrations depend on the clock rates */
+	ad9361_cal_cache_flush(phy);
+
 	dev_dbg(&phy->spi->dev,
 		"%s: %"PRIu32" %"PRIu32" %"PRIu32" %"PRIu32" %"PRIu32" %"PRIu32,
 		__func__, rx_path_clks[BBPLL_FREQ], rx_path_clks[ADC_FREQ],
@@ -4470,11 +4848,13 @@ int32_t ad9361_set_trx_clock_chain(struct ad9361_rf_phy *phy,
 	if (phy->rx_fir_dec == 1 || phy->bypass_rx_fir) {
 		ad9361_spi_writef(phy->spi, REG_RX_ENABLE_FILTER_CTRL,
 				  RX_FIR_ENABLE_DECIMATION(~0), !phy->bypass_rx_fir);
+		clk_invalidate(phy, BIT(RX_SAMPL_CLK));
 	}
 
 	if (phy->tx_fir_int == 1 || phy->bypass_tx_fir) {
 		ad9361_spi_writef(phy->spi, REG_TX_ENABLE_FILTER_CTRL,
 				  TX_FIR_ENABLE_INTERPOLATION(~0), !phy->bypass_tx_fir);
+		clk_invalidate(phy, BIT(TX_SAMPL_CLK));
 	}
 
 	/* The FIR filter once enabled causes the interface timing to change.
@@ -4923,6 +5303,7 @@ static int32_t ad9361_fastlock_prepare(struct ad9361_rf_phy *phy, bool tx,
 		ad9361_spi_writef(phy->spi, REG_RX_FORCE_VCO_TUNE_1 + offs, FORCE_VCO_TUNE, 1);
 		ad9361_spi_writef(phy->spi, REG_RX_FORCE_ALC + offs, FORCE_ALC_ENABLE, 0);
 		ad9361_spi_writef(phy->spi, REG_RX_FORCE_VCO_TUNE_1 + offs, FORCE_VCO_TUNE, 0);
+		ad9361_rfpll_shadow_flush(phy);
 
 		ad9361_trx_vco_cal_control(phy, tx, true);
 		ad9361_spi_writef(phy->spi, REG_ENSM_CONFIG_2, ready_mask, 0);
@@ -5084,6 +5465,7 @@ void ad9361_clear_state(struct ad9361_rf_phy *phy)
 	phy->curr_ensm_state = 0;
 	phy->auto_cal_en = false;
 	phy->last_tx_quad_cal_freq = 0;
+	phy->tx_quad_cal_pending = false;
 	phy->flags = 0;
 	phy->current_rx_bw_Hz = 0;
 	phy->current_tx_bw_Hz = 0;
@@ -5125,11 +5507,204 @@ static uint32_t ad9361_ref_div_sel(uint32_t refin_Hz, uint32_t max)
 }
 
 /**
- * Setup the AD9361 device.
+ * Invalidate all the entries of the calibration cache.
+ * @param phy The AD9361 state structure.
+ * @return None.
+ */
+void ad9361_cal_cache_flush(struct ad9361_rf_phy *phy)
+{
+	uint32_t i;
+
+	for (i = 0; i < AD9361_CAL_CACHE_SIZE; i++)
+		phy->cal_cache.entry[i].valid = false;
+}
+
+/**
+ * Find the calibration cache entry matching a TX LO frequency.
+ *
+ * An entry matches when it was calibrated with the current RF bandwidths,
+ * within cal_threshold_freq of the LO and within temp_threshold of the
+ * current temperature. The closest match in frequency is returned.
+ * @param phy The AD9361 state structure.
+ * @param freq The TX LO frequency [Hz].
+ * @param temp The device temperature [mdegC].
+ * @return The matching entry, NULL if there is none.
+ */
+static struct ad9361_cal_cache_entry *ad9361_cal_cache_find(
+	struct ad9361_rf_phy *phy, uint64_t freq, int32_t temp)
+{
+	struct ad9361_cal_cache *cc = &phy->cal_cache;
+	struct ad9361_cal_cache_entry *e, *best = NULL;
+	uint64_t diff, best_diff = 0;
+	int32_t drift;
+	uint32_t i;
+
+	for (i = 0; i < AD9361_CAL_CACHE_SIZE; i++) {
+		e = &cc->entry[i];
+		if (!e->valid || e->rx_bw != phy->current_rx_bw_Hz ||
+		    e->tx_bw != phy->current_tx_bw_Hz)
+			continue;
+
+		diff = diff_abs(e->lo_freq, freq);
+		if (diff > phy->cal_threshold_freq)
+			continue;
+
+		drift = temp - e->temp;
+		if (abs(drift) > cc->temp_threshold)
+			continue;
+
+		if (!best || diff < best_diff) {
+			best = e;
+			best_diff = diff;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * Save the TX quadrature calibration results in the calibration cache.
+ *
+ * The entry of a previous calibration for the same LO range and RF bandwidths
+ * is replaced, otherwise a free or the least recently used entry is taken.
  * @param phy The AD9361 state structure.
+ * @param freq The TX LO frequency [Hz].
+ * @param temp The device temperature [mdegC].
  * @return 0 in case of success, negative error code otherwise.
  */
-int32_t ad9361_setup(struct ad9361_rf_phy *phy)
+static int32_t ad9361_cal_cache_store(struct ad9361_rf_phy *phy,
+				      uint64_t freq, int32_t temp)
+{
+	struct ad9361_cal_cache *cc = &phy->cal_cache;
+	struct ad9361_cal_cache_entry *e, *slot = NULL;
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < AD9361_CAL_CACHE_SIZE; i++) {
+		e = &cc->entry[i];
+		if (e->valid && e->rx_bw == phy->current_rx_bw_Hz &&
+		    e->tx_bw == phy->current_tx_bw_Hz &&
+		    diff_abs(e->lo_freq, freq) <= phy->cal_threshold_freq) {
+			slot = e;
+			break;
+		}
+		if (!slot || (slot->valid &&
+			      (!e->valid || e->last_use < slot->last_use)))
+			slot = e;
+	}
+
+	slot->valid = false;
+	ret = ad9361_spi_readm(phy->spi, REG_TX2_OUT_2_OFFSET_Q,
+			       &slot->regs[0], MAX_MBYTE_SPI);
+	if (ret < 0)
+		return ret;
+	ret = ad9361_spi_readm(phy->spi, REG_TX2_OUT_1_OFFSET_Q,
+			       &slot->regs[MAX_MBYTE_SPI], MAX_MBYTE_SPI);
+	if (ret < 0)
+		return ret;
+
+	slot->lo_freq = freq;
+	slot->rx_bw = phy->current_rx_bw_Hz;
+	slot->tx_bw = phy->current_tx_bw_Hz;
+	slot->temp = temp;
+	slot->phase = phy->last_tx_quad_cal_phase;
+	slot->last_use = ++cc->counter;
+	slot->valid = true;
+
+	return 0;
+}
+
+/**
+ * Restore the TX quadrature calibration results of a cache entry.
+ * @param phy The AD9361 state structure.
+ * @param e The calibration cache entry.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_cal_cache_apply(struct ad9361_rf_phy *phy,
+				      struct ad9361_cal_cache_entry *e)
+{
+	uint8_t msgs[2 * (2 + MAX_MBYTE_SPI)];
+	uint32_t len;
+	int32_t ret;
+
+	len = ad9361_spi_batch_add(msgs, 0, REG_TX2_OUT_2_OFFSET_Q,
+				   &e->regs[0], MAX_MBYTE_SPI);
+	len = ad9361_spi_batch_add(msgs, len, REG_TX2_OUT_1_OFFSET_Q,
+				   &e->regs[MAX_MBYTE_SPI], MAX_MBYTE_SPI);
+	ret = ad9361_spi_write_batch(phy->spi, msgs, len);
+	if (ret < 0)
+		return ret;
+
+	phy->last_tx_quad_cal_phase = e->phase;
+	e->last_use = ++phy->cal_cache.counter;
+
+	return 0;
+}
+
+/**
+ * Perform a TX quadrature calibration, or restore the results of a previous
+ * one for the same LO range, RF bandwidths and temperature.
+ * @param phy The AD9361 state structure.
+ * @param freq The TX LO frequency [Hz].
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_tx_quad_calib_cached(struct ad9361_rf_phy *phy,
+		uint64_t freq)
+{
+	struct ad9361_cal_cache *cc = &phy->cal_cache;
+	struct ad9361_cal_cache_entry *e;
+	int32_t temp = 0, ret;
+
+	if (cc->en) {
+		temp = ad9361_get_temp(phy);
+		e = ad9361_cal_cache_find(phy, freq, temp);
+		if (e) {
+			cc->hits++;
+			return ad9361_cal_cache_apply(phy, e);
+		}
+		cc->misses++;
+	}
+
+	ret = ad9361_do_calib_run(phy, TX_QUAD_CAL, -1);
+	if (ret < 0 || !cc->en)
+		return ret;
+
+	return ad9361_cal_cache_store(phy, freq, temp);
+}
+
+/**
+ * Run the TX quadrature calibration after a TX LO frequency change.
+ *
+ * The frequency is only recorded once calibrated, so a failed calibration
+ * is retried on the next change. When another calibration is in progress,
+ * the calibration is run by ad9361_calib_complete().
+ * @param phy The AD9361 state structure.
+ * @param freq The TX LO frequency [Hz].
+ * @return None.
+ */
+static void ad9361_tx_quad_calib_lo(struct ad9361_rf_phy *phy, uint64_t freq)
+{
+	int32_t ret;
+
+	ret = ad9361_tx_quad_calib_cached(phy, freq);
+	if (ret == -EBUSY) {
+		phy->tx_quad_cal_pending = true;
+		return;
+	}
+	if (ret < 0) {
+		dev_err(&phy->spi->dev, "%s: TX QUAD cal failed", __func__);
+		return;
+	}
+
+	phy->last_tx_quad_cal_freq = freq;
+}
+
+/**
+ * Configure the AD9361 device up to the initial calibrations.
+ * @param phy The AD9361 state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_setup_config(struct ad9361_rf_phy *phy)
 {
 	uint32_t refin_Hz, ref_freq, bbpll_freq;
 	struct spi_desc *spi = phy->spi;
@@ -5366,19 +5941,120 @@ int32_t ad9361_setup(struct ad9361_rf_phy *phy)
 	if (ret < 0)
 		return ret;
 
-	ret = ad9361_bb_dc_offset_calib(phy);
+	return 0;
+}
+
+/**
+ * Start one of the initial calibrations.
+ * @param phy The AD9361 state structure.
+ * @param cal The calibration (BBDC_CAL, RFDC_CAL, TX_QUAD_CAL).
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_setup_calib_next(struct ad9361_rf_phy *phy, uint32_t cal)
+{
+	struct ad9361_cal_state *st = &phy->cal_state;
+	struct ad9361_phy_platform_data *pd = phy->pdata;
+	int32_t ret;
+
+	st->cal = cal;
+	st->restore = false;
+	st->step = AD9361_CAL_STEP_RUN;
+
+	switch (cal) {
+	case BBDC_CAL:
+		ad9361_bb_dc_offset_setup(phy);
+		ret = ad9361_cal_hw_start(phy, BBDC_CAL);
+		break;
+	case RFDC_CAL:
+		ad9361_rf_dc_offset_setup(phy,
+					  ad9361_from_clk(clk_get_rate(phy, phy->ref_clk_scale[RX_RFPLL])));
+		ret = ad9361_cal_hw_start(phy, RFDC_CAL);
+		break;
+	default:
+		phy->current_rx_bw_Hz = pd->rf_rx_bandwidth_Hz;
+		phy->current_tx_bw_Hz = pd->rf_tx_bandwidth_Hz;
+		phy->last_tx_quad_cal_phase = ~0;
+		ret = ad9361_tx_quad_calib_setup(phy, pd->rf_rx_bandwidth_Hz / 2,
+						 pd->rf_tx_bandwidth_Hz / 2, -1);
+		if (ret < 0)
+			break;
+		st->step = AD9361_CAL_STEP_QUAD_FIRST;
+		ret = __ad9361_tx_quad_calib_start(phy, st->rx_phase);
+		break;
+	}
+
+	st->ret = ret;
 	if (ret < 0)
+		st->step = AD9361_CAL_STEP_IDLE;
+
+	return ret;
+}
+
+/**
+ * Start the initial calibrations of the AD9361 device.
+ *
+ * The BB DC offset, RF DC offset and TX quadrature calibrations are run back
+ * to back by ad9361_setup_calib_poll(), so that other devices can be
+ * configured while they are running.
+ * @param phy The AD9361 state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_setup_calib_start(struct ad9361_rf_phy *phy)
+{
+	if (phy->cal_state.step != AD9361_CAL_STEP_IDLE)
+		return -EBUSY;
+
+	return ad9361_setup_calib_next(phy, BBDC_CAL);
+}
+
+/**
+ * Advance the initial calibrations started with ad9361_setup_calib_start().
+ * @param phy The AD9361 state structure.
+ * @param wait_us The suggested time to wait before the next call [us].
+ * @return 0 when all the calibrations are done, -EINPROGRESS if they are
+ *         still running, negative error code otherwise.
+ */
+int32_t ad9361_setup_calib_poll(struct ad9361_rf_phy *phy, uint32_t *wait_us)
+{
+	struct ad9361_cal_state *st = &phy->cal_state;
+	int32_t ret;
+
+	ret = ad9361_calib_poll(phy, wait_us);
+	if (ret == -EINPROGRESS)
 		return ret;
 
-	ret = ad9361_rf_dc_offset_calib(phy,
-					ad9361_from_clk(clk_get_rate(phy, phy->ref_clk_scale[RX_RFPLL])));
+	st->step = AD9361_CAL_STEP_IDLE;
 	if (ret < 0)
 		return ret;
 
-	phy->current_rx_bw_Hz = pd->rf_rx_bandwidth_Hz;
-	phy->current_tx_bw_Hz = pd->rf_tx_bandwidth_Hz;
-	phy->last_tx_quad_cal_phase = ~0;
-	ret = ad9361_tx_quad_calib(phy, real_rx_bandwidth, real_tx_bandwidth, -1);
+	switch (st->cal) {
+	case BBDC_CAL:
+		ret = ad9361_setup_calib_next(phy, RFDC_CAL);
+		break;
+	case RFDC_CAL:
+		ret = ad9361_setup_calib_next(phy, TX_QUAD_CAL);
+		break;
+	default:
+		return 0;
+	}
+
+	return ret < 0 ? ret : -EINPROGRESS;
+}
+
+/**
+ * Complete the AD9361 device setup after the initial calibrations.
+ * @param phy The AD9361 state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_setup_finish(struct ad9361_rf_phy *phy)
+{
+	struct spi_desc *spi = phy->spi;
+	struct ad9361_phy_platform_data *pd = phy->pdata;
+	int32_t ret;
+
+	ad9361_cal_cache_flush(phy);
+	ret = ad9361_cal_cache_store(phy, pd->tx_synth_freq,
+				     ad9361_get_temp(phy));
 	if (ret < 0)
 		return ret;
 
@@ -5432,53 +6108,892 @@ int32_t ad9361_setup(struct ad9361_rf_phy *phy)
 
 	phy->auto_cal_en = true;
 	phy->cal_threshold_freq = 100000000ULL; /* 100 MHz */
+	phy->cal_cache.en = true;
+	phy->cal_cache.temp_threshold = 10000; /* 10 degC */
 
 	return 0;
-
 }
 
 /**
- * Perform the selected calibration
+ * Setup the AD9361 device.
  * @param phy The AD9361 state structure.
- * @param cal The selected calibration.
- * @param arg The argument of the calibration.
  * @return 0 in case of success, negative error code otherwise.
  */
-int32_t ad9361_do_calib_run(struct ad9361_rf_phy *phy, uint32_t cal,
-			    int32_t arg)
+int32_t ad9361_setup(struct ad9361_rf_phy *phy)
 {
+	uint32_t wait_us;
 	int32_t ret;
 
-	dev_dbg(&phy->spi->dev, "%s: CAL %"PRIu32" ARG %"PRId32, __func__, cal, arg);
-
-	ret = ad9361_tracking_control(phy, false, false, false);
+	ret = ad9361_setup_config(phy);
 	if (ret < 0)
 		return ret;
 
-	ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
-
-	switch (cal) {
-	case TX_QUAD_CAL:
-		ret = ad9361_tx_quad_calib(phy, phy->current_rx_bw_Hz / 2,
-					   phy->current_tx_bw_Hz / 2, arg);
-		break;
-	case RFDC_CAL:
-		ret = ad9361_rf_dc_offset_calib(phy,
-						ad9361_from_clk(clk_get_rate(phy, phy->ref_clk_scale[RX_RFPLL])));
-		break;
-	default:
-		ret = -EINVAL;
-		break;
-	}
+	ret = ad9361_setup_calib_start(phy);
+	if (ret < 0)
+		return ret;
 
-	ret = ad9361_tracking_control(phy, phy->bbdc_track_en,
-				      phy->rfdc_track_en, phy->quad_track_en);
-	ad9361_ensm_restore_prev_state(phy);
+	while ((ret = ad9361_setup_calib_poll(phy, &wait_us)) == -EINPROGRESS)
+		udelay(wait_us);
+	if (ret < 0)
+		return ret;
 
-	return ret;
+	return ad9361_setup_finish(phy);
 }
 
-/**
+/*
+ * Warm boot snapshot layout (little endian):
+ *  0   magic
+ *  4   version (16 bit), product ID (8 bit), flags (8 bit)
+ *  8   reference clock rate
+ *  12  total size
+ *  16  CRC-32 of the bytes following the header
+ *  20  driver state words
+ *      register image, in the order of the ranges below, each range stored
+ *      from its highest address down (as sent in a SPI burst)
+ *      TX FIR: number of taps, config, TX1 and TX2 coefficients (16 bit)
+ *      RX FIR: number of taps, config, RX1 and RX2 coefficients (16 bit)
+ */
+#define AD9361_SNAPSHOT_RX2TX2		(1 << 0)
+#define AD9361_SNAPSHOT_FDD		(1 << 1)
+#define AD9361_SNAPSHOT_STATE_WORDS	19
+
+struct ad9361_snapshot_range {
+	uint16_t	reg;
+	uint8_t		num;
+};
+
+/* Restored first, followed by the BBPLL calibration */
+static const struct ad9361_snapshot_range ad9361_snapshot_clk_regs[] = {
+	{REG_CTRL, 1},
+	{REG_BANDGAP_CONFIG0, 1},
+	{REG_BANDGAP_CONFIG1, 1},
+	{REG_REF_DIVIDE_CONFIG_1, 2},
+	{REG_DCXO_COARSE_TUNE, 4},
+	{REG_CLOCK_ENABLE, 2},
+	{REG_REFERENCE_CLOCK_CYCLES, 5},
+	{REG_FRACT_BB_FREQ_WORD_1, 4},
+	{REG_CLOCK_CTRL, 7},
+	{REG_SDM_CTRL, 1},
+};
+
+/*
+ * Status, read back and self clearing registers as well as the indirectly
+ * accessed tables (FIR, gain, Gm) are not part of the image.
+ */
+static const struct ad9361_snapshot_range ad9361_snapshot_regs[] = {
+	{REG_MULTICHIP_SYNC_AND_TX_MON_CTRL, 7},
+	{REG_TEMP_OFFSET, 1},
+	{REG_TEMP_SENSE2, 1},
+	{REG_TEMP_SENSOR_CONFIG, 1},
+	{REG_PARALLEL_PORT_CONF_1, 4},
+	{REG_ENSM_CONFIG_2, 1},
+	{REG_AUXDAC_1_WORD, 6},
+	{REG_AUTO_GPO, 20},
+	{REG_CTRL_OUTPUT_POINTER, 2},
+	{REG_RX_SYNTH_POWER_DOWN_OVERRIDE, 9},
+	{REG_TX_MON_LOW_GAIN, 4},
+	{REG_TPM_MODE_ENABLE, 4},
+	{REG_TX1_ATTEN_0, 7},
+	{REG_TX2_DIG_ATTEN, 1},
+	{REG_TX1_SYMBOL_ATTEN, 3},
+	{REG_TX1_OUT_1_PHASE_CORR, 16},
+	{REG_TX_FORCE_BITS, 8},
+	{REG_QUAD_CAL_COUNT, 6},
+	{REG_TXDAC_VDS_I, 4},
+	{REG_TXBBF_OPAMP_A, 13},
+	{REG_CONFIG0, 4},
+	{REG_TX_BBF_TUNE_DIVIDER, 2},
+	{REG_RX_FILTER_GAIN, 1},
+	{REG_AGC_CONFIG_1, 5},
+	{REG_DIGITAL_GAIN, 15},
+	{REG_FAST_CONFIG_1, 12},
+	{REG_AGC_INNER_LOW_THRESH, 6},
+	{REG_DIGITAL_SAT_COUNTER, 3},
+	{REG_EXT_LNA_HIGH_GAIN, 2},
+	{REG_CONFIG, 1},
+	{REG_MAX_MIXER_CALIBRATION_GAIN_INDEX, 5},
+	{REG_MEASURE_DURATION_01, 14},
+	{REG_RX_QUAD_CAL_LEVEL, 27},
+	{REG_WAIT_COUNT, 5},
+	{REG_DC_OFFSET_CONFIG2, 3},
+	{REG_BB_DC_OFFSET_SHIFT, 5},
+	{REG_RX1_BB_DC_WORD_I_MSB, 12},
+	{REG_RX_DIFF_LNA_FORCE, 4},
+	{REG_RX_MIX_GM_CONFIG, 5},
+	{REG_INPUT_A_MSBS, 11},
+	{REG_RX_MIX_LO_CM, 3},
+	{REG_RX_TIA_CONFIG, 27},
+	{REG_RX_BBF_TUNE_DIVIDE, 5},
+	{REG_FB_DAC_CLK_DELAY1, 37},
+	{REG_RX_FAST_LOCK_SETUP, 2},
+	{REG_TX_FAST_LOCK_SETUP, 2},
+	{REG_BIST_CONFIG, 3},
+	{REG_DAC_TEST_0, 3},
+};
+
+/*
+ * Restored last. The bursts are decrementing, so the integer byte of each
+ * synthesizer is written after its fractional word and triggers the VCO
+ * calibration.
+ */
+static const struct ad9361_snapshot_range ad9361_snapshot_synth_regs[] = {
+	{REG_RX_LO_GEN_POWER_MODE, 1},
+	{REG_TX_LO_GEN_POWER_MODE, 1},
+	{REG_RX_VCO_LDO, 10},
+	{REG_RX_VCO_CAL_REF, 2},
+	{REG_RX_PFD_CONFIG, 19},
+	{REG_TX_VCO_LDO, 10},
+	{REG_TX_VCO_CAL_REF, 2},
+	{REG_TX_PFD_CONFIG, 20},
+};
+
+/**
+ * Store a 32 bit little endian value.
+ * @param buf The destination buffer.
+ * @param val The value.
+ * @return None.
+ */
+static void ad9361_snapshot_put(uint8_t *buf, uint32_t val)
+{
+	buf[0] = val;
+	buf[1] = val >> 8;
+	buf[2] = val >> 16;
+	buf[3] = val >> 24;
+}
+
+/**
+ * Load a 32 bit little endian value.
+ * @param buf The source buffer.
+ * @return The value.
+ */
+static uint32_t ad9361_snapshot_get(const uint8_t *buf)
+{
+	return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+/**
+ * Compute the CRC-32 (IEEE 802.3) of a buffer.
+ * @param buf The buffer.
+ * @param len The buffer length.
+ * @return The CRC value.
+ */
+static uint32_t ad9361_snapshot_crc(const uint8_t *buf, uint32_t len)
+{
+	uint32_t crc = ~0;
+	int32_t i;
+
+	while (len--) {
+		crc ^= *buf++;
+		for (i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+	}
+
+	return ~crc;
+}
+
+/**
+ * Get the size of the register image.
+ * @return The number of registers in the image.
+ */
+static uint32_t ad9361_snapshot_regs_size(void)
+{
+	uint32_t i, size = 0;
+
+	for (i = 0; i < ARRAY_SIZE(ad9361_snapshot_clk_regs); i++)
+		size += ad9361_snapshot_clk_regs[i].num;
+	for (i = 0; i < ARRAY_SIZE(ad9361_snapshot_regs); i++)
+		size += ad9361_snapshot_regs[i].num;
+	for (i = 0; i < ARRAY_SIZE(ad9361_snapshot_synth_regs); i++)
+		size += ad9361_snapshot_synth_regs[i].num;
+
+	return size;
+}
+
+/**
+ * Read a list of register ranges into the snapshot.
+ * @param spi
+ * @param range The register ranges.
+ * @param num The number of ranges.
+ * @param buf The snapshot buffer.
+ * @param pos The current position in the snapshot, updated on return.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_snapshot_read_regs(struct spi_desc *spi,
+		const struct ad9361_snapshot_range *range, uint32_t num,
+		uint8_t *buf, uint32_t *pos)
+{
+	uint32_t i, reg, cnt;
+	int32_t ret;
+
+	for (i = 0; i < num; i++) {
+		reg = range[i].reg + range[i].num - 1;
+		cnt = range[i].num;
+		while (cnt) {
+			ret = ad9361_spi_readm(spi, reg, &buf[*pos],
+					       min_t(uint32_t, cnt, MAX_MBYTE_SPI));
+			if (ret < 0)
+				return ret;
+			ret = min_t(uint32_t, cnt, MAX_MBYTE_SPI);
+			reg -= ret;
+			cnt -= ret;
+			*pos += ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Write a list of register ranges from the snapshot.
+ * @param spi
+ * @param range The register ranges.
+ * @param num The number of ranges.
+ * @param buf The snapshot buffer.
+ * @param pos The current position in the snapshot, updated on return.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_snapshot_write_regs(struct spi_desc *spi,
+		const struct ad9361_snapshot_range *range, uint32_t num,
+		const uint8_t *buf, uint32_t *pos)
+{
+	uint8_t msgs[2 + MAX_MBYTE_SPI];
+	uint32_t i, reg, cnt, len;
+	int32_t ret;
+
+	for (i = 0; i < num; i++) {
+		reg = range[i].reg + range[i].num - 1;
+		cnt = range[i].num;
+		while (cnt) {
+			len = min_t(uint32_t, cnt, MAX_MBYTE_SPI);
+			ret = ad9361_spi_write_batch(spi, msgs,
+						     ad9361_spi_batch_add(msgs, 0, reg,
+								     &buf[*pos], len));
+			if (ret < 0)
+				return ret;
+			reg -= len;
+			cnt -= len;
+			*pos += len;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Read the TX or RX FIR filter coefficients into the snapshot.
+ * @param phy The AD9361 state structure.
+ * @param rx Set to true for the RX FIR filter.
+ * @param buf The snapshot buffer.
+ * @param pos The current position in the snapshot, updated on return.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_snapshot_read_fir(struct ad9361_rf_phy *phy, bool rx,
+					uint8_t *buf, uint32_t *pos)
+{
+	struct spi_desc *spi = phy->spi;
+	uint32_t val, offs = 0, gain = 0, conf, sel, ntaps;
+	int32_t ret, lsb, msb;
+
+	ntaps = rx ? phy->rx_fir_ntaps : phy->tx_fir_ntaps;
+	if (rx)
+		offs = REG_RX_FILTER_COEF_ADDR - REG_TX_FILTER_COEF_ADDR;
+
+	ret = ad9361_spi_read(spi, REG_TX_FILTER_CONF + offs);
+	if (ret < 0)
+		return ret;
+	conf = ret;
+	buf[(*pos)++] = ntaps;
+	buf[(*pos)++] = conf;
+	if (!ntaps)
+		return 0;
+
+	ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
+
+	if (rx) {
+		ret = ad9361_spi_read(spi, REG_RX_FILTER_GAIN);
+		if (ret < 0)
+			goto out;
+		gain = ret;
+		ad9361_spi_write(spi, REG_RX_FILTER_GAIN, 0);
+	}
+
+	for (sel = 1; sel <= 2; sel++) {
+		ret = ad9361_spi_write(spi, REG_TX_FILTER_CONF + offs,
+				       FIR_NUM_TAPS(ntaps / 16 - 1) |
+				       FIR_SELECT(sel) | FIR_START_CLK);
+		if (ret < 0)
+			goto out_restore;
+		for (val = 0; val < ntaps; val++) {
+			ret = ad9361_spi_write(spi, REG_TX_FILTER_COEF_ADDR + offs, val);
+			if (ret < 0)
+				goto out_restore;
+			lsb = ad9361_spi_read(spi, REG_TX_FILTER_COEF_READ_DATA_1 + offs);
+			msb = ad9361_spi_read(spi, REG_TX_FILTER_COEF_READ_DATA_2 + offs);
+			if (lsb < 0 || msb < 0) {
+				ret = (lsb < 0) ? lsb : msb;
+				goto out_restore;
+			}
+			buf[(*pos)++] = lsb;
+			buf[(*pos)++] = msb;
+		}
+	}
+
+	ret = 0;
+
+out_restore:
+	if (rx)
+		ad9361_spi_write(spi, REG_RX_FILTER_GAIN, gain);
+
+	ad9361_spi_write(spi, REG_TX_FILTER_CONF + offs, conf);
+out:
+	ad9361_ensm_restore_prev_state(phy);
+
+	return ret;
+}
+
+/**
+ * Load the TX or RX FIR filter coefficients from the snapshot.
+ *
+ * Identical channel coefficients are written to both channels at once.
+ * @param phy The AD9361 state structure.
+ * @param rx Set to true for the RX FIR filter.
+ * @param dec The FIR interpolation/decimation.
+ * @param buf The snapshot buffer.
+ * @param size The snapshot size.
+ * @param pos The current position in the snapshot, updated on return.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_snapshot_write_fir(struct ad9361_rf_phy *phy, bool rx,
+		uint32_t dec, const uint8_t *buf, uint32_t size, uint32_t *pos)
+{
+	struct spi_desc *spi = phy->spi;
+	uint32_t offs = 0, conf, fir_conf, fir_enable, reg, mask;
+	uint32_t sel, cnt, ntaps;
+	const uint8_t *coef;
+	int32_t ret;
+
+	if (*pos + 2 > size)
+		return -EINVAL;
+
+	ntaps = buf[(*pos)++];
+	conf = buf[(*pos)++];
+	if (!ntaps)
+		return 0;
+
+	if (ntaps > 128 || ntaps % 16 || *pos + 4 * ntaps > size)
+		return -EINVAL;
+
+	coef = &buf[*pos];
+	*pos += 4 * ntaps;
+
+	if (rx) {
+		offs = REG_RX_FILTER_COEF_ADDR - REG_TX_FILTER_COEF_ADDR;
+		reg = REG_RX_ENABLE_FILTER_CTRL;
+		mask = RX_FIR_ENABLE_DECIMATION(~0);
+		fir_conf = 0;
+	} else {
+		reg = REG_TX_ENABLE_FILTER_CTRL;
+		mask = TX_FIR_ENABLE_INTERPOLATION(~0);
+		fir_conf = conf & TX_FIR_GAIN_6DB;
+	}
+
+	fir_enable = ad9361_spi_readf(spi, reg, mask);
+	ad9361_spi_writef(spi, reg, mask, (dec == 4) ? 3 : dec);
+
+	fir_conf |= FIR_NUM_TAPS(ntaps / 16 - 1) | FIR_START_CLK;
+
+	if (!memcmp(coef, coef + 2 * ntaps, 2 * ntaps)) {
+		sel = 3;
+		cnt = 1;
+	} else {
+		sel = 1;
+		cnt = 2;
+	}
+
+	for (; cnt > 0; cnt--, sel++, coef += 2 * ntaps) {
+		ad9361_spi_write(spi, REG_TX_FILTER_CONF + offs,
+				 fir_conf | FIR_SELECT(sel));
+		ret = ad9361_fir_write_taps(spi, offs, fir_conf | FIR_SELECT(sel),
+					    ntaps, coef);
+		if (ret < 0)
+			return ret;
+	}
+
+	ad9361_spi_write(spi, REG_TX_FILTER_CONF + offs, conf);
+	ad9361_spi_writef(spi, reg, mask, fir_enable);
+
+	return 0;
+}
+
+/**
+ * Save the device configuration for a later warm boot.
+ *
+ * The snapshot includes the register configuration, the FIR filter
+ * coefficients and the driver state. The gain tables are reloaded from the
+ * driver tables on restore.
+ * @param phy The AD9361 state structure.
+ * @param buf The snapshot, allocated by this function. Release it with free().
+ * @param size The snapshot size.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_snapshot_save(struct ad9361_rf_phy *phy, uint8_t **buf,
+			     uint32_t *size)
+{
+	uint32_t state[AD9361_SNAPSHOT_STATE_WORDS];
+	uint32_t i, len, pos;
+	uint8_t *snap;
+	int32_t ret;
+
+	len = AD9361_SNAPSHOT_HDR_SIZE + sizeof(state) +
+	      ad9361_snapshot_regs_size() +
+	      4 + 4 * phy->tx_fir_ntaps + 4 * phy->rx_fir_ntaps;
+
+	snap = malloc(len);
+	if (!snap)
+		return -ENOMEM;
+
+	i = 0;
+	state[i++] = phy->current_rx_bw_Hz;
+	state[i++] = phy->current_tx_bw_Hz;
+	state[i++] = phy->rxbbf_div;
+	state[i++] = phy->rate_governor;
+	state[i++] = phy->cached_rx_rfpll_div | (phy->cached_tx_rfpll_div << 8) |
+		     (phy->cached_synth_pd[0] << 16) |
+		     ((uint32_t)phy->cached_synth_pd[1] << 24);
+	state[i++] = phy->last_tx_quad_cal_freq;
+	state[i++] = phy->last_tx_quad_cal_freq >> 32;
+	state[i++] = phy->last_tx_quad_cal_phase;
+	state[i++] = phy->current_tx_lo_freq;
+	state[i++] = phy->current_tx_lo_freq >> 32;
+	state[i++] = phy->current_rx_lo_freq;
+	state[i++] = phy->current_rx_lo_freq >> 32;
+	state[i++] = phy->tx_fir_int | (phy->tx_fir_ntaps << 8) |
+		     (phy->rx_fir_dec << 16) | ((uint32_t)phy->rx_fir_ntaps << 24);
+	state[i++] = phy->agc_mode[0] | (phy->agc_mode[1] << 8);
+	state[i++] = phy->current_tx_use_tdd_table |
+		     (phy->current_rx_use_tdd_table << 1) |
+		     (phy->bypass_rx_fir << 2) | (phy->bypass_tx_fir << 3) |
+		     (phy->rx_eq_2tx << 4) | (phy->rfdc_track_en << 5) |
+		     (phy->bbdc_track_en << 6) | (phy->quad_track_en << 7) |
+		     (phy->txmon_tdd_en << 8) | (phy->bbpll_initialized << 9);
+	state[i++] = phy->auxdac1_value | (phy->auxdac2_value << 16);
+	state[i++] = phy->tx1_atten_cached;
+	state[i++] = phy->tx2_atten_cached;
+	state[i++] = phy->flags;
+
+	pos = AD9361_SNAPSHOT_HDR_SIZE;
+	for (i = 0; i < AD9361_SNAPSHOT_STATE_WORDS; i++, pos += 4)
+		ad9361_snapshot_put(&snap[pos], state[i]);
+
+	ret = ad9361_snapshot_read_regs(phy->spi, ad9361_snapshot_clk_regs,
+					ARRAY_SIZE(ad9361_snapshot_clk_regs),
+					snap, &pos);
+	if (ret < 0)
+		goto out;
+	ret = ad9361_snapshot_read_regs(phy->spi, ad9361_snapshot_regs,
+					ARRAY_SIZE(ad9361_snapshot_regs),
+					snap, &pos);
+	if (ret < 0)
+		goto out;
+	ret = ad9361_snapshot_read_regs(phy->spi, ad9361_snapshot_synth_regs,
+					ARRAY_SIZE(ad9361_snapshot_synth_regs),
+					snap, &pos);
+	if (ret < 0)
+		goto out;
+
+	ret = ad9361_snapshot_read_fir(phy, false, snap, &pos);
+	if (ret < 0)
+		goto out;
+	ret = ad9361_snapshot_read_fir(phy, true, snap, &pos);
+	if (ret < 0)
+		goto out;
+
+	ret = ad9361_spi_read(phy->spi, REG_PRODUCT_ID);
+	if (ret < 0)
+		goto out;
+
+	ad9361_snapshot_put(&snap[0], AD9361_SNAPSHOT_MAGIC);
+	snap[4] = AD9361_SNAPSHOT_VERSION;
+	snap[5] = AD9361_SNAPSHOT_VERSION >> 8;
+	snap[6] = ret;
+	snap[7] = (phy->pdata->rx2tx2 ? AD9361_SNAPSHOT_RX2TX2 : 0) |
+		  (phy->pdata->fdd ? AD9361_SNAPSHOT_FDD : 0);
+	ad9361_snapshot_put(&snap[8], phy->clk_refin->rate);
+	ad9361_snapshot_put(&snap[12], len);
+	ad9361_snapshot_put(&snap[16],
+			    ad9361_snapshot_crc(&snap[AD9361_SNAPSHOT_HDR_SIZE],
+					    len - AD9361_SNAPSHOT_HDR_SIZE));
+
+	*buf = snap;
+	*size = len;
+
+	return 0;
+
+out:
+	free(snap);
+
+	return ret;
+}
+
+/**
+ * Restore the device configuration saved with ad9361_snapshot_save().
+ *
+ * Replaces ad9361_setup() after a device reset. The clocks are restored and
+ * the BBPLL is calibrated first, then the remaining registers are written in
+ * bursts, the synthesizer lock is verified and the FIR filters, the Gm sub
+ * table and the gain tables are loaded. No RF calibration is run, the
+ * calibration results are part of the snapshot.
+ * @param phy The AD9361 state structure.
+ * @param buf The snapshot.
+ * @param size The snapshot size.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_warm_boot(struct ad9361_rf_phy *phy, const uint8_t *buf,
+			 uint32_t size)
+{
+	struct ad9361_phy_platform_data *pd = phy->pdata;
+	struct spi_desc *spi = phy->spi;
+	uint32_t state[AD9361_SNAPSHOT_STATE_WORDS];
+	uint32_t i, pos, flags;
+	int32_t ret;
+
+	pos = AD9361_SNAPSHOT_HDR_SIZE + sizeof(state);
+	if (size < pos + ad9361_snapshot_regs_size() + 4 ||
+	    ad9361_snapshot_get(&buf[0]) != AD9361_SNAPSHOT_MAGIC ||
+	    (buf[4] | (buf[5] << 8)) != AD9361_SNAPSHOT_VERSION ||
+	    ad9361_snapshot_get(&buf[12]) != size) {
+		dev_err(&spi->dev, "%s: Invalid snapshot", __func__);
+		return -EINVAL;
+	}
+
+	if (ad9361_snapshot_get(&buf[16]) !=
+	    ad9361_snapshot_crc(&buf[AD9361_SNAPSHOT_HDR_SIZE],
+				size - AD9361_SNAPSHOT_HDR_SIZE)) {
+		dev_err(&spi->dev, "%s: Snapshot CRC error", __func__);
+		return -EINVAL;
+	}
+
+	flags = (pd->rx2tx2 ? AD9361_SNAPSHOT_RX2TX2 : 0) |
+		(pd->fdd ? AD9361_SNAPSHOT_FDD : 0);
+	if (buf[6] != ad9361_spi_read(spi, REG_PRODUCT_ID) || buf[7] != flags ||
+	    ad9361_snapshot_get(&buf[8]) != phy->clk_refin->rate) {
+		dev_err(&spi->dev, "%s: Snapshot does not match the device",
+			__func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < AD9361_SNAPSHOT_STATE_WORDS; i++)
+		state[i] = ad9361_snapshot_get(&buf[AD9361_SNAPSHOT_HDR_SIZE +
+							    4 * i]);
+
+	ad9361_rfpll_shadow_flush(phy);
+	clk_invalidate(phy, BIT(BB_REFCLK) | BIT(RX_REFCLK) | BIT(TX_REFCLK));
+
+	ret = ad9361_snapshot_write_regs(spi, ad9361_snapshot_clk_regs,
+					 ARRAY_SIZE(ad9361_snapshot_clk_regs),
+					 buf, &pos);
+	if (ret < 0)
+		return ret;
+
+	ad9361_spi_write(spi, REG_SDM_CTRL_1,
+			 INIT_BB_FO_CAL | BBPLL_RESET_BAR); /* Start BBPLL Calibration */
+	ad9361_spi_write(spi, REG_SDM_CTRL_1,
+			 BBPLL_RESET_BAR); /* Clear BBPLL start calibration bit */
+	ad9361_spi_write(spi, REG_VCO_PROGRAM_1,
+			 0x86); /* Increase BBPLL KV and phase margin */
+	ad9361_spi_write(spi, REG_VCO_PROGRAM_2,
+			 0x01); /* Increase BBPLL KV and phase margin */
+	ad9361_spi_write(spi, REG_VCO_PROGRAM_2,
+			 0x05); /* Increase BBPLL KV and phase margin */
+
+	ret = ad9361_check_cal_done(phy, REG_CH_1_OVERFLOW, BBPLL_LOCK, 1);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9361_snapshot_write_regs(spi, ad9361_snapshot_regs,
+					 ARRAY_SIZE(ad9361_snapshot_regs),
+					 buf, &pos);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9361_snapshot_write_regs(spi, ad9361_snapshot_synth_regs,
+					 ARRAY_SIZE(ad9361_snapshot_synth_regs),
+					 buf, &pos);
+	if (ret < 0)
+		return ret;
+
+	if (!pd->use_ext_rx_lo && !((state[4] >> 24) & RX_LO_POWER_DOWN)) {
+		ret = ad9361_check_cal_done(phy, REG_RX_CP_OVERRANGE_VCO_LOCK,
+					    VCO_LOCK, 1);
+		if (ret < 0)
+			return ret;
+	}
+
+	if (!pd->use_ext_tx_lo && !((state[4] >> 16) & TX_LO_POWER_DOWN)) {
+		ret = ad9361_check_cal_done(phy, REG_TX_CP_OVERRANGE_VCO_LOCK,
+					    VCO_LOCK, 1);
+		if (ret < 0)
+			return ret;
+	}
+
+	ret = ad9361_snapshot_write_fir(phy, false, state[12] & 0xFF,
+					buf, size, &pos);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9361_snapshot_write_fir(phy, true, (state[12] >> 16) & 0xFF,
+					buf, size, &pos);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9361_load_mixer_gm_subtable(phy);
+	if (ret < 0)
+		return ret;
+
+	/* The device gain table was reset, force the load */
+	phy->current_table = RXGAIN_TBLS_END;
+	ret = ad9361_load_gt(phy, ad9361_from_clk(state[10]), GT_RX1 + GT_RX2);
+	if (ret < 0) {
+		phy->current_table = RXGAIN_TBLS_END;
+		return ret;
+	}
+
+	i = 0;
+	phy->current_rx_bw_Hz = state[i++];
+	phy->current_tx_bw_Hz = state[i++];
+	phy->rxbbf_div = state[i++];
+	phy->rate_governor = state[i++];
+	phy->cached_rx_rfpll_div = state[i];
+	phy->cached_tx_rfpll_div = state[i] >> 8;
+	phy->cached_synth_pd[0] = state[i] >> 16;
+	phy->cached_synth_pd[1] = state[i++] >> 24;
+	phy->last_tx_quad_cal_freq = state[i] | ((uint64_t)state[i + 1] << 32);
+	i += 2;
+	phy->last_tx_quad_cal_phase = state[i++];
+	phy->current_tx_lo_freq = state[i] | ((uint64_t)state[i + 1] << 32);
+	i += 2;
+	phy->current_rx_lo_freq = state[i] | ((uint64_t)state[i + 1] << 32);
+	i += 2;
+	phy->tx_fir_int = state[i];
+	phy->tx_fir_ntaps = state[i] >> 8;
+	phy->rx_fir_dec = state[i] >> 16;
+	phy->rx_fir_ntaps = state[i++] >> 24;
+	phy->agc_mode[0] = state[i];
+	phy->agc_mode[1] = state[i++] >> 8;
+	phy->current_tx_use_tdd_table = state[i] & BIT(0);
+	phy->current_rx_use_tdd_table = state[i] & BIT(1);
+	phy->bypass_rx_fir = state[i] & BIT(2);
+	phy->bypass_tx_fir = state[i] & BIT(3);
+	phy->rx_eq_2tx = state[i] & BIT(4);
+	phy->rfdc_track_en = state[i] & BIT(5);
+	phy->bbdc_track_en = state[i] & BIT(6);
+	phy->quad_track_en = state[i] & BIT(7);
+	phy->txmon_tdd_en = state[i] & BIT(8);
+	phy->bbpll_initialized = state[i++] & BIT(9);
+	phy->auxdac1_value = state[i];
+	phy->auxdac2_value = state[i++] >> 16;
+	phy->tx1_atten_cached = state[i++];
+	phy->tx2_atten_cached = state[i++];
+	phy->flags = state[i++];
+	phy->filt_valid = false;
+
+	for (i = 0; i < NUM_AD9361_CLKS; i++)
+		if (i != RX_RFPLL_DUMMY && i != TX_RFPLL_DUMMY)
+			phy->clks[i]->rate = clk_get_rate(phy,
+							  phy->ref_clk_scale[i]);
+
+	ret = ad9361_set_ensm_mode(phy, pd->fdd, pd->ensm_pin_ctrl);
+	if (ret < 0)
+		return ret;
+
+	phy->curr_ensm_state = ad9361_spi_readf(spi, REG_STATE, ENSM_STATE(~0));
+	ad9361_ensm_set_state(phy, pd->fdd ? ENSM_STATE_FDD : ENSM_STATE_RX,
+			      pd->ensm_pin_ctrl);
+
+	ad9361_cal_cache_flush(phy);
+	ret = ad9361_cal_cache_store(phy, phy->last_tx_quad_cal_freq,
+				     ad9361_get_temp(phy));
+	if (ret < 0)
+		return ret;
+
+	phy->auto_cal_en = true;
+	phy->cal_threshold_freq = 100000000ULL; /* 100 MHz */
+	phy->cal_cache.en = true;
+	phy->cal_cache.temp_threshold = 10000; /* 10 degC */
+
+	return 0;
+}
+
+/**
+ * Start the selected calibration without waiting for it to complete.
+ *
+ * The tracking calibrations are disabled and the ENSM is moved to the ALERT
+ * state until ad9361_calib_complete() is called. Use ad9361_calib_poll() to
+ * advance the calibration.
+ * @param phy The AD9361 state structure.
+ * @param cal The selected calibration (TX_QUAD_CAL, RFDC_CAL).
+ * @param arg For TX_QUAD_CAL - the optional RX phase value overwrite.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_calib_start(struct ad9361_rf_phy *phy, uint32_t cal,
+			   int32_t arg)
+{
+	struct ad9361_cal_state *st = &phy->cal_state;
+	int32_t ret;
+
+	dev_dbg(&phy->spi->dev, "%s: CAL %"PRIu32" ARG %"PRId32, __func__, cal, arg);
+
+	if (st->step != AD9361_CAL_STEP_IDLE)
+		return -EBUSY;
+
+	if (cal != TX_QUAD_CAL && cal != RFDC_CAL)
+		return -EINVAL;
+
+	ret = ad9361_tracking_control(phy, false, false, false);
+	if (ret < 0)
+		return ret;
+
+	ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
+
+	st->cal = cal;
+	st->restore = true;
+
+	if (cal == TX_QUAD_CAL) {
+		ret = ad9361_tx_quad_calib_setup(phy, phy->current_rx_bw_Hz / 2,
+						 phy->current_tx_bw_Hz / 2, arg);
+		if (ret < 0) {
+			st->step = AD9361_CAL_STEP_DONE;
+			st->ret = ret;
+			return ret;
+		}
+		st->step = AD9361_CAL_STEP_QUAD_FIRST;
+		st->ret = __ad9361_tx_quad_calib_start(phy, st->rx_phase);
+	} else {
+		ad9361_rf_dc_offset_setup(phy,
+					  ad9361_from_clk(clk_get_rate(phy, phy->ref_clk_scale[RX_RFPLL])));
+		st->step = AD9361_CAL_STEP_RUN;
+		st->ret = ad9361_cal_hw_start(phy, RFDC_CAL);
+	}
+
+	return st->ret;
+}
+
+/**
+ * Advance the calibration started with ad9361_calib_start().
+ *
+ * Each call checks the running calibration with a single register read and
+ * starts the next calibration run when needed.
+ * @param phy The AD9361 state structure.
+ * @param wait_us The suggested time to wait before the next call [us],
+ *                adapted to the expected duration of the calibration.
+ * @return 0 when the calibration is done, -EINPROGRESS if it is still
+ *         running, negative error code otherwise.
+ */
+int32_t ad9361_calib_poll(struct ad9361_rf_phy *phy, uint32_t *wait_us)
+{
+	struct ad9361_cal_state *st = &phy->cal_state;
+	int32_t ret;
+
+	*wait_us = 0;
+
+	switch (st->step) {
+	case AD9361_CAL_STEP_IDLE:
+		return -EINVAL;
+	case AD9361_CAL_STEP_DONE:
+		return st->ret;
+	default:
+		break;
+	}
+
+	ret = st->ret;
+	if (!ret)
+		ret = ad9361_cal_hw_poll(phy, wait_us);
+	if (ret == -EINPROGRESS)
+		return ret;
+
+	if (st->cal == TX_QUAD_CAL) {
+		if (!ret)
+			ret = ad9361_tx_quad_calib_step(phy);
+		if (ret == -EINPROGRESS) {
+			st->wait_us = max_t(uint32_t, st->tx_quad_cal_us -
+					    st->tx_quad_cal_us / 8,
+					    AD9361_CAL_POLL_MIN_US);
+			*wait_us = st->wait_us;
+			return ret;
+		}
+		ad9361_tx_quad_calib_finish(phy);
+	}
+
+	st->step = AD9361_CAL_STEP_DONE;
+	st->ret = ret;
+
+	return ret;
+}
+
+/**
+ * Wait for the calibration started with ad9361_calib_start() and restore the
+ * tracking calibrations and the ENSM state. A TX quadrature calibration
+ * deferred by a TX LO change meanwhile is run afterwards.
+ * @param phy The AD9361 state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_calib_complete(struct ad9361_rf_phy *phy)
+{
+	struct ad9361_cal_state *st = &phy->cal_state;
+	uint32_t wait_us;
+	int32_t ret, err;
+
+	if (st->step == AD9361_CAL_STEP_IDLE)
+		return -EINVAL;
+
+	while ((ret = ad9361_calib_poll(phy, &wait_us)) == -EINPROGRESS)
+		udelay(wait_us);
+
+	if (st->restore) {
+		err = ad9361_tracking_control(phy, phy->bbdc_track_en,
+					      phy->rfdc_track_en, phy->quad_track_en);
+		ad9361_ensm_restore_prev_state(phy);
+		if (!ret)
+			ret = err;
+	}
+
+	st->step = AD9361_CAL_STEP_IDLE;
+
+	/* TX LO changed while the calibration was running */
+	if (phy->tx_quad_cal_pending) {
+		phy->tx_quad_cal_pending = false;
+		ad9361_tx_quad_calib_lo(phy,
+					ad9361_from_clk(clk_get_rate(phy, phy->ref_clk_scale[TX_RFPLL])));
+	}
+
+	return ret;
+}
+
+/**
+ * Perform the selected calibration
+ * @param phy The AD9361 state structure.
+ * @param cal The selected calibration.
+ * @param arg The argument of the calibration.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_do_calib_run(struct ad9361_rf_phy *phy, uint32_t cal,
+			    int32_t arg)
+{
+	int32_t ret;
+
+	ret = ad9361_calib_start(phy, cal, arg);
+	/*
+	 * Nothing to complete if the calibration did not start, and -EBUSY
+	 * belongs to a calibration started by someone else.
+	 */
+	if (ret == -EBUSY ||
+	    (ret < 0 && phy->cal_state.step == AD9361_CAL_STEP_IDLE))
+		return ret;
+
+	return ad9361_calib_complete(phy);
+}
+
+/**
  * Set the RF bandwidth.
  * @param phy The AD9361 state structure.
  * @param rf_rx_bw The desired RX bandwidth [Hz].
@@ -5591,27 +7106,20 @@ static int32_t ad9361_verify_fir_filter_coef(struct ad9361_rf_phy *phy,
  * @param dest Destination identifier (RX1,2 / TX1,2).
  * @param gain_dB Gain option.
  * @param ntaps Number of filter Taps.
- * @param coef Pointer to filter coefficients.
+ * @param coef The coefficients, 16 bit little endian.
  * @return 0 in case of success, negative error code otherwise.
  */
-int32_t ad9361_load_fir_filter_coef(struct ad9361_rf_phy *phy,
-				    enum fir_dest dest, int32_t gain_dB,
-				    uint32_t ntaps, int16_t *coef)
+static int32_t ad9361_fir_load(struct ad9361_rf_phy *phy, enum fir_dest dest,
+			       int32_t gain_dB, uint32_t ntaps,
+			       const uint8_t *coef)
 {
 	struct spi_desc *spi = phy->spi;
 	uint32_t val, offs = 0, fir_conf = 0, fir_enable = 0;
+	int32_t ret;
 
 	dev_dbg(&phy->spi->dev, "%s: TAPS %"PRIu32", gain %"PRId32", dest %d",
 		__func__, ntaps, gain_dB, dest);
 
-	if (coef == NULL || !ntaps || ntaps > 128 || ntaps % 16) {
-		dev_err(&phy->spi->dev,
-			"%s: Invalid parameters: TAPS %"PRIu32", gain %"PRId32", dest 0x%X",
-			__func__, ntaps, gain_dB, dest);
-
-		return -EINVAL;
-	}
-
 	ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
 
 	if (dest & FIR_IS_RX) {
@@ -5641,17 +7149,7 @@ int32_t ad9361_load_fir_filter_coef(struct ad9361_rf_phy *phy,
 
 	ad9361_spi_write(spi, REG_TX_FILTER_CONF + offs, fir_conf);
 
-	for (val = 0; val < ntaps; val++) {
-		ad9361_spi_write(spi, REG_TX_FILTER_COEF_ADDR + offs, val);
-		ad9361_spi_write(spi, REG_TX_FILTER_COEF_WRITE_DATA_1 + offs,
-				 coef[val] & 0xFF);
-		ad9361_spi_write(spi, REG_TX_FILTER_COEF_WRITE_DATA_2 + offs,
-				 coef[val] >> 8);
-		ad9361_spi_write(spi, REG_TX_FILTER_CONF + offs,
-				 fir_conf | FIR_WRITE);
-		ad9361_spi_write(spi, REG_TX_FILTER_COEF_READ_DATA_2 + offs, 0);
-		ad9361_spi_write(spi, REG_TX_FILTER_COEF_READ_DATA_2 + offs, 0);
-	}
+	ret = ad9361_fir_write_taps(spi, offs, fir_conf, ntaps, coef);
 
 	ad9361_spi_write(spi, REG_TX_FILTER_CONF + offs, fir_conf);
 	fir_conf &= ~FIR_START_CLK;
@@ -5666,32 +7164,74 @@ int32_t ad9361_load_fir_filter_coef(struct ad9361_rf_phy *phy,
 
 	ad9361_ensm_restore_prev_state(phy);
 
-	return ad9361_verify_fir_filter_coef(phy, dest, ntaps, coef);
+	return ret;
 }
 
 /**
- * Parse the FIR filter file/buffer.
+ * Load the FIR filter coefficients.
  * @param phy The AD9361 state structure.
- * @param data Pointer to buffer.
+ * @param dest Destination identifier (RX1,2 / TX1,2).
+ * @param gain_dB Gain option.
+ * @param ntaps Number of filter Taps.
+ * @param coef Pointer to filter coefficients.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_load_fir_filter_coef(struct ad9361_rf_phy *phy,
+				    enum fir_dest dest, int32_t gain_dB,
+				    uint32_t ntaps, int16_t *coef)
+{
+	uint8_t buf[2 * 128];
+	uint32_t val;
+	int32_t ret;
+
+	if (coef == NULL || !ntaps || ntaps > 128 || ntaps % 16) {
+		dev_err(&phy->spi->dev,
+			"%s: Invalid parameters: TAPS %"PRIu32", gain %"PRId32", dest 0x%X",
+			__func__, ntaps, gain_dB, dest);
+
+		return -EINVAL;
+	}
+
+	for (val = 0; val < ntaps; val++) {
+		buf[2 * val] = coef[val] & 0xFF;
+		buf[2 * val + 1] = coef[val] >> 8;
+	}
+
+	ret = ad9361_fir_load(phy, dest, gain_dB, ntaps, buf);
+	if (ret < 0)
+		return ret;
+
+	return ad9361_verify_fir_filter_coef(phy, dest, ntaps, coef);
+}
+
+/**
+ * Build a binary FIR profile from a FIR filter file/buffer.
+ *
+ * The profile holds the TX and RX filter settings, path clocks and
+ * coefficients in the layout loaded by ad9361_fir_profile_load(), so it can
+ * be produced offline and switched at runtime without parsing. This function
+ * does not access the device.
+ * @param data Pointer to buffer, in the format used by ad9361_parse_fir().
+ *             The buffer is modified.
  * @param size Buffer size.
+ * @param profile The profile, at least AD9361_FIR_PROFILE_MAX_SIZE bytes.
+ * @param profile_size The profile size.
  * @return 0 in case of success, negative error code otherwise.
  */
-int32_t ad9361_parse_fir(struct ad9361_rf_phy *phy,
-			 char *data, uint32_t size)
+int32_t ad9361_fir_profile_build(char *data, uint32_t size,
+				 uint8_t *profile, uint32_t *profile_size)
 {
 	char *line;
-	int32_t i = 0, ret, txc, rxc;
+	int32_t i = 0, j, ret, txc, rxc;
 	int32_t tx = -1, tx_gain = 0, tx_int = 0;
 	int32_t rx = -1, rx_gain = 0, rx_dec = 0;
 	int32_t rtx = -1, rrx = -1;
+	uint32_t tx_clks[6], rx_clks[6], tx_bw = 0, rx_bw = 0;
 	int16_t coef_tx[128];
 	int16_t coef_rx[128];
+	uint8_t *filt;
 	char *ptr = data;
 
-	phy->filt_rx_bw_Hz = 0;
-	phy->filt_tx_bw_Hz = 0;
-	phy->filt_valid = false;
-
 	while ((line = strsep(&ptr, "\n"))) {
 		if (line >= data + size) {
 			break;
@@ -5734,12 +7274,8 @@ int32_t ad9361_parse_fir(struct ad9361_rf_phy *phy,
 			ret = sscanf(line,
 				     "RTX %"PRIu32" %"PRIu32" %"PRIu32" %"PRIu32" %"PRIu32" %"PRIu32,
 #endif
-				     &phy->filt_tx_path_clks[0],
-				     &phy->filt_tx_path_clks[1],
-				     &phy->filt_tx_path_clks[2],
-				     &phy->filt_tx_path_clks[3],
-				     &phy->filt_tx_path_clks[4],
-				     &phy->filt_tx_path_clks[5]);
+				     &tx_clks[0], &tx_clks[1], &tx_clks[2],
+				     &tx_clks[3], &tx_clks[4], &tx_clks[5]);
 			if (ret == 6) {
 				rtx = 0;
 				continue;
@@ -5755,12 +7291,8 @@ int32_t ad9361_parse_fir(struct ad9361_rf_phy *phy,
 			ret = sscanf(line,
 				     "RRX %"PRIu32" %"PRIu32" %"PRIu32" %"PRIu32" %"PRIu32" %"PRIu32,
 #endif
-				     &phy->filt_rx_path_clks[0],
-				     &phy->filt_rx_path_clks[1],
-				     &phy->filt_rx_path_clks[2],
-				     &phy->filt_rx_path_clks[3],
-				     &phy->filt_rx_path_clks[4],
-				     &phy->filt_rx_path_clks[5]);
+				     &rx_clks[0], &rx_clks[1], &rx_clks[2],
+				     &rx_clks[3], &rx_clks[4], &rx_clks[5]);
 			if (ret == 6) {
 				rrx = 0;
 				continue;
@@ -5769,28 +7301,28 @@ int32_t ad9361_parse_fir(struct ad9361_rf_phy *phy,
 			}
 		}
 
-		if (!phy->filt_rx_bw_Hz) {
+		if (!rx_bw) {
 #ifdef WIN32
-			ret = sscanf(line, "BWRX %d", &phy->filt_rx_bw_Hz);
+			ret = sscanf(line, "BWRX %d", &rx_bw);
 #else
-			ret = sscanf(line, "BWRX %"PRId32, &phy->filt_rx_bw_Hz);
+			ret = sscanf(line, "BWRX %"PRIu32, &rx_bw);
 #endif
 			if (ret == 1)
 				continue;
 			else
-				phy->filt_rx_bw_Hz = 0;
+				rx_bw = 0;
 		}
 
-		if (!phy->filt_tx_bw_Hz) {
+		if (!tx_bw) {
 #ifdef WIN32
-			ret = sscanf(line, "BWTX %d", &phy->filt_tx_bw_Hz);
+			ret = sscanf(line, "BWTX %d", &tx_bw);
 #else
-			ret = sscanf(line, "BWTX %"PRId32, &phy->filt_tx_bw_Hz);
+			ret = sscanf(line, "BWTX %"PRIu32, &tx_bw);
 #endif
 			if (ret == 1)
 				continue;
 			else
-				phy->filt_tx_bw_Hz = 0;
+				tx_bw = 0;
 		}
 
 #ifdef WIN32
@@ -5798,6 +7330,9 @@ int32_t ad9361_parse_fir(struct ad9361_rf_phy *phy,
 #else
 		ret = sscanf(line, "%"PRId32",%"PRId32, &txc, &rxc);
 #endif
+		if (ret > 0 && i == 128)
+			return -EINVAL;
+
 		if (ret == 1) {
 			coef_tx[i] = coef_rx[i] = (int16_t)txc;
 			i++;
@@ -5810,35 +7345,181 @@ int32_t ad9361_parse_fir(struct ad9361_rf_phy *phy,
 		}
 	}
 
-	switch (tx) {
-	case FIR_TX1:
-	case FIR_TX2:
-	case FIR_TX1_TX2:
-		phy->tx_fir_int = tx_int;
-		ret = ad9361_load_fir_filter_coef(phy, (enum fir_dest)tx, tx_gain, i, coef_tx);
-		break;
-	default:
-		ret = -EINVAL;
+	if (tx < FIR_TX1 || tx > FIR_TX1_TX2 || rx < FIR_TX1 ||
+	    rx > FIR_TX1_TX2 || !i || i % 16)
+		return -EINVAL;
+
+	filt = &profile[AD9361_FIR_PROFILE_HDR_SIZE];
+	filt[0] = tx;
+	filt[1] = tx_gain;
+	filt[2] = tx_int;
+	filt[3] = i;
+	for (j = 0; j < 6; j++)
+		ad9361_snapshot_put(&filt[4 + 4 * j], rtx ? 0 : tx_clks[j]);
+	ad9361_snapshot_put(&filt[28], tx_bw);
+
+	filt += AD9361_FIR_PROFILE_FILT_SIZE;
+	filt[0] = rx;
+	filt[1] = rx_gain;
+	filt[2] = rx_dec;
+	filt[3] = i;
+	for (j = 0; j < 6; j++)
+		ad9361_snapshot_put(&filt[4 + 4 * j], rrx ? 0 : rx_clks[j]);
+	ad9361_snapshot_put(&filt[28], rx_bw);
+
+	filt += AD9361_FIR_PROFILE_FILT_SIZE;
+	for (j = 0; j < i; j++) {
+		filt[2 * j] = coef_tx[j] & 0xFF;
+		filt[2 * j + 1] = coef_tx[j] >> 8;
+		filt[2 * (i + j)] = coef_rx[j] & 0xFF;
+		filt[2 * (i + j) + 1] = coef_rx[j] >> 8;
+	}
+
+	*profile_size = AD9361_FIR_PROFILE_SIZE(i, i);
+
+	ad9361_snapshot_put(&profile[0], AD9361_FIR_PROFILE_MAGIC);
+	profile[4] = AD9361_FIR_PROFILE_VERSION;
+	profile[5] = AD9361_FIR_PROFILE_VERSION >> 8;
+	profile[6] = 0;
+	profile[7] = 0;
+	ad9361_snapshot_put(&profile[8], *profile_size);
+	ad9361_snapshot_put(&profile[12],
+			    ad9361_snapshot_crc(&profile[AD9361_FIR_PROFILE_HDR_SIZE],
+						*profile_size -
+						AD9361_FIR_PROFILE_HDR_SIZE));
+
+	return 0;
+}
+
+/**
+ * Verify the coefficients of a FIR profile after they were loaded.
+ * @param phy The AD9361 state structure.
+ * @param dest Destination identifier (RX1,2 / TX1,2).
+ * @param ntaps Number of filter Taps.
+ * @param coef The coefficients, in the profile layout.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_fir_profile_verify(struct ad9361_rf_phy *phy,
+		enum fir_dest dest, uint32_t ntaps,
+		const uint8_t *coef)
+{
+	int16_t taps[128];
+	uint32_t i;
+
+	for (i = 0; i < ntaps; i++)
+		taps[i] = coef[2 * i] | (coef[2 * i + 1] << 8);
+
+	return ad9361_verify_fir_filter_coef(phy, dest, ntaps, taps);
+}
+
+/**
+ * Load a binary FIR profile built with ad9361_fir_profile_build().
+ *
+ * The coefficients are written with batched SPI transfers. Like
+ * ad9361_load_fir_filter_coef(), they are read back and compared when DEBUG
+ * is defined. The filters are not enabled.
+ * @param phy The AD9361 state structure.
+ * @param profile The profile.
+ * @param size The profile size.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_fir_profile_load(struct ad9361_rf_phy *phy,
+				const uint8_t *profile, uint32_t size)
+{
+	const uint8_t *tx, *rx, *coef;
+	uint32_t i;
+	int32_t ret;
+
+	tx = &profile[AD9361_FIR_PROFILE_HDR_SIZE];
+	rx = tx + AD9361_FIR_PROFILE_FILT_SIZE;
+	coef = rx + AD9361_FIR_PROFILE_FILT_SIZE;
+
+	if (size < AD9361_FIR_PROFILE_SIZE(0, 0) ||
+	    ad9361_snapshot_get(&profile[0]) != AD9361_FIR_PROFILE_MAGIC ||
+	    (profile[4] | (profile[5] << 8)) != AD9361_FIR_PROFILE_VERSION ||
+	    ad9361_snapshot_get(&profile[8]) != size ||
+	    size != AD9361_FIR_PROFILE_SIZE(tx[3], rx[3])) {
+		dev_err(&phy->spi->dev, "%s: Invalid FIR profile", __func__);
+		return -EINVAL;
 	}
 
-	switch (rx | FIR_IS_RX) {
-	case FIR_RX1:
-	case FIR_RX2:
-	case FIR_RX1_RX2:
-		phy->rx_fir_dec = rx_dec;
-		ret = ad9361_load_fir_filter_coef(phy, (enum fir_dest)(rx | FIR_IS_RX),
-						  rx_gain, i, coef_rx);
-		break;
-	default:
-		ret = -EINVAL;
+	if (ad9361_snapshot_get(&profile[12]) !=
+	    ad9361_snapshot_crc(&profile[AD9361_FIR_PROFILE_HDR_SIZE],
+				size - AD9361_FIR_PROFILE_HDR_SIZE)) {
+		dev_err(&phy->spi->dev, "%s: FIR profile CRC error", __func__);
+		return -EINVAL;
+	}
+
+	if (tx[0] < FIR_TX1 || tx[0] > FIR_TX1_TX2 || !tx[3] || tx[3] > 128 ||
+	    tx[3] % 16 || rx[0] < FIR_TX1 || rx[0] > FIR_TX1_TX2 || !rx[3] ||
+	    rx[3] > 128 || rx[3] % 16) {
+		dev_err(&phy->spi->dev, "%s: Invalid FIR profile", __func__);
+		return -EINVAL;
+	}
+
+	phy->filt_valid = false;
+
+	for (i = 0; i < 6; i++) {
+		phy->filt_tx_path_clks[i] = ad9361_snapshot_get(&tx[4 + 4 * i]);
+		phy->filt_rx_path_clks[i] = ad9361_snapshot_get(&rx[4 + 4 * i]);
 	}
+	phy->filt_tx_bw_Hz = ad9361_snapshot_get(&tx[28]);
+	phy->filt_rx_bw_Hz = ad9361_snapshot_get(&rx[28]);
 
+	phy->tx_fir_int = tx[2];
+	ret = ad9361_fir_load(phy, (enum fir_dest)tx[0], (int8_t)tx[1], tx[3],
+			      coef);
 	if (ret < 0)
 		return ret;
 
-	if (!(rrx | rtx))
+	ret = ad9361_fir_profile_verify(phy, (enum fir_dest)tx[0], tx[3], coef);
+	if (ret < 0)
+		return ret;
+
+	phy->rx_fir_dec = rx[2];
+	ret = ad9361_fir_load(phy, (enum fir_dest)(rx[0] | FIR_IS_RX),
+			      (int8_t)rx[1], rx[3], coef + 2 * tx[3]);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9361_fir_profile_verify(phy, (enum fir_dest)(rx[0] | FIR_IS_RX),
+					rx[3], coef + 2 * tx[3]);
+	if (ret < 0)
+		return ret;
+
+	if (phy->filt_tx_path_clks[TX_SAMPL_FREQ] &&
+	    phy->filt_rx_path_clks[RX_SAMPL_FREQ])
 		phy->filt_valid = true;
 
+	return 0;
+}
+
+/**
+ * Parse the FIR filter file/buffer.
+ * @param phy The AD9361 state structure.
+ * @param data Pointer to buffer.
+ * @param size Buffer size.
+ * @return The buffer size in case of success, negative error code otherwise.
+ */
+int32_t ad9361_parse_fir(struct ad9361_rf_phy *phy,
+			 char *data, uint32_t size)
+{
+	uint8_t profile[AD9361_FIR_PROFILE_MAX_SIZE];
+	uint32_t profile_size;
+	int32_t ret;
+
+	phy->filt_rx_bw_Hz = 0;
+	phy->filt_tx_bw_Hz = 0;
+	phy->filt_valid = false;
+
+	ret = ad9361_fir_profile_build(data, size, profile, &profile_size);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9361_fir_profile_load(phy, profile, profile_size);
+	if (ret < 0)
+		return ret;
+
 	return size;
 }
 
@@ -6534,6 +8215,234 @@ static int32_t ad9361_calc_rfpll_int_divder(struct ad9361_rf_phy *phy,
 	return 0;
 }
 
+/* Synthesizer registers in write order, the integer byte triggers the VCO cal */
+static const struct ad9361_rfpll_reg {
+	uint16_t	reg;
+	uint8_t		mask;
+} ad9361_rfpll_regs[AD9361_RFPLL_REGS] = {
+	{REG_RX_VCO_VARACTOR_CTRL_1, 0xFF},
+	{REG_RX_VCO_VARACTOR_CTRL_0, 0xFF},
+	{REG_RX_VCO_CAL_REF, 0xFF},
+	{REG_RX_VCO_BIAS_1, 0xFF},
+	{REG_RX_LOOP_FILTER_3, 0xFF},
+	{REG_RX_LOOP_FILTER_2, 0xFF},
+	{REG_RX_LOOP_FILTER_1, 0xFF},
+	{REG_RX_CP_CURRENT, CHARGE_PUMP_CURRENT(~0)},
+	{REG_RX_VCO_OUTPUT, 0xFF},
+	{REG_RX_ALC_VARACTOR, VCO_VARACTOR(~0)},
+	{REG_RX_FORCE_VCO_TUNE_1, 0xFF},
+	{REG_RX_FRACT_BYTE_2, 0xFF},
+	{REG_RX_FRACT_BYTE_1, 0xFF},
+	{REG_RX_FRACT_BYTE_0, 0xFF},
+	{REG_RX_INTEGER_BYTE_1, SYNTH_INTEGER_WORD(~0)},
+	{REG_RX_INTEGER_BYTE_0, 0xFF},
+};
+
+#define AD9361_RFPLL_WORD	11 /* index of REG_RX_FRACT_BYTE_2 */
+
+/**
+ * Invalidate the programmed synthesizer register copy.
+ *
+ * Must be called whenever the synthesizer registers are written outside of
+ * ad9361_rfpll_int_set_rate().
+ * @param phy The AD9361 state structure.
+ * @return None.
+ */
+void ad9361_rfpll_shadow_flush(struct ad9361_rf_phy *phy)
+{
+	phy->rfpll_cache.shadow_valid[0] = false;
+	phy->rfpll_cache.shadow_valid[1] = false;
+	phy->rfpll_cache.div_valid = false;
+}
+
+/**
+ * Get the RFPLL retune statistics.
+ * @param phy The AD9361 state structure.
+ * @param stats The statistics.
+ * @return None.
+ */
+void ad9361_get_rfpll_stats(struct ad9361_rf_phy *phy,
+			    struct ad9361_rfpll_stats *stats)
+{
+	*stats = phy->rfpll_cache.stats;
+}
+
+/**
+ * Clear the RFPLL retune statistics.
+ * @param phy The AD9361 state structure.
+ * @return None.
+ */
+void ad9361_clear_rfpll_stats(struct ad9361_rf_phy *phy)
+{
+	memset(&phy->rfpll_cache.stats, 0, sizeof(phy->rfpll_cache.stats));
+}
+
+/**
+ * Get the synthesizer settings for a frequency, computing them on a miss.
+ * @param phy The AD9361 state structure.
+ * @param tx Set true for TX_RFPLL.
+ * @param rate The clock rate.
+ * @param parent_rate The parent clock rate.
+ * @param entry The cache entry.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_rfpll_cache_get(struct ad9361_rf_phy *phy, bool tx,
+				      uint32_t rate, uint32_t parent_rate,
+				      struct ad9361_rfpll_cache_entry **entry)
+{
+	struct ad9361_rfpll_cache *cache = &phy->rfpll_cache;
+	struct ad9361_rfpll_cache_entry *e, *slot = NULL;
+	uint32_t i, integer, fract;
+	uint64_t vco;
+	bool tdd_table;
+	int32_t ret;
+
+	tdd_table = ad9361_rfpll_use_tdd_table(phy, tx);
+	cache->counter++;
+
+	for (i = 0; i < AD9361_RFPLL_CACHE_SIZE; i++) {
+		e = &cache->entry[tx][i];
+		if (e->valid && e->rate == rate &&
+		    e->parent_rate == parent_rate && e->tdd_table == tdd_table) {
+			e->last_use = cache->counter;
+			cache->stats.hits++;
+			*entry = e;
+			return 0;
+		}
+		if (!slot || (slot->valid && (!e->valid ||
+					      e->last_use < slot->last_use)))
+			slot = e;
+	}
+
+	cache->stats.misses++;
+
+	ret = ad9361_calc_rfpll_int_divder(phy, ad9361_from_clk(rate),
+					   parent_rate, &integer, &fract,
+					   &slot->vco_div, &vco);
+	if (ret)
+		return ret;
+
+	ad9361_rfpll_vco_init(phy, vco, parent_rate, tdd_table, slot->regs);
+
+	slot->regs[AD9361_RFPLL_WORD] = SYNTH_FRACT_WORD(fract >> 16);
+	slot->regs[AD9361_RFPLL_WORD + 1] = fract >> 8;
+	slot->regs[AD9361_RFPLL_WORD + 2] = fract & 0xFF;
+	slot->regs[AD9361_RFPLL_WORD + 3] = SYNTH_INTEGER_WORD(integer >> 8);
+	slot->regs[AD9361_RFPLL_WORD + 4] = integer & 0xFF;
+
+	slot->rate = rate;
+	slot->parent_rate = parent_rate;
+	slot->tdd_table = tdd_table;
+	slot->last_use = cache->counter;
+	slot->valid = true;
+	*entry = slot;
+
+	return 0;
+}
+
+/**
+ * Program the synthesizer, writing only the registers that differ from the
+ * programmed ones.
+ * @param phy The AD9361 state structure.
+ * @param tx Set true for TX_RFPLL.
+ * @param e The synthesizer settings.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_rfpll_write(struct ad9361_rf_phy *phy, bool tx,
+				  const struct ad9361_rfpll_cache_entry *e)
+{
+	struct ad9361_rfpll_cache *cache = &phy->rfpll_cache;
+	uint8_t *shadow = cache->shadow[tx];
+	uint8_t val[AD9361_RFPLL_REGS], msgs[48], div;
+	uint32_t i, j, last, reg, num, offs, len = 0, written = 0;
+	int32_t ret;
+
+	offs = tx ? REG_TX_INTEGER_BYTE_0 - REG_RX_INTEGER_BYTE_0 : 0;
+
+	/* Unknown synthesizer state, read it back once */
+	if (!cache->shadow_valid[tx]) {
+		reg = REG_RX_INTEGER_BYTE_0 + AD9361_RFPLL_SHADOW_SIZE - 1;
+		for (i = AD9361_RFPLL_SHADOW_SIZE; i > 0; i -= num, reg -= num) {
+			uint8_t rbuf[MAX_MBYTE_SPI];
+
+			num = min_t(uint32_t, i, MAX_MBYTE_SPI);
+			ret = ad9361_spi_readm(phy->spi, reg + offs, rbuf, num);
+			if (ret < 0)
+				return ret;
+			for (j = 0; j < num; j++)
+				shadow[reg - j - REG_RX_INTEGER_BYTE_0] = rbuf[j];
+		}
+		cache->shadow_valid[tx] = true;
+	}
+
+	if (!cache->div_valid) {
+		cache->div = ad9361_spi_read(phy->spi, REG_RFPLL_DIVIDERS);
+		cache->div_valid = true;
+	}
+
+	for (i = 0; i < AD9361_RFPLL_REGS; i++) {
+		reg = ad9361_rfpll_regs[i].reg - REG_RX_INTEGER_BYTE_0;
+		val[i] = (shadow[reg] & ~ad9361_rfpll_regs[i].mask) |
+			 (e->regs[i] & ad9361_rfpll_regs[i].mask);
+	}
+
+	/* VCO and loop filter: bursts over adjacent registers that changed */
+	for (i = 0; i < AD9361_RFPLL_WORD; i = last + 1) {
+		reg = ad9361_rfpll_regs[i].reg;
+		if (val[i] == shadow[reg - REG_RX_INTEGER_BYTE_0]) {
+			last = i;
+			continue;
+		}
+
+		for (j = i, last = i; j + 1 < AD9361_RFPLL_WORD &&
+		     ad9361_rfpll_regs[j + 1].reg == ad9361_rfpll_regs[j].reg - 1 &&
+		     j + 1 - i < MAX_MBYTE_SPI; j++)
+			if (val[j + 1] != shadow[ad9361_rfpll_regs[j + 1].reg -
+								 REG_RX_INTEGER_BYTE_0])
+				last = j + 1;
+
+		len = ad9361_spi_batch_add(msgs, len, reg + offs, &val[i],
+					   last - i + 1);
+		written += last - i + 1;
+	}
+
+	/* Synthesizer word, always ending with the integer byte since writing
+	 * it starts the VCO calibration */
+	for (i = AD9361_RFPLL_WORD; i < AD9361_RFPLL_REGS - 1; i++)
+		if (val[i] != shadow[ad9361_rfpll_regs[i].reg -
+					 REG_RX_INTEGER_BYTE_0])
+			break;
+
+	len = ad9361_spi_batch_add(msgs, len, ad9361_rfpll_regs[i].reg + offs,
+				   &val[i], AD9361_RFPLL_REGS - i);
+	written += AD9361_RFPLL_REGS - i;
+
+	if (tx)
+		div = (cache->div & ~TX_VCO_DIVIDER(~0)) | TX_VCO_DIVIDER(e->vco_div);
+	else
+		div = (cache->div & ~RX_VCO_DIVIDER(~0)) | RX_VCO_DIVIDER(e->vco_div);
+
+	if (div != cache->div) {
+		len = ad9361_spi_batch_add(msgs, len, REG_RFPLL_DIVIDERS, &div, 1);
+		written++;
+	}
+
+	ret = ad9361_spi_write_batch(phy->spi, msgs, len);
+	if (ret < 0) {
+		ad9361_rfpll_shadow_flush(phy);
+		return ret;
+	}
+
+	for (i = 0; i < AD9361_RFPLL_REGS; i++)
+		shadow[ad9361_rfpll_regs[i].reg - REG_RX_INTEGER_BYTE_0] = val[i];
+	cache->div = div;
+
+	cache->stats.regs_written += written;
+	cache->stats.regs_skipped += AD9361_RFPLL_REGS + 1 - written;
+
+	return 0;
+}
+
 /**
  * Recalculate the clock rate.
  * @param clk_priv The refclk_scale structure.
@@ -6628,10 +8537,13 @@ int32_t ad9361_rfpll_int_set_rate(struct refclk_scale *clk_priv, uint32_t rate,
 				  uint32_t parent_rate)
 {
 	struct ad9361_rf_phy *phy = clk_priv->phy;
-	uint64_t vco = 0;
-	uint8_t buf[5];
-	uint32_t reg, div_mask, lock_reg, fract = 0, integer = 0;
-	int32_t vco_div, ret, fixup_other;
+	struct ad9361_rfpll_stats *stats = &phy->rfpll_cache.stats;
+	struct ad9361_rfpll_cache_entry *entry;
+	int32_t ret, fixup_other;
+	bool tx;
+#ifdef HAVE_RETUNE_TIMING
+	uint64_t start_ns = timestamp_ns();
+#endif
 
 	dev_dbg(&clk_priv->spi->dev,
 		"%s: %s Rate %"PRIu32" Hz Parent Rate %"PRIu32" Hz",
@@ -6640,24 +8552,17 @@ int32_t ad9361_rfpll_int_set_rate(struct refclk_scale *clk_priv, uint32_t rate,
 
 	ad9361_fastlock_prepare(phy, clk_priv->source == TX_RFPLL_INT, 0, false);
 
-	ret = ad9361_calc_rfpll_int_divder(phy, ad9361_from_clk(rate), parent_rate,
-					   &integer, &fract, &vco_div, &vco);
+	ret = ad9361_validate_rfpll(phy, ad9361_from_clk(rate));
 	if (ret < 0)
 		return ret;
 
 	switch (clk_priv->source) {
 	case RX_RFPLL_INT:
-		reg = REG_RX_FRACT_BYTE_2;
-		lock_reg = REG_RX_CP_OVERRANGE_VCO_LOCK;
-		div_mask = RX_VCO_DIVIDER(~0);
-		phy->cached_rx_rfpll_div = vco_div;
+		tx = false;
 		phy->current_rx_lo_freq = rate;
 		break;
 	case TX_RFPLL_INT:
-		reg = REG_TX_FRACT_BYTE_2;
-		lock_reg = REG_TX_CP_OVERRANGE_VCO_LOCK;
-		div_mask = TX_VCO_DIVIDER(~0);
-		phy->cached_tx_rfpll_div = vco_div;
+		tx = true;
 		phy->current_tx_lo_freq = rate;
 		break;
 	default:
@@ -6672,21 +8577,22 @@ int32_t ad9361_rfpll_int_set_rate(struct refclk_scale *clk_priv, uint32_t rate,
 
 	do {
 		fixup_other = 0;
-		ad9361_rfpll_vco_init(phy, div_mask == TX_VCO_DIVIDER(~0),
-				      vco, parent_rate);
 
-		buf[0] = SYNTH_FRACT_WORD(fract >> 16);
-		buf[1] = fract >> 8;
-		buf[2] = fract & 0xFF;
-		buf[3] = SYNTH_INTEGER_WORD(integer >> 8) |
-			 (~SYNTH_INTEGER_WORD(~0) &
-			  ad9361_spi_read(clk_priv->spi, reg - 3));
-		buf[4] = integer & 0xFF;
+		ret = ad9361_rfpll_cache_get(phy, tx, rate, parent_rate, &entry);
+		if (ret)
+			return ret;
+
+		if (tx)
+			phy->cached_tx_rfpll_div = entry->vco_div;
+		else
+			phy->cached_rx_rfpll_div = entry->vco_div;
 
-		ad9361_spi_writem(clk_priv->spi, reg, buf, 5);
-		ad9361_spi_writef(clk_priv->spi, REG_RFPLL_DIVIDERS, div_mask, vco_div);
+		ret = ad9361_rfpll_write(phy, tx, entry);
+		if (ret < 0)
+			return ret;
 
-		ret = ad9361_check_cal_done(phy, lock_reg, VCO_LOCK, 1);
+		ret = ad9361_check_cal_done(phy, tx ? REG_TX_CP_OVERRANGE_VCO_LOCK :
+					    REG_RX_CP_OVERRANGE_VCO_LOCK, VCO_LOCK, 1);
 
 		/* In FDD mode with RX LO == TX LO frequency we use TDD tables to
 		 * reduce VCO pulling
@@ -6698,32 +8604,12 @@ int32_t ad9361_rfpll_int_set_rate(struct refclk_scale *clk_priv, uint32_t rate,
 		    ((phy->pdata->fdd && !phy->pdata->fdd_independent_mode)  &&
 		     (phy->current_tx_lo_freq != phy->current_rx_lo_freq) &&
 		     (phy->current_tx_use_tdd_table || phy->current_rx_use_tdd_table))) {
-			unsigned long _rate;
-
-			switch (clk_priv->source) {
-			case RX_RFPLL_INT:
-				reg = REG_TX_FRACT_BYTE_2;
-				lock_reg = REG_TX_CP_OVERRANGE_VCO_LOCK;
-				div_mask = TX_VCO_DIVIDER(~0);
-				_rate = phy->current_tx_lo_freq;
-				break;
-			case TX_RFPLL_INT:
-				reg = REG_RX_FRACT_BYTE_2;
-				lock_reg = REG_RX_CP_OVERRANGE_VCO_LOCK;
-				div_mask = RX_VCO_DIVIDER(~0);
-				_rate = phy->current_rx_lo_freq;
-				break;
-			default:
-				return -EINVAL;
-
-			}
 
-			if (phy->current_tx_lo_freq != phy->current_rx_lo_freq) {
-				ad9361_calc_rfpll_int_divder(phy, ad9361_from_clk(_rate),
-							     parent_rate, &integer, &fract, &vco_div, &vco);
+			tx = !tx;
+			rate = tx ? phy->current_tx_lo_freq : phy->current_rx_lo_freq;
 
-				ad9361_fastlock_prepare(phy, clk_priv->source == RX_RFPLL_INT, 0, false);
-			}
+			if (phy->current_tx_lo_freq != phy->current_rx_lo_freq)
+				ad9361_fastlock_prepare(phy, tx, 0, false);
 
 			fixup_other = 1;
 		}
@@ -6734,6 +8620,16 @@ int32_t ad9361_rfpll_int_set_rate(struct refclk_scale *clk_priv, uint32_t rate,
 		ad9361_trx_vco_cal_control(phy, clk_priv->source == TX_RFPLL_INT,
 					   false);
 
+	stats->retunes++;
+#ifdef HAVE_RETUNE_TIMING
+	stats->last_ns = timestamp_elapsed_ns(start_ns);
+	stats->total_ns += stats->last_ns;
+	if (!stats->min_ns || stats->last_ns < stats->min_ns)
+		stats->min_ns = stats->last_ns;
+	if (stats->last_ns > stats->max_ns)
+		stats->max_ns = stats->last_ns;
+#endif
+
 	return ret;
 }
 
@@ -6891,11 +8787,7 @@ int32_t ad9361_rfpll_set_rate(struct refclk_scale *clk_priv, uint32_t rate)
 		if (phy->auto_cal_en && !phy->pdata->use_ext_tx_lo)
 			if ((diff_abs(phy->last_tx_quad_cal_freq, ad9361_from_clk(rate))) >
 			    phy->cal_threshold_freq) {
-				ret = ad9361_do_calib_run(phy, TX_QUAD_CAL, -1);
-				if (ret < 0)
-					dev_err(&phy->spi->dev,
-						"%s: TX QUAD cal failed", __func__);
-				phy->last_tx_quad_cal_freq = ad9361_from_clk(rate);
+				ad9361_tx_quad_calib_lo(phy, ad9361_from_clk(rate));
 			}
 		break;
 	default:
@@ -7164,6 +9056,9 @@ int32_t register_clocks(struct ad9361_rf_phy *phy)
 			      flags | CLK_IGNORE_UNUSED,
 			      TX_RFPLL, 0);
 
+	/* The rates were just read back from the hardware */
+	phy->clk_stale = 0;
+
 	return 0;
 }
 
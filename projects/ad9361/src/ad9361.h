@@ -3039,6 +3039,146 @@ struct rx_gain_info {
 	int32_t idx_step_offset;
 };
 
+struct ad9361_gt_cache {
+	uint8_t		*msgs;
+	uint32_t	len;
+	bool		split;
+	uint32_t	lna;
+	uint32_t	dest;
+};
+
+#define AD9361_CAL_DONE_POLLS	20000
+#define AD9361_CAL_TIMEOUT_US	24000000 /* 20000 polls of 1200 us */
+#define AD9361_CAL_POLL_MIN_US	100
+#define AD9361_TX_QUAD_CAL_US	1200 /* initial expected durations */
+#define AD9361_RFDC_CAL_US	12000
+#define AD9361_BBDC_CAL_US	2000
+
+enum ad9361_cal_step {
+	AD9361_CAL_STEP_IDLE,
+	AD9361_CAL_STEP_RUN,
+	AD9361_CAL_STEP_QUAD_FIRST,
+	AD9361_CAL_STEP_QUAD_RETRY,
+	AD9361_CAL_STEP_QUAD_SEARCH,
+	AD9361_CAL_STEP_QUAD_FINAL,
+	AD9361_CAL_STEP_DONE,
+};
+
+struct sched_task;
+
+struct ad9361_cal_wait {
+	struct ad9361_rf_phy	*phy;
+	uint32_t	reg;
+	uint32_t	mask;
+	uint32_t	done_state;
+	int32_t		state;
+	int32_t		ret;
+};
+
+struct ad9361_cal_state {
+	enum ad9361_cal_step	step;
+	uint32_t	cal;
+	int32_t		ret;
+	bool		restore;
+	uint32_t	mask;
+	uint64_t	poll_ns;
+	uint32_t	elapsed_us;
+	uint32_t	wait_us;
+	uint32_t	tx_quad_cal_us;
+	uint32_t	rfdc_cal_us;
+	uint32_t	bbdc_cal_us;
+	/* TX quadrature calibration */
+	uint32_t	rxnco_word;
+	uint8_t		decim;
+	uint8_t		rx_phase;
+	uint8_t		reg_inv_bits;
+	uint8_t		phase;
+	int32_t		txnco_freq;
+	uint32_t	bw_rx;
+	uint32_t	bw_tx;
+	uint8_t		field[64];
+};
+
+#define AD9361_CAL_CACHE_SIZE	16
+#define AD9361_CAL_CACHE_REGS	16 /* REG_TX1_OUT_1_PHASE_CORR .. REG_TX2_OUT_2_OFFSET_Q */
+
+struct ad9361_cal_cache_entry {
+	uint64_t	lo_freq;
+	uint32_t	rx_bw;
+	uint32_t	tx_bw;
+	int32_t		temp;
+	uint32_t	phase;
+	uint32_t	last_use;
+	bool		valid;
+	/* Registers in decrementing order from REG_TX2_OUT_2_OFFSET_Q */
+	uint8_t		regs[AD9361_CAL_CACHE_REGS];
+};
+
+struct ad9361_cal_cache {
+	bool		en;
+	int32_t		temp_threshold;
+	uint32_t	counter;
+	uint32_t	hits;
+	uint32_t	misses;
+	struct ad9361_cal_cache_entry	entry[AD9361_CAL_CACHE_SIZE];
+};
+
+#define AD9361_RFPLL_CACHE_SIZE	8
+#define AD9361_RFPLL_REGS	16 /* REG_RX_VCO_VARACTOR_CTRL_1 .. REG_RX_INTEGER_BYTE_0 */
+#define AD9361_RFPLL_SHADOW_SIZE	33 /* REG_RX_INTEGER_BYTE_0 .. REG_RX_VCO_VARACTOR_CTRL_1 */
+
+struct ad9361_rfpll_cache_entry {
+	uint32_t	rate;
+	uint32_t	parent_rate;
+	bool		tdd_table;
+	bool		valid;
+	uint32_t	last_use;
+	int32_t		vco_div;
+	uint8_t		regs[AD9361_RFPLL_REGS];
+};
+
+struct ad9361_rfpll_stats {
+	uint32_t	retunes;
+	uint32_t	hits;
+	uint32_t	misses;
+	uint32_t	regs_written;
+	uint32_t	regs_skipped;
+	uint64_t	last_ns;
+	uint64_t	min_ns;
+	uint64_t	max_ns;
+	uint64_t	total_ns;
+};
+
+struct ad9361_rfpll_cache {
+	uint32_t	counter;
+	/* Programmed synthesizer registers, indexed from REG_RX_INTEGER_BYTE_0 */
+	bool		shadow_valid[2];
+	uint8_t		shadow[2][AD9361_RFPLL_SHADOW_SIZE];
+	bool		div_valid;
+	uint8_t		div;
+	struct ad9361_rfpll_cache_entry	entry[2][AD9361_RFPLL_CACHE_SIZE];
+	struct ad9361_rfpll_stats	stats;
+};
+
+#define AD9361_FIR_BATCH_TAPS	16 /* Coefficients per batched SPI write */
+
+/* Binary FIR profile: 16 byte header (magic, version, size, CRC-32 of the
+ * rest), TX and RX filter descriptors (dest, gain, interpolation/decimation,
+ * taps, path clocks[6], bandwidth), then the TX and RX coefficients. All
+ * values are little endian. */
+#define AD9361_FIR_PROFILE_MAGIC	0x52494641 /* "AFIR" */
+#define AD9361_FIR_PROFILE_VERSION	1
+#define AD9361_FIR_PROFILE_HDR_SIZE	16
+#define AD9361_FIR_PROFILE_FILT_SIZE	32
+#define AD9361_FIR_PROFILE_SIZE(tx_taps, rx_taps) \
+	(AD9361_FIR_PROFILE_HDR_SIZE + 2 * AD9361_FIR_PROFILE_FILT_SIZE + \
+	 2 * ((tx_taps) + (rx_taps)))
+#define AD9361_FIR_PROFILE_MAX_SIZE	AD9361_FIR_PROFILE_SIZE(128, 128)
+
+#define AD9361_SNAPSHOT_MAGIC	0x4E534441 /* "ADSN" */
+#define AD9361_SNAPSHOT_VERSION	1
+#define AD9361_SNAPSHOT_HDR_SIZE	20
+
 struct port_control {
 	uint8_t			pp_conf[3];
 	uint8_t			rx_clk_data_delay;
@@ -3290,6 +3430,8 @@ struct ad9361_fastlock {
 	struct ad9361_fastlock_entry entry[2][8];
 };
 
+#define AD9361_MAX_MULTI_DEV	4 /* devices brought up together */
+
 enum dig_tune_flags {
 	BE_VERBOSE = 1,
 	BE_MOREVERBOSE = 2,
@@ -3347,10 +3489,12 @@ struct ad9361_rf_phy {
 	uint8_t			cached_synth_pd[2];
 	struct rx_gain_info rx_gain[RXGAIN_TBLS_END];
 	enum rx_gain_table_name current_table;
+	struct ad9361_gt_cache	gt_cache[RXGAIN_TBLS_END];
 	bool 			ensm_pin_ctl_en;
 
 	bool			auto_cal_en;
 	uint64_t			last_tx_quad_cal_freq;
+	bool				tx_quad_cal_pending;
 	uint32_t			last_tx_quad_cal_phase;
 	uint64_t		current_tx_lo_freq;
 	uint64_t		current_rx_lo_freq;
@@ -3358,6 +3502,9 @@ struct ad9361_rf_phy {
 	bool			current_rx_use_tdd_table;
 	uint32_t		flags;
 	uint32_t		cal_threshold_freq;
+	struct ad9361_cal_cache	cal_cache;
+	struct ad9361_cal_state	cal_state;
+	struct ad9361_rfpll_cache	rfpll_cache;
 	uint32_t			current_rx_bw_Hz;
 	uint32_t			current_tx_bw_Hz;
 	uint32_t			rxbbf_div;
@@ -3394,6 +3541,7 @@ struct ad9361_rf_phy {
 	uint32_t				bist_tone_level_dB;
 	uint32_t				bist_tone_mask;
 	bool			bbpll_initialized;
+	uint32_t		clk_stale;
 };
 
 struct refclk_scale {
@@ -3428,7 +3576,12 @@ int32_t ad9361_reset(struct ad9361_rf_phy *phy);
 int32_t register_clocks(struct ad9361_rf_phy *phy);
 int32_t ad9361_init_gain_tables(struct ad9361_rf_phy *phy);
 int32_t ad9361_setup(struct ad9361_rf_phy *phy);
+int32_t ad9361_setup_config(struct ad9361_rf_phy *phy);
+int32_t ad9361_setup_calib_start(struct ad9361_rf_phy *phy);
+int32_t ad9361_setup_calib_poll(struct ad9361_rf_phy *phy, uint32_t *wait_us);
+int32_t ad9361_setup_finish(struct ad9361_rf_phy *phy);
 int32_t ad9361_post_setup(struct ad9361_rf_phy *phy);
+int32_t ad9361_multi_post_setup(struct ad9361_rf_phy **phys, uint32_t nb);
 int32_t ad9361_set_ensm_mode(struct ad9361_rf_phy *phy, bool fdd, bool pinctrl);
 int32_t ad9361_ensm_set_state(struct ad9361_rf_phy *phy, uint8_t ensm_state,
 			      bool pinctrl);
@@ -3457,6 +3610,10 @@ int32_t ad9361_set_gain_ctrl_mode(struct ad9361_rf_phy *phy,
 int32_t ad9361_load_fir_filter_coef(struct ad9361_rf_phy *phy,
 				    enum fir_dest dest, int32_t gain_dB,
 				    uint32_t ntaps, short *coef);
+int32_t ad9361_fir_profile_build(char *data, uint32_t size,
+				 uint8_t *profile, uint32_t *profile_size);
+int32_t ad9361_fir_profile_load(struct ad9361_rf_phy *phy,
+				const uint8_t *profile, uint32_t size);
 int32_t ad9361_validate_enable_fir(struct ad9361_rf_phy *phy);
 int32_t ad9361_set_tx_atten(struct ad9361_rf_phy *phy, uint32_t atten_mdb,
 			    bool tx1, bool tx2, bool immed);
@@ -3506,6 +3663,20 @@ int32_t ad9361_rf_port_setup(struct ad9361_rf_phy *phy, bool is_out,
 int32_t ad9361_mcs(struct ad9361_rf_phy *phy, int32_t step);
 int32_t ad9361_do_calib_run(struct ad9361_rf_phy *phy, uint32_t cal,
 			    int32_t arg);
+int32_t ad9361_calib_start(struct ad9361_rf_phy *phy, uint32_t cal,
+			   int32_t arg);
+int32_t ad9361_calib_poll(struct ad9361_rf_phy *phy, uint32_t *wait_us);
+int32_t ad9361_calib_complete(struct ad9361_rf_phy *phy);
+int32_t ad9361_check_cal_done_task(struct sched_task *task, void *ctx);
+void ad9361_cal_cache_flush(struct ad9361_rf_phy *phy);
+void ad9361_rfpll_shadow_flush(struct ad9361_rf_phy *phy);
+void ad9361_get_rfpll_stats(struct ad9361_rf_phy *phy,
+			    struct ad9361_rfpll_stats *stats);
+void ad9361_clear_rfpll_stats(struct ad9361_rf_phy *phy);
+int32_t ad9361_snapshot_save(struct ad9361_rf_phy *phy, uint8_t **buf,
+			     uint32_t *size);
+int32_t ad9361_warm_boot(struct ad9361_rf_phy *phy, const uint8_t *buf,
+			 uint32_t size);
 int32_t ad9361_fastlock_store(struct ad9361_rf_phy *phy, bool tx,
 			      uint32_t profile);
 int32_t ad9361_fastlock_recall(struct ad9361_rf_phy *phy, bool tx,
@@ -3524,8 +3695,14 @@ int32_t ad9361_find_opt(uint8_t *field, uint32_t size, uint32_t *ret_start);
 int32_t ad9361_hdl_loopback(struct ad9361_rf_phy *phy, bool enable);
 int32_t ad9361_dig_interface_timing_analysis(struct ad9361_rf_phy *phy,
 		char *buf, int32_t buflen);
+void ad9361_set_intf_delay(struct ad9361_rf_phy *phy, bool tx,
+			   uint32_t clock_delay,
+			   uint32_t data_delay, bool clock_changed);
 int32_t ad9361_dig_tune(struct ad9361_rf_phy *phy, uint32_t max_freq,
 			enum dig_tune_flags flags);
+int32_t ad9361_multi_dig_tune(struct ad9361_rf_phy **phys, uint32_t nb,
+			      const uint32_t *max_freq,
+			      enum dig_tune_flags flags);
 int32_t ad9361_en_dis_tx(struct ad9361_rf_phy *phy, uint32_t tx_if,
 			 uint32_t enable);
 int32_t ad9361_en_dis_rx(struct ad9361_rf_phy *phy, uint32_t rx_if,
@@ -49,6 +49,9 @@
 #include "util.h"
 #include "config.h"
 #include <string.h>
+#ifdef HAVE_BOOT_TIMING
+#include "timestamp.h"
+#endif
 
 #define ADI_REG_VERSION			0x0000
 
@@ -69,16 +72,35 @@ static struct axiadc_chip_info axiadc_chip_info_tbl[] = {
 #endif
 
 /**
- * Initialize the AD9361 part.
+ * Free the resources of an AD9361 part.
+ * @param phy The AD9361 state structure.
+ * @return None.
+ */
+static void ad9361_free(struct ad9361_rf_phy *phy)
+{
+	int32_t i;
+
+	for (i = 0; i < RXGAIN_TBLS_END; i++)
+		free(phy->gt_cache[i].msgs);
+	free(phy->spi);
+#ifndef AXI_ADC_NOT_PRESENT
+	free(phy->adc_conv);
+	free(phy->adc_state);
+#endif
+	free(phy->clk_refin);
+	free(phy->pdata);
+	free(phy);
+}
+
+/**
+ * Allocate the AD9361 state, reset the part and register its clocks.
  * @param ad9361_phy The AD9361 state structure.
  * @param init_param The structure that contains the AD9361 initial parameters.
- * @return A structure that contains the AD9361 current state in case of
- *         success, negative error code otherwise.
- *
- * Note: This function will/may affect the data path.
+ * @return The silicon revision in case of success, negative error code
+ *         otherwise.
  */
-int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
-		     AD9361_InitParam *init_param)
+static int32_t ad9361_probe(struct ad9361_rf_phy **ad9361_phy,
+			    AD9361_InitParam *init_param)
 {
 	struct ad9361_rf_phy *phy;
 	int32_t ret = 0;
@@ -516,6 +538,11 @@ int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
 	phy->bbdc_track_en = true;
 	phy->quad_track_en = true;
 
+	phy->cal_state.step = AD9361_CAL_STEP_IDLE;
+	phy->cal_state.tx_quad_cal_us = AD9361_TX_QUAD_CAL_US;
+	phy->cal_state.rfdc_cal_us = AD9361_RFDC_CAL_US;
+	phy->cal_state.bbdc_cal_us = AD9361_BBDC_CAL_US;
+
 	phy->bist_loopback_mode = 0;
 	phy->bist_config = 0;
 	phy->bist_prbs_mode = BIST_DISABLE;
@@ -544,7 +571,50 @@ int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
 
 	ad9361_init_gain_tables(phy);
 
-	ret = ad9361_setup(phy);
+	*ad9361_phy = phy;
+
+	return rev;
+
+out:
+	ad9361_free(phy);
+
+	return ret;
+}
+
+/**
+ * Initialize the AD9361 part.
+ * @param ad9361_phy The AD9361 state structure.
+ * @param init_param The structure that contains the AD9361 initial parameters.
+ * @return A structure that contains the AD9361 current state in case of
+ *         success, negative error code otherwise.
+ *
+ * Note: This function will/may affect the data path.
+ */
+int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
+		     AD9361_InitParam *init_param)
+{
+	struct ad9361_rf_phy *phy;
+	int32_t ret = 0;
+	int32_t rev = 0;
+
+	rev = ad9361_probe(&phy, init_param);
+	if (rev < 0) {
+		printf("%s : AD936x initialization error\n", __func__);
+		return -ENODEV;
+	}
+
+	if (init_param->warm_boot_snapshot) {
+		ret = ad9361_warm_boot(phy, init_param->warm_boot_snapshot,
+				       init_param->warm_boot_snapshot_size);
+		if (ret < 0) {
+			printf("%s : Warm boot failed, falling back to full setup\n",
+			       __func__);
+			ad9361_reset(phy);
+			ret = ad9361_setup(phy);
+		}
+	} else {
+		ret = ad9361_setup(phy);
+	}
 	if (ret < 0)
 		goto out;
 
@@ -564,17 +634,178 @@ int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
 	return 0;
 
 out:
-	free(phy->spi);
+	ad9361_free(phy);
+	printf("%s : AD936x initialization error\n", __func__);
+
+	return -ENODEV;
+}
+
+/**
+ * Account the time spent in a boot phase.
+ * @param stats The boot statistics, may be NULL.
+ * @param phase The boot phase that just ended.
+ * @param start_ns The start time of the phase, updated to the current time.
+ * @return None.
+ */
+static void ad9361_boot_phase_end(struct ad9361_boot_stats *stats,
+				  enum ad9361_boot_phase phase,
+				  uint64_t *start_ns)
+{
+#ifdef HAVE_BOOT_TIMING
+	uint64_t now_ns = timestamp_ns();
+
+	if (stats) {
+		stats->phase_ns[phase] = now_ns - *start_ns;
+		stats->total_ns += stats->phase_ns[phase];
+	}
+	*start_ns = now_ns;
+#endif
+}
+
+/**
+ * Initialize multiple AD9361 parts together.
+ *
+ * The parts are brought up phase by phase instead of one after the other:
+ * the initial calibrations of a part are started before the next part is
+ * configured and are then polled on all the parts at once, and the digital
+ * interfaces are tuned in lockstep. The parts are not synchronized: call
+ * ad9361_multi_mcs() once the FIR filters and the HDL cores are set up, as
+ * loading the FIR filters clocks the filter blocks.
+ * @param phys The AD9361 state structures.
+ * @param init_params The initial parameters of each part.
+ * @param nb The number of parts [1, AD9361_MAX_MULTI_DEV].
+ * @param stats The time spent in each boot phase, may be NULL. Only
+ *              measured when HAVE_BOOT_TIMING is defined. The MCS phase is
+ *              left to the caller.
+ * @return 0 in case of success, negative error code otherwise.
+ *
+ * Note: This function will/may affect the data path.
+ */
+int32_t ad9361_multi_init(struct ad9361_rf_phy **phys,
+			  AD9361_InitParam **init_params, uint32_t nb,
+			  struct ad9361_boot_stats *stats)
+{
+	int32_t rev[AD9361_MAX_MULTI_DEV];
+	bool calib[AD9361_MAX_MULTI_DEV];
+	uint32_t due_us[AD9361_MAX_MULTI_DEV];
+	uint32_t n, nb_probed = 0, done, wait_us, min_wait_us;
+	uint64_t start_ns = 0;
+	int32_t ret;
+
+	if (!nb || nb > AD9361_MAX_MULTI_DEV)
+		return -EINVAL;
+
+	if (stats)
+		memset(stats, 0, sizeof(*stats));
+#ifdef HAVE_BOOT_TIMING
+	start_ns = timestamp_ns();
+#endif
+
+	for (n = 0; n < nb; n++) {
+		rev[n] = ad9361_probe(&phys[n], init_params[n]);
+		if (rev[n] < 0) {
+			ret = rev[n];
+			goto out;
+		}
+		nb_probed++;
+	}
+	ad9361_boot_phase_end(stats, AD9361_BOOT_PROBE, &start_ns);
+
+	/* Configure each part while the calibrations of the previous ones run */
+	for (n = 0; n < nb; n++) {
+		calib[n] = false;
+		if (init_params[n]->warm_boot_snapshot) {
+			ret = ad9361_warm_boot(phys[n],
+					       init_params[n]->warm_boot_snapshot,
+					       init_params[n]->warm_boot_snapshot_size);
+			if (!ret)
+				continue;
+			printf("%s : Warm boot failed, falling back to full setup\n",
+			       __func__);
+			ad9361_reset(phys[n]);
+		}
+
+		ret = ad9361_setup_config(phys[n]);
+		if (ret < 0)
+			goto out;
+
+		ret = ad9361_setup_calib_start(phys[n]);
+		if (ret < 0)
+			goto out;
+		calib[n] = true;
+		due_us[n] = 0;
+	}
+	ad9361_boot_phase_end(stats, AD9361_BOOT_SETUP, &start_ns);
+
+	/*
+	 * Poll a part only once the wait it asked for is over. With a time
+	 * base, an early poll would only cost an SPI read, but without one the
+	 * calibration poll accounts that wait as elapsed time for its timeout
+	 * and for the learned calibration duration.
+	 */
+	do {
+		done = 0;
+		min_wait_us = AD9361_CAL_TIMEOUT_US;
+		for (n = 0; n < nb; n++) {
+			if (!calib[n]) {
+				done++;
+				continue;
+			}
+
+			if (!due_us[n]) {
+				ret = ad9361_setup_calib_poll(phys[n], &wait_us);
+				if (ret == -EINPROGRESS) {
+					due_us[n] = wait_us;
+				} else {
+					if (ret < 0)
+						goto out;
+
+					ret = ad9361_setup_finish(phys[n]);
+					if (ret < 0)
+						goto out;
+					calib[n] = false;
+					done++;
+					continue;
+				}
+			}
+			min_wait_us = min(min_wait_us, due_us[n]);
+		}
+		if (done < nb) {
+			udelay(min_wait_us);
+			for (n = 0; n < nb; n++)
+				if (calib[n])
+					due_us[n] -= min_wait_us;
+		}
+	} while (done < nb);
+	ad9361_boot_phase_end(stats, AD9361_BOOT_CALIB, &start_ns);
+
 #ifndef AXI_ADC_NOT_PRESENT
-	free(phy->adc_conv);
-	free(phy->adc_state);
+	for (n = 0; n < nb; n++) {
+		axi_adc_init(&phys[n]->rx_adc, phys[n]->rx_adc_init);
+		axi_adc_read(phys[n]->rx_adc, ADI_REG_VERSION,
+			     &phys[n]->adc_state->pcore_version);
+	}
+	/* platform specific wrapper to call ad9361_post_setup() */
+	ret = ad9361_multi_post_setup(phys, nb);
+	if (ret < 0)
+		goto out;
 #endif
-	free(phy->clk_refin);
-	free(phy->pdata);
-	free(phy);
+	ad9361_boot_phase_end(stats, AD9361_BOOT_INTERFACE, &start_ns);
+
+	for (n = 0; n < nb; n++)
+		printf("%s : AD936x #%d Rev %d successfully initialized\n",
+		       __func__, (int)n, (int)rev[n]);
+
+	return 0;
+
+out:
+	for (n = 0; n < nb_probed; n++) {
+		ad9361_free(phys[n]);
+		phys[n] = NULL;
+	}
 	printf("%s : AD936x initialization error\n", __func__);
 
-	return -ENODEV;
+	return ret;
 }
 
 /**
@@ -1753,6 +1984,46 @@ int32_t ad9361_get_tx_auto_cal_en_dis (struct ad9361_rf_phy *phy,
 	return 0;
 }
 
+/**
+ * Enable/disable the auto calibration results cache.
+ * When enabled, the results of the TX quadrature calibrations run on TX LO
+ * changes are saved per LO range, RF bandwidth and temperature, and restored
+ * instead of calibrating again when returning to an already visited LO.
+ * Disabling the cache also clears it.
+ * @param phy The AD9361 current state structure.
+ * @param en_dis The option (ENABLE, DISABLE).
+ * 				 Accepted values:
+ * 				  ENABLE (1)
+ * 				  DISABLE (0)
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_set_tx_cal_cache_en_dis (struct ad9361_rf_phy *phy,
+					uint8_t en_dis)
+{
+	if (en_dis == 0) {
+		phy->cal_cache.en = 0;
+		ad9361_cal_cache_flush(phy);
+	} else {
+		phy->cal_cache.en = 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Get the status of the auto calibration results cache.
+ * @param phy The AD9361 current state structure.
+ * @param en_dis The enable/disable status buffer.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_get_tx_cal_cache_en_dis (struct ad9361_rf_phy *phy,
+					uint8_t *en_dis)
+{
+	*en_dis = phy->cal_cache.en;
+
+	return 0;
+}
+
 /**
  * Store TX fastlock profile.
  * To create a profile tune the synthesizer (ad9361_set_tx_lo_freq()) and then
@@ -1973,48 +2244,69 @@ int32_t ad9361_set_no_ch_mode(struct ad9361_rf_phy *phy, uint8_t no_ch_mode)
 }
 
 /**
- * Do multi chip synchronization.
- * @param phy_master The AD9361 Master state structure.
- * @param phy_slave The AD9361 Slave state structure.
+ * Do multi chip synchronization of multiple parts.
+ * @param phys The AD9361 state structures, the first one being the master.
+ * @param nb The number of parts.
  * @return 0 in case of success, negative error code otherwise.
  *
  * Note: This function will/may affect the data path.
  */
-int32_t ad9361_do_mcs(struct ad9361_rf_phy *phy_master,
-		      struct ad9361_rf_phy *phy_slave)
+int32_t ad9361_multi_mcs(struct ad9361_rf_phy **phys, uint32_t nb)
 {
+	struct ad9361_rf_phy *phy_master = phys[0];
 	uint32_t ensm_mode;
+	uint32_t n;
 	int32_t step;
 	int32_t reg;
 
-	if ((phy_master->dev_sel == ID_AD9363A) ||
-	    (phy_slave->dev_sel == ID_AD9363A)) {
-		printf("%s : MCS is not supported by AD9363!\n", __func__);
-		return -1;
+	for (n = 0; n < nb; n++) {
+		if (phys[n]->dev_sel == ID_AD9363A) {
+			printf("%s : MCS is not supported by AD9363!\n", __func__);
+			return -1;
+		}
 	}
 
-	reg = ad9361_spi_read(phy_master->spi, REG_RX_CLOCK_DATA_DELAY);
-	ad9361_spi_write(phy_slave->spi, REG_RX_CLOCK_DATA_DELAY, reg);
-	reg = ad9361_spi_read(phy_master->spi, REG_TX_CLOCK_DATA_DELAY);
-	ad9361_spi_write(phy_slave->spi, REG_TX_CLOCK_DATA_DELAY, reg);
+	for (n = 1; n < nb; n++) {
+		reg = ad9361_spi_read(phy_master->spi, REG_RX_CLOCK_DATA_DELAY);
+		ad9361_spi_write(phys[n]->spi, REG_RX_CLOCK_DATA_DELAY, reg);
+		reg = ad9361_spi_read(phy_master->spi, REG_TX_CLOCK_DATA_DELAY);
+		ad9361_spi_write(phys[n]->spi, REG_TX_CLOCK_DATA_DELAY, reg);
+	}
 
 	ad9361_get_en_state_machine_mode(phy_master, &ensm_mode);
 
-	ad9361_set_en_state_machine_mode(phy_master, ENSM_MODE_ALERT);
-	ad9361_set_en_state_machine_mode(phy_slave, ENSM_MODE_ALERT);
+	for (n = 0; n < nb; n++)
+		ad9361_set_en_state_machine_mode(phys[n], ENSM_MODE_ALERT);
 
 	for (step = 0; step <= 5; step++) {
-		ad9361_mcs(phy_slave, step);
+		for (n = 1; n < nb; n++)
+			ad9361_mcs(phys[n], step);
 		ad9361_mcs(phy_master, step);
 		mdelay(100);
 	}
 
-	ad9361_set_en_state_machine_mode(phy_master, ensm_mode);
-	ad9361_set_en_state_machine_mode(phy_slave, ensm_mode);
+	for (n = 0; n < nb; n++)
+		ad9361_set_en_state_machine_mode(phys[n], ensm_mode);
 
 	return 0;
 }
 
+/**
+ * Do multi chip synchronization.
+ * @param phy_master The AD9361 Master state structure.
+ * @param phy_slave The AD9361 Slave state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ *
+ * Note: This function will/may affect the data path.
+ */
+int32_t ad9361_do_mcs(struct ad9361_rf_phy *phy_master,
+		      struct ad9361_rf_phy *phy_slave)
+{
+	struct ad9361_rf_phy *phys[2] = {phy_master, phy_slave};
+
+	return ad9361_multi_mcs(phys, 2);
+}
+
 /**
  * Enable/disable the TRX FIR filters.
  * @param phy The AD9361 current state structure.
@@ -2095,6 +2387,67 @@ int32_t ad9361_do_calib(struct ad9361_rf_phy *phy, uint32_t cal, int32_t arg)
 	return ad9361_do_calib_run(phy, cal, arg);
 }
 
+/**
+ * Start the selected calibration without waiting for it to complete.
+ * ad9361_do_calib_poll() must then be called until it doesn't return
+ * -EINPROGRESS anymore, followed by ad9361_do_calib_complete(). Other
+ * calibrations can't be started in the meantime.
+ * @param phy The AD9361 state structure.
+ * @param cal The selected calibration (TX_QUAD_CAL, RFDC_CAL).
+ * 			  Accepted values:
+ * 			   TX_QUAD_CAL
+ * 			   RFDC_CAL
+ * @param arg For TX_QUAD_CAL - the optional RX phase value overwrite (set to zero).
+ * @return 0 in case of success, negative error code otherwise.
+ *
+ * Note: This function will/may affect the data path.
+ */
+int32_t ad9361_do_calib_start(struct ad9361_rf_phy *phy, uint32_t cal,
+			      int32_t arg)
+{
+	return ad9361_calib_start(phy, cal, arg);
+}
+
+/**
+ * Check the progress of the calibration started by ad9361_do_calib_start().
+ * @param phy The AD9361 state structure.
+ * @param wait_us The suggested time until the next call [us].
+ * @return 0 when the calibration is done, -EINPROGRESS if it is still
+ *         running, negative error code otherwise.
+ */
+int32_t ad9361_do_calib_poll(struct ad9361_rf_phy *phy, uint32_t *wait_us)
+{
+	return ad9361_calib_poll(phy, wait_us);
+}
+
+/**
+ * Complete the calibration started by ad9361_do_calib_start().
+ * Waits for the calibration if it is still running.
+ * @param phy The AD9361 state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_do_calib_complete(struct ad9361_rf_phy *phy)
+{
+	return ad9361_calib_complete(phy);
+}
+
+/**
+ * Save the device configuration for a warm boot.
+ *
+ * Pass the snapshot to ad9361_init() through the warm_boot_snapshot
+ * initialization parameters to skip the setup and calibration sequence.
+ * @param phy The AD9361 state structure.
+ * @param snapshot The snapshot, allocated by this function. Release it with
+ *                 free().
+ * @param size The snapshot size.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_get_snapshot(struct ad9361_rf_phy *phy, uint8_t **snapshot,
+			    uint32_t *size)
+{
+	return ad9361_snapshot_save(phy, snapshot, size);
+}
+
 /**
  * Load and enable TRX FIR filters configurations.
  * @param phy The AD9361 current state structure.
@@ -2145,6 +2498,35 @@ int32_t ad9361_trx_load_enable_fir(struct ad9361_rf_phy *phy,
 	return 0;
 }
 
+/**
+ * Load and enable a binary FIR profile built with ad9361_fir_profile_build().
+ * @param phy The AD9361 current state structure.
+ * @param profile The FIR profile.
+ * @param size The FIR profile size.
+ * @return 0 in case of success, negative error code otherwise.
+ *
+ * Note: This function will/may affect the data path.
+ */
+int32_t ad9361_set_fir_profile(struct ad9361_rf_phy *phy,
+			       const uint8_t *profile, uint32_t size)
+{
+	int32_t ret;
+
+	ret = ad9361_fir_profile_load(phy, profile, size);
+	if (ret < 0)
+		return ret;
+
+	phy->bypass_rx_fir = false;
+	phy->bypass_tx_fir = false;
+	ret = ad9361_validate_enable_fir(phy);
+	if (ret < 0) {
+		phy->bypass_rx_fir = true;
+		phy->bypass_tx_fir = true;
+	}
+
+	return ret;
+}
+
 /**
  * Do DCXO coarse tuning.
  * @param phy The AD9361 current state structure.
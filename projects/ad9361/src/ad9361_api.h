@@ -293,6 +293,9 @@ typedef struct {
 	struct axi_dac_init	*tx_dac_init;
 	struct axi_dmac_init	*rx_dmac_init;
 	struct axi_dmac_init	*tx_dmac_init;
+	/* Warm boot */
+	const uint8_t	*warm_boot_snapshot;
+	uint32_t	warm_boot_snapshot_size;
 } AD9361_InitParam;
 
 typedef struct {
@@ -363,12 +366,30 @@ enum ad9361_ensm_mode {
 #define ON			0
 #define OFF			1
 
+enum ad9361_boot_phase {
+	AD9361_BOOT_PROBE,	/* reset, identification, clocks */
+	AD9361_BOOT_SETUP,	/* configuration up to the initial calibrations */
+	AD9361_BOOT_CALIB,	/* initial calibrations and setup completion */
+	AD9361_BOOT_INTERFACE,	/* HDL core and digital interface tuning */
+	AD9361_BOOT_MCS,	/* multi chip synchronization, by the caller */
+	AD9361_BOOT_PHASES,
+};
+
+struct ad9361_boot_stats {
+	uint64_t	phase_ns[AD9361_BOOT_PHASES];
+	uint64_t	total_ns;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
 /* Initialize the AD9361 part. */
 int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
 		     AD9361_InitParam *init_param);
+/* Initialize multiple AD9361 parts together. */
+int32_t ad9361_multi_init(struct ad9361_rf_phy **phys,
+			  AD9361_InitParam **init_params, uint32_t nb,
+			  struct ad9361_boot_stats *stats);
 /* Set the Enable State Machine (ENSM) mode. */
 int32_t ad9361_set_en_state_machine_mode (struct ad9361_rf_phy *phy,
 		uint32_t mode);
@@ -502,6 +523,12 @@ int32_t ad9361_set_tx_auto_cal_en_dis (struct ad9361_rf_phy *phy,
 /* Get the status of the auto calibration flag. */
 int32_t ad9361_get_tx_auto_cal_en_dis (struct ad9361_rf_phy *phy,
 				       uint8_t *en_dis);
+/* Enable/disable the auto calibration results cache. */
+int32_t ad9361_set_tx_cal_cache_en_dis (struct ad9361_rf_phy *phy,
+					uint8_t en_dis);
+/* Get the status of the auto calibration results cache. */
+int32_t ad9361_get_tx_cal_cache_en_dis (struct ad9361_rf_phy *phy,
+					uint8_t *en_dis);
 /* Store TX fastlock profile. */
 int32_t ad9361_tx_fastlock_store(struct ad9361_rf_phy *phy, uint32_t profile);
 /* Recall TX fastlock profile. */
@@ -524,6 +551,8 @@ int32_t ad9361_get_trx_path_clks(struct ad9361_rf_phy *phy,
 				 uint32_t *rx_path_clks, uint32_t *tx_path_clks);
 /* Set the number of channels mode. */
 int32_t ad9361_set_no_ch_mode(struct ad9361_rf_phy *phy, uint8_t no_ch_mode);
+/* Do multi chip synchronization of multiple parts. */
+int32_t ad9361_multi_mcs(struct ad9361_rf_phy **phys, uint32_t nb);
 /* Do multi chip synchronization. */
 int32_t ad9361_do_mcs(struct ad9361_rf_phy *phy_master,
 		      struct ad9361_rf_phy *phy_slave);
@@ -535,10 +564,23 @@ int32_t ad9361_set_trx_rate_gov (struct ad9361_rf_phy *phy, uint32_t rate_gov);
 int32_t ad9361_get_trx_rate_gov (struct ad9361_rf_phy *phy, uint32_t *rate_gov);
 /* Perform the selected calibration. */
 int32_t ad9361_do_calib(struct ad9361_rf_phy *phy, uint32_t cal, int32_t arg);
+/* Start the selected calibration without waiting for it. */
+int32_t ad9361_do_calib_start(struct ad9361_rf_phy *phy, uint32_t cal,
+			      int32_t arg);
+/* Check the progress of the calibration started by ad9361_do_calib_start(). */
+int32_t ad9361_do_calib_poll(struct ad9361_rf_phy *phy, uint32_t *wait_us);
+/* Complete the calibration started by ad9361_do_calib_start(). */
+int32_t ad9361_do_calib_complete(struct ad9361_rf_phy *phy);
+/* Save the device configuration for a warm boot. */
+int32_t ad9361_get_snapshot(struct ad9361_rf_phy *phy, uint8_t **snapshot,
+			    uint32_t *size);
 /* Load and enable TRX FIR filters configurations. */
 int32_t ad9361_trx_load_enable_fir(struct ad9361_rf_phy *phy,
 				   AD9361_RXFIRConfig rx_fir_cfg,
 				   AD9361_TXFIRConfig tx_fir_cfg);
+/* Load and enable a binary FIR profile. */
+int32_t ad9361_set_fir_profile(struct ad9361_rf_phy *phy,
+			       const uint8_t *profile, uint32_t size);
 /* Do DCXO coarse tuning. */
 int32_t ad9361_do_dcxo_tune_coarse(struct ad9361_rf_phy *phy,
 				   uint32_t coarse);
@@ -0,0 +1,481 @@
+/***************************************************************************//**
+ *   @file   ad9361_bist.c
+ *   @brief  AD9361 data path verification based on the BIST generators.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <string.h>
+#include "config.h"
+#include "ad9361_bist.h"
+#include "ad9361_util.h"
+#include "axi_dmac.h"
+#include "delay.h"
+#include "util.h"
+#ifdef XILINX_PLATFORM
+#include <xil_cache.h>
+#endif
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define AD9361_BIST_SAMPLE_BITS		12
+#define AD9361_BIST_SAMPLE_MASK		0xFFF
+#define AD9361_BIST_MAX_NIBBLES		8
+#define AD9361_BIST_MAX_BAD_RUN		16
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/*
+ * PN generator advanced by one sample. The next sample and the next state are
+ * linear in the current state, so both are looked up per state nibble.
+ */
+struct ad9361_bist_lfsr {
+	uint32_t	mask;
+	uint32_t	nb_nibbles;
+	uint32_t	seed_samples;
+	uint32_t	state_tbl[AD9361_BIST_MAX_NIBBLES][16];
+	uint16_t	sample_tbl[AD9361_BIST_MAX_NIBBLES][16];
+};
+
+struct ad9361_bist_stream {
+	/* PN generator state or tone period */
+	uint32_t	state;
+	uint16_t	tone[AD9361_BIST_TONE_PERIOD];
+	/* Samples the checker locked on so far */
+	uint32_t	locked;
+	/* Consecutive mismatching samples */
+	uint32_t	bad_run;
+};
+
+struct ad9361_bist_state {
+	int32_t			loopback;
+	int32_t			bist_config;
+	enum ad9361_bist_mode	prbs_mode;
+	enum ad9361_bist_mode	tone_mode;
+	uint32_t		tone_freq_Hz;
+	uint32_t		tone_level_dB;
+	uint32_t		tone_mask;
+	uint8_t			bist_mask;
+	uint8_t			ensm_state;
+};
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+/* Polynomial x^n + x^m + 1 of each sequence as {n, m} */
+static const uint8_t ad9361_bist_pn_poly[][2] = {
+	[AD9361_BIST_PN7] = {7, 6},
+	[AD9361_BIST_PN9] = {9, 5},
+	[AD9361_BIST_PN15] = {15, 14},
+	[AD9361_BIST_PN23] = {23, 18},
+	[AD9361_BIST_PN31] = {31, 28},
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * Advance the PN generator bit by bit.
+ * @param n Polynomial degree.
+ * @param m Polynomial middle tap.
+ * @param state The generator state, the latest bit in bit 0.
+ * @return The generated sample, the first bit in the MSB.
+ */
+static uint16_t ad9361_bist_lfsr_step(uint32_t n, uint32_t m, uint32_t *state)
+{
+	uint32_t s = *state;
+	uint32_t bit, i;
+	uint16_t sample = 0;
+
+	for (i = 0; i < AD9361_BIST_SAMPLE_BITS; i++) {
+		bit = ((s >> (n - 1)) ^ (s >> (m - 1))) & 1;
+		s = ((s << 1) | bit) & ((1u << n) - 1);
+		sample = (sample << 1) | bit;
+	}
+	*state = s;
+
+	return sample;
+}
+
+/**
+ * Build the per nibble lookup tables of a PN generator.
+ * @param lfsr The PN generator.
+ * @param pn The sequence.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_bist_lfsr_init(struct ad9361_bist_lfsr *lfsr,
+				     enum ad9361_bist_pn pn)
+{
+	uint32_t n, m, k, v, b, s;
+	uint32_t basis_state[32];
+	uint16_t basis_sample[32];
+
+	if (pn > AD9361_BIST_PN31)
+		return -EINVAL;
+
+	n = ad9361_bist_pn_poly[pn][0];
+	m = ad9361_bist_pn_poly[pn][1];
+	lfsr->mask = (1u << n) - 1;
+	lfsr->nb_nibbles = DIV_ROUND_UP(n, 4);
+	lfsr->seed_samples = DIV_ROUND_UP(n, AD9361_BIST_SAMPLE_BITS);
+
+	for (b = 0; b < n; b++) {
+		s = 1u << b;
+		basis_sample[b] = ad9361_bist_lfsr_step(n, m, &s);
+		basis_state[b] = s;
+	}
+
+	for (k = 0; k < lfsr->nb_nibbles; k++) {
+		for (v = 0; v < 16; v++) {
+			lfsr->state_tbl[k][v] = 0;
+			lfsr->sample_tbl[k][v] = 0;
+			for (b = 0; b < 4; b++) {
+				if (!(v & (1 << b)) || 4 * k + b >= n)
+					continue;
+				lfsr->state_tbl[k][v] ^= basis_state[4 * k + b];
+				lfsr->sample_tbl[k][v] ^= basis_sample[4 * k + b];
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Get the next sample of a PN generator.
+ * @param lfsr The PN generator.
+ * @param state The generator state.
+ * @return The expected sample.
+ */
+static inline uint16_t ad9361_bist_lfsr_next(const struct ad9361_bist_lfsr *lfsr,
+		uint32_t *state)
+{
+	uint32_t s = *state, next = 0, k;
+	uint16_t sample = 0;
+
+	for (k = 0; k < lfsr->nb_nibbles; k++, s >>= 4) {
+		next ^= lfsr->state_tbl[k][s & 0xF];
+		sample ^= lfsr->sample_tbl[k][s & 0xF];
+	}
+	*state = next;
+
+	return sample;
+}
+
+/**
+ * Check a captured buffer of interleaved 16 bit I/Q samples.
+ *
+ * Each I/Q stream is checked independently. The checker locks on the first
+ * received samples of a stream and compares the rest against the generated
+ * sequence or the tone period, so a bit error is counted once. The 12 bit
+ * samples are sent MSB first and bit b of a sample travels on lane
+ * b % nb_lanes.
+ * @param config The test configuration.
+ * @param buf The captured samples.
+ * @param nb_samples The number of samples per stream.
+ * @param nb_streams The number of I/Q streams [1, AD9361_BIST_MAX_STREAMS].
+ * @param nb_lanes The number of data lanes, 6 for LVDS or 12 for CMOS.
+ * @param result The error counts.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_bist_check(const struct ad9361_bist_config *config,
+			  const uint16_t *buf, uint32_t nb_samples,
+			  uint32_t nb_streams, uint32_t nb_lanes,
+			  struct ad9361_bist_result *result)
+{
+	struct ad9361_bist_stream streams[AD9361_BIST_MAX_STREAMS];
+	struct ad9361_bist_stream *st;
+	struct ad9361_bist_lfsr lfsr;
+	uint32_t max_bad_run, i, s, bit, diff, pos;
+	uint16_t data, expected;
+	bool prbs;
+	int32_t ret;
+
+	if (!config || !buf || !result || !nb_streams ||
+	    nb_streams > AD9361_BIST_MAX_STREAMS || !nb_lanes ||
+	    nb_lanes > AD9361_BIST_MAX_LANES)
+		return -EINVAL;
+
+	prbs = (config->pattern == AD9361_BIST_PATTERN_PRBS);
+	if (prbs) {
+		ret = ad9361_bist_lfsr_init(&lfsr, config->pn);
+		if (ret < 0)
+			return ret;
+	}
+	max_bad_run = config->max_bad_run ? config->max_bad_run :
+		      AD9361_BIST_MAX_BAD_RUN;
+
+	memset(result, 0, sizeof(*result));
+	memset(streams, 0, sizeof(streams));
+	result->samples = nb_samples;
+	result->nb_streams = nb_streams;
+	result->nb_lanes = nb_lanes;
+
+	for (i = 0; i < nb_samples; i++) {
+		for (s = 0; s < nb_streams; s++) {
+			st = &streams[s];
+			data = *buf++ & AD9361_BIST_SAMPLE_MASK;
+
+			if (prbs) {
+				if (st->locked < lfsr.seed_samples) {
+					st->state = ((st->state << AD9361_BIST_SAMPLE_BITS) |
+						     data) & lfsr.mask;
+					st->locked++;
+					continue;
+				}
+				expected = ad9361_bist_lfsr_next(&lfsr, &st->state);
+			} else {
+				pos = st->locked % AD9361_BIST_TONE_PERIOD;
+				if (st->locked++ < AD9361_BIST_TONE_PERIOD) {
+					st->tone[pos] = data;
+					continue;
+				}
+				expected = st->tone[pos];
+			}
+
+			diff = data ^ expected;
+			if (!diff) {
+				st->bad_run = 0;
+				continue;
+			}
+
+			while (diff) {
+				bit = find_first_set_bit(diff);
+				result->lane_errors[bit % nb_lanes]++;
+				result->stream_errors[s]++;
+				result->errors++;
+				diff &= diff - 1;
+			}
+
+			/* Lock again on the received data */
+			if (++st->bad_run >= max_bad_run) {
+				st->locked = 0;
+				st->bad_run = 0;
+				result->resyncs++;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Enable the BIST pattern on the RX data port.
+ * @param phy The AD9361 state structure.
+ * @param config The test configuration.
+ * @param state The device state to be restored by ad9361_bist_stop().
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_bist_start(struct ad9361_rf_phy *phy,
+				 const struct ad9361_bist_config *config,
+				 struct ad9361_bist_state *state)
+{
+	int32_t ret;
+
+	state->loopback = phy->bist_loopback_mode;
+	state->bist_config = phy->bist_config;
+	state->prbs_mode = phy->bist_prbs_mode;
+	state->tone_mode = phy->bist_tone_mode;
+	state->tone_freq_Hz = phy->bist_tone_freq_Hz;
+	state->tone_level_dB = phy->bist_tone_level_dB;
+	state->tone_mask = phy->bist_tone_mask;
+	state->bist_mask = ad9361_spi_read(phy->spi,
+					   REG_BIST_AND_DATA_PORT_TEST_CONFIG);
+	state->ensm_state = ad9361_ensm_get_state(phy);
+
+	/* Mute TX, we don't want to transmit the pattern */
+	ad9361_tx_mute(phy, 1);
+
+	if (!phy->pdata->fdd)
+		ad9361_set_ensm_mode(phy, true, false);
+
+	ad9361_bist_loopback(phy, 0);
+	if (config->pattern == AD9361_BIST_PATTERN_PRBS)
+		ret = ad9361_bist_prbs(phy, BIST_INJ_RX);
+	else
+		ret = ad9361_bist_tone(phy, BIST_INJ_RX, config->tone_freq_Hz,
+				       config->tone_level_dB, config->tone_mask);
+
+	ad9361_ensm_force_state(phy, ENSM_STATE_FDD);
+
+	return ret;
+}
+
+/**
+ * Restore the device state saved by ad9361_bist_start().
+ * @param phy The AD9361 state structure.
+ * @param state The saved device state.
+ * @return None.
+ */
+static void ad9361_bist_stop(struct ad9361_rf_phy *phy,
+			     const struct ad9361_bist_state *state)
+{
+	ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
+	ad9361_bist_loopback(phy, state->loopback);
+	ad9361_spi_write(phy->spi, REG_BIST_AND_DATA_PORT_TEST_CONFIG,
+			 state->bist_mask);
+	ad9361_spi_write(phy->spi, REG_BIST_CONFIG, state->bist_config);
+
+	phy->bist_config = state->bist_config;
+	phy->bist_prbs_mode = state->prbs_mode;
+	phy->bist_tone_mode = state->tone_mode;
+	phy->bist_tone_freq_Hz = state->tone_freq_Hz;
+	phy->bist_tone_level_dB = state->tone_level_dB;
+	phy->bist_tone_mask = state->tone_mask;
+
+	if (!phy->pdata->fdd)
+		ad9361_set_ensm_mode(phy, phy->pdata->fdd, phy->pdata->ensm_pin_ctrl);
+	ad9361_ensm_restore_state(phy, state->ensm_state);
+
+	ad9361_tx_mute(phy, 0);
+}
+
+/**
+ * Capture the RX data and check it.
+ * @param phy The AD9361 state structure.
+ * @param config The test configuration.
+ * @param buf The capture buffer.
+ * @param nb_samples The number of samples per stream.
+ * @param result The error counts.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_bist_capture_check(struct ad9361_rf_phy *phy,
+		const struct ad9361_bist_config *config,
+		uint16_t *buf, uint32_t nb_samples,
+		struct ad9361_bist_result *result)
+{
+	uint32_t nb_streams, nb_lanes, size;
+	int32_t ret;
+
+	nb_streams = phy->pdata->rx2tx2 ? 4 : 2;
+	nb_lanes = (phy->pdata->port_ctrl.pp_conf[2] & LVDS_MODE) ? 6 : 12;
+	size = nb_samples * nb_streams * sizeof(*buf);
+
+	ret = axi_dmac_transfer(phy->rx_dmac, (uintptr_t)buf, size);
+	if (ret < 0)
+		return ret;
+#ifdef XILINX_PLATFORM
+	Xil_DCacheInvalidateRange((uintptr_t)buf, size);
+#endif
+
+	return ad9361_bist_check(config, buf, nb_samples, nb_streams, nb_lanes,
+				 result);
+}
+
+/**
+ * Enable the BIST pattern, capture it through the RX DMA and check it.
+ * @param phy The AD9361 state structure.
+ * @param config The test configuration.
+ * @param buf The capture buffer, nb_samples I/Q samples of each RX channel.
+ * @param nb_samples The number of samples per stream.
+ * @param result The error counts.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_bist_verify(struct ad9361_rf_phy *phy,
+			   const struct ad9361_bist_config *config,
+			   uint16_t *buf, uint32_t nb_samples,
+			   struct ad9361_bist_result *result)
+{
+	struct ad9361_bist_state state;
+	int32_t ret;
+
+	if (!phy || !config || !buf || !nb_samples || !result)
+		return -EINVAL;
+	if (!phy->rx_dmac)
+		return -ENODEV;
+
+	ret = ad9361_bist_start(phy, config, &state);
+	if (ret == 0) {
+		mdelay(1);
+		ret = ad9361_bist_capture_check(phy, config, buf, nb_samples,
+						result);
+	}
+	ad9361_bist_stop(phy, &state);
+
+	return ret;
+}
+
+/**
+ * Capture and check the BIST pattern for every RX clock/data delay.
+ * @param phy The AD9361 state structure.
+ * @param config The test configuration.
+ * @param buf The capture buffer, nb_samples I/Q samples of each RX channel.
+ * @param nb_samples The number of samples per stream and delay setting.
+ * @param errors The bit errors, indexed by clock and data delay.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_bist_timing_sweep(struct ad9361_rf_phy *phy,
+				 const struct ad9361_bist_config *config,
+				 uint16_t *buf, uint32_t nb_samples,
+				 uint32_t errors[16][16])
+{
+	struct ad9361_bist_result result;
+	struct ad9361_bist_state state;
+	uint32_t i, j;
+	int32_t ret;
+	uint8_t rx;
+
+	if (!phy || !config || !buf || !nb_samples || !errors)
+		return -EINVAL;
+	if (!phy->rx_dmac)
+		return -ENODEV;
+
+	rx = ad9361_spi_read(phy->spi, REG_RX_CLOCK_DATA_DELAY);
+
+	ret = ad9361_bist_start(phy, config, &state);
+	for (i = 0; i < 16 && ret == 0; i++) {
+		for (j = 0; j < 16 && ret == 0; j++) {
+			ad9361_set_intf_delay(phy, false, i, j, j == 0);
+			mdelay(1);
+			ret = ad9361_bist_capture_check(phy, config, buf,
+							nb_samples, &result);
+			if (ret < 0)
+				break;
+			errors[i][j] = result.errors;
+		}
+	}
+
+	ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
+	ad9361_spi_write(phy->spi, REG_RX_CLOCK_DATA_DELAY, rx);
+	ad9361_bist_stop(phy, &state);
+
+	return ret;
+}
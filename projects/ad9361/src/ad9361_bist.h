@@ -0,0 +1,129 @@
+/***************************************************************************//**
+ *   @file   ad9361_bist.h
+ *   @brief  AD9361 data path verification based on the BIST generators.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef AD9361_BIST_H_
+#define AD9361_BIST_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "ad9361.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* I/Q streams of the two RX channels */
+#define AD9361_BIST_MAX_STREAMS		4
+/* Data lanes of the CMOS interface, LVDS uses 6 */
+#define AD9361_BIST_MAX_LANES		12
+/* Samples per period of the BIST tone */
+#define AD9361_BIST_TONE_PERIOD		32
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+enum ad9361_bist_pattern {
+	/* Pseudo random sequence, checked against the PN generator */
+	AD9361_BIST_PATTERN_PRBS,
+	/* Tone, checked against its previous period */
+	AD9361_BIST_PATTERN_TONE,
+};
+
+enum ad9361_bist_pn {
+	AD9361_BIST_PN7,
+	AD9361_BIST_PN9,
+	AD9361_BIST_PN15,
+	AD9361_BIST_PN23,
+	AD9361_BIST_PN31,
+};
+
+struct ad9361_bist_config {
+	/* Test pattern */
+	enum ad9361_bist_pattern	pattern;
+	/* Sequence generated by the BIST PRBS */
+	enum ad9361_bist_pn		pn;
+	/* Tone frequency [Hz], level [dB] and channel mask, see ad9361_bist_tone() */
+	uint32_t			tone_freq_Hz;
+	uint32_t			tone_level_dB;
+	uint32_t			tone_mask;
+	/*
+	 * Consecutive mismatching samples after which a stream is considered
+	 * out of sync and the checker locks again on the received data.
+	 */
+	uint32_t			max_bad_run;
+};
+
+struct ad9361_bist_result {
+	/* Samples checked per stream */
+	uint32_t		samples;
+	/* Number of I/Q streams in the buffer */
+	uint32_t		nb_streams;
+	/* Number of data lanes */
+	uint32_t		nb_lanes;
+	/* Bit errors per data lane */
+	uint32_t		lane_errors[AD9361_BIST_MAX_LANES];
+	/* Bit errors per I/Q stream (I1, Q1, I2, Q2) */
+	uint32_t		stream_errors[AD9361_BIST_MAX_STREAMS];
+	/* Times a stream lost sync */
+	uint32_t		resyncs;
+	/* Total number of bit errors */
+	uint32_t		errors;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Check a captured buffer of interleaved 16 bit I/Q samples. */
+int32_t ad9361_bist_check(const struct ad9361_bist_config *config,
+			  const uint16_t *buf, uint32_t nb_samples,
+			  uint32_t nb_streams, uint32_t nb_lanes,
+			  struct ad9361_bist_result *result);
+/* Enable the BIST pattern, capture it through the RX DMA and check it. */
+int32_t ad9361_bist_verify(struct ad9361_rf_phy *phy,
+			   const struct ad9361_bist_config *config,
+			   uint16_t *buf, uint32_t nb_samples,
+			   struct ad9361_bist_result *result);
+/* Capture and check the BIST pattern for every RX clock/data delay. */
+int32_t ad9361_bist_timing_sweep(struct ad9361_rf_phy *phy,
+				 const struct ad9361_bist_config *config,
+				 uint16_t *buf, uint32_t nb_samples,
+				 uint32_t errors[16][16]);
+
+#endif // AD9361_BIST_H_
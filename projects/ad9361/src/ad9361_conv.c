@@ -159,11 +159,11 @@ static uint32_t ad9361_num_phy_chan(struct axiadc_converter *conv)
 }
 
 /**
- * Check PN checker status.
- * @return 0 in case of success, negative error code otherwise.
+ * Clear the PN checker status.
+ * @param phy The AD9361 state structure.
+ * @return None.
  */
-static int32_t ad9361_check_pn(struct ad9361_rf_phy *phy, bool tx,
-			       uint32_t delay)
+static void ad9361_pn_clear(struct ad9361_rf_phy *phy)
 {
 	struct axiadc_converter *conv = phy->adc_conv;
 	struct axi_adc *axi_adc = phy->rx_adc;
@@ -173,8 +173,22 @@ static int32_t ad9361_check_pn(struct ad9361_rf_phy *phy, bool tx,
 	for (chan = 0; chan < num_chan; chan++)
 		axi_adc_write(axi_adc, ADI_REG_CHAN_STATUS(chan),
 			      ADI_PN_ERR | ADI_PN_OOS);
-	mdelay(delay);
+}
+
+/**
+ * Get the PN checker status accumulated since ad9361_pn_clear().
+ * @param phy The AD9361 state structure.
+ * @param tx Set if TX.
+ * @return 0 if no PN errors were detected, 1 otherwise.
+ */
+static int32_t ad9361_pn_status(struct ad9361_rf_phy *phy, bool tx)
+{
+	struct axiadc_converter *conv = phy->adc_conv;
+	struct axi_adc *axi_adc = phy->rx_adc;
+	uint32_t num_chan = ad9361_num_phy_chan(conv);
+	uint32_t chan;
 	uint32_t adi_reg_status;
+
 	axi_adc_read(axi_adc, ADI_REG_STATUS, &adi_reg_status);
 	if (!tx && !(adi_reg_status & ADI_STATUS))
 		return 1;
@@ -189,6 +203,19 @@ static int32_t ad9361_check_pn(struct ad9361_rf_phy *phy, bool tx,
 	return 0;
 }
 
+/**
+ * Check PN checker status.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_check_pn(struct ad9361_rf_phy *phy, bool tx,
+			       uint32_t delay)
+{
+	ad9361_pn_clear(phy);
+	mdelay(delay);
+
+	return ad9361_pn_status(phy, tx);
+}
+
 /**
  * HDL loopback enable/disable.
  * @param phy The AD9361 state structure.
@@ -344,11 +371,15 @@ static void ad9361_dig_tune_verbose_print(struct ad9361_rf_phy *phy,
 /**
  * Set intf delay.
  * @param phy The AD9361 state structure.
+ * @param tx Set if TX.
+ * @param clock_delay The clock delay.
+ * @param data_delay The data delay.
+ * @param clock_changed Set if the clock delay changed, the ENSM is cycled.
  * @return None.
  */
-static void ad9361_set_intf_delay(struct ad9361_rf_phy *phy, bool tx,
-				  uint32_t clock_delay,
-				  uint32_t data_delay, bool clock_changed)
+void ad9361_set_intf_delay(struct ad9361_rf_phy *phy, bool tx,
+			   uint32_t clock_delay,
+			   uint32_t data_delay, bool clock_changed)
 {
 	if (clock_changed)
 		ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
@@ -429,34 +460,67 @@ int32_t ad9361_dig_interface_timing_analysis(struct ad9361_rf_phy *phy,
 	return len;
 }
 
+/**
+ * Per device state of a digital interface tuning.
+ */
+struct ad9361_dig_tune_dev {
+	struct ad9361_rf_phy	*phy;
+	uint32_t		max_freq;
+	bool			active;
+	bool			restore;
+	int32_t			ret;
+	uint32_t		loopback;
+	uint32_t		bist;
+	uint32_t		ensm_state;
+	/* TX tuning */
+	uint32_t		hdl_dac_version;
+	uint32_t		saved;
+	uint32_t		saved_dsel[4];
+	uint32_t		saved_chan_ctrl6[4];
+	uint32_t		saved_chan_ctrl0[4];
+};
+
 /**
  * Digital tune delay.
- * @param phy The AD9361 state structure.
- * @param max_freq Maximum frequency.
+ *
+ * The active devices are swept in lockstep, so that they share the PN
+ * checker settling time of each delay setting.
+ * @param dev The devices to tune.
+ * @param nb The number of devices.
  * @param flags Flags: BE_VERBOSE, BE_MOREVERBOSE, DO_IDELAY, DO_ODELAY.
  * @param tx Set if TX.
- * @return 0 in case of success, negative error code otherwise.
+ * @return None, the result of each device is stored in its ret field.
  */
-static int32_t ad9361_dig_tune_delay(struct ad9361_rf_phy *phy,
-				     uint32_t max_freq, enum dig_tune_flags flags, bool tx)
+static void ad9361_dig_tune_delay(struct ad9361_dig_tune_dev *dev,
+				  uint32_t nb, enum dig_tune_flags flags, bool tx)
 {
 	static const uint32_t rates[3] = {25000000U, 40000000U, 61440000U};
+	struct ad9361_rf_phy *phy;
 	uint32_t s0, s1, c0, c1;
-	uint32_t i, j, r;
+	uint32_t i, j, r, n, nb_rates = 1;
 	bool half_data_rate;
-	uint8_t field[2][16];
-
-	if (((phy->pdata->port_ctrl.pp_conf[2] & LVDS_MODE) ||
-	     !phy->pdata->rx2tx2))
-		half_data_rate = false;
-	else
-		half_data_rate = true;
+	uint8_t field[AD9361_MAX_MULTI_DEV][2][16];
+
+	memset(field, 0, sizeof(field));
+	for (n = 0; n < nb; n++)
+		if (dev[n].active && dev[n].max_freq)
+			nb_rates = ARRAY_SIZE(rates);
+
+	for (r = 0; r < nb_rates; r++) {
+		for (n = 0; n < nb; n++) {
+			phy = dev[n].phy;
+			if (!dev[n].active || !dev[n].max_freq)
+				continue;
+
+			if (((phy->pdata->port_ctrl.pp_conf[2] & LVDS_MODE) ||
+			     !phy->pdata->rx2tx2))
+				half_data_rate = false;
+			else
+				half_data_rate = true;
 
-	memset(field, 0, 32);
-	for (r = 0; r < (max_freq ? ARRAY_SIZE(rates) : 1); r++) {
-		if (max_freq)
 			ad9361_set_trx_clock_chain_freq(phy,
 							half_data_rate ? rates[r] / 2 : rates[r]);
+		}
 
 		for (i = 0; i < 2; i++) {
 			for (j = 0; j < 16; j++) {
@@ -464,169 +528,233 @@ static int32_t ad9361_dig_tune_delay(struct ad9361_rf_phy *phy,
 				 * i == 0: clock delay = 0, data delay from 0 to 15
 				 * i == 1: clock delay = 15, data delay from 15 to 0
 				 */
-				ad9361_set_intf_delay(phy, tx, i ? 15 : 0,
-						      i ? 15 - j : j, j == 0);
-				field[i][j] |= ad9361_check_pn(phy, tx, 4);
+				for (n = 0; n < nb; n++) {
+					if (!dev[n].active || (r && !dev[n].max_freq))
+						continue;
+					ad9361_set_intf_delay(dev[n].phy, tx, i ? 15 : 0,
+							      i ? 15 - j : j, j == 0);
+					ad9361_pn_clear(dev[n].phy);
+				}
+				mdelay(4);
+				for (n = 0; n < nb; n++) {
+					if (!dev[n].active || (r && !dev[n].max_freq))
+						continue;
+					field[n][i][j] |= ad9361_pn_status(dev[n].phy, tx);
+				}
 			}
 		}
 
-		if ((flags & BE_MOREVERBOSE) && max_freq) {
-			ad9361_dig_tune_verbose_print(phy, field, tx, -1, -1);
+		for (n = 0; n < nb; n++) {
+			if (!dev[n].active || !dev[n].max_freq)
+				continue;
+			if (flags & BE_MOREVERBOSE)
+				ad9361_dig_tune_verbose_print(dev[n].phy, field[n],
+							      tx, -1, -1);
 		}
 	}
 
-	c0 = ad9361_find_opt(&field[0][0], 16, &s0);
-	c1 = ad9361_find_opt(&field[1][0], 16, &s1);
+	for (n = 0; n < nb; n++) {
+		phy = dev[n].phy;
+		if (!dev[n].active)
+			continue;
+
+		c0 = ad9361_find_opt(&field[n][0][0], 16, &s0);
+		c1 = ad9361_find_opt(&field[n][1][0], 16, &s1);
+
+		if (!c0 && !c1) {
+			ad9361_dig_tune_verbose_print(phy, field[n], tx, -1, -1);
+			dev_err(&phy->spi->dev, "%s: Tuning %s FAILED!", __func__,
+				tx ? "TX" : "RX");
+			dev[n].ret = -EIO;
+			continue;
+		} else if (flags & BE_VERBOSE) {
+			if (c1 > c0)
+				ad9361_dig_tune_verbose_print(phy, field[n], tx,
+							      (s1 + c1 / 2), -1);
+			else
+				ad9361_dig_tune_verbose_print(phy, field[n], tx,
+							      -1, (s0 + c0 / 2));
+		}
 
-	if (!c0 && !c1) {
-		ad9361_dig_tune_verbose_print(phy, field, tx, -1, -1);
-		dev_err(&phy->spi->dev, "%s: Tuning %s FAILED!", __func__,
-			tx ? "TX" : "RX");
-		return -EIO;
-	} else if (flags & BE_VERBOSE) {
 		if (c1 > c0)
-			ad9361_dig_tune_verbose_print(phy, field, tx, (s1 + c1 / 2), -1);
+			ad9361_set_intf_delay(phy, tx, s1 + c1 / 2, 0, true);
 		else
-			ad9361_dig_tune_verbose_print(phy, field, tx, -1, (s0 + c0 / 2));
-	}
+			ad9361_set_intf_delay(phy, tx, 0, s0 + c0 / 2, true);
 
-	if (c1 > c0)
-		ad9361_set_intf_delay(phy, tx, s1 + c1 / 2, 0, true);
-	else
-		ad9361_set_intf_delay(phy, tx, 0, s0 + c0 / 2, true);
-
-	return 0;
+		dev[n].ret = 0;
+	}
 }
 
 /**
  * Digital tune RX.
- * @param phy The AD9361 state structure.
- * @param max_freq Maximum frequency.
+ * @param dev The devices to tune.
+ * @param nb The number of devices.
  * @param flags Flags: BE_VERBOSE, BE_MOREVERBOSE, DO_IDELAY, DO_ODELAY.
- * @return 0 in case of success, negative error code otherwise.
+ * @return None, the result of each device is stored in its ret field.
  */
-static int32_t ad9361_dig_tune_rx(struct ad9361_rf_phy *phy, uint32_t max_freq,
-				  enum dig_tune_flags flags)
+static void ad9361_dig_tune_rx(struct ad9361_dig_tune_dev *dev, uint32_t nb,
+			       enum dig_tune_flags flags)
 {
-	struct axi_adc *rx_adc = phy->rx_adc;
-	int32_t ret;
-
-	ad9361_bist_loopback(phy, 0);
-	ad9361_bist_prbs(phy, BIST_INJ_RX);
+	struct axi_adc *rx_adc;
+	uint32_t n;
+
+	for (n = 0; n < nb; n++) {
+		if (!dev[n].active)
+			continue;
+		ad9361_bist_loopback(dev[n].phy, 0);
+		ad9361_bist_prbs(dev[n].phy, BIST_INJ_RX);
+	}
 
-	ret = ad9361_dig_tune_delay(phy, max_freq, flags, false);
-	if (flags & DO_IDELAY)
-		ad9361_dig_tune_iodelay(phy, false);
+	ad9361_dig_tune_delay(dev, nb, flags, false);
 
-	axi_adc_write(rx_adc, ADI_REG_RSTN, ADI_MMCM_RSTN);
-	axi_adc_write(rx_adc, ADI_REG_RSTN, ADI_RSTN | ADI_MMCM_RSTN);
+	for (n = 0; n < nb; n++) {
+		if (!dev[n].active)
+			continue;
+		if (flags & DO_IDELAY)
+			ad9361_dig_tune_iodelay(dev[n].phy, false);
 
-	return ret;
+		rx_adc = dev[n].phy->rx_adc;
+		axi_adc_write(rx_adc, ADI_REG_RSTN, ADI_MMCM_RSTN);
+		axi_adc_write(rx_adc, ADI_REG_RSTN, ADI_RSTN | ADI_MMCM_RSTN);
+	}
 }
 
 /**
  * Digital tune TX.
- * @param phy The AD9361 state structure.
- * @param max_freq Maximum frequency.
+ * @param dev The devices to tune.
+ * @param nb The number of devices.
  * @param flags Flags: BE_VERBOSE, BE_MOREVERBOSE, DO_IDELAY, DO_ODELAY.
- * @return 0 in case of success, negative error code otherwise.
+ * @return None, the result of each device is stored in its ret field.
  */
-static int32_t ad9361_dig_tune_tx(struct ad9361_rf_phy *phy, uint32_t max_freq,
-				  enum dig_tune_flags flags)
+static void ad9361_dig_tune_tx(struct ad9361_dig_tune_dev *dev, uint32_t nb,
+			       enum dig_tune_flags flags)
 {
-	struct axiadc_converter *conv = phy->adc_conv;
-	struct axi_adc *rx_adc = phy->rx_adc;
-	uint32_t saved_dsel[4], saved_chan_ctrl6[4], saved_chan_ctrl0[4];
+	struct ad9361_rf_phy *phy;
+	struct axi_adc *rx_adc;
 	uint32_t chan, num_chan;
-	uint32_t hdl_dac_version;
-	uint32_t tmp, saved = 0;
-	int32_t ret;
-
-	num_chan = ad9361_num_phy_chan(conv);
-	axi_adc_read(rx_adc, 0x4000, &hdl_dac_version);
-
-	ad9361_bist_prbs(phy, BIST_DISABLE);
-	ad9361_bist_loopback(phy, 1);
-	axi_adc_write(rx_adc, 0x4000 + ADI_REG_RSTN, ADI_RSTN | ADI_MMCM_RSTN);
-
-	for (chan = 0; chan < num_chan; chan++) {
-		axi_adc_read(rx_adc, ADI_REG_CHAN_CNTRL(chan), &saved_chan_ctrl0[chan]);
-		axi_adc_write(rx_adc, ADI_REG_CHAN_CNTRL(chan),
-			      ADI_FORMAT_SIGNEXT | ADI_FORMAT_ENABLE |
-			      ADI_ENABLE | ADI_IQCOR_ENB);
-		axi_adc_set_pnsel(phy->rx_adc, chan, ADC_PN_CUSTOM);
-		axi_adc_read(rx_adc, 0x4414 + (chan) * 0x40, &saved_chan_ctrl6[chan]);
-		if (PCORE_VERSION_MAJOR(hdl_dac_version) > 7) {
-			axi_adc_read(rx_adc, 0x4418 + (chan) * 0x40, &saved_dsel[chan]);
-			axi_adc_write(rx_adc, 0x4418 + (chan) * 0x40, 9);
-			axi_adc_write(rx_adc, 0x4414 + (chan) * 0x40, 0); /* !IQCOR_ENB */
-			axi_adc_write(rx_adc, 0x4044, 1);
-		} else {
-			axi_adc_write(rx_adc, 0x4414 + (chan) * 0x40, 1); /* DAC_PN_ENB */
+	uint32_t tmp, n;
+
+	for (n = 0; n < nb; n++) {
+		phy = dev[n].phy;
+		rx_adc = phy->rx_adc;
+		if (!dev[n].active)
+			continue;
+
+		num_chan = ad9361_num_phy_chan(phy->adc_conv);
+		axi_adc_read(rx_adc, 0x4000, &dev[n].hdl_dac_version);
+
+		ad9361_bist_prbs(phy, BIST_DISABLE);
+		ad9361_bist_loopback(phy, 1);
+		axi_adc_write(rx_adc, 0x4000 + ADI_REG_RSTN, ADI_RSTN | ADI_MMCM_RSTN);
+
+		for (chan = 0; chan < num_chan; chan++) {
+			axi_adc_read(rx_adc, ADI_REG_CHAN_CNTRL(chan),
+				     &dev[n].saved_chan_ctrl0[chan]);
+			axi_adc_write(rx_adc, ADI_REG_CHAN_CNTRL(chan),
+				      ADI_FORMAT_SIGNEXT | ADI_FORMAT_ENABLE |
+				      ADI_ENABLE | ADI_IQCOR_ENB);
+			axi_adc_set_pnsel(rx_adc, chan, ADC_PN_CUSTOM);
+			axi_adc_read(rx_adc, 0x4414 + (chan) * 0x40,
+				     &dev[n].saved_chan_ctrl6[chan]);
+			if (PCORE_VERSION_MAJOR(dev[n].hdl_dac_version) > 7) {
+				axi_adc_read(rx_adc, 0x4418 + (chan) * 0x40,
+					     &dev[n].saved_dsel[chan]);
+				axi_adc_write(rx_adc, 0x4418 + (chan) * 0x40, 9);
+				axi_adc_write(rx_adc, 0x4414 + (chan) * 0x40, 0); /* !IQCOR_ENB */
+				axi_adc_write(rx_adc, 0x4044, 1);
+			} else {
+				axi_adc_write(rx_adc, 0x4414 + (chan) * 0x40, 1); /* DAC_PN_ENB */
+			}
+		}
+		if (PCORE_VERSION_MAJOR(dev[n].hdl_dac_version) < 8) {
+			axi_adc_read(rx_adc, 0x4048, &tmp);
+			dev[n].saved = tmp;
+			tmp &= ~0xF;
+			tmp |= 1;
+			axi_adc_write(rx_adc, 0x4048, tmp);
 		}
-	}
-	if (PCORE_VERSION_MAJOR(hdl_dac_version) < 8) {
-		axi_adc_read(rx_adc, 0x4048, &tmp);
-		saved = tmp;
-		tmp &= ~0xF;
-		tmp |= 1;
-		axi_adc_write(rx_adc, 0x4048, tmp);
 	}
 
-	ret = ad9361_dig_tune_delay(phy, max_freq, flags, true);
-	if (flags & DO_ODELAY)
-		ad9361_dig_tune_iodelay(phy, true);
+	ad9361_dig_tune_delay(dev, nb, flags, true);
 
-	if (PCORE_VERSION_MAJOR(hdl_dac_version) < 8)
-		axi_adc_write(rx_adc, 0x4048, saved);
+	for (n = 0; n < nb; n++) {
+		phy = dev[n].phy;
+		rx_adc = phy->rx_adc;
+		if (!dev[n].active)
+			continue;
 
-	for (chan = 0; chan < num_chan; chan++) {
-		axi_adc_write(rx_adc, ADI_REG_CHAN_CNTRL(chan),
-			      saved_chan_ctrl0[chan]);
-		axi_adc_set_pnsel(phy->rx_adc, chan, ADC_PN9);
-		if (PCORE_VERSION_MAJOR(hdl_dac_version) > 7) {
-			axi_adc_write(rx_adc, 0x4418 + chan * 0x40,
-				      saved_dsel[chan]);
-			axi_adc_write(rx_adc, 0x4044, 1);
-		}
+		if (flags & DO_ODELAY)
+			ad9361_dig_tune_iodelay(phy, true);
+
+		if (PCORE_VERSION_MAJOR(dev[n].hdl_dac_version) < 8)
+			axi_adc_write(rx_adc, 0x4048, dev[n].saved);
+
+		num_chan = ad9361_num_phy_chan(phy->adc_conv);
+		for (chan = 0; chan < num_chan; chan++) {
+			axi_adc_write(rx_adc, ADI_REG_CHAN_CNTRL(chan),
+				      dev[n].saved_chan_ctrl0[chan]);
+			axi_adc_set_pnsel(rx_adc, chan, ADC_PN9);
+			if (PCORE_VERSION_MAJOR(dev[n].hdl_dac_version) > 7) {
+				axi_adc_write(rx_adc, 0x4418 + chan * 0x40,
+					      dev[n].saved_dsel[chan]);
+				axi_adc_write(rx_adc, 0x4044, 1);
+			}
 
-		axi_adc_write(rx_adc, 0x4414 + chan * 0x40, saved_chan_ctrl6[chan]);
+			axi_adc_write(rx_adc, 0x4414 + chan * 0x40,
+				      dev[n].saved_chan_ctrl6[chan]);
+		}
 	}
-
-	return ret;
 }
 
 /**
- * Digital tune.
- * @param phy The AD9361 state structure.
- * @param max_freq Maximum frequency.
+ * Digital tune of multiple devices.
+ *
+ * The digital interfaces of all the devices are tuned at the same time.
+ * @param phys The AD9361 state structures.
+ * @param nb The number of devices [1, AD9361_MAX_MULTI_DEV].
+ * @param max_freq The maximum frequency of each device.
  * @param flags Flags: BE_VERBOSE, BE_MOREVERBOSE, DO_IDELAY, DO_ODELAY.
- * @return 0 in case of success, negative error code otherwise.
+ * @return 0 in case of success, the first negative error code otherwise.
  */
-int32_t ad9361_dig_tune(struct ad9361_rf_phy *phy, uint32_t max_freq,
-			enum dig_tune_flags flags)
+int32_t ad9361_multi_dig_tune(struct ad9361_rf_phy **phys, uint32_t nb,
+			      const uint32_t *max_freq,
+			      enum dig_tune_flags flags)
 {
-	struct axiadc_converter *conv = phy->adc_conv;
-	struct axi_adc *rx_adc = phy->rx_adc;
-	uint32_t loopback, bist, ensm_state;
-	bool restore = false;
+	struct ad9361_dig_tune_dev dev[AD9361_MAX_MULTI_DEV];
+	struct ad9361_rf_phy *phy;
+	struct axi_adc *rx_adc;
 	int32_t ret = 0;
+	uint32_t n;
 
-	if (!conv)
-		return -ENODEV;
+	if (!nb || nb > AD9361_MAX_MULTI_DEV)
+		return -EINVAL;
 
-	dev_dbg(&phy->spi->dev, "%s: freq %"PRIu32" flags 0x%X\n", __func__,
-		max_freq, flags);
+	for (n = 0; n < nb; n++)
+		if (!phys[n]->adc_conv)
+			return -ENODEV;
 
-	ensm_state = ad9361_ensm_get_state(phy);
+	memset(dev, 0, sizeof(dev));
 
-	if (phy->pdata->dig_interface_tune_skipmode == 2 ||
-	    (flags & RESTORE_DEFAULT)) {
-		/* skip completely and use defaults */
-		restore = true;
-	} else {
-		loopback = phy->bist_loopback_mode;
-		bist = phy->bist_config;
+	for (n = 0; n < nb; n++) {
+		phy = phys[n];
+		dev[n].phy = phy;
+		dev[n].max_freq = max_freq[n];
+
+		dev_dbg(&phy->spi->dev, "%s: freq %"PRIu32" flags 0x%X\n",
+			__func__, max_freq[n], flags);
+
+		dev[n].ensm_state = ad9361_ensm_get_state(phy);
+
+		if (phy->pdata->dig_interface_tune_skipmode == 2 ||
+		    (flags & RESTORE_DEFAULT)) {
+			/* skip completely and use defaults */
+			dev[n].restore = true;
+			continue;
+		}
+
+		dev[n].active = true;
+		dev[n].loopback = phy->bist_loopback_mode;
+		dev[n].bist = phy->bist_config;
 
 		/* Mute TX, we don't want to transmit the PRBS */
 		ad9361_tx_mute(phy, 1);
@@ -639,114 +767,182 @@ int32_t ad9361_dig_tune(struct ad9361_rf_phy *phy, uint32_t max_freq,
 
 		if (flags & DO_ODELAY)
 			ad9361_midscale_iodelay(phy, true);
+	}
 
-		ret = ad9361_dig_tune_rx(phy, max_freq, flags);
-		if (ret == 0 && !phy->pdata->dig_interface_tune_skipmode)
-			ret = ad9361_dig_tune_tx(phy, max_freq, flags);
+	ad9361_dig_tune_rx(dev, nb, flags);
 
-		ad9361_bist_loopback(phy, loopback);
-		ad9361_spi_write(phy->spi, REG_BIST_CONFIG, bist);
+	for (n = 0; n < nb; n++)
+		dev[n].active = dev[n].active && dev[n].ret == 0 &&
+				!phys[n]->pdata->dig_interface_tune_skipmode;
 
-		if (ret == -EIO)
-			restore = true;
-		if (!max_freq)
-			ret = 0;
-	}
+	ad9361_dig_tune_tx(dev, nb, flags);
 
-	if (restore) {
-		ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
-		ad9361_spi_write(phy->spi, REG_RX_CLOCK_DATA_DELAY,
-				 phy->pdata->port_ctrl.rx_clk_data_delay);
-		ad9361_spi_write(phy->spi, REG_TX_CLOCK_DATA_DELAY,
-				 phy->pdata->port_ctrl.tx_clk_data_delay);
-	} else if (!(flags & SKIP_STORE_RESULT)) {
-		phy->pdata->port_ctrl.rx_clk_data_delay =
-			ad9361_spi_read(phy->spi, REG_RX_CLOCK_DATA_DELAY);
-		phy->pdata->port_ctrl.tx_clk_data_delay =
-			ad9361_spi_read(phy->spi, REG_TX_CLOCK_DATA_DELAY);
-	}
+	for (n = 0; n < nb; n++) {
+		phy = dev[n].phy;
+		rx_adc = phy->rx_adc;
 
-	if (!phy->pdata->fdd)
-		ad9361_set_ensm_mode(phy, phy->pdata->fdd, phy->pdata->ensm_pin_ctrl);
-	ad9361_ensm_restore_state(phy, ensm_state);
+		if (!dev[n].restore) {
+			ad9361_bist_loopback(phy, dev[n].loopback);
+			ad9361_spi_write(phy->spi, REG_BIST_CONFIG, dev[n].bist);
 
-	axi_adc_write(rx_adc, ADI_REG_RSTN, ADI_MMCM_RSTN);
-	axi_adc_write(rx_adc, ADI_REG_RSTN, ADI_RSTN | ADI_MMCM_RSTN);
+			if (dev[n].ret == -EIO)
+				dev[n].restore = true;
+			if (!dev[n].max_freq)
+				dev[n].ret = 0;
+		}
 
-	ad9361_tx_mute(phy, 0);
+		if (dev[n].restore) {
+			ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
+			ad9361_spi_write(phy->spi, REG_RX_CLOCK_DATA_DELAY,
+					 phy->pdata->port_ctrl.rx_clk_data_delay);
+			ad9361_spi_write(phy->spi, REG_TX_CLOCK_DATA_DELAY,
+					 phy->pdata->port_ctrl.tx_clk_data_delay);
+		} else if (!(flags & SKIP_STORE_RESULT)) {
+			phy->pdata->port_ctrl.rx_clk_data_delay =
+				ad9361_spi_read(phy->spi, REG_RX_CLOCK_DATA_DELAY);
+			phy->pdata->port_ctrl.tx_clk_data_delay =
+				ad9361_spi_read(phy->spi, REG_TX_CLOCK_DATA_DELAY);
+		}
+
+		if (!phy->pdata->fdd)
+			ad9361_set_ensm_mode(phy, phy->pdata->fdd,
+					     phy->pdata->ensm_pin_ctrl);
+		ad9361_ensm_restore_state(phy, dev[n].ensm_state);
+
+		axi_adc_write(rx_adc, ADI_REG_RSTN, ADI_MMCM_RSTN);
+		axi_adc_write(rx_adc, ADI_REG_RSTN, ADI_RSTN | ADI_MMCM_RSTN);
+
+		ad9361_tx_mute(phy, 0);
+
+		if (!ret)
+			ret = dev[n].ret;
+	}
 
 	return ret;
 }
 
 /**
-* Setup the AD9361 device.
-* @param phy The AD9361 state structure.
-* @return 0 in case of success, negative error code otherwise.
-*/
-int32_t ad9361_post_setup(struct ad9361_rf_phy *phy)
+ * Digital tune.
+ * @param phy The AD9361 state structure.
+ * @param max_freq Maximum frequency.
+ * @param flags Flags: BE_VERBOSE, BE_MOREVERBOSE, DO_IDELAY, DO_ODELAY.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_dig_tune(struct ad9361_rf_phy *phy, uint32_t max_freq,
+			enum dig_tune_flags flags)
 {
-	struct axiadc_converter *conv = phy->adc_conv;
-	struct axi_adc *rx_adc = phy->rx_adc;
-	int32_t rx2tx2 = phy->pdata->rx2tx2;
-	uint32_t tmp, num_chan, flags, i;
-	int32_t ret;
-
-	num_chan = ad9361_num_phy_chan(conv);
+	return ad9361_multi_dig_tune(&phy, 1, &max_freq, flags);
+}
 
-	axi_adc_write(rx_adc, ADI_REG_CNTRL, rx2tx2 ? 0 : ADI_R1_MODE);
-	axi_adc_read(rx_adc, 0x4048, &tmp);
+/**
+* Setup the digital interface of multiple AD9361 devices.
+* @param phys The AD9361 state structures.
+* @param nb The number of devices [1, AD9361_MAX_MULTI_DEV].
+* @return 0 in case of success, the first negative error code otherwise.
+*/
+int32_t ad9361_multi_post_setup(struct ad9361_rf_phy **phys, uint32_t nb)
+{
+	uint32_t max_freq[AD9361_MAX_MULTI_DEV];
+	struct ad9361_rf_phy *phy;
+	struct axi_adc *rx_adc;
+	int32_t rx2tx2;
+	uint32_t tmp, num_chan, flags, i, n;
+	int32_t ret, err;
+
+	if (!nb || nb > AD9361_MAX_MULTI_DEV)
+		return -EINVAL;
+
+	for (n = 0; n < nb; n++) {
+		phy = phys[n];
+		rx_adc = phy->rx_adc;
+		rx2tx2 = phy->pdata->rx2tx2;
+		num_chan = ad9361_num_phy_chan(phy->adc_conv);
+
+		axi_adc_write(rx_adc, ADI_REG_CNTRL, rx2tx2 ? 0 : ADI_R1_MODE);
+		axi_adc_read(rx_adc, 0x4048, &tmp);
 
-	if (!rx2tx2) {
-		axi_adc_write(rx_adc, 0x4048, tmp | BIT(5)); /* R1_MODE */
-		axi_adc_write(rx_adc, 0x404c,
-			      (phy->pdata->port_ctrl.pp_conf[2] & LVDS_MODE) ? 1 : 0); /* RATE */
-	} else {
-		tmp &= ~BIT(5);
-		axi_adc_write(rx_adc, 0x4048, tmp);
-		axi_adc_write(rx_adc, 0x404c,
-			      (phy->pdata->port_ctrl.pp_conf[2] & LVDS_MODE) ? 3 : 1); /* RATE */
-	}
+		if (!rx2tx2) {
+			axi_adc_write(rx_adc, 0x4048, tmp | BIT(5)); /* R1_MODE */
+			axi_adc_write(rx_adc, 0x404c,
+				      (phy->pdata->port_ctrl.pp_conf[2] & LVDS_MODE) ? 1 : 0); /* RATE */
+		} else {
+			tmp &= ~BIT(5);
+			axi_adc_write(rx_adc, 0x4048, tmp);
+			axi_adc_write(rx_adc, 0x404c,
+				      (phy->pdata->port_ctrl.pp_conf[2] & LVDS_MODE) ? 3 : 1); /* RATE */
+		}
 
 #ifdef ALTERA_PLATFORM
-	axiadc_write(st, 0x404c, 1);
+		axiadc_write(st, 0x404c, 1);
 #endif
 
-	for (i = 0; i < num_chan; i++) {
-		axi_adc_write(rx_adc, ADI_REG_CHAN_CNTRL_1(i),
-			      ADI_DCFILT_OFFSET(0));
-		axi_adc_write(rx_adc, ADI_REG_CHAN_CNTRL_2(i),
-			      (i & 1) ? 0x00004000 : 0x40000000);
-		axi_adc_write(rx_adc, ADI_REG_CHAN_CNTRL(i),
-			      ADI_FORMAT_SIGNEXT | ADI_FORMAT_ENABLE |
-			      ADI_ENABLE | ADI_IQCOR_ENB);
+		for (i = 0; i < num_chan; i++) {
+			axi_adc_write(rx_adc, ADI_REG_CHAN_CNTRL_1(i),
+				      ADI_DCFILT_OFFSET(0));
+			axi_adc_write(rx_adc, ADI_REG_CHAN_CNTRL_2(i),
+				      (i & 1) ? 0x00004000 : 0x40000000);
+			axi_adc_write(rx_adc, ADI_REG_CHAN_CNTRL(i),
+				      ADI_FORMAT_SIGNEXT | ADI_FORMAT_ENABLE |
+				      ADI_ENABLE | ADI_IQCOR_ENB);
+		}
+
+		axi_adc_read(rx_adc, ADI_REG_ID, &tmp);
+		max_freq[n] = tmp ? 0 : 61440000;
 	}
 
 	flags = 0x0;
 
-	axi_adc_read(rx_adc, ADI_REG_ID, &tmp);
-	ret = ad9361_dig_tune(phy, (tmp) ?
-			      0 : 61440000, flags);
+	ret = ad9361_multi_dig_tune(phys, nb, max_freq, flags);
 	if (ret < 0)
 		return ret;
 
 	if (flags & (DO_IDELAY | DO_ODELAY)) {
-		axi_adc_read(rx_adc, ADI_REG_ID, &tmp);
-		ret = ad9361_dig_tune(phy, (tmp) ?
-				      0 : 61440000, flags & BE_VERBOSE);
+		ret = ad9361_multi_dig_tune(phys, nb, max_freq, flags & BE_VERBOSE);
 		if (ret < 0)
 			return ret;
 	}
 
-	ret = ad9361_set_trx_clock_chain(phy,
-					 phy->pdata->rx_path_clks,
-					 phy->pdata->tx_path_clks);
+	for (n = 0; n < nb; n++) {
+		phy = phys[n];
+		err = ad9361_set_trx_clock_chain(phy,
+						 phy->pdata->rx_path_clks,
+						 phy->pdata->tx_path_clks);
 
-	ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
-	ad9361_ensm_restore_prev_state(phy);
+		ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
+		ad9361_ensm_restore_prev_state(phy);
+
+		if (!ret)
+			ret = err;
+	}
 
 	return ret;
 }
+
+/**
+* Setup the AD9361 device.
+* @param phy The AD9361 state structure.
+* @return 0 in case of success, negative error code otherwise.
+*/
+int32_t ad9361_post_setup(struct ad9361_rf_phy *phy)
+{
+	return ad9361_multi_post_setup(&phy, 1);
+}
 #else
+/**
+ * Set intf delay.
+ * @param phy The AD9361 state structure.
+ * @param tx Set if TX.
+ * @param clock_delay The clock delay.
+ * @param data_delay The data delay.
+ * @param clock_changed Set if the clock delay changed, the ENSM is cycled.
+ * @return None.
+ */
+void ad9361_set_intf_delay(struct ad9361_rf_phy *phy, bool tx,
+			   uint32_t clock_delay,
+			   uint32_t data_delay, bool clock_changed)
+{
+}
+
 /**
  * HDL loopback enable/disable.
  * @param phy The AD9361 state structure.
@@ -771,6 +967,32 @@ int32_t ad9361_dig_tune(struct ad9361_rf_phy *phy, uint32_t max_freq,
 	return 0;
 }
 
+/**
+ * Digital tune of multiple devices.
+ * @param phys The AD9361 state structures.
+ * @param nb The number of devices [1, AD9361_MAX_MULTI_DEV].
+ * @param max_freq The maximum frequency of each device.
+ * @param flags Flags: BE_VERBOSE, BE_MOREVERBOSE, DO_IDELAY, DO_ODELAY.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_multi_dig_tune(struct ad9361_rf_phy **phys, uint32_t nb,
+			      const uint32_t *max_freq,
+			      enum dig_tune_flags flags)
+{
+	return 0;
+}
+
+/**
+* Setup the digital interface of multiple AD9361 devices.
+* @param phys The AD9361 state structures.
+* @param nb The number of devices [1, AD9361_MAX_MULTI_DEV].
+* @return 0 in case of success, negative error code otherwise.
+*/
+int32_t ad9361_multi_post_setup(struct ad9361_rf_phy **phys, uint32_t nb)
+{
+	return 0;
+}
+
 /**
 * Setup the AD9361 device.
 * @param phy The AD9361 state structure.
@@ -0,0 +1,366 @@
+/***************************************************************************//**
+ *   @file   ad9361_hop.c
+ *   @brief  Frequency hopping engine based on the AD9361 fastlock profiles.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "ad9361_hop.h"
+#include "ad9361_api.h"
+#include "delay.h"
+#include "timestamp.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define AD9361_HOP_LOCK_POLLS		100
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * Allocate the hopping engine.
+ * @param hop The hopping engine.
+ * @param param The initialization parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_hop_init(struct ad9361_hop **hop,
+			const struct ad9361_hop_init_param *param)
+{
+	struct ad9361_hop *h;
+	uint32_t i;
+
+	if (!param->phy || !param->nb_freqs ||
+	    param->nb_freqs > AD9361_HOP_MAX_FREQS)
+		return -EINVAL;
+
+	h = (struct ad9361_hop *)calloc(1, sizeof(*h));
+	if (!h)
+		return -ENOMEM;
+
+	h->phy = param->phy;
+	h->tx = param->tx;
+	h->wait_lock = param->wait_lock;
+	memcpy(h->pins, param->pins, sizeof(h->pins));
+	h->nb_freqs = param->nb_freqs;
+	for (i = 0; i < h->nb_freqs; i++) {
+		h->freqs[i].freq = param->freqs[i];
+		h->freqs[i].slot = -1;
+	}
+	for (i = 0; i < AD9361_HOP_NUM_SLOTS; i++)
+		h->slot_owner[i] = -1;
+	h->current = -1;
+	ad9361_hop_stats_reset(h);
+
+	*hop = h;
+
+	return 0;
+}
+
+/**
+ * Free the resources allocated by ad9361_hop_init().
+ * @param hop The hopping engine.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_hop_remove(struct ad9361_hop *hop)
+{
+	if (!hop)
+		return -EINVAL;
+
+	free(hop);
+
+	return 0;
+}
+
+/**
+ * Load the profile of a frequency in a device slot.
+ * @param hop The hopping engine.
+ * @param index The frequency index.
+ * @param slot The device profile slot.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_hop_load(struct ad9361_hop *hop, uint32_t index,
+			       uint32_t slot)
+{
+	int32_t ret;
+
+	ret = ad9361_fastlock_load(hop->phy, hop->tx, slot,
+				   hop->freqs[index].words);
+	if (ret < 0)
+		return ret;
+
+	if (hop->slot_owner[slot] >= 0)
+		hop->freqs[hop->slot_owner[slot]].slot = -1;
+	hop->slot_owner[slot] = index;
+	hop->freqs[index].slot = slot;
+
+	return 0;
+}
+
+/**
+ * Tune to every hop frequency and keep its fastlock profile in RAM.
+ *
+ * The synthesizer is tuned and calibrated for each frequency, its profile is
+ * stored through slot 0 and read back. The first eight profiles are then
+ * loaded in the device. The synthesizer is left tuned to the last frequency.
+ * @param hop The hopping engine.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_hop_prepare(struct ad9361_hop *hop)
+{
+	struct ad9361_rf_phy *phy = hop->phy;
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < AD9361_HOP_NUM_SLOTS; i++)
+		hop->slot_owner[i] = -1;
+
+	for (i = 0; i < hop->nb_freqs; i++) {
+		if (hop->tx)
+			ret = ad9361_set_tx_lo_freq(phy, hop->freqs[i].freq);
+		else
+			ret = ad9361_set_rx_lo_freq(phy, hop->freqs[i].freq);
+		if (ret < 0)
+			return ret;
+
+		ret = ad9361_fastlock_store(phy, hop->tx, 0);
+		if (ret < 0)
+			return ret;
+		ret = ad9361_fastlock_save(phy, hop->tx, 0,
+					   hop->freqs[i].words);
+		if (ret < 0)
+			return ret;
+		hop->freqs[i].slot = -1;
+		hop->freqs[i].last_use = 0;
+	}
+
+	for (i = 0; i < hop->nb_freqs && i < AD9361_HOP_NUM_SLOTS; i++) {
+		ret = ad9361_hop_load(hop, i, i);
+		if (ret < 0)
+			return ret;
+	}
+
+	hop->current = -1;
+
+	return 0;
+}
+
+/**
+ * Pick the device slot for a profile that is not loaded.
+ *
+ * A free slot is used first, otherwise the least recently used one, except
+ * the slot of the current frequency.
+ * @param hop The hopping engine.
+ * @return The slot number.
+ */
+static uint32_t ad9361_hop_pick_slot(struct ad9361_hop *hop)
+{
+	uint32_t i, slot = 0, oldest = UINT32_MAX;
+	int8_t owner;
+
+	for (i = 0; i < AD9361_HOP_NUM_SLOTS; i++) {
+		owner = hop->slot_owner[i];
+		if (owner < 0)
+			return i;
+		if (owner == hop->current)
+			continue;
+		if (hop->freqs[owner].last_use < oldest) {
+			oldest = hop->freqs[owner].last_use;
+			slot = i;
+		}
+	}
+
+	return slot;
+}
+
+/**
+ * Wait for the hopped synthesizer to lock.
+ * @param hop The hopping engine.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_hop_wait_lock(struct ad9361_hop *hop)
+{
+	uint32_t reg, i;
+	int32_t ret;
+
+	reg = hop->tx ? REG_TX_CP_OVERRANGE_VCO_LOCK :
+	      REG_RX_CP_OVERRANGE_VCO_LOCK;
+
+	for (i = 0; i < AD9361_HOP_LOCK_POLLS; i++) {
+		ret = ad9361_spi_read(hop->phy->spi, reg);
+		if (ret < 0)
+			return ret;
+		if (ret & VCO_LOCK)
+			return 0;
+		udelay(1);
+	}
+
+	return -ETIMEDOUT;
+}
+
+/**
+ * Hop to a frequency of the hop set.
+ *
+ * Profiles present in the device are recalled with a single SPI write, or
+ * through the profile select pins when they are given and fastlock pin
+ * control is enabled. Other profiles are first loaded from RAM in the least
+ * recently used slot.
+ * @param hop The hopping engine.
+ * @param index The frequency index.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_hop_to(struct ad9361_hop *hop, uint32_t index)
+{
+	struct ad9361_rf_phy *phy = hop->phy;
+	struct ad9361_hop_freq *f;
+	uint64_t start, elapsed;
+	uint32_t slot, i;
+	int32_t ret;
+
+	if (index >= hop->nb_freqs)
+		return -EINVAL;
+
+	start = timestamp_ns();
+	f = &hop->freqs[index];
+	f->last_use = ++hop->counter;
+
+	if (f->slot < 0) {
+		ret = ad9361_hop_load(hop, index, ad9361_hop_pick_slot(hop));
+		if (ret < 0)
+			return ret;
+		hop->stats.loads++;
+	}
+	slot = f->slot;
+
+	if (hop->pins[0] && phy->pdata->trx_fastlock_pinctrl_en[hop->tx] &&
+	    phy->fastlock.current_profile[hop->tx]) {
+		/* Already in fastlock pin mode, only select the profile */
+		for (i = 0; i < AD9361_HOP_NUM_PINS; i++) {
+			ret = gpio_set_value(hop->pins[i], (slot >> i) & 1);
+			if (ret < 0)
+				return ret;
+		}
+		phy->fastlock.current_profile[hop->tx] = slot + 1;
+	} else {
+		ret = ad9361_fastlock_recall(phy, hop->tx, slot);
+		if (ret < 0)
+			return ret;
+	}
+	hop->current = index;
+
+	if (hop->wait_lock) {
+		ret = ad9361_hop_wait_lock(hop);
+		if (ret < 0)
+			hop->stats.lock_errors++;
+	} else {
+		ret = 0;
+	}
+
+	elapsed = timestamp_ns() - start;
+	if (!hop->stats.hops || elapsed < hop->stats.min_ns)
+		hop->stats.min_ns = elapsed;
+	if (elapsed > hop->stats.max_ns)
+		hop->stats.max_ns = elapsed;
+	hop->stats.total_ns += elapsed;
+	hop->stats.hops++;
+
+	return ret;
+}
+
+/**
+ * Execute a hop schedule with a fixed dwell time.
+ *
+ * The dwell time is counted from the start of each hop when a timestamp
+ * source is available (see timestamp.h), so the hop period does not depend
+ * on the hop latency. Otherwise it is added after each hop.
+ * @param hop The hopping engine.
+ * @param schedule Frequency indexes to hop to, in order.
+ * @param len The number of hops.
+ * @param dwell_us The time spent on each frequency [us].
+ * @return 0 in case of success, the first hop error otherwise.
+ */
+int32_t ad9361_hop_run(struct ad9361_hop *hop, const uint32_t *schedule,
+		       uint32_t len, uint32_t dwell_us)
+{
+	bool has_timebase = timestamp_available();
+	uint64_t start;
+	int32_t ret, err = 0;
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		start = timestamp_ns();
+		ret = ad9361_hop_to(hop, schedule[i]);
+		if (ret < 0) {
+			if (ret != -ETIMEDOUT)
+				return ret;
+			if (!err)
+				err = ret;
+		}
+
+		if (!has_timebase)
+			udelay(dwell_us);
+		else
+			while (timestamp_ns() - start < (uint64_t)dwell_us * 1000)
+				;
+	}
+
+	return err;
+}
+
+/**
+ * Get the hop statistics.
+ * @param hop The hopping engine.
+ * @param stats The statistics.
+ */
+void ad9361_hop_stats_get(struct ad9361_hop *hop,
+			  struct ad9361_hop_stats *stats)
+{
+	*stats = hop->stats;
+}
+
+/**
+ * Clear the hop statistics.
+ * @param hop The hopping engine.
+ */
+void ad9361_hop_stats_reset(struct ad9361_hop *hop)
+{
+	memset(&hop->stats, 0, sizeof(hop->stats));
+}
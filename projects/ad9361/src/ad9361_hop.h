@@ -0,0 +1,141 @@
+/***************************************************************************//**
+ *   @file   ad9361_hop.h
+ *   @brief  Frequency hopping engine based on the AD9361 fastlock profiles.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef AD9361_HOP_H_
+#define AD9361_HOP_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "ad9361.h"
+#include "gpio.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define AD9361_HOP_MAX_FREQS		64
+#define AD9361_HOP_NUM_SLOTS		8
+#define AD9361_HOP_NUM_WORDS		16
+#define AD9361_HOP_NUM_PINS		3
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+struct ad9361_hop_init_param {
+	/* Device */
+	struct ad9361_rf_phy	*phy;
+	/* Hop the TX synthesizer instead of the RX one */
+	bool			tx;
+	/* Hop frequencies [Hz] */
+	const uint64_t		*freqs;
+	/* Number of hop frequencies */
+	uint32_t		nb_freqs;
+	/*
+	 * Optional profile select pins, used for hops to profiles present in
+	 * the device when fastlock pin control is enabled for the synthesizer.
+	 */
+	struct gpio_desc	*pins[AD9361_HOP_NUM_PINS];
+	/* Wait for the synthesizer to lock after each hop */
+	bool			wait_lock;
+};
+
+struct ad9361_hop_freq {
+	/* Frequency [Hz] */
+	uint64_t		freq;
+	/* Fastlock profile words */
+	uint8_t			words[AD9361_HOP_NUM_WORDS];
+	/* Device profile slot holding the words, -1 if none */
+	int8_t			slot;
+	/* Hop counter value at the last use */
+	uint32_t		last_use;
+};
+
+struct ad9361_hop_stats {
+	/* Number of hops */
+	uint32_t		hops;
+	/* Hops that had to load a profile in the device first */
+	uint32_t		loads;
+	/* Hops that did not lock in time */
+	uint32_t		lock_errors;
+	/* Shortest hop [ns] */
+	uint64_t		min_ns;
+	/* Longest hop [ns] */
+	uint64_t		max_ns;
+	/* Total hop time [ns] */
+	uint64_t		total_ns;
+};
+
+struct ad9361_hop {
+	struct ad9361_rf_phy	*phy;
+	bool			tx;
+	bool			wait_lock;
+	struct gpio_desc	*pins[AD9361_HOP_NUM_PINS];
+	uint32_t		nb_freqs;
+	struct ad9361_hop_freq	freqs[AD9361_HOP_MAX_FREQS];
+	/* Frequency index held by each device slot, -1 if free */
+	int8_t			slot_owner[AD9361_HOP_NUM_SLOTS];
+	/* Currently selected frequency index, -1 if none */
+	int32_t			current;
+	uint32_t		counter;
+	struct ad9361_hop_stats	stats;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Allocate the hopping engine. */
+int32_t ad9361_hop_init(struct ad9361_hop **hop,
+			const struct ad9361_hop_init_param *param);
+/* Free the resources allocated by ad9361_hop_init(). */
+int32_t ad9361_hop_remove(struct ad9361_hop *hop);
+/* Tune to every hop frequency and keep its fastlock profile in RAM. */
+int32_t ad9361_hop_prepare(struct ad9361_hop *hop);
+/* Hop to a frequency of the hop set. */
+int32_t ad9361_hop_to(struct ad9361_hop *hop, uint32_t index);
+/* Execute a hop schedule with a fixed dwell time. */
+int32_t ad9361_hop_run(struct ad9361_hop *hop, const uint32_t *schedule,
+		       uint32_t len, uint32_t dwell_us);
+/* Get the hop statistics. */
+void ad9361_hop_stats_get(struct ad9361_hop *hop,
+			  struct ad9361_hop_stats *stats);
+/* Clear the hop statistics. */
+void ad9361_hop_stats_reset(struct ad9361_hop *hop);
+
+#endif // AD9361_HOP_H_
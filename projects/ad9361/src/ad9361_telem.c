@@ -0,0 +1,295 @@
+/***************************************************************************//**
+ *   @file   ad9361_telem.c
+ *   @brief  RSSI and AGC telemetry sampler for the AD9361.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "ad9361_telem.h"
+#include "timestamp.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * Allocate the telemetry sampler.
+ *
+ * Sampling is stopped until ad9361_telem_enable() is called.
+ * @param telem The telemetry sampler.
+ * @param param The initialization parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_telem_init(struct ad9361_telem **telem,
+			  const struct ad9361_telem_init_param *param)
+{
+	struct ad9361_telem *t;
+	uint32_t size;
+	int32_t ret;
+
+	if (!param->phy || !param->period_us || !param->nb_records)
+		return -EINVAL;
+
+	t = (struct ad9361_telem *)calloc(1, sizeof(*t));
+	if (!t)
+		return -ENOMEM;
+
+	size = param->nb_records * sizeof(struct ad9361_telem_record);
+	t->buff = (uint8_t *)malloc(size);
+	if (!t->buff) {
+		ret = -ENOMEM;
+		goto error;
+	}
+
+	ret = ring_buf_init(&t->ring, t->buff, size);
+	if (ret < 0) {
+		ret = -EINVAL;
+		goto error;
+	}
+
+	t->phy = param->phy;
+	t->period_us = param->period_us;
+
+	*telem = t;
+
+	return 0;
+
+error:
+	free(t->buff);
+	free(t);
+
+	return ret;
+}
+
+/**
+ * Free the resources allocated by ad9361_telem_init().
+ * @param telem The telemetry sampler.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_telem_remove(struct ad9361_telem *telem)
+{
+	if (!telem)
+		return -EINVAL;
+
+	free(telem->buff);
+	free(telem);
+
+	return 0;
+}
+
+/**
+ * Start or stop periodic sampling.
+ *
+ * Starting discards the records left in the ring and takes the first sample
+ * at the next ad9361_telem_poll() call.
+ * @param telem The telemetry sampler.
+ * @param enable Start sampling if true, stop it otherwise.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_telem_enable(struct ad9361_telem *telem, bool enable)
+{
+	if (enable && !telem->enabled) {
+		ring_buf_reset(&telem->ring);
+		telem->next_ns = timestamp_ns();
+	}
+	telem->enabled = enable;
+
+	return 0;
+}
+
+/**
+ * Change the sampling period.
+ * @param telem The telemetry sampler.
+ * @param period_us The sampling period [us].
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_telem_set_period(struct ad9361_telem *telem,
+				uint32_t period_us)
+{
+	if (!period_us)
+		return -EINVAL;
+
+	telem->period_us = period_us;
+	telem->next_ns = timestamp_ns();
+
+	return 0;
+}
+
+/**
+ * Take a sample now and store it in the ring.
+ *
+ * The RSSI, gain index and fast attack state of both receivers are read with
+ * two SPI bursts, so a sample costs the same as a single ad9361_read_rssi()
+ * call and none of the gain table accesses done by ad9361_get_rx_gain().
+ * @param telem The telemetry sampler.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_telem_sample(struct ad9361_telem *telem)
+{
+	struct ad9361_telem_record rec;
+	struct spi_desc *spi = telem->phy->spi;
+	/* 0x1AB..0x1A7: symbol LSBs, RX2 preamble, RX2 symbol, RX1 preamble,
+	 * RX1 symbol */
+	uint8_t rssi[5];
+	/* 0x2B7..0x2B0: RX2 digital, LPF, gain index, slow loop state,
+	 * fast attack state, RX1 digital, LPF, gain index */
+	uint8_t gain[8];
+	int32_t ret;
+
+	if (ring_buf_space(&telem->ring) < sizeof(rec)) {
+		telem->stats.overflows++;
+		return -ENOSPC;
+	}
+
+	rec.timestamp = timestamp_ns();
+
+	ret = ad9361_spi_readm(spi, REG_SYMBOL_LSB, rssi, sizeof(rssi));
+	if (ret < 0)
+		goto error;
+
+	ret = ad9361_spi_readm(spi, REG_DIG_GAIN_RX2, gain, sizeof(gain));
+	if (ret < 0)
+		goto error;
+
+	rec.rssi[0] = (rssi[4] << RSSI_LSB_SHIFT) | (rssi[0] & RSSI_LSB_MASK1);
+	rec.rssi[1] = (rssi[2] << RSSI_LSB_SHIFT) |
+		      ((rssi[0] & RSSI_LSB_MASK2) >> 1);
+	rec.gain_index[0] = gain[7] & FULL_TABLE_GAIN_INDEX(~0);
+	rec.gain_index[1] = gain[2] & FULL_TABLE_GAIN_INDEX(~0);
+	rec.agc_state[0] = (gain[4] >> RX1_FAST_ATK_SHIFT) & FAST_ATK_MASK;
+	rec.agc_state[1] = (gain[4] >> RX2_FAST_ATK_SHIFT) & FAST_ATK_MASK;
+
+	ring_buf_write(&telem->ring, (const uint8_t *)&rec, sizeof(rec));
+	telem->stats.samples++;
+
+	return 0;
+
+error:
+	telem->stats.errors++;
+
+	return ret;
+}
+
+/**
+ * Take a sample if the sampling period elapsed.
+ *
+ * Meant to be called from the application main loop, or from a scheduler
+ * task, at least once per sampling period. Periods that elapsed entirely
+ * between two calls are skipped and counted as missed, so the sample times
+ * stay on the period grid. Without a time base (see timestamp.h), a sample
+ * is taken at each call.
+ * @param telem The telemetry sampler.
+ * @return 1 if a sample was taken, 0 if it was not due yet, negative error
+ *         code otherwise.
+ */
+int32_t ad9361_telem_poll(struct ad9361_telem *telem)
+{
+	uint64_t now, period_ns, late;
+	int32_t ret;
+
+	if (!telem->enabled)
+		return 0;
+
+	now = timestamp_ns();
+	if (now) {
+		if (now < telem->next_ns)
+			return 0;
+
+		period_ns = (uint64_t)telem->period_us * 1000;
+		late = (now - telem->next_ns) / period_ns;
+		telem->stats.missed += late;
+		telem->next_ns += (late + 1) * period_ns;
+	}
+
+	ret = ad9361_telem_sample(telem);
+
+	return ret < 0 ? ret : 1;
+}
+
+/**
+ * Get the number of records waiting in the ring.
+ * @param telem The telemetry sampler.
+ * @return The number of records.
+ */
+uint32_t ad9361_telem_level(struct ad9361_telem *telem)
+{
+	return ring_buf_level(&telem->ring) /
+	       sizeof(struct ad9361_telem_record);
+}
+
+/**
+ * Read records from the ring.
+ * @param telem The telemetry sampler.
+ * @param records Where to store the records.
+ * @param nb_records The maximum number of records to read.
+ * @return The number of records read.
+ */
+uint32_t ad9361_telem_read(struct ad9361_telem *telem,
+			   struct ad9361_telem_record *records,
+			   uint32_t nb_records)
+{
+	uint32_t level = ad9361_telem_level(telem);
+
+	if (nb_records > level)
+		nb_records = level;
+
+	return ring_buf_read(&telem->ring, (uint8_t *)records,
+			     nb_records * sizeof(*records)) / sizeof(*records);
+}
+
+/**
+ * Get the sampler statistics.
+ * @param telem The telemetry sampler.
+ * @param stats The statistics.
+ */
+void ad9361_telem_stats_get(struct ad9361_telem *telem,
+			    struct ad9361_telem_stats *stats)
+{
+	*stats = telem->stats;
+}
+
+/**
+ * Clear the sampler statistics.
+ * @param telem The telemetry sampler.
+ */
+void ad9361_telem_stats_reset(struct ad9361_telem *telem)
+{
+	memset(&telem->stats, 0, sizeof(telem->stats));
+}
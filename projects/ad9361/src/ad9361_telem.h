@@ -0,0 +1,133 @@
+/***************************************************************************//**
+ *   @file   ad9361_telem.h
+ *   @brief  RSSI and AGC telemetry sampler for the AD9361.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef AD9361_TELEM_H_
+#define AD9361_TELEM_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "ad9361.h"
+#include "ring_buf.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define AD9361_TELEM_NUM_CH		2
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/*
+ * Telemetry record, stored as is (little endian) in the ring. The layout
+ * has no padding and every member is naturally aligned.
+ */
+struct ad9361_telem_record {
+	/* Sample time [ns] (see timestamp.h) */
+	uint64_t		timestamp;
+	/* RX1/RX2 symbol RSSI, 0.25 dB steps */
+	uint16_t		rssi[AD9361_TELEM_NUM_CH];
+	/* RX1/RX2 full table (or LMT) gain index */
+	uint8_t			gain_index[AD9361_TELEM_NUM_CH];
+	/* RX1/RX2 fast attack AGC state */
+	uint8_t			agc_state[AD9361_TELEM_NUM_CH];
+};
+
+struct ad9361_telem_init_param {
+	/* Device */
+	struct ad9361_rf_phy	*phy;
+	/* Sampling period [us] */
+	uint32_t		period_us;
+	/* Ring capacity in records, must be a power of two */
+	uint32_t		nb_records;
+};
+
+struct ad9361_telem_stats {
+	/* Records written to the ring */
+	uint32_t		samples;
+	/* Records dropped because the ring was full */
+	uint32_t		overflows;
+	/* Sampling periods skipped because the sampler was polled late */
+	uint32_t		missed;
+	/* Failed register reads */
+	uint32_t		errors;
+};
+
+struct ad9361_telem {
+	struct ad9361_rf_phy	*phy;
+	uint32_t		period_us;
+	/* Time of the next sample [ns] */
+	uint64_t		next_ns;
+	bool			enabled;
+	uint8_t			*buff;
+	struct ring_buf		ring;
+	struct ad9361_telem_stats	stats;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Allocate the telemetry sampler. */
+int32_t ad9361_telem_init(struct ad9361_telem **telem,
+			  const struct ad9361_telem_init_param *param);
+/* Free the resources allocated by ad9361_telem_init(). */
+int32_t ad9361_telem_remove(struct ad9361_telem *telem);
+/* Start or stop periodic sampling. */
+int32_t ad9361_telem_enable(struct ad9361_telem *telem, bool enable);
+/* Change the sampling period. */
+int32_t ad9361_telem_set_period(struct ad9361_telem *telem,
+				uint32_t period_us);
+/* Take a sample now and store it in the ring. */
+int32_t ad9361_telem_sample(struct ad9361_telem *telem);
+/* Take a sample if the sampling period elapsed. */
+int32_t ad9361_telem_poll(struct ad9361_telem *telem);
+/* Get the number of records waiting in the ring. */
+uint32_t ad9361_telem_level(struct ad9361_telem *telem);
+/* Read records from the ring. */
+uint32_t ad9361_telem_read(struct ad9361_telem *telem,
+			   struct ad9361_telem_record *records,
+			   uint32_t nb_records);
+/* Get the sampler statistics. */
+void ad9361_telem_stats_get(struct ad9361_telem *telem,
+			    struct ad9361_telem_stats *stats);
+/* Clear the sampler statistics. */
+void ad9361_telem_stats_reset(struct ad9361_telem *telem);
+
+#endif // AD9361_TELEM_H_
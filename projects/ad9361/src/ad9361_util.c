@@ -48,6 +48,34 @@
 /*************************** Macros Definitions *******************************/
 /******************************************************************************/
 #define BITS_PER_LONG		32
+/* Baseband clocks, the rates are cached and derived from the parent rate */
+#define CLK_CACHED_MASK		(BIT(TX_SAMPL_CLK + 1) - 1)
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+/*
+ * Direct parents of each clock. The reference clocks are fed by the external
+ * clock and the RF synthesizers by either their internal PLL or the external
+ * LO. The enum order is a topological order of this graph.
+ */
+static const uint32_t clk_parents[NUM_AD9361_CLKS] = {
+	[BBPLL_CLK] = BIT(BB_REFCLK),
+	[ADC_CLK] = BIT(BBPLL_CLK),
+	[R2_CLK] = BIT(ADC_CLK),
+	[R1_CLK] = BIT(R2_CLK),
+	[CLKRF_CLK] = BIT(R1_CLK),
+	[RX_SAMPL_CLK] = BIT(CLKRF_CLK),
+	[DAC_CLK] = BIT(ADC_CLK),
+	[T2_CLK] = BIT(DAC_CLK),
+	[T1_CLK] = BIT(T2_CLK),
+	[CLKTF_CLK] = BIT(T1_CLK),
+	[TX_SAMPL_CLK] = BIT(CLKTF_CLK),
+	[RX_RFPLL_INT] = BIT(RX_REFCLK),
+	[TX_RFPLL_INT] = BIT(TX_REFCLK),
+	[RX_RFPLL] = BIT(RX_RFPLL_INT) | BIT(RX_RFPLL_DUMMY),
+	[TX_RFPLL] = BIT(TX_RFPLL_INT) | BIT(TX_RFPLL_DUMMY),
+};
 
 /***************************************************************************//**
  * @brief clk_prepare_enable
@@ -62,27 +90,63 @@ int32_t clk_prepare_enable(struct clk *clk)
 }
 
 /***************************************************************************//**
- * @brief clk_get_rate
+ * @brief clk_descendants
 *******************************************************************************/
-uint32_t clk_get_rate(struct ad9361_rf_phy *phy,
-		      struct refclk_scale *clk_priv)
+static uint32_t clk_descendants(uint32_t mask)
+{
+	uint32_t i;
+
+	for (i = 0; i < NUM_AD9361_CLKS; i++)
+		if (clk_parents[i] & mask)
+			mask |= BIT(i);
+
+	return mask;
+}
+
+/***************************************************************************//**
+ * @brief clk_recalc_rate
+*******************************************************************************/
+static uint32_t clk_recalc_rate(struct ad9361_rf_phy *phy,
+				struct refclk_scale *clk_priv)
 {
 	uint32_t rate = 0;
 	uint32_t source;
+	uint32_t parent_rate;
 
 	source = clk_priv->source;
 
+	if (source <= TX_REFCLK)
+		parent_rate = phy->clk_refin->rate;
+	else
+		parent_rate = phy->clks[clk_priv->parent_source]->rate;
+
+	/* The scaler of a clean clock is known, skip the read back */
+	if ((BIT(source) & CLK_CACHED_MASK & ~phy->clk_stale) &&
+	    (source != BBPLL_CLK))
+		return ((uint64_t)parent_rate * clk_priv->mult) / clk_priv->div;
+
 	switch (source) {
 	case TX_REFCLK:
 	case RX_REFCLK:
 	case BB_REFCLK:
-		rate = ad9361_clk_factor_recalc_rate(clk_priv,
-						     phy->clk_refin->rate);
+	case ADC_CLK:
+	case R2_CLK:
+	case R1_CLK:
+	case CLKRF_CLK:
+	case RX_SAMPL_CLK:
+	case DAC_CLK:
+	case T2_CLK:
+	case T1_CLK:
+	case CLKTF_CLK:
+	case TX_SAMPL_CLK:
+		rate = ad9361_clk_factor_recalc_rate(clk_priv, parent_rate);
+		break;
+	case BBPLL_CLK:
+		rate = ad9361_bbpll_recalc_rate(clk_priv, parent_rate);
 		break;
 	case TX_RFPLL_INT:
 	case RX_RFPLL_INT:
-		rate = ad9361_rfpll_int_recalc_rate(clk_priv,
-						    phy->clks[clk_priv->parent_source]->rate);
+		rate = ad9361_rfpll_int_recalc_rate(clk_priv, parent_rate);
 		break;
 	case RX_RFPLL_DUMMY:
 	case TX_RFPLL_DUMMY:
@@ -92,23 +156,6 @@ uint32_t clk_get_rate(struct ad9361_rf_phy *phy,
 	case RX_RFPLL:
 		rate = ad9361_rfpll_recalc_rate(clk_priv);
 		break;
-	case BBPLL_CLK:
-		rate = ad9361_bbpll_recalc_rate(clk_priv,
-						phy->clks[clk_priv->parent_source]->rate);
-		break;
-	case ADC_CLK:
-	case R2_CLK:
-	case R1_CLK:
-	case CLKRF_CLK:
-	case RX_SAMPL_CLK:
-	case DAC_CLK:
-	case T2_CLK:
-	case T1_CLK:
-	case CLKTF_CLK:
-	case TX_SAMPL_CLK:
-		rate = ad9361_clk_factor_recalc_rate(clk_priv,
-						     phy->clks[clk_priv->parent_source]->rate);
-		break;
 	default:
 		break;
 	}
@@ -116,6 +163,56 @@ uint32_t clk_get_rate(struct ad9361_rf_phy *phy,
 	return rate;
 }
 
+/***************************************************************************//**
+ * @brief clk_update_rates
+*******************************************************************************/
+static void clk_update_rates(struct ad9361_rf_phy *phy, uint32_t mask)
+{
+	uint32_t i;
+
+	for (i = 0; i < NUM_AD9361_CLKS; i++) {
+		if (!(mask & BIT(i)))
+			continue;
+		phy->clks[i]->rate = clk_recalc_rate(phy, phy->ref_clk_scale[i]);
+		phy->clk_stale &= ~BIT(i);
+	}
+}
+
+/***************************************************************************//**
+ * @brief clk_invalidate
+*******************************************************************************/
+void clk_invalidate(struct ad9361_rf_phy *phy, uint32_t mask)
+{
+	phy->clk_stale |= clk_descendants(mask) & CLK_CACHED_MASK;
+}
+
+/***************************************************************************//**
+ * @brief clk_get_rate
+*******************************************************************************/
+uint32_t clk_get_rate(struct ad9361_rf_phy *phy,
+		      struct refclk_scale *clk_priv)
+{
+	uint32_t source;
+	uint32_t mask;
+	uint32_t i;
+
+	source = clk_priv->source;
+
+	if (!(BIT(source) & CLK_CACHED_MASK))
+		return clk_recalc_rate(phy, clk_priv);
+
+	if (phy->clk_stale & BIT(source)) {
+		/* Refresh the stale ancestors first */
+		mask = BIT(source);
+		for (i = source; i > 0; i--)
+			if (mask & BIT(i))
+				mask |= clk_parents[i];
+		clk_update_rates(phy, mask & phy->clk_stale);
+	}
+
+	return phy->clks[source]->rate;
+}
+
 /***************************************************************************//**
  * @brief clk_set_rate
 *******************************************************************************/
@@ -124,10 +221,14 @@ int32_t clk_set_rate(struct ad9361_rf_phy *phy,
 		     uint32_t rate)
 {
 	uint32_t source;
-	int32_t i;
 	uint32_t round_rate;
+	uint32_t mult, div;
+	int32_t ret = 0;
 
 	source = clk_priv->source;
+	/* Compare against the hardware setting rather than a stale entry */
+	if (BIT(source) & CLK_CACHED_MASK)
+		clk_get_rate(phy, clk_priv);
 	if(phy->clks[source]->rate != rate) {
 		switch (source) {
 		case TX_REFCLK:
@@ -135,10 +236,8 @@ int32_t clk_set_rate(struct ad9361_rf_phy *phy,
 		case BB_REFCLK:
 			round_rate = ad9361_clk_factor_round_rate(clk_priv, rate,
 					&phy->clk_refin->rate);
-			ad9361_clk_factor_set_rate(clk_priv, round_rate,
-						   phy->clk_refin->rate);
-			phy->clks[source]->rate = ad9361_clk_factor_recalc_rate(clk_priv,
-						  phy->clk_refin->rate);
+			ret = ad9361_clk_factor_set_rate(clk_priv, round_rate,
+							 phy->clk_refin->rate);
 			break;
 		case TX_RFPLL_INT:
 		case RX_RFPLL_INT:
@@ -146,8 +245,6 @@ int32_t clk_set_rate(struct ad9361_rf_phy *phy,
 					&phy->clks[clk_priv->parent_source]->rate);
 			ad9361_rfpll_int_set_rate(clk_priv, round_rate,
 						  phy->clks[clk_priv->parent_source]->rate);
-			phy->clks[source]->rate = ad9361_rfpll_int_recalc_rate(clk_priv,
-						  phy->clks[clk_priv->parent_source]->rate);
 			break;
 		case RX_RFPLL_DUMMY:
 		case TX_RFPLL_DUMMY:
@@ -157,15 +254,12 @@ int32_t clk_set_rate(struct ad9361_rf_phy *phy,
 		case RX_RFPLL:
 			round_rate = ad9361_rfpll_round_rate(clk_priv, rate);
 			ad9361_rfpll_set_rate(clk_priv, round_rate);
-			phy->clks[source]->rate = ad9361_rfpll_recalc_rate(clk_priv);
 			break;
 		case BBPLL_CLK:
 			round_rate = ad9361_bbpll_round_rate(clk_priv, rate,
 							     &phy->clks[clk_priv->parent_source]->rate);
 			ad9361_bbpll_set_rate(clk_priv, round_rate,
 					      phy->clks[clk_priv->parent_source]->rate);
-			phy->clks[source]->rate = ad9361_bbpll_recalc_rate(clk_priv,
-						  phy->clks[clk_priv->parent_source]->rate);
 			phy->bbpll_initialized = true;
 			break;
 		case ADC_CLK:
@@ -178,37 +272,29 @@ int32_t clk_set_rate(struct ad9361_rf_phy *phy,
 		case T1_CLK:
 		case CLKTF_CLK:
 		case TX_SAMPL_CLK:
+			mult = clk_priv->mult;
+			div = clk_priv->div;
 			round_rate = ad9361_clk_factor_round_rate(clk_priv, rate,
 					&phy->clks[clk_priv->parent_source]->rate);
-			ad9361_clk_factor_set_rate(clk_priv, round_rate,
-						   phy->clks[clk_priv->parent_source]->rate);
-			phy->clks[source]->rate = ad9361_clk_factor_recalc_rate(clk_priv,
-						  phy->clks[clk_priv->parent_source]->rate);
+			/*
+			 * Only the rate of the parent changed, the scaler is
+			 * already programmed. The FIR stages also hold the
+			 * bypass state, so these are always written.
+			 */
+			if (clk_priv->mult == mult && clk_priv->div == div &&
+			    source != RX_SAMPL_CLK && source != TX_SAMPL_CLK)
+				break;
+			ret = ad9361_clk_factor_set_rate(clk_priv, round_rate,
+							 phy->clks[clk_priv->parent_source]->rate);
 			break;
 		default:
 			break;
 		}
-		for(i = BB_REFCLK; i < BBPLL_CLK; i++) {
-			phy->clks[i]->rate = ad9361_clk_factor_recalc_rate(phy->ref_clk_scale[i],
-					     phy->clk_refin->rate);
-		}
-		phy->clks[BBPLL_CLK]->rate = ad9361_bbpll_recalc_rate(
-						     phy->ref_clk_scale[BBPLL_CLK],
-						     phy->clks[phy->ref_clk_scale[BBPLL_CLK]->parent_source]->rate);
-		for(i = ADC_CLK; i < RX_RFPLL_INT; i++) {
-			phy->clks[i]->rate = ad9361_clk_factor_recalc_rate(phy->ref_clk_scale[i],
-					     phy->clks[phy->ref_clk_scale[i]->parent_source]->rate);
-		}
-		for(i = RX_RFPLL_INT; i < RX_RFPLL_DUMMY; i++) {
-			phy->clks[i]->rate = ad9361_rfpll_int_recalc_rate(phy->ref_clk_scale[i],
-					     phy->clks[phy->ref_clk_scale[i]->parent_source]->rate);
-		}
-		for(i = RX_RFPLL_DUMMY; i < RX_RFPLL; i++) {
-			phy->clks[i]->rate = ad9361_rfpll_dummy_recalc_rate(phy->ref_clk_scale[i]);
-		}
-		for(i = RX_RFPLL; i < NUM_AD9361_CLKS; i++) {
-			phy->clks[i]->rate = ad9361_rfpll_recalc_rate(phy->ref_clk_scale[i]);
-		}
+		/* The scaler was left untouched, read back the hardware state */
+		if (ret < 0)
+			clk_invalidate(phy, BIT(source));
+		/* Only the clocks derived from this one are affected */
+		clk_update_rates(phy, clk_descendants(BIT(source)));
 	} else {
 		if ((source == BBPLL_CLK) && !phy->bbpll_initialized) {
 			round_rate = ad9361_bbpll_round_rate(clk_priv, rate,
@@ -122,6 +122,7 @@ uint32_t clk_get_rate(struct ad9361_rf_phy *phy,
 int32_t clk_set_rate(struct ad9361_rf_phy *phy,
 		     struct refclk_scale *clk_priv,
 		     uint32_t rate);
+void clk_invalidate(struct ad9361_rf_phy *phy, uint32_t mask);
 uint32_t int_sqrt(uint32_t x);
 int32_t ilog2(int32_t x);
 uint32_t find_first_bit(uint32_t word);
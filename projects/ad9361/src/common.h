@@ -51,10 +51,13 @@
 #define EAGAIN		11	/* Try again */
 #define ENOMEM		12	/* Out of memory */
 #define EFAULT		14	/* Bad address */
+#define EBUSY		16	/* Device or resource busy */
 #define ENODEV		19	/* No such device */
 #define EINVAL		22	/* Invalid argument */
+#define ENOSPC		28	/* No space left on device */
 #define EOPNOTSUPP	45	/* Operation not supported on transport endpoint */
 #define ETIMEDOUT	110	/* Connection timed out */
+#define EINPROGRESS	115	/* Operation now in progress */
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -58,6 +58,10 @@
 //#define TDD_SWITCH_STATE_EXAMPLE
 
 //#define IIO_EXAMPLE
+//#define IIO_TELEMETRY /* RSSI/AGC telemetry IIO device, needs TELEMETRY=y */
+#define HAVE_RETUNE_TIMING /* RF PLL retune timing, reads 0 without a time base */
+//#define HAVE_BOOT_TIMING /* FMCOMMS5 boot phase timing */
+//#define HAVE_SCHEDULER /* ad9361_check_cal_done_task(), needs SCHEDULER=y */
 
 #ifndef IIO_EXAMPLE
 #define HAVE_VERBOSE_MESSAGES /* Recommended during development prints errors and warnings */
@@ -57,6 +57,13 @@
 #include "axi_dac_core.h"
 #include "axi_dmac.h"
 #include "error.h"
+#if defined(HAVE_BOOT_TIMING) || defined(HAVE_RETUNE_TIMING)
+#include "timer.h"
+#include "timestamp.h"
+#ifdef XILINX_PLATFORM
+#include "timer_extra.h"
+#endif
+#endif
 
 #ifdef IIO_EXAMPLE
 
@@ -64,6 +71,9 @@
 #include "iio_axi_adc_app.h"
 #include "iio_axi_dac_app.h"
 #include "iio_ad9361.h"
+#ifdef IIO_TELEMETRY
+#include "iio_ad9361_telem.h"
+#endif
 #include "irq.h"
 #include "irq_extra.h"
 #include "uart.h"
@@ -71,6 +81,10 @@
 
 static struct uart_desc *uart_desc;
 
+#ifdef IIO_TELEMETRY
+static struct ad9361_telem *telem;
+#endif
+
 /**
  * iio_uart_write() - Write data to UART device wrapper.
  * @buf - Pointer to buffer containing data.
@@ -84,13 +98,30 @@ static ssize_t iio_uart_write(const char *buf, size_t len)
 
 /**
  * iio_uart_read() - Read data from UART device wrapper.
+ * With IIO_TELEMETRY, the telemetry sampler is polled while waiting for the
+ * data, so records keep being taken between two buffer refills without
+ * sharing the SPI bus with an interrupt handler.
  * @buf - Pointer to buffer containing data.
  * @len - Number of bytes to read.
  * @Return: SUCCESS in case of success, FAILURE otherwise.
  */
 static ssize_t iio_uart_read(char *buf, size_t len)
 {
+#ifdef IIO_TELEMETRY
+	size_t received = 0;
+
+	while (received < len) {
+		received += uart_read_nonblocking(uart_desc,
+						  (uint8_t *)buf + received,
+						  len - received);
+		if (received < len)
+			ad9361_telem_poll(telem);
+	}
+
+	return len;
+#else
 	return uart_read(uart_desc, (uint8_t *)buf, len);
+#endif
 }
 
 #endif // IIO_EXAMPLE
@@ -449,6 +480,17 @@ AD9361_TXFIRConfig tx_fir_config = {	// BPF PASSBAND 3/20 fs to 1/4 fs
 struct ad9361_rf_phy *ad9361_phy;
 #ifdef FMCOMMS5
 struct ad9361_rf_phy *ad9361_phy_b;
+AD9361_InitParam init_param_b;
+struct axi_adc_init rx_adc_init_b = {
+	"cf-ad9361-lpc",
+	AD9361_RX_1_BASEADDR,
+	4
+};
+struct axi_dac_init tx_dac_init_b = {
+	"cf-ad9361-dds-core-lpc",
+	AD9361_TX_1_BASEADDR,
+	4
+};
 #endif
 
 struct xil_spi_init_param xil_spi_param = {
@@ -466,6 +508,49 @@ struct spi_init_param spi_param = {
 	.extra = &xil_spi_param
 };
 
+#if defined(HAVE_BOOT_TIMING) || defined(HAVE_RETUNE_TIMING)
+/***************************************************************************//**
+ * @brief Start the time base of the boot and retune timing.
+ *
+ * On Linux, timestamp.h falls back to CLOCK_MONOTONIC. Without a timer the
+ * measured durations read 0.
+ *
+ * @return SUCCESS in case of success, FAILURE otherwise.
+*******************************************************************************/
+static int32_t timing_init(void)
+{
+#if defined(XILINX_PLATFORM) && defined(TIMER_DEVICE_ID)
+	static struct timer_desc *timer;
+	struct xil_timer_init_param xil_timer_param = {
+#ifdef PLATFORM_MB
+		.type = TIMER_PL,
+#else
+		.type = TIMER_PS,
+#endif
+		.device_id = TIMER_DEVICE_ID
+	};
+	struct timer_init_param timer_param = {
+		.freq_hz = TIMER_FREQ_HZ,
+		.load_value = 0,
+		.extra = &xil_timer_param
+	};
+	int32_t status;
+
+	status = timer_init(&timer, &timer_param);
+	if (status != SUCCESS)
+		return status;
+
+	status = timer_start(timer);
+	if (status != SUCCESS)
+		return status;
+
+	return timestamp_init(timer);
+#else
+	return SUCCESS;
+#endif
+}
+#endif
+
 /***************************************************************************//**
  * @brief main
 *******************************************************************************/
@@ -480,6 +565,14 @@ int main(void)
 	struct gpio_init_param 	gpio_init;
 	gpio_init.extra = &xil_gpio_param;
 
+#if defined(HAVE_BOOT_TIMING) || defined(HAVE_RETUNE_TIMING)
+	status = timing_init();
+	if (status != SUCCESS) {
+		printf("timing_init() error: %"PRIi32"\n", status);
+		return status;
+	}
+#endif
+
 #ifdef ALTERA_PLATFORM
 	if (altera_bridge_init()) {
 		printf("Altera Bridge Init Error!\n");
@@ -549,11 +642,6 @@ int main(void)
 	default_init_param.digital_interface_tune_fir_disable = 1;
 #endif
 
-	ad9361_init(&ad9361_phy, &default_init_param);
-
-	ad9361_set_tx_fir_config(ad9361_phy, tx_fir_config);
-	ad9361_set_rx_fir_config(ad9361_phy, rx_fir_config);
-
 #ifdef FMCOMMS5
 #ifdef LINUX_PLATFORM
 	gpio_init(default_init_param.gpio_sync);
@@ -565,39 +653,60 @@ int main(void)
 		return status;
 	}
 	gpio_direction_output(default_init_param.gpio_desc_sync, 1);
-	default_init_param.id_no = SPI_CS_2;
-	default_init_param.gpio_resetb.number = GPIO_RESET_PIN_2;
+
+	/* The second part only differs by its SPI CS, reset GPIO, LO and cores */
+	init_param_b = default_init_param;
+	init_param_b.id_no = SPI_CS_2;
+	init_param_b.gpio_resetb.number = GPIO_RESET_PIN_2;
 #ifdef LINUX_PLATFORM
-	gpio_init(default_init_param.gpio_resetb);
+	gpio_init(init_param_b.gpio_resetb);
 #endif
-	default_init_param.gpio_sync.number = -1;
-	default_init_param.gpio_cal_sw1.number = -1;
-	default_init_param.gpio_cal_sw2.number = -1;
-	default_init_param.rx_synthesizer_frequency_hz = 2300000000UL;
-	default_init_param.tx_synthesizer_frequency_hz = 2300000000UL;
-	status = gpio_get(&default_init_param.gpio_desc_resetb,
-			  &default_init_param.gpio_resetb);
+	init_param_b.gpio_sync.number = -1;
+	init_param_b.gpio_cal_sw1.number = -1;
+	init_param_b.gpio_cal_sw2.number = -1;
+	init_param_b.rx_synthesizer_frequency_hz = 2300000000UL;
+	init_param_b.tx_synthesizer_frequency_hz = 2300000000UL;
+	status = gpio_get(&init_param_b.gpio_desc_resetb,
+			  &init_param_b.gpio_resetb);
 	if (status != SUCCESS) {
 		printf("gpio_get() error: %"PRIi32"\n", status);
 		return status;
 	}
-	gpio_direction_output(default_init_param.gpio_desc_resetb, 1);
+	gpio_direction_output(init_param_b.gpio_desc_resetb, 1);
 
-	rx_adc_init.base = AD9361_RX_1_BASEADDR;
-	tx_dac_init.base = AD9361_TX_1_BASEADDR;
+	init_param_b.rx_adc_init = &rx_adc_init_b;
+	init_param_b.tx_dac_init = &tx_dac_init_b;
 
-	spi_param.chip_select = default_init_param.id_no;
+	spi_param.chip_select = init_param_b.id_no;
 
-	status = spi_init(&default_init_param.spi, &spi_param);
+	status = spi_init(&init_param_b.spi, &spi_param);
 	if (status != SUCCESS) {
 		printf("spi_init() error: %"PRIi32"\n", status);
 		return status;
 	}
 
-	ad9361_init(&ad9361_phy_b, &default_init_param);
+	struct ad9361_rf_phy *phys[2];
+	AD9361_InitParam *init_params[2] = {&default_init_param, &init_param_b};
+	struct ad9361_boot_stats boot_stats;
+
+	/* Bring both parts up together, MCS is done below */
+	status = ad9361_multi_init(phys, init_params, 2, &boot_stats);
+	if (status < 0) {
+		printf("ad9361_multi_init() error: %"PRIi32"\n", status);
+		return status;
+	}
+	ad9361_phy = phys[0];
+	ad9361_phy_b = phys[1];
 
+	ad9361_set_tx_fir_config(ad9361_phy, tx_fir_config);
+	ad9361_set_rx_fir_config(ad9361_phy, rx_fir_config);
 	ad9361_set_tx_fir_config(ad9361_phy_b, tx_fir_config);
 	ad9361_set_rx_fir_config(ad9361_phy_b, rx_fir_config);
+#else
+	ad9361_init(&ad9361_phy, &default_init_param);
+
+	ad9361_set_tx_fir_config(ad9361_phy, tx_fir_config);
+	ad9361_set_rx_fir_config(ad9361_phy, rx_fir_config);
 #endif
 	status = axi_dmac_init(&ad9361_phy->tx_dmac, default_init_param.tx_dmac_init);
 	if (status < 0) {
@@ -631,7 +740,22 @@ int main(void)
 #endif
 
 #ifdef FMCOMMS5
+#ifdef HAVE_BOOT_TIMING
+	uint64_t mcs_start_ns = timestamp_ns();
+#endif
 	ad9361_do_mcs(ad9361_phy, ad9361_phy_b);
+#ifdef HAVE_BOOT_TIMING
+	boot_stats.phase_ns[AD9361_BOOT_MCS] = timestamp_ns() - mcs_start_ns;
+	boot_stats.total_ns += boot_stats.phase_ns[AD9361_BOOT_MCS];
+	printf("Boot: probe %"PRIu64" setup %"PRIu64" calib %"PRIu64
+	       " interface %"PRIu64" mcs %"PRIu64" total %"PRIu64" us\n",
+	       boot_stats.phase_ns[AD9361_BOOT_PROBE] / 1000,
+	       boot_stats.phase_ns[AD9361_BOOT_SETUP] / 1000,
+	       boot_stats.phase_ns[AD9361_BOOT_CALIB] / 1000,
+	       boot_stats.phase_ns[AD9361_BOOT_INTERFACE] / 1000,
+	       boot_stats.phase_ns[AD9361_BOOT_MCS] / 1000,
+	       boot_stats.total_ns / 1000);
+#endif
 #endif
 
 #ifndef AXI_ADC_NOT_PRESENT
@@ -810,6 +934,40 @@ int main(void)
 	if(status < 0)
 		return status;
 
+#ifdef IIO_TELEMETRY
+	struct ad9361_telem_init_param telem_init_par = {
+		.phy = ad9361_phy,
+		.period_us = 1000,
+		.nb_records = 1024,
+	};
+	struct iio_ad9361_telem_init_par iio_telem_init_par;
+	struct iio_ad9361_telem *iio_telem;
+
+	status = ad9361_telem_init(&telem, &telem_init_par);
+	if(status < 0)
+		return status;
+
+	iio_telem_init_par.telem = telem;
+	status = iio_ad9361_telem_init(&iio_telem, &iio_telem_init_par);
+	if(status < 0)
+		return status;
+
+	const char telem_dev_name[] = "ad9361-telemetry";
+	struct iio_interface_init_par iio_telem_intf_par = {
+		.dev_name = telem_dev_name,
+		.dev_instance = iio_telem,
+		.iio_device = iio_ad9361_telem_create_device(telem_dev_name),
+		.get_xml = iio_ad9361_telem_get_xml,
+		.transfer_dev_to_mem = iio_ad9361_telem_transfer_dev_to_mem,
+		.transfer_mem_to_dev = NULL,
+		.read_data = iio_ad9361_telem_read_dev,
+		.write_data = NULL,
+	};
+	status = iio_register(&iio_telem_intf_par);
+	if(status < 0)
+		return status;
+#endif // IIO_TELEMETRY
+
 	return iio_app(iio_app_desc);
 
 #endif // IIO_EXAMPLE
@@ -99,6 +99,8 @@
 #define GPIO_TXNRX_PIN        		102
 #define SPI_DEVICE_ID				XPAR_PS7_SPI_0_DEVICE_ID
 #define UART_IRQ_ID				XPAR_XUARTPS_1_INTR
+#define TIMER_DEVICE_ID				XPAR_PS7_SCUTIMER_0_DEVICE_ID
+#define TIMER_FREQ_HZ				10000000
 #endif
 #define GPIO_RESET_PIN_ZC702		84
 #define GPIO_RESET_PIN_ZC706		83
@@ -126,6 +128,10 @@
 #else
 #define SPI_DEVICE_ID				XPAR_SPI_0_DEVICE_ID
 #endif
+#ifdef XPAR_AXI_TIMER_0_DEVICE_ID
+#define TIMER_DEVICE_ID				XPAR_AXI_TIMER_0_DEVICE_ID
+#define TIMER_FREQ_HZ				XPAR_AXI_TIMER_0_CLOCK_FREQ_HZ
+#endif
 #endif
 
 #define SPI_CS                  0
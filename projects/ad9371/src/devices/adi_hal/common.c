@@ -15,6 +15,7 @@
 #include <errno.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include "common.h"
 #include "spi.h"
 #include "spi_extra.h"
@@ -205,6 +206,59 @@ commonErr_t CMB_SPIReadByte(spiSettings_t *spiSettings, uint16_t addr,
 	return(COMMONERR_OK);
 }
 
+/* write count consecutive registers, one instruction word per transaction */
+commonErr_t CMB_SPIWriteStream(spiSettings_t *spiSettings, uint16_t addr,
+			       uint8_t *data, uint32_t count)
+{
+	uint8_t buf[2 + CMB_SPI_STREAM_MAX];
+	uint32_t len;
+
+	spi_ad_desc->chip_select = spiSettings->chipSelectIndex - 1;
+
+	while (count) {
+		len = (count < CMB_SPI_STREAM_MAX) ? count : CMB_SPI_STREAM_MAX;
+		buf[0] = (uint8_t) ((addr >> 8) & 0x7f);
+		buf[1] = (uint8_t) (addr & 0xff);
+		memcpy(&buf[2], data, len);
+
+		if (spi_write_and_read(spi_ad_desc, buf, len + 2) != 0)
+			return(COMMONERR_FAILED);
+
+		addr += len;
+		data += len;
+		count -= len;
+	}
+
+	return(COMMONERR_OK);
+}
+
+/* read count consecutive registers, one instruction word per transaction */
+commonErr_t CMB_SPIReadStream(spiSettings_t *spiSettings, uint16_t addr,
+			      uint8_t *readdata, uint32_t count)
+{
+	uint8_t buf[2 + CMB_SPI_STREAM_MAX];
+	uint32_t len;
+
+	spi_ad_desc->chip_select = spiSettings->chipSelectIndex - 1;
+
+	while (count) {
+		len = (count < CMB_SPI_STREAM_MAX) ? count : CMB_SPI_STREAM_MAX;
+		buf[0] = (uint8_t) ((addr >> 8) | 0x80);
+		buf[1] = (uint8_t) (addr & 0xff);
+		memset(&buf[2], 0, len);
+
+		if (spi_write_and_read(spi_ad_desc, buf, len + 2) != 0)
+			return(COMMONERR_FAILED);
+		memcpy(readdata, &buf[2], len);
+
+		addr += len;
+		readdata += len;
+		count -= len;
+	}
+
+	return(COMMONERR_OK);
+}
+
 commonErr_t CMB_SPIWriteField(spiSettings_t *spiSettings, uint16_t addr,
 			      uint8_t field_val, uint8_t mask, uint8_t start_bit)
 {
@@ -65,12 +65,15 @@ typedef struct {
 	uint8_t MSBFirst;				///< 1 = MSBFirst, 0 = LSBFirst
 	uint8_t CPHA;					///< clock phase, sets which clock edge the data updates (valid 0 or 1)
 	uint8_t CPOL;					///< clock polarity 0 = clock starts low, 1 = clock starts high
-	uint8_t enSpiStreaming;			///< Not implemented. SW feature to improve SPI throughput.
-	uint8_t autoIncAddrUp;			///< Not implemented. For SPI Streaming, set address increment direction. 1= next addr = addr+1, 0:addr = addr-1
+	uint8_t enSpiStreaming;			///< 1 = SPI streaming for burst ARM memory and mailbox reads, needs autoIncAddrUp = 1
+	uint8_t autoIncAddrUp;			///< For SPI Streaming, set address increment direction. 1= next addr = addr+1, 0:addr = addr-1
 	uint8_t fourWireMode;			///< 1: Use 4-wire SPI, 0: 3-wire SPI (SDIO pin is bidirectional). NOTE: ADI's FPGA platform always uses 4-wire mode.
 	uint32_t spiClkFreq_Hz;			///< SPI Clk frequency in Hz (default 25000000), platform will use next lowest frequency that it's baud rate generator can create */
 } spiSettings_t;
 
+/* Maximum data bytes in one SPI streaming transaction */
+#define CMB_SPI_STREAM_MAX	16
+
 /* global variable so application layer can set the log level */
 extern ADI_LOGLEVEL CMB_LOGLEVEL;
 
@@ -94,6 +97,12 @@ commonErr_t CMB_SPIWriteBytes(spiSettings_t *spiSettings, uint16_t *addr,
 			      uint8_t *data, uint32_t count);
 commonErr_t CMB_SPIReadByte (spiSettings_t *spiSettings, uint16_t addr,
 			     uint8_t *readdata); /* single SPI byte read function */
+commonErr_t CMB_SPIWriteStream(spiSettings_t *spiSettings, uint16_t addr,
+			       uint8_t *data,
+			       uint32_t count); /* SPI streaming write of consecutive registers */
+commonErr_t CMB_SPIReadStream(spiSettings_t *spiSettings, uint16_t addr,
+			      uint8_t *readdata,
+			      uint32_t count); /* SPI streaming read of consecutive registers */
 commonErr_t CMB_SPIWriteField(spiSettings_t *spiSettings, uint16_t addr,
 			      uint8_t  field_val, uint8_t mask,
 			      uint8_t start_bit); /* write a field in a single register */
@@ -15589,6 +15589,10 @@ mykonosErr_t MYKONOS_readArmMem(mykonosDevice_t *device, uint32_t address, uint8
 {
     uint8_t dataMem;
     uint32_t i;
+    uint32_t offset = 0;
+    uint32_t len = 0;
+    uint8_t armAddr[2] = {0};
+    uint8_t spiStreaming = 0;
 
 #if (MYKONOS_VERBOSE == 1)
     CMB_writeToLog(ADIHAL_LOG_MESSAGE, device->spiSettings->chipSelectIndex, MYKONOS_ERR_OK, "MYKONOS_readArmMem()\n");
@@ -15631,16 +15635,47 @@ mykonosErr_t MYKONOS_readArmMem(mykonosDevice_t *device, uint32_t address, uint8
         CMB_SPIWriteField(device->spiSettings, MYKONOS_ADDR_ARM_CTL_1, 0x00, 0x04, 2);
     }
 
+    /* burst transfers need SPI streaming with ascending register addresses */
+    if ((device->spiSettings->enSpiStreaming > 0) && (device->spiSettings->autoIncAddrUp > 0))
+    {
+        spiStreaming = 1;
+    }
+
     /* setting up for ARM read */
     CMB_SPIWriteField(device->spiSettings, MYKONOS_ADDR_ARM_CTL_1, 0x01, 0x20, 5);
-    CMB_SPIWriteByte(device->spiSettings, MYKONOS_ADDR_ARM_ADDR_BYTE_0, (uint8_t)((address) >> 2)); /* write address[9:2] */
-    CMB_SPIWriteByte(device->spiSettings, MYKONOS_ADDR_ARM_ADDR_BYTE_1, (uint8_t)(address >> 10) | (uint8_t)(dataMem << 7)); /* write address[15:10] */
+    armAddr[0] = (uint8_t)((address) >> 2); /* address[9:2] */
+    armAddr[1] = (uint8_t)(address >> 10) | (uint8_t)(dataMem << 7); /* address[15:10] */
+
+    if (spiStreaming)
+    {
+        CMB_SPIWriteStream(device->spiSettings, MYKONOS_ADDR_ARM_ADDR_BYTE_0, armAddr, 2);
+    }
+    else
+    {
+        CMB_SPIWriteByte(device->spiSettings, MYKONOS_ADDR_ARM_ADDR_BYTE_0, armAddr[0]);
+        CMB_SPIWriteByte(device->spiSettings, MYKONOS_ADDR_ARM_ADDR_BYTE_1, armAddr[1]);
+    }
 
     /* start read-back at correct byte offset */
     /* read data is located at SPI address 0xD04=data[7:0], 0xD05=data[15:8], 0xD06=data[23:16], 0xD07=data[31:24]. */
     /* with address auto increment set, after xD07 is read, the address will automatically increment */
     /* without address auto increment set, 0x4 must be added to the address for correct indexing */
-    if (autoIncrement)
+    if (autoIncrement && spiStreaming)
+    {
+        /* one SPI burst per ARM word, the ARM address advances after xD07 is read */
+        for (i = 0; i < bytesToRead; i += len)
+        {
+            offset = (address + i) & 0x3;
+            len = 4 - offset;
+            if (len > (bytesToRead - i))
+            {
+                len = bytesToRead - i;
+            }
+
+            CMB_SPIReadStream(device->spiSettings, (MYKONOS_ADDR_ARM_DATA_BYTE_0 | offset), &returnData[i], len);
+        }
+    }
+    else if (autoIncrement)
     {
         for (i = 0; i < bytesToRead; i++)
         {
@@ -16023,9 +16058,16 @@ mykonosErr_t MYKONOS_readArmCmdStatus(mykonosDevice_t *device, uint16_t *errorWo
     *statusWord = 0;
 
     /* read in the entire 64-bit status register into a byte array for parsing */
-    for (i = 0; i < 8; i++)
+    if ((device->spiSettings->enSpiStreaming > 0) && (device->spiSettings->autoIncAddrUp > 0))
+    {
+        CMB_SPIReadStream(device->spiSettings, MYKONOS_ADDR_ARM_CMD_STATUS_0, bytes, 8);
+    }
+    else
     {
-        CMB_SPIReadByte(device->spiSettings, MYKONOS_ADDR_ARM_CMD_STATUS_0 + i, &bytes[i]);
+        for (i = 0; i < 8; i++)
+        {
+            CMB_SPIReadByte(device->spiSettings, MYKONOS_ADDR_ARM_CMD_STATUS_0 + i, &bytes[i]);
+        }
     }
 
     /* parse the byte array for pending bits and error types and generate statusWord and errorWord bits */
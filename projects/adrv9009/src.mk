@@ -19,6 +19,7 @@ SRCS := $(PROJECT)/src/app/headless.c					\
 	$(PROJECT)/src/app/app_jesd.c						\
 	$(PROJECT)/src/app/app_transceiver.c				\
 	$(PROJECT)/src/app/app_talise.c						\
+	$(PROJECT)/src/app/app_boot.c						\
 	$(DRIVERS)/frequency/ad9528/ad9528.c				\
 	$(PROJECT)/src/devices/adi_hal/no_os_hal.c			\
 	$(DRIVERS)/rf-transceiver/talise/api/talise_agc.c			\
@@ -54,11 +55,23 @@ SRCS +=	$(PLATFORM_DRIVERS)/axi_io.c					\
 	$(PLATFORM_DRIVERS)/spi.c					\
 	$(PLATFORM_DRIVERS)/gpio.c					\
 	$(PLATFORM_DRIVERS)/delay.c
+ifeq (y,$(strip $(JESD_MONITOR)))
+SRCS += $(DRIVERS)/axi_core/jesd204/axi_jesd204_rx_monitor.c		\
+	$(NO-OS)/util/scheduler.c
+endif
+ifeq (y,$(strip $(EYESCAN)))
+SRCS += $(DRIVERS)/axi_core/jesd204/axi_adxcvr_eyescan.c
+endif
+ifneq (,$(filter y,$(strip $(BOOT_TIMING)) $(strip $(JESD_MONITOR))))
+SRCS += $(NO-OS)/util/timestamp.c					\
+	$(PLATFORM_DRIVERS)/timer.c
+endif
 INCS :=	$(PROJECT)/src/app/app_config.h					\
 	$(PROJECT)/src/app/app_clocking.h						\
 	$(PROJECT)/src/app/app_jesd.h						\
 	$(PROJECT)/src/app/app_transceiver.h				\
 	$(PROJECT)/src/app/app_talise.h						\
+	$(PROJECT)/src/app/app_boot.h						\
 	$(DRIVERS)/frequency/ad9528/ad9528.h				\
 	$(PROJECT)/src/devices/adi_hal/adi_hal.h			\
 	$(PROJECT)/src/devices/adi_hal/common.h				\
@@ -113,4 +126,16 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/gpio.h						\
 	$(INCLUDE)/error.h						\
 	$(INCLUDE)/delay.h						\
-	$(INCLUDE)/util.h
\ No newline at end of file
+	$(INCLUDE)/util.h
+ifeq (y,$(strip $(JESD_MONITOR)))
+INCS += $(DRIVERS)/axi_core/jesd204/axi_jesd204_rx_monitor.h		\
+	$(INCLUDE)/scheduler.h
+endif
+ifeq (y,$(strip $(EYESCAN)))
+INCS += $(DRIVERS)/axi_core/jesd204/axi_adxcvr_eyescan.h
+endif
+ifneq (,$(filter y,$(strip $(BOOT_TIMING)) $(strip $(JESD_MONITOR))))
+INCS += $(INCLUDE)/timestamp.h						\
+	$(INCLUDE)/timer.h						\
+	$(PLATFORM_DRIVERS)/timer_extra.h
+endif
\ No newline at end of file
@@ -0,0 +1,125 @@
+/***************************************************************************//**
+ *   @file   app_boot.c
+ *   @brief  Bring-up timeline routines.
+ *   @author Darius Berghe (darius.berghe@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+// stdlibs
+#include <stdio.h>
+#include <inttypes.h>
+
+// platform drivers
+#include "util.h"
+
+// hal
+#include "parameters.h"
+
+#ifdef HAVE_BOOT_TIMING
+#include "timestamp.h"
+#endif
+
+// header
+#include "app_boot.h"
+
+struct boot_step {
+	const char *name;
+	/* end of the step, relative to boot_timeline_start() */
+	uint64_t end_ns;
+	/* time spent polling for a status within the step */
+	uint32_t waited_us;
+};
+
+static struct boot_step boot_steps[BOOT_TIMELINE_MAX_STEPS];
+static uint32_t boot_nb_steps;
+static uint64_t boot_start_ns;
+
+static uint64_t boot_time_ns(void)
+{
+#ifdef HAVE_BOOT_TIMING
+	return timestamp_ns();
+#else
+	return 0;
+#endif
+}
+
+void boot_timeline_start(void)
+{
+	boot_nb_steps = 0;
+	boot_start_ns = boot_time_ns();
+}
+
+/* Record the end of a bring-up step. Steps past the table size are dropped. */
+void boot_step_done(const char *name, uint32_t waited_us)
+{
+	struct boot_step *step;
+
+	if (boot_nb_steps >= ARRAY_SIZE(boot_steps))
+		return;
+
+	step = &boot_steps[boot_nb_steps++];
+	step->name = name;
+	step->end_ns = boot_time_ns() - boot_start_ns;
+	step->waited_us = waited_us;
+}
+
+void boot_timeline_print(void)
+{
+#ifdef HAVE_BOOT_TIMING
+	uint64_t prev_ns = 0;
+#endif
+	uint32_t waited_us = 0;
+	uint32_t i;
+
+	printf("boot timeline:\n");
+	for (i = 0; i < boot_nb_steps; i++) {
+#ifdef HAVE_BOOT_TIMING
+		printf("\t%-24s %8" PRIu64 " us (at %8" PRIu64 " us), polled %8"
+		       PRIu32 " us\n", boot_steps[i].name,
+		       (boot_steps[i].end_ns - prev_ns) / 1000,
+		       boot_steps[i].end_ns / 1000, boot_steps[i].waited_us);
+		prev_ns = boot_steps[i].end_ns;
+#else
+		printf("\t%-24s polled %8" PRIu32 " us\n", boot_steps[i].name,
+		       boot_steps[i].waited_us);
+#endif
+		waited_us += boot_steps[i].waited_us;
+	}
+#ifdef HAVE_BOOT_TIMING
+	printf("\ttotal %" PRIu64 " us, polled %" PRIu32 " us\n",
+	       prev_ns / 1000, waited_us);
+#else
+	printf("\ttotal polled %" PRIu32 " us\n", waited_us);
+#endif
+}
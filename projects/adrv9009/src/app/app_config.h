@@ -45,4 +45,8 @@
 
 //#define DAC_DMA_EXAMPLE
 
+//#define HAVE_BOOT_TIMING /* Bring-up step durations, needs timestamp.h (BOOT_TIMING=y) */
+//#define IIO_JESD_MONITOR /* RX link monitor IIO device, needs JESD_MONITOR=y */
+//#define EYESCAN_EXAMPLE /* RX lanes eye scan dump, Xilinx only, needs EYESCAN=y */
+
 #endif /* APP_CONFIG_H_ */
@@ -45,6 +45,7 @@
 
 // platform drivers
 #include "error.h"
+#include "delay.h"
 #include "util.h"
 
 // jesd
@@ -62,6 +63,8 @@ static struct axi_jesd204_rx *rx_jesd = NULL;
 static struct axi_jesd204_tx *tx_jesd = NULL;
 static struct axi_jesd204_rx *rx_os_jesd = NULL;
 
+#define JESD_POLL_US	100
+
 adiHalErr_t jesd_init(uint32_t rx_div40_rate_hz,
 		      uint32_t tx_div40_rate_hz,
 		      uint32_t rx_os_div40_rate_hz)
@@ -156,3 +159,33 @@ void jesd_rx_watchdog(void)
 	axi_jesd204_rx_watchdog(rx_os_jesd);
 }
 
+/* Poll until the FPGA side of all the links is in the DATA state. */
+adiHalErr_t jesd_wait_links(uint32_t timeout_us, uint32_t *waited_us)
+{
+	uint32_t rx_status, tx_status, rx_os_status;
+	uint32_t t;
+
+	for (t = 0; ; t += JESD_POLL_US) {
+		axi_jesd204_rx_link_status_get(rx_jesd, &rx_status);
+		axi_jesd204_tx_link_status_get(tx_jesd, &tx_status);
+		axi_jesd204_rx_link_status_get(rx_os_jesd, &rx_os_status);
+		if (rx_status == AXI_JESD204_RX_LINK_STATUS_DATA &&
+		    tx_status == AXI_JESD204_TX_LINK_STATUS_DATA &&
+		    rx_os_status == AXI_JESD204_RX_LINK_STATUS_DATA)
+			break;
+		if (t >= timeout_us) {
+			*waited_us = t;
+			return ADIHAL_WAIT_TIMEOUT;
+		}
+		udelay(JESD_POLL_US);
+	}
+	*waited_us = t;
+
+	return ADIHAL_OK;
+}
+
+/* RX link, for the link monitor. */
+struct axi_jesd204_rx *jesd_rx_get(void)
+{
+	return rx_jesd;
+}
@@ -55,6 +55,7 @@
 #include "talise_cals.h"
 #include "talise_config.h"
 #include "talise_error.h"
+#include "talise_reg_addr_macros.h"
 #include "talise_arm_binary.h"
 #include "talise_stream_binary.h"
 
@@ -64,6 +65,14 @@
 
 // header
 #include "app_talise.h"
+#include "app_boot.h"
+
+#define TALISE_POLL_US			100
+#define TALISE_CALS_POLL_US		1000
+#define TALISE_RESET_TIMEOUT_US		100000
+#define TALISE_PLL_LOCK_TIMEOUT_US	200000
+#define TALISE_INIT_CALS_TIMEOUT_US	20000000
+#define TALISE_LINK_TIMEOUT_US		200000
 
 
 bool adrv9009_check_sysref_rate(uint32_t lmfc, uint32_t sysref)
@@ -77,25 +86,117 @@ bool adrv9009_check_sysref_rate(uint32_t lmfc, uint32_t sysref)
 	return mod <= div || mod >= sysref - div;
 }
 
-adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
+/* Poll the device instead of waiting a fixed time, the timeouts are the fixed
+ * delays that used to be there. */
+static uint32_t talise_wait_ready(taliseDevice_t * const pd,
+				  taliseInit_t * const pi,
+				  uint32_t timeout_us, uint32_t *waited_us)
+{
+	uint32_t talAction;
+	uint32_t t;
+
+	/* The SPI port comes out of reset in its default mode: apply the
+	 * configured SPI settings before each try, TALISE_setSpiSettings()
+	 * then checks the vendor ID and the scratch pad. */
+	for (t = 0; ; t += TALISE_POLL_US) {
+		talAction = TALISE_setSpiSettings(pd, &pi->spiSettings);
+		if (talAction == TALACT_NO_ACTION ||
+		    talAction == TALACT_ERR_CHECK_PARAM || t >= timeout_us)
+			break;
+		udelay(TALISE_POLL_US);
+	}
+	*waited_us = t;
+
+	return talAction;
+}
+
+static uint32_t talise_wait_pll_lock(taliseDevice_t * const pd, uint8_t mask,
+				     uint32_t timeout_us, uint8_t *pllLockStatus,
+				     uint32_t *waited_us)
+{
+	uint32_t talAction;
+	uint32_t t;
+
+	for (t = 0; ; t += TALISE_POLL_US) {
+		talAction = TALISE_getPllsLockStatus(pd, pllLockStatus);
+		if (talAction != TALACT_NO_ACTION ||
+		    (*pllLockStatus & mask) == mask || t >= timeout_us)
+			break;
+		udelay(TALISE_POLL_US);
+	}
+	*waited_us = t;
+
+	return talAction;
+}
+
+static uint32_t talise_wait_init_cals(taliseDevice_t * const pd,
+				      uint32_t timeout_us, uint8_t *errorFlag,
+				      uint32_t *waited_us)
+{
+	uint32_t talAction;
+	uint8_t running;
+	uint32_t t;
+
+	for (t = 0; ; t += TALISE_CALS_POLL_US) {
+		talAction = TALISE_checkInitCalComplete(pd, &running, NULL);
+		if (talAction != TALACT_NO_ACTION || !running || t >= timeout_us)
+			break;
+		udelay(TALISE_CALS_POLL_US);
+	}
+	*waited_us = t;
+	if (talAction != TALACT_NO_ACTION)
+		return talAction;
+
+	/* Returns at once, with the ARM error flag and recovery action */
+	return TALISE_waitInitCals(pd, 0, errorFlag);
+}
+
+static uint32_t talise_wait_links(taliseDevice_t * const pd,
+				  uint32_t timeout_us, uint8_t *framerStatus,
+				  uint16_t *deframerStatus, uint32_t *waited_us)
+{
+	uint32_t talAction;
+	uint32_t t;
+
+	for (t = 0; ; t += TALISE_POLL_US) {
+		talAction = TALISE_readFramerStatus(pd, TAL_FRAMER_A, framerStatus);
+		if (talAction != TALACT_NO_ACTION) {
+			printf("error: TALISE_readFramerStatus() failed\n");
+			break;
+		}
+		talAction = TALISE_readDeframerStatus(pd, TAL_DEFRAMER_A,
+						      deframerStatus);
+		if (talAction != TALACT_NO_ACTION) {
+			printf("error: TALISE_readDeframerStatus() failed\n");
+			break;
+		}
+		if (((*framerStatus & 0x07) == 0x05 &&
+		     (*deframerStatus & 0xF7) == 0x86) || t >= timeout_us)
+			break;
+		udelay(TALISE_POLL_US);
+	}
+	*waited_us = t;
+
+	return talAction;
+}
+
+/* Bring the device up to the point where the init calibrations run. The
+ * calibrations take most of the bring-up time, so the FPGA side can be set
+ * up meanwhile, before talise_setup_finish() is called. */
+adiHalErr_t talise_setup_start(taliseDevice_t * const pd,
+			       taliseInit_t * const pi)
 {
 	uint32_t talAction = TALACT_NO_ACTION;
-	uint8_t errorFlag = 0;
 	uint8_t mcsStatus = 0;
 	uint8_t pllLockStatus = 0;
-	uint16_t deframerStatus = 0;
-	uint8_t framerStatus = 0;
 	uint32_t count = sizeof(armBinary);
+	uint32_t waited_us;
 	taliseArmVersionInfo_t talArmVersionInfo;
 	uint32_t initCalMask =  TAL_TX_BB_FILTER | TAL_ADC_TUNER | TAL_TIA_3DB_CORNER
 				| TAL_DC_OFFSET | TAL_TX_ATTENUATION_DELAY | TAL_RX_GAIN_DELAY | TAL_FLASH_CAL |
 				TAL_PATH_DELAY | TAL_TX_LO_LEAKAGE_INTERNAL | TAL_TX_QEC_INIT |
 				TAL_LOOPBACK_RX_LO_DELAY | TAL_LOOPBACK_RX_RX_QEC_INIT |
 				TAL_RX_LO_DELAY | TAL_RX_QEC_INIT;
-	uint32_t trackingCalMask =  TAL_TRACK_RX1_QEC |
-				    TAL_TRACK_RX2_QEC |
-				    TAL_TRACK_TX1_QEC |
-				    TAL_TRACK_TX2_QEC;
 
 	uint32_t api_vers[4];
 	uint8_t rev;
@@ -120,7 +221,13 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 		goto error_11;
 	}
 
-	mdelay(100);
+	talAction = talise_wait_ready(pd, pi, TALISE_RESET_TIMEOUT_US,
+				      &waited_us);
+	if (talAction != TALACT_NO_ACTION) {
+		printf("error: Talise not responding after reset\n");
+		goto error_11;
+	}
+	boot_step_done("talise reset", waited_us);
 
 	/* TALISE_initialize() loads the Talise device data structure
 	 * settings for the Rx/Tx/ORx profiles, FIR filters, digital
@@ -138,7 +245,8 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 	/*******************************/
 	/***** CLKPLL Status Check *****/
 	/*******************************/
-	talAction = TALISE_getPllsLockStatus(pd, &pllLockStatus);
+	talAction = talise_wait_pll_lock(pd, 0x01, TALISE_PLL_LOCK_TIMEOUT_US,
+					 &pllLockStatus, &waited_us);
 	if (talAction != TALACT_NO_ACTION) {
 		/*** < User: decide what to do based on Talise recovery action returned > ***/
 		printf("error: TALISE_getPllsLockStatus() failed\n");
@@ -151,6 +259,7 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 		printf("error: CLKPLL not locked\n");
 		goto error_11;
 	}
+	boot_step_done("talise initialize", waited_us);
 
 	/*******************************************************/
 	/**** Perform MultiChip Sync (MCS) on Talise Device ***/
@@ -173,51 +282,46 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 		/*< user code - MCS failed - ensure MCS before proceeding*/
 		printf("warning: TALISE_enableMultichipSync() failed\n");
 	}
+	boot_step_done("talise mcs", 0);
 
 	/*******************************************************/
 	/**** Prepare Talise Arm binary and Load Arm and	****/
 	/**** Stream processor Binaryes 					****/
 	/*******************************************************/
-	if (pllLockStatus & 0x01) {
-		talAction = TALISE_initArm(pd, pi);
-		if (talAction != TALACT_NO_ACTION) {
-			/*** < User: decide what to do based on Talise recovery action returned > ***/
-			printf("error: TALISE_initArm() failed\n");
-			goto error_11;
-		}
-
-		/*< user code- load Talise stream binary into streamBinary[4096] >*/
-		/*< user code- load ARM binary byte array into armBinary[114688] >*/
+	talAction = TALISE_initArm(pd, pi);
+	if (talAction != TALACT_NO_ACTION) {
+		/*** < User: decide what to do based on Talise recovery action returned > ***/
+		printf("error: TALISE_initArm() failed\n");
+		goto error_11;
+	}
 
-		talAction = TALISE_loadStreamFromBinary(pd, &streamBinary[0]);
-		if (talAction != TALACT_NO_ACTION) {
-			/*** < User: decide what to do based on Talise recovery action returned > ***/
-			printf("error: TALISE_loadStreamFromBinary() failed\n");
-			goto error_11;
-		}
+	/*< user code- load Talise stream binary into streamBinary[4096] >*/
+	/*< user code- load ARM binary byte array into armBinary[114688] >*/
 
-		talAction = TALISE_loadArmFromBinary(pd, &armBinary[0], count);
-		if (talAction != TALACT_NO_ACTION) {
-			/*** < User: decide what to do based on Talise recovery action returned > ***/
-			printf("error: TALISE_loadArmFromBinary() failed\n");
-			goto error_11;
-		}
+	talAction = TALISE_loadStreamFromBinary(pd, &streamBinary[0]);
+	if (talAction != TALACT_NO_ACTION) {
+		/*** < User: decide what to do based on Talise recovery action returned > ***/
+		printf("error: TALISE_loadStreamFromBinary() failed\n");
+		goto error_11;
+	}
 
-		/* TALISE_verifyArmChecksum() will timeout after 200ms
-		 * if ARM checksum is not computed
-		 */
-		talAction = TALISE_verifyArmChecksum(pd);
-		if (talAction != TAL_ERR_OK) {
-			/*< user code- ARM did not load properly - check armBinary & clock/profile settings >*/
-			printf("error: TALISE_verifyArmChecksum() failed\n");
-			goto error_11;
-		}
+	talAction = TALISE_loadArmFromBinary(pd, &armBinary[0], count);
+	if (talAction != TALACT_NO_ACTION) {
+		/*** < User: decide what to do based on Talise recovery action returned > ***/
+		printf("error: TALISE_loadArmFromBinary() failed\n");
+		goto error_11;
+	}
 
-	} else {
-		/*< user code- check settings for proper CLKPLL lock  > ***/
-		printf("error: CLKPLL not locked\n");
+	/* TALISE_verifyArmChecksum() polls the ARM and will timeout after
+	 * 200ms if ARM checksum is not computed
+	 */
+	talAction = TALISE_verifyArmChecksum(pd);
+	if (talAction != TAL_ERR_OK) {
+		/*< user code- ARM did not load properly - check armBinary & clock/profile settings >*/
+		printf("error: TALISE_verifyArmChecksum() failed\n");
 		goto error_11;
 	}
+	boot_step_done("talise arm load", 0);
 
 	TALISE_getDeviceRev(pd, &rev);
 	TALISE_getArmVersion_v2(pd, &talArmVersionInfo);
@@ -239,14 +343,15 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 		goto error_11;
 	}
 
-	/*** < wait 200ms for PLLs to lock - user code here > ***/
-
-	talAction = TALISE_getPllsLockStatus(pd, &pllLockStatus);
+	/* Poll for up to 200ms for PLLs to lock */
+	talAction = talise_wait_pll_lock(pd, 0x07, TALISE_PLL_LOCK_TIMEOUT_US,
+					 &pllLockStatus, &waited_us);
 	if ((pllLockStatus & 0x07) != 0x07) {
 		/*< user code - ensure lock of all PLLs before proceeding>*/
 		printf("error: RFPLL not locked\n");
 		goto error_11;
 	}
+	boot_step_done("talise rf pll", waited_us);
 
 	/****************************************************/
 	/**** Run Talise ARM Initialization Calibrations ***/
@@ -257,8 +362,33 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 		printf("error: TALISE_runInitCals() failed\n");
 		goto error_11;
 	}
+	boot_step_done("talise init cals start", 0);
+
+	return ADIHAL_OK;
+
+error_11:
+	TALISE_closeHw(pd);
+error_0:
+	return FAILURE;
+}
 
-	talAction = TALISE_waitInitCals(pd, 20000, &errorFlag);
+/* Wait for the init calibrations started by talise_setup_start(), then bring
+ * up the JESD204 links and turn the radio on. The FPGA JESD204 links must be
+ * enabled by now. */
+adiHalErr_t talise_setup_finish(taliseDevice_t * const pd)
+{
+	uint32_t talAction = TALACT_NO_ACTION;
+	uint8_t errorFlag = 0;
+	uint16_t deframerStatus = 0;
+	uint8_t framerStatus = 0;
+	uint32_t waited_us;
+	uint32_t trackingCalMask =  TAL_TRACK_RX1_QEC |
+				    TAL_TRACK_RX2_QEC |
+				    TAL_TRACK_TX1_QEC |
+				    TAL_TRACK_TX2_QEC;
+
+	talAction = talise_wait_init_cals(pd, TALISE_INIT_CALS_TIMEOUT_US,
+					  &errorFlag, &waited_us);
 	if (talAction != TALACT_NO_ACTION) {
 		/*** < User: decide what to do based on Talise recovery action returned > ***/
 		printf("error: TALISE_waitInitCals() failed\n");
@@ -273,6 +403,7 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 		/*< user code - Calibrations completed successfully > */
 		printf("talise: Calibrations completed successfully\n");
 	}
+	boot_step_done("talise init cals", waited_us);
 
 	/***************************************************/
 	/**** Enable  Talise JESD204B Framer ***/
@@ -335,40 +466,24 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 
 	ADIHAL_sysrefReq(pd->devHalInfo, SYSREF_CONT_ON);
 
-	mdelay(100);
+	/**********************************************************/
+	/**** Wait for the Talise Framer and Deframer to sync ***/
+	/**********************************************************/
+	talAction = talise_wait_links(pd, TALISE_LINK_TIMEOUT_US, &framerStatus,
+				      &deframerStatus, &waited_us);
 
 	ADIHAL_sysrefReq(pd->devHalInfo, SYSREF_CONT_OFF);
 
-	mdelay(100);
-
-	/*** < Insert User JESD204B Sync Verification Code Here > ***/
-
-	/**************************************/
-	/**** Check Talise Deframer Status ***/
-	/**************************************/
-	talAction = TALISE_readDeframerStatus(pd, TAL_DEFRAMER_A, &deframerStatus);
-	if (talAction != TALACT_NO_ACTION) {
-		/*** < User: decide what to do based on Talise recovery action returned > ***/
-		printf("error: TALISE_readDeframerStatus() failed\n");
+	if (talAction != TALACT_NO_ACTION)
 		goto error_11;
-	}
 
 	if ((deframerStatus & 0xF7) != 0x86)
 		printf("warning: TAL_DEFRAMER_A status 0x%X\n", deframerStatus);
 
-	/************************************/
-	/**** Check Talise Framer Status ***/
-	/************************************/
-	talAction = TALISE_readFramerStatus(pd, TAL_FRAMER_A, &framerStatus);
-	if (talAction != TALACT_NO_ACTION) {
-		/*** < User: decide what to do based on Talise recovery action returned > ***/
-		printf("error: TALISE_readFramerStatus() failed\n");
-		goto error_11;
-	}
-
 	if ((framerStatus & 0x07) != 0x05) {
 		printf("warning: TAL_FRAMER_A status 0x%X\n", framerStatus);
 	}
+	boot_step_done("talise jesd links", waited_us);
 
 	/*** < User: When links have been verified, proceed > ***/
 
@@ -401,6 +516,7 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 		printf("error: TALISE_setRxTxEnable() failed\n");
 		goto error_0;
 	}
+	boot_step_done("talise radio on", 0);
 
 	return ADIHAL_OK;
 
@@ -410,6 +526,17 @@ error_0:
 	return FAILURE;
 }
 
+adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
+{
+	adiHalErr_t err;
+
+	err = talise_setup_start(pd, pi);
+	if (err != ADIHAL_OK)
+		return err;
+
+	return talise_setup_finish(pd);
+}
+
 void talise_shutdown(taliseDevice_t * const pd)
 {
 	uint32_t talAction = TALACT_NO_ACTION;
@@ -45,6 +45,9 @@
 
 adiHalErr_t talise_setup(taliseDevice_t * const talDev,
 			 taliseInit_t * const talInit);
+adiHalErr_t talise_setup_start(taliseDevice_t * const talDev,
+			       taliseInit_t * const talInit);
+adiHalErr_t talise_setup_finish(taliseDevice_t * const talDev);
 
 void talise_shutdown(taliseDevice_t * const pd);
 bool adrv9009_check_sysref_rate(uint32_t lmfc, uint32_t sysref);
@@ -185,3 +185,10 @@ void fpga_xcvr_deinit(void)
 	adxcvr_remove(tx_adxcvr);
 	adxcvr_remove(rx_adxcvr);
 }
+
+#ifndef ALTERA_PLATFORM
+struct adxcvr *fpga_xcvr_rx_get(void)
+{
+	return rx_adxcvr;
+}
+#endif
@@ -47,5 +47,8 @@ adiHalErr_t fpga_xcvr_init(uint32_t rx_lane_rate_khz,
 			   uint32_t rx_os_lane_rate_khz,
 			   uint32_t device_clock);
 void fpga_xcvr_deinit(void);
+#ifndef ALTERA_PLATFORM
+struct adxcvr *fpga_xcvr_rx_get(void);
+#endif
 
 #endif /* __APP_TRANSCEIVER_H */
\ No newline at end of file
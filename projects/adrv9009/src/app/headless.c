@@ -11,6 +11,7 @@
 /****< Insert User Includes Here >***/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "adi_hal.h"
 #include "spi.h"
 #include "spi_extra.h"
@@ -32,19 +33,40 @@
 #include "app_jesd.h"
 #include "app_transceiver.h"
 #include "app_talise.h"
+#include "app_boot.h"
 #include "ad9528.h"
+#if defined(HAVE_BOOT_TIMING) || defined(IIO_JESD_MONITOR)
+#include "timer.h"
+#include "timestamp.h"
+#ifndef ALTERA_PLATFORM
+#include "timer_extra.h"
+#endif
+#endif
+#ifdef EYESCAN_EXAMPLE
+#include "axi_adxcvr_eyescan.h"
+#endif
 
 #ifdef IIO_EXAMPLE
 
 #include "iio_app.h"
 #include "iio_axi_adc_app.h"
 #include "iio_axi_dac_app.h"
+#ifdef IIO_JESD_MONITOR
+#include "iio.h"
+#include "iio_axi_jesd204_rx_monitor.h"
+#include "scheduler.h"
+#endif
 #include "irq.h"
 #include "irq_extra.h"
 #include "uart.h"
 #include "uart_extra.h"
 
 static struct uart_desc *uart_desc;
+#ifdef IIO_JESD_MONITOR
+/* Runs the link monitor task, NULL without a timer */
+static struct scheduler *sched;
+static struct sched_task rx_monitor_task;
+#endif
 
 /**
  * iio_uart_write() - Write data to UART device wrapper.
@@ -59,17 +81,138 @@ static ssize_t iio_uart_write(const char *buf, size_t len)
 
 /**
  * iio_uart_read() - Read data from UART device wrapper.
+ * With IIO_JESD_MONITOR, the scheduler runs while waiting for the data, so
+ * the link keeps being sampled while the IIO server is idle.
  * @buf - Pointer to buffer containing data.
  * @len - Number of bytes to read.
  * @Return: SUCCESS in case of success, FAILURE otherwise.
  */
 static ssize_t iio_uart_read(char *buf, size_t len)
 {
+#ifdef IIO_JESD_MONITOR
+	size_t received = 0;
+
+	while (received < len) {
+		received += uart_read_nonblocking(uart_desc,
+						  (uint8_t *)buf + received,
+						  len - received);
+		if (received < len && sched)
+			scheduler_run_once(sched);
+	}
+
+	return len;
+#else
 	return uart_read(uart_desc, (uint8_t *)buf, len);
+#endif
 }
 
 #endif // IIO_EXAMPLE
 
+#if defined(HAVE_BOOT_TIMING) || defined(IIO_JESD_MONITOR)
+/**
+ * timestamp_setup() - Start the timer used as timestamp.h time base.
+ *
+ * Uses the Cortex-A9 private timer when the design has one. Otherwise no
+ * time base is selected: the boot timings read 0 and the JESD monitor is not
+ * sampled.
+ * @timer - The started timer, NULL if none.
+ * @Return: SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t timestamp_setup(struct timer_desc **timer)
+{
+#if !defined(ALTERA_PLATFORM) && defined(TIMER_DEVICE_ID)
+	struct timer_desc *desc;
+	struct xil_timer_init_param xil_timer_param = {
+		.type = TIMER_PS,
+		.device_id = TIMER_DEVICE_ID
+	};
+	struct timer_init_param timer_param = {
+		.freq_hz = TIMER_FREQ_HZ,
+		.load_value = 0,
+		.extra = &xil_timer_param
+	};
+	int32_t status;
+
+	status = timer_init(&desc, &timer_param);
+	if (status != SUCCESS)
+		return status;
+
+	status = timer_start(desc);
+	if (status != SUCCESS)
+		return status;
+
+	status = timestamp_init(desc);
+	if (status != SUCCESS)
+		return status;
+
+	*timer = desc;
+
+	return SUCCESS;
+#else
+	printf("warning: no timer, no timestamp time base\n");
+
+	return SUCCESS;
+#endif
+}
+#endif
+
+#ifdef EYESCAN_EXAMPLE
+/**
+ * rx_eyescan_dump() - Eye scan the RX lanes and print the exported map.
+ *
+ * The adxcvr_eyescan_export() blob is printed as hex, 32 bytes per
+ * "eyescan:" line, to be captured from the console.
+ * @Return: SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t rx_eyescan_dump(void)
+{
+	struct adxcvr_eyescan_init es_init = {
+		.xcvr = fpga_xcvr_rx_get(),
+		.lane_mask = 0,
+		.data_width = 40,
+		.horz_step = 4,
+		.vert_step = 8,
+		.prescale_min = 0,
+		.prescale_max = 8,
+		.prescale_step = 2,
+	};
+	struct adxcvr_eyescan *es;
+	uint8_t *buf = NULL;
+	int32_t status, len, i;
+
+	status = adxcvr_eyescan_init(&es, &es_init);
+	if (status != SUCCESS)
+		return status;
+
+	status = adxcvr_eyescan_run(es);
+	if (status != SUCCESS)
+		goto out;
+
+	len = adxcvr_eyescan_export(es, NULL, 0);
+	buf = (uint8_t *)malloc(len);
+	if (!buf) {
+		status = FAILURE;
+		goto out;
+	}
+
+	status = adxcvr_eyescan_export(es, buf, len);
+	if (status != len) {
+		status = FAILURE;
+		goto out;
+	}
+
+	for (i = 0; i < len; i++)
+		printf("%s%02x%s", i % 32 ? "" : "eyescan: ", buf[i],
+		       (i % 32 == 31 || i == len - 1) ? "\n" : "");
+	status = SUCCESS;
+out:
+	free(buf);
+	adxcvr_eyescan_remove(es);
+
+	return status;
+}
+#endif
+
 /**********************************************************/
 /**********************************************************/
 /********** Talise Data Structure Initializations ********/
@@ -108,6 +251,7 @@ int main(void)
 
 	uint32_t lmfc_rate = min(rx_lmfc_rate, rx_os_lmfc_rate);
 	lmfc_rate = min(tx_lmfc_rate, lmfc_rate);
+	uint32_t waited_us;
 
 	struct axi_adc_init rx_adc_init = {
 		"rx_adc",
@@ -182,6 +326,14 @@ int main(void)
 
 	printf("Hello\n");
 
+#if defined(HAVE_BOOT_TIMING) || defined(IIO_JESD_MONITOR)
+	struct timer_desc *timer = NULL;
+
+	if (timestamp_setup(&timer) != SUCCESS)
+		printf("error: timestamp_setup() failed\n");
+#endif
+	boot_timeline_start();
+
 	/**********************************************************/
 	/**********************************************************/
 	/************ Talise Initialization Sequence *************/
@@ -193,18 +345,27 @@ int main(void)
 		      rx_os_div40_rate_hz,
 		      talInit.clocks.deviceClock_kHz,
 		      lmfc_rate);
+	boot_step_done("clocking", 0);
+
+	/* Start the Talise init calibrations first, the FPGA side is set up
+	 * while they run. */
+	if (talise_setup_start(&talDev, &talInit) != ADIHAL_OK)
+		return FAILURE;
 
 	/*** < Insert User BBIC JESD204B Initialization Code Here > ***/
 	jesd_init(rx_div40_rate_hz,
 		  tx_div40_rate_hz,
 		  rx_os_div40_rate_hz);
+	boot_step_done("fpga jesd", 0);
 
 	fpga_xcvr_init(rx_lane_rate_khz,
 		       tx_lane_rate_khz,
 		       rx_os_lane_rate_khz,
 		       talInit.clocks.deviceClock_kHz);
+	boot_step_done("fpga xcvr", 0);
 
-	talise_setup(&talDev, &talInit);
+	if (talise_setup_finish(&talDev) != ADIHAL_OK)
+		return FAILURE;
 
 	ADIHAL_sysrefReq(talDev.devHalInfo, SYSREF_CONT_ON);
 
@@ -235,7 +396,17 @@ int main(void)
 			  sizeof(sine_lut_iq) * 2);
 #endif
 
-	mdelay(1000);
+	/* Wait for the FPGA side of the links instead of a fixed delay */
+	if (jesd_wait_links(1000000, &waited_us) != ADIHAL_OK)
+		printf("warning: JESD204 links not in DATA state\n");
+	boot_step_done("fpga jesd links", waited_us);
+
+	boot_timeline_print();
+
+#ifdef EYESCAN_EXAMPLE
+	if (rx_eyescan_dump() != SUCCESS)
+		printf("error: rx_eyescan_dump() failed\n");
+#endif
 
 	/* Initialize the DMAC and transfer 16384 samples from ADC to MEM */
 	axi_dmac_init(&rx_dmac, &rx_dmac_init);
@@ -389,6 +560,60 @@ int main(void)
 	if(status < 0)
 		return status;
 
+#ifdef IIO_JESD_MONITOR
+	struct jesd204_rx_monitor_init rx_monitor_init = {
+		.jesd = jesd_rx_get(),
+		.period_us = 100000,
+		.auto_reinit = false,
+	};
+	struct iio_axi_jesd204_rx_monitor_init_par iio_monitor_init_par;
+	struct iio_axi_jesd204_rx_monitor *iio_monitor;
+	struct jesd204_rx_monitor *rx_monitor;
+
+	status = jesd204_rx_monitor_init(&rx_monitor, &rx_monitor_init);
+	if(status < 0)
+		return status;
+
+	iio_monitor_init_par.monitor = rx_monitor;
+	status = iio_axi_jesd204_rx_monitor_init(&iio_monitor,
+			&iio_monitor_init_par);
+	if(status < 0)
+		return status;
+
+	const char monitor_dev_name[] = "axi-jesd204-rx-monitor";
+	struct iio_interface_init_par iio_monitor_intf_par = {
+		.dev_name = monitor_dev_name,
+		.dev_instance = iio_monitor,
+		.iio_device = iio_axi_jesd204_rx_monitor_create_device(
+			monitor_dev_name, rx_monitor_init.jesd->num_lanes),
+		.get_xml = iio_axi_jesd204_rx_monitor_get_xml,
+		.transfer_dev_to_mem = NULL,
+		.transfer_mem_to_dev = NULL,
+		.read_data = NULL,
+		.write_data = NULL,
+	};
+	status = iio_register(&iio_monitor_intf_par);
+	if(status < 0)
+		return status;
+
+	if (timer) {
+		struct scheduler_init_param sched_param = {
+			.timer = timer,
+		};
+
+		status = scheduler_init(&sched, &sched_param);
+		if(status < 0)
+			return status;
+
+		status = scheduler_task_add(sched, &rx_monitor_task,
+					    jesd204_rx_monitor_task, rx_monitor);
+		if(status < 0)
+			return status;
+	} else {
+		printf("warning: no timer, the JESD monitor is not sampled\n");
+	}
+#endif // IIO_JESD_MONITOR
+
 	return iio_app(iio_app_desc);
 
 #endif // IIO_EXAMPLE
@@ -72,6 +72,9 @@ extern "C" {
 /* Minimum HAL_SPIWRITEARRAY_BUFFERSIZE = 18 */
 #define HAL_SPIWRITEARRAY_BUFFERSIZE 341
 
+/* Maximum data bytes in one SPI streaming transaction */
+#define ADIHAL_SPI_STREAM_MAX 16
+
 /*============================================================================
  * ADI Device Hardware Control Functions
  *===========================================================================*/
@@ -395,6 +398,64 @@ adiHalErr_t ADIHAL_spiReadByte(void *devHalInfo, uint16_t addr,
 adiHalErr_t ADIHAL_spiReadBytes(void *devHalInfo, uint16_t *addr,
 				uint8_t *readdata, uint32_t count);
 
+/**
+ * \brief Performs a SPI streaming write to an ADI Device
+ *
+ * This function shall write count consecutive SPI registers starting at addr
+ * with a single instruction word, in one SPI transaction per
+ * ADIHAL_SPI_STREAM_MAX bytes. The device must have SPI streaming enabled
+ * with ascending register addresses.
+ *
+ * \pre This function may only be used after the required SPI drivers and resources
+ * are opened by the ADIHAL_openHw() function call and not after ADIHAL_closeHW.
+ *
+ * <B>Dependencies</B>
+ * --Application and Platform Specific modules
+ *
+ * \param devHalInfo Pointer to Platform HAL defined structure containing
+ *                   hardware settings describing the device of interest.
+ *
+ * \param addr The 15-bit address of the first SPI register to write.
+ *
+ * \param data An array of count 8-bit data values to write.
+ *
+ * \param count The number of consecutive SPI registers to write.
+ *
+ * \retval ADIHAL_OK if function completed successfully.
+ * \retval ADIHAL_SPI_FAIL if function failed to complete SPI transaction
+ */
+adiHalErr_t ADIHAL_spiWriteStream(void *devHalInfo, uint16_t addr,
+				  uint8_t *data, uint32_t count);
+
+/**
+ * \brief Performs a SPI streaming read from an ADI Device
+ *
+ * This function shall read count consecutive SPI registers starting at addr
+ * with a single instruction word, in one SPI transaction per
+ * ADIHAL_SPI_STREAM_MAX bytes. The device must have SPI streaming enabled
+ * with ascending register addresses.
+ *
+ * \pre This function may only be used after the required SPI drivers and resources
+ * are opened by the ADIHAL_openHw() function call and not after ADIHAL_closeHW.
+ *
+ * <B>Dependencies</B>
+ * --Application and Platform Specific modules
+ *
+ * \param devHalInfo Pointer to Platform HAL defined structure containing
+ *                   hardware settings describing the device of interest.
+ *
+ * \param addr The 15-bit address of the first SPI register to read.
+ *
+ * \param readdata An array receiving the count 8-bit register values.
+ *
+ * \param count The number of consecutive SPI registers to read.
+ *
+ * \retval ADIHAL_OK if function completed successfully.
+ * \retval ADIHAL_SPI_FAIL if function failed to complete SPI transaction
+ */
+adiHalErr_t ADIHAL_spiReadStream(void *devHalInfo, uint16_t addr,
+				 uint8_t *readdata, uint32_t count);
+
 /**
  * \brief Performs a write to the specified field in a SPI register.
  *
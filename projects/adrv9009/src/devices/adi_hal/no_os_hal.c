@@ -41,12 +41,14 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdio.h>
+#include <string.h>
 #include "adi_hal.h"
 #include "parameters.h"
 #include "spi.h"
 #include "gpio.h"
 #include "error.h"
 #include "delay.h"
+#include "util.h"
 
 /******************************************************************************/
 /************************** Functions Implementation **************************/
@@ -210,6 +212,57 @@ adiHalErr_t ADIHAL_spiReadBytes(void *devHalInfo,
 	return ADIHAL_OK;
 }
 
+adiHalErr_t ADIHAL_spiWriteStream(void *devHalInfo,
+				  uint16_t addr, uint8_t *data, uint32_t count)
+{
+	struct adi_hal *devHalData = (struct adi_hal *)devHalInfo;
+	uint8_t buf[2 + ADIHAL_SPI_STREAM_MAX];
+	uint32_t len;
+	int32_t status;
+
+	while (count) {
+		len = min_t(uint32_t, count, ADIHAL_SPI_STREAM_MAX);
+		buf[0] = (addr >> 8) & 0x7F;
+		buf[1] = addr & 0xFF;
+		memcpy(&buf[2], data, len);
+		status = spi_write_and_read(devHalData->spi_adrv_desc, buf, len + 2);
+		if (status != SUCCESS)
+			return ADIHAL_SPI_FAIL;
+
+		addr += len;
+		data += len;
+		count -= len;
+	}
+
+	return ADIHAL_OK;
+}
+
+adiHalErr_t ADIHAL_spiReadStream(void *devHalInfo,
+				 uint16_t addr, uint8_t *readdata, uint32_t count)
+{
+	struct adi_hal *devHalData = (struct adi_hal *)devHalInfo;
+	uint8_t buf[2 + ADIHAL_SPI_STREAM_MAX];
+	uint32_t len;
+	int32_t status;
+
+	while (count) {
+		len = min_t(uint32_t, count, ADIHAL_SPI_STREAM_MAX);
+		buf[0] = 0x80 | ((addr >> 8) & 0x7F);
+		buf[1] = addr & 0xFF;
+		memset(&buf[2], 0, len);
+		status = spi_write_and_read(devHalData->spi_adrv_desc, buf, len + 2);
+		if (status != SUCCESS)
+			return ADIHAL_SPI_FAIL;
+		memcpy(readdata, &buf[2], len);
+
+		addr += len;
+		readdata += len;
+		count -= len;
+	}
+
+	return ADIHAL_OK;
+}
+
 adiHalErr_t ADIHAL_spiWriteField(void *devHalInfo,
 				 uint16_t addr, uint8_t fieldVal, uint8_t mask, uint8_t startBit)
 {
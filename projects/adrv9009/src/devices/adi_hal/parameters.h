@@ -149,6 +149,10 @@
 #define UART_IRQ_ID			XPAR_XUARTPS_1_INTR
 #endif
 #define INTC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
+#ifdef XPAR_PS7_SCUTIMER_0_DEVICE_ID
+#define TIMER_DEVICE_ID			XPAR_PS7_SCUTIMER_0_DEVICE_ID
+#define TIMER_FREQ_HZ			10000000
+#endif
 #endif
 
 #define CLK_CS			0
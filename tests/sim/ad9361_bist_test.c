@@ -0,0 +1,260 @@
+/***************************************************************************//**
+ *   @file   ad9361_bist_test.c
+ *   @brief  AD9361 BIST pattern checker test.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "error.h"
+#include "util.h"
+#include "sim_test.h"
+#include "ad9361_bist.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Samples per stream */
+#define NB_SAMPLES		1024
+/* Streams of a two channel capture */
+#define NB_STREAMS		AD9361_BIST_MAX_STREAMS
+/* Stream that slips by one sample in test_resync() */
+#define SLIP_STREAM		2
+/* First slipped sample */
+#define SLIP_SAMPLE		300
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* Bit flipped in a captured sample */
+struct bit_error {
+	uint32_t	stream;
+	uint32_t	sample;
+	uint32_t	bit;
+};
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+/* Polynomial x^n + x^m + 1 of each sequence as {n, m} */
+static const uint8_t pn_poly[][2] = {
+	[AD9361_BIST_PN7] = {7, 6},
+	[AD9361_BIST_PN9] = {9, 5},
+	[AD9361_BIST_PN15] = {15, 14},
+	[AD9361_BIST_PN23] = {23, 18},
+	[AD9361_BIST_PN31] = {31, 28},
+};
+
+/* Bit errors of test_errors(), past the samples the checker locks on */
+static const struct bit_error bit_errors[] = {
+	{ 1, 100, 7 },
+	{ 3, 500, 0 },
+	{ 3, 501, 6 },
+	{ 0, 1000, 11 },
+	{ 0, 1000, 5 },
+};
+
+static uint16_t buf[NB_SAMPLES * NB_STREAMS];
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Generate the BIST pattern of every stream.
+ *
+ * The PN sequences are generated bit by bit, 12 bits per sample sent MSB
+ * first, from a different seed per stream. The tone is a 32 sample period,
+ * different per stream.
+ * @param config - The test configuration.
+ */
+static void pattern_gen(const struct ad9361_bist_config *config)
+{
+	uint32_t n = pn_poly[config->pn][0];
+	uint32_t m = pn_poly[config->pn][1];
+	uint32_t state[NB_STREAMS];
+	uint32_t i, s, b, bit;
+	uint16_t sample;
+
+	for (s = 0; s < NB_STREAMS; s++)
+		state[s] = (0x5A5A5A5A >> s) & ((1u << n) - 1);
+
+	for (i = 0; i < NB_SAMPLES; i++) {
+		for (s = 0; s < NB_STREAMS; s++) {
+			if (config->pattern == AD9361_BIST_PATTERN_TONE) {
+				buf[i * NB_STREAMS + s] =
+					((i % AD9361_BIST_TONE_PERIOD) * 97 +
+					 s * 13) & 0xFFF;
+				continue;
+			}
+			sample = 0;
+			for (b = 0; b < 12; b++) {
+				bit = ((state[s] >> (n - 1)) ^
+				       (state[s] >> (m - 1))) & 1;
+				state[s] = ((state[s] << 1) | bit) &
+					   ((1u << n) - 1);
+				sample = (sample << 1) | bit;
+			}
+			buf[i * NB_STREAMS + s] = sample;
+		}
+	}
+}
+
+/**
+ * @brief Check a clean capture of every PN sequence and of the tone.
+ */
+static void test_clean(void)
+{
+	struct ad9361_bist_config config = { 0 };
+	struct ad9361_bist_result result;
+	uint32_t pn;
+
+	for (pn = AD9361_BIST_PN7; pn <= AD9361_BIST_PN31; pn++) {
+		config.pn = pn;
+		pattern_gen(&config);
+		SIM_TEST_CHECK(ad9361_bist_check(&config, buf, NB_SAMPLES,
+						 NB_STREAMS, 12, &result) == 0);
+		if (!SIM_TEST_CHECK(result.errors == 0 && result.resyncs == 0))
+			printf("PN%"PRIu32": %"PRIu32" errors\n",
+			       pn_poly[pn][0], result.errors);
+		SIM_TEST_CHECK(result.samples == NB_SAMPLES);
+		SIM_TEST_CHECK(result.nb_streams == NB_STREAMS);
+		SIM_TEST_CHECK(result.nb_lanes == 12);
+	}
+
+	config.pattern = AD9361_BIST_PATTERN_TONE;
+	pattern_gen(&config);
+	SIM_TEST_CHECK(ad9361_bist_check(&config, buf, NB_SAMPLES, NB_STREAMS,
+					 6, &result) == 0);
+	SIM_TEST_CHECK(result.errors == 0 && result.resyncs == 0);
+}
+
+/**
+ * @brief Flip single bits and check that each one is counted once, on its
+ * stream and on the lane that carries it.
+ * @param config - The test configuration.
+ * @param nb_lanes - Number of data lanes.
+ */
+static void test_errors(const struct ad9361_bist_config *config,
+			uint32_t nb_lanes)
+{
+	uint32_t lane_errors[AD9361_BIST_MAX_LANES] = { 0 };
+	uint32_t stream_errors[NB_STREAMS] = { 0 };
+	struct ad9361_bist_result result;
+	const struct bit_error *e;
+	uint32_t i;
+
+	pattern_gen(config);
+	for (i = 0; i < ARRAY_SIZE(bit_errors); i++) {
+		e = &bit_errors[i];
+		buf[e->sample * NB_STREAMS + e->stream] ^= 1 << e->bit;
+		lane_errors[e->bit % nb_lanes]++;
+		stream_errors[e->stream]++;
+	}
+
+	SIM_TEST_CHECK(ad9361_bist_check(config, buf, NB_SAMPLES, NB_STREAMS,
+					 nb_lanes, &result) == 0);
+	SIM_TEST_CHECK(result.errors == ARRAY_SIZE(bit_errors));
+	SIM_TEST_CHECK(result.resyncs == 0);
+	SIM_TEST_CHECK(!memcmp(result.lane_errors, lane_errors,
+			       sizeof(lane_errors)));
+	SIM_TEST_CHECK(!memcmp(result.stream_errors, stream_errors,
+			       sizeof(stream_errors)));
+}
+
+/**
+ * @brief A stream that slips by one sample is out of sync after
+ * max_bad_run mismatching samples, the checker locks on it again and the
+ * other streams are not affected.
+ * @param config - The test configuration.
+ */
+static void test_resync(const struct ad9361_bist_config *config)
+{
+	struct ad9361_bist_result result;
+	uint32_t i, s;
+
+	pattern_gen(config);
+	for (i = NB_SAMPLES - 1; i > SLIP_SAMPLE; i--)
+		buf[i * NB_STREAMS + SLIP_STREAM] =
+			buf[(i - 1) * NB_STREAMS + SLIP_STREAM];
+
+	SIM_TEST_CHECK(ad9361_bist_check(config, buf, NB_SAMPLES, NB_STREAMS,
+					 12, &result) == 0);
+	SIM_TEST_CHECK(result.resyncs == 1);
+	SIM_TEST_CHECK(result.errors == result.stream_errors[SLIP_STREAM]);
+	for (s = 0; s < NB_STREAMS; s++)
+		if (s != SLIP_STREAM)
+			SIM_TEST_CHECK(result.stream_errors[s] == 0);
+}
+
+/**
+ * @brief Run the BIST checker tests.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	struct ad9361_bist_config config = { 0 };
+	struct ad9361_bist_result result;
+
+	SIM_TEST_CHECK(ad9361_bist_check(&config, buf, NB_SAMPLES, 0, 12,
+					 &result) == -EINVAL);
+	SIM_TEST_CHECK(ad9361_bist_check(&config, buf, NB_SAMPLES, NB_STREAMS,
+					 AD9361_BIST_MAX_LANES + 1,
+					 &result) == -EINVAL);
+
+	test_clean();
+
+	config.pn = AD9361_BIST_PN31;
+	test_errors(&config, 6);
+	test_errors(&config, 12);
+	config.pn = AD9361_BIST_PN9;
+	test_resync(&config);
+
+	config.pattern = AD9361_BIST_PATTERN_TONE;
+	test_errors(&config, 6);
+	config.max_bad_run = 4;
+	test_resync(&config);
+
+	return sim_test_result("ad9361_bist_test");
+}
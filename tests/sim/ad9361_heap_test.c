@@ -0,0 +1,115 @@
+/***************************************************************************//**
+ *   @file   ad9361_heap_test.c
+ *   @brief  Checks that the AD9361 register I/O hot paths do not use the heap.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "error.h"
+#include "sim.h"
+#include "sim_test.h"
+#include "ad9361_sim.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Number of passes over the hot paths */
+#define HOT_PATH_ROUNDS		100
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Exercise the register I/O done at run time: single and field
+ * register accesses, gain and LO reads and LO retunes.
+ * @param phy - The device.
+ */
+static void run_hot_paths(struct ad9361_rf_phy *phy)
+{
+	uint64_t lo;
+	int32_t gain, val;
+	uint32_t i;
+
+	for (i = 0; i < HOT_PATH_ROUNDS; i++) {
+		val = ad9361_spi_read(phy->spi, REG_RX_FILTER_GAIN);
+		SIM_TEST_CHECK(val >= 0);
+		SIM_TEST_CHECK(ad9361_spi_write(phy->spi, REG_RX_FILTER_GAIN,
+						val) >= 0);
+		SIM_TEST_CHECK(ad9361_spi_read(phy->spi, REG_PRODUCT_ID) >= 0);
+		SIM_TEST_CHECK(ad9361_get_rx_rf_gain(phy, 0, &gain) == SUCCESS);
+		SIM_TEST_CHECK(ad9361_get_rx_lo_freq(phy, &lo) == SUCCESS);
+		SIM_TEST_CHECK(ad9361_set_rx_lo_freq(phy, (i & 1) ?
+						     2400000000ull :
+						     2450000000ull) == SUCCESS);
+	}
+}
+
+/**
+ * @brief Bring the AD9361 up on the register models, then check that the
+ * hot paths make no heap allocation.
+ *
+ * Linked with drivers/platform/sim/heap.c, which counts the allocations in
+ * sim_stats.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	struct ad9361_rf_phy *phy = NULL;
+	struct ad9361_sim sim;
+
+	if (!SIM_TEST_CHECK(ad9361_sim_init(&sim, &phy) == SUCCESS))
+		return sim_test_result("ad9361_heap_test");
+
+	printf("bring-up: %"PRIu32" allocations\n",
+	       sim_stats_live()->heap_allocs);
+
+	sim_stats_reset();
+	run_hot_paths(phy);
+	printf("hot paths: %"PRIu32" allocations\n",
+	       sim_stats_live()->heap_allocs);
+	SIM_TEST_CHECK(sim_stats_live()->heap_allocs == 0);
+
+	ad9361_sim_remove(&sim);
+
+	return sim_test_result("ad9361_heap_test");
+}
@@ -0,0 +1,159 @@
+/***************************************************************************//**
+ *   @file   ad9361_multi_test.c
+ *   @brief  Two-part AD9361 bring-up test on the simulated platform.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "error.h"
+#include "sim.h"
+#include "sim_test.h"
+#include "ad9361_sim.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* REG_CALIBRATION_CTRL bit of the RF DC offset calibration */
+#define RFDC_CAL_BIT		1
+/* RF DC offset calibration durations of the two parts (ns) */
+#define RFDC_CAL_NS_A		20000000
+#define RFDC_CAL_NS_B		5000000
+/* RF DC offset calibrations run after the bring-up, so the learned
+ * durations converge */
+#define RFDC_CAL_RUNS		16
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Check the RF DC offset calibration duration learned by a part.
+ *
+ * Each calibration moves the learned duration a quarter of the way from its
+ * previous value to the measured one, so RFDC_CAL_RUNS more calibrations are
+ * run first. The measurement is taken halfway between the last two checks,
+ * so it may be up to half a check interval (1/32 of the duration) short.
+ * @param phy - The device.
+ * @param cal_ns - Duration of the calibration in the register model.
+ */
+static void check_learned(struct ad9361_rf_phy *phy, uint64_t cal_ns)
+{
+	uint32_t cal_us = cal_ns / 1000;
+	uint32_t n;
+
+	for (n = 0; n < RFDC_CAL_RUNS; n++)
+		SIM_TEST_CHECK(ad9361_do_calib_run(phy, RFDC_CAL, 0) == 0);
+
+	printf("RF DC cal %"PRIu32" us, learned %"PRIu32" us\n", cal_us,
+	       phy->cal_state.rfdc_cal_us);
+	SIM_TEST_CHECK(phy->cal_state.rfdc_cal_us >= cal_us - cal_us / 32);
+	SIM_TEST_CHECK(phy->cal_state.rfdc_cal_us <= cal_us + cal_us / 4);
+}
+
+/**
+ * @brief Create the register models of two parts with different calibration
+ * durations.
+ * @param sims - Register models.
+ * @param params - Initialization parameters of the parts.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t setup(struct ad9361_sim *sims, AD9361_InitParam **params)
+{
+	int32_t ret;
+
+	ret = ad9361_sim_multi_setup(sims, params, 2);
+	if (ret != SUCCESS)
+		return ret;
+
+	sims[0].dev->cal_time_ns[RFDC_CAL_BIT] = RFDC_CAL_NS_A;
+	sims[1].dev->cal_time_ns[RFDC_CAL_BIT] = RFDC_CAL_NS_B;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Bring two parts with different calibration durations up together
+ * and check that each part accounts only the time that really elapsed, and
+ * that it is faster than bringing them up one after the other.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	struct ad9361_sim sims[2];
+	AD9361_InitParam *params[2];
+	struct ad9361_rf_phy *phys[2];
+	struct ad9361_boot_stats stats;
+	uint64_t multi_ns, seq_ns;
+	uint32_t n;
+
+	if (!SIM_TEST_CHECK(setup(sims, params) == SUCCESS))
+		return sim_test_result("ad9361_multi_test");
+
+	multi_ns = sim_time_ns();
+	if (!SIM_TEST_CHECK(ad9361_multi_init(phys, params, 2, &stats) == 0))
+		return sim_test_result("ad9361_multi_test");
+	multi_ns = sim_time_ns() - multi_ns;
+
+	check_learned(phys[0], RFDC_CAL_NS_A);
+	check_learned(phys[1], RFDC_CAL_NS_B);
+
+	for (n = 0; n < 2; n++)
+		ad9361_sim_remove(&sims[n]);
+
+	/* The same parts, brought up one after the other */
+	if (!SIM_TEST_CHECK(setup(sims, params) == SUCCESS))
+		return sim_test_result("ad9361_multi_test");
+
+	seq_ns = sim_time_ns();
+	for (n = 0; n < 2; n++)
+		SIM_TEST_CHECK(ad9361_init(&phys[n], params[n]) == 0);
+	seq_ns = sim_time_ns() - seq_ns;
+
+	printf("bring-up: together %"PRIu64" us, one after the other %"PRIu64
+	       " us\n", multi_ns / 1000, seq_ns / 1000);
+	SIM_TEST_CHECK(multi_ns < seq_ns);
+
+	for (n = 0; n < 2; n++)
+		ad9361_sim_remove(&sims[n]);
+
+	return sim_test_result("ad9361_multi_test");
+}
@@ -0,0 +1,253 @@
+/***************************************************************************//**
+ *   @file   ad9361_sim.c
+ *   @brief  AD9361 project bring-up on the simulated platform.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include "error.h"
+#include "spi.h"
+#include "gpio.h"
+#include "timer.h"
+#include "timestamp.h"
+#include "parameters.h"
+#include "ad9361_sim.h"
+#include "axi_adc_core.h"
+#include "axi_dac_core.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Interface clock reported by the AXI ADC and DAC cores. */
+#define AD9361_SIM_CORE_CLK_HZ	(245760000 / 4)
+/* Address offset of the HDL cores of each additional part. */
+#define AD9361_SIM_PART_STRIDE	0x20000
+/* Frequency of the timestamp_ns() time base. */
+#define AD9361_SIM_TIMER_HZ	100000000
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+/* Project parameters, from projects/ad9361/src/main.c */
+extern AD9361_InitParam default_init_param;
+extern struct spi_init_param spi_param;
+
+/* Parameters and HDL cores of the additional parts */
+static AD9361_InitParam multi_init_param[AD9361_SIM_MAX_PARTS];
+static struct axi_adc_init multi_adc_init[AD9361_SIM_MAX_PARTS];
+static struct axi_dac_init multi_dac_init[AD9361_SIM_MAX_PARTS];
+
+/* Time base of timestamp_ns(), shared by all the parts */
+static struct timer_desc *ad9361_sim_timer;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Make timestamp_ns() follow the simulated time.
+ *
+ * Without it, the host clock would be used and the driver would measure
+ * almost no time across the modeled delays. Created once, never freed.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_sim_timestamp_init(void)
+{
+	struct timer_init_param param = { .freq_hz = AD9361_SIM_TIMER_HZ };
+	int32_t ret;
+
+	if (ad9361_sim_timer)
+		return SUCCESS;
+
+	ret = timer_init(&ad9361_sim_timer, &param);
+	if (ret != SUCCESS)
+		return ret;
+
+	timer_start(ad9361_sim_timer);
+
+	return timestamp_init(ad9361_sim_timer);
+}
+
+/**
+ * @brief Create the register models of one part and connect its parameters.
+ *
+ * Follows the bring-up of the project main(), with the Xilinx SPI and GPIO
+ * parameters replaced by connections to the register models.
+ * @param sim - Register models, filled by this function.
+ * @param param - The init parameters of the part.
+ * @param dmac - Also create the DMAC models.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_sim_part_init(struct ad9361_sim *sim,
+				    AD9361_InitParam *param, bool dmac)
+{
+	struct gpio_init_param gpio_init;
+	int32_t ret;
+
+	memset(sim, 0, sizeof(*sim));
+
+	ret = ad9361_sim_timestamp_init();
+	if (ret != SUCCESS)
+		return ret;
+
+	ret = sim_ad9361_init(&sim->dev);
+	if (ret != SUCCESS)
+		return ret;
+
+	ret = sim_axi_core_init(&sim->adc, SIM_AXI_ADC, param->rx_adc_init->base,
+				AD9361_SIM_CORE_CLK_HZ);
+	ret |= sim_axi_core_init(&sim->dac, SIM_AXI_DAC, param->tx_dac_init->base,
+				 AD9361_SIM_CORE_CLK_HZ);
+	if (dmac) {
+		ret |= sim_axi_core_init(&sim->rx_dmac, SIM_AXI_DMAC,
+					 CF_AD9361_RX_DMA_BASEADDR, 0);
+		ret |= sim_axi_core_init(&sim->tx_dmac, SIM_AXI_DMAC,
+					 CF_AD9361_TX_DMA_BASEADDR, 0);
+	}
+	if (ret != SUCCESS)
+		return FAILURE;
+
+	sim->spi.xfer = sim_ad9361_xfer;
+	sim->spi.priv = sim->dev;
+	sim->resetb.set = sim_ad9361_resetb_set;
+	sim->resetb.priv = sim->dev;
+
+	param->gpio_resetb.extra = &sim->resetb;
+	ret = gpio_get(&param->gpio_desc_resetb, &param->gpio_resetb);
+	if (ret != SUCCESS)
+		return ret;
+	param->gpio_sync.number = -1;
+	param->gpio_cal_sw1.number = -1;
+	param->gpio_cal_sw2.number = -1;
+
+	memset(&gpio_init, 0, sizeof(gpio_init));
+	gpio_init.number = GPIO_DEVICE_ID;
+	ret = gpio_get(&param->gpio_desc_device_id, &gpio_init);
+	if (ret != SUCCESS)
+		return ret;
+	gpio_direction_output(param->gpio_desc_resetb, 0);
+
+	spi_param.extra = &sim->spi;
+	return spi_init(&param->spi, &spi_param);
+}
+
+/**
+ * @brief Create the register models and run ad9361_init().
+ * @param sim - Register models, filled by this function.
+ * @param phy - The device, created by ad9361_init().
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t ad9361_sim_init(struct ad9361_sim *sim, struct ad9361_rf_phy **phy)
+{
+	int32_t ret;
+
+	default_init_param.gpio_resetb.number = GPIO_RESET_PIN;
+	ret = ad9361_sim_part_init(sim, &default_init_param, true);
+	if (ret != SUCCESS)
+		return ret;
+
+	return ad9361_init(phy, &default_init_param);
+}
+
+/**
+ * @brief Create the register models of several parts, for
+ * ad9361_multi_init().
+ *
+ * The first part uses the project parameters. The other parts are copies
+ * with their own SPI, reset and HDL cores, as on FMCOMMS5. Only the first
+ * part has DMAC models.
+ * @param sims - Register models, one per part, filled by this function.
+ * @param params - The init parameters of each part, filled by this function.
+ * @param nb - Number of parts [1, AD9361_SIM_MAX_PARTS].
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t ad9361_sim_multi_setup(struct ad9361_sim *sims,
+			       AD9361_InitParam **params, uint32_t nb)
+{
+	uint32_t n;
+	int32_t ret;
+
+	if (!nb || nb > AD9361_SIM_MAX_PARTS)
+		return FAILURE;
+
+	for (n = 0; n < nb; n++) {
+		if (!n) {
+			params[n] = &default_init_param;
+			params[n]->gpio_resetb.number = GPIO_RESET_PIN;
+		} else {
+			multi_init_param[n] = default_init_param;
+			params[n] = &multi_init_param[n];
+			params[n]->id_no = n;
+			params[n]->gpio_resetb.number = GPIO_RESET_PIN + n;
+
+			multi_adc_init[n] = *default_init_param.rx_adc_init;
+			multi_adc_init[n].base += n * AD9361_SIM_PART_STRIDE;
+			params[n]->rx_adc_init = &multi_adc_init[n];
+			multi_dac_init[n] = *default_init_param.tx_dac_init;
+			multi_dac_init[n].base += n * AD9361_SIM_PART_STRIDE;
+			params[n]->tx_dac_init = &multi_dac_init[n];
+		}
+
+		ret = ad9361_sim_part_init(&sims[n], params[n], !n);
+		if (ret != SUCCESS)
+			return ret;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the register models.
+ * @param sim - Register models.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t ad9361_sim_remove(struct ad9361_sim *sim)
+{
+	if (sim->tx_dmac)
+		sim_axi_core_remove(sim->tx_dmac);
+	if (sim->rx_dmac)
+		sim_axi_core_remove(sim->rx_dmac);
+	sim_axi_core_remove(sim->dac);
+	sim_axi_core_remove(sim->adc);
+
+	return sim_ad9361_remove(sim->dev);
+}
@@ -0,0 +1,101 @@
+/***************************************************************************//**
+ *   @file   ad9361_sim.h
+ *   @brief  AD9361 project bring-up on the simulated platform.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef AD9361_SIM_H_
+#define AD9361_SIM_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include "ad9361_api.h"
+#include "spi_extra.h"
+#include "gpio_extra.h"
+#include "sim_ad9361.h"
+#include "sim_axi_core.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Maximum number of parts brought up by ad9361_sim_multi_init() */
+#define AD9361_SIM_MAX_PARTS	2
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct ad9361_sim
+ * @brief Register models behind the AD9361 project.
+ */
+struct ad9361_sim {
+	/** AD9361 register model */
+	struct sim_ad9361		*dev;
+	/** AXI ADC core model */
+	struct sim_axi_core		*adc;
+	/** AXI DAC core model */
+	struct sim_axi_core		*dac;
+	/** RX DMAC model */
+	struct sim_axi_core		*rx_dmac;
+	/** TX DMAC model */
+	struct sim_axi_core		*tx_dmac;
+	/** SPI connection to the AD9361 model */
+	struct sim_spi_init_param	spi;
+	/** RESETB connection to the AD9361 model */
+	struct sim_gpio_init_param	resetb;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Create the register models and run ad9361_init() with the project
+ * parameters from main.c. */
+int32_t ad9361_sim_init(struct ad9361_sim *sim, struct ad9361_rf_phy **phy);
+
+/* Create the register models of several parts, for ad9361_multi_init(). */
+int32_t ad9361_sim_multi_setup(struct ad9361_sim *sims,
+			       AD9361_InitParam **params, uint32_t nb);
+
+/* Free the register models. */
+int32_t ad9361_sim_remove(struct ad9361_sim *sim);
+
+#endif // AD9361_SIM_H_
@@ -0,0 +1,196 @@
+/***************************************************************************//**
+ *   @file   ad9361_sim_test.c
+ *   @brief  AD9361 bring-up and API regression test on the simulated platform.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "error.h"
+#include "sim.h"
+#include "sim_test.h"
+#include "ad9361_sim.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* The synthesizer fractional word limits the LO resolution to a few Hz. */
+#define LO_TOLERANCE_HZ		10
+#define LO_MATCH(f, ref)	((f) + LO_TOLERANCE_HZ >= (ref) && \
+				 (f) <= (ref) + LO_TOLERANCE_HZ)
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+static const uint64_t lo_freqs[] = {
+	2400000000ull, 2405000000ull, 900000000ull, 5800000000ull,
+	70000000ull, 6000000000ull, 2400000000ull
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Check the RX and TX LO tuning read-back.
+ * @param phy - The device.
+ */
+static void test_lo(struct ad9361_rf_phy *phy)
+{
+	uint64_t rx, tx;
+	uint32_t i;
+
+	for (i = 0; i < sizeof(lo_freqs) / sizeof(lo_freqs[0]); i++) {
+		SIM_TEST_CHECK(ad9361_set_rx_lo_freq(phy, lo_freqs[i]) == SUCCESS);
+		SIM_TEST_CHECK(ad9361_set_tx_lo_freq(phy, lo_freqs[i]) == SUCCESS);
+		ad9361_get_rx_lo_freq(phy, &rx);
+		ad9361_get_tx_lo_freq(phy, &tx);
+		SIM_TEST_CHECK(LO_MATCH(rx, lo_freqs[i]));
+		SIM_TEST_CHECK(LO_MATCH(tx, lo_freqs[i]));
+	}
+}
+
+/**
+ * @brief Check the sampling rate and RF bandwidth read-back.
+ * @param phy - The device.
+ */
+static void test_rates(struct ad9361_rf_phy *phy)
+{
+	uint32_t rate, bw;
+
+	SIM_TEST_CHECK(ad9361_set_rx_sampling_freq(phy, 30720000) == SUCCESS);
+	ad9361_get_rx_sampling_freq(phy, &rate);
+	SIM_TEST_CHECK(rate == 30720000);
+
+	SIM_TEST_CHECK(ad9361_set_rx_rf_bandwidth(phy, 18000000) == SUCCESS);
+	ad9361_get_rx_rf_bandwidth(phy, &bw);
+	SIM_TEST_CHECK(bw == 18000000);
+}
+
+/**
+ * @brief Check the manual gain and attenuation read-back.
+ * @param phy - The device.
+ */
+static void test_gain(struct ad9361_rf_phy *phy)
+{
+	uint32_t atten;
+	int32_t gain;
+
+	SIM_TEST_CHECK(ad9361_set_rx_gain_control_mode(phy, 0,
+			RF_GAIN_MGC) == SUCCESS);
+	SIM_TEST_CHECK(ad9361_set_rx_rf_gain(phy, 0, 30) == SUCCESS);
+	ad9361_get_rx_rf_gain(phy, 0, &gain);
+	SIM_TEST_CHECK(gain == 30);
+
+	SIM_TEST_CHECK(ad9361_set_tx_attenuation(phy, 0, 10000) == SUCCESS);
+	ad9361_get_tx_attenuation(phy, 0, &atten);
+	SIM_TEST_CHECK(atten == 10000);
+}
+
+/**
+ * @brief Check the state machine mode read-back.
+ * @param phy - The device.
+ */
+static void test_ensm(struct ad9361_rf_phy *phy)
+{
+	uint32_t mode;
+
+	SIM_TEST_CHECK(ad9361_set_en_state_machine_mode(phy,
+			ENSM_MODE_ALERT) == SUCCESS);
+	ad9361_get_en_state_machine_mode(phy, &mode);
+	SIM_TEST_CHECK(mode == ENSM_MODE_ALERT);
+
+	SIM_TEST_CHECK(ad9361_set_en_state_machine_mode(phy,
+			ENSM_MODE_FDD) == SUCCESS);
+	ad9361_get_en_state_machine_mode(phy, &mode);
+	SIM_TEST_CHECK(mode == ENSM_MODE_FDD);
+}
+
+/**
+ * @brief Check that a TX LO change during a calibration defers the TX
+ * quadrature calibration until that calibration completes.
+ * @param phy - The device.
+ */
+static void test_tx_quad_deferred(struct ad9361_rf_phy *phy)
+{
+	uint64_t last;
+
+	SIM_TEST_CHECK(ad9361_set_tx_lo_freq(phy, 2400000000ull) == SUCCESS);
+	last = phy->last_tx_quad_cal_freq;
+	SIM_TEST_CHECK(LO_MATCH(last, 2400000000ull));
+
+	SIM_TEST_CHECK(ad9361_calib_start(phy, RFDC_CAL, 0) == 0);
+	SIM_TEST_CHECK(ad9361_set_tx_lo_freq(phy, 3500000000ull) == SUCCESS);
+	SIM_TEST_CHECK(phy->tx_quad_cal_pending);
+	SIM_TEST_CHECK(phy->last_tx_quad_cal_freq == last);
+
+	SIM_TEST_CHECK(ad9361_calib_complete(phy) == 0);
+	SIM_TEST_CHECK(!phy->tx_quad_cal_pending);
+	SIM_TEST_CHECK(LO_MATCH(phy->last_tx_quad_cal_freq, 3500000000ull));
+}
+
+/**
+ * @brief Run the AD9361 project bring-up on the register models and check
+ * the main API calls.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	struct ad9361_rf_phy *phy = NULL;
+	struct ad9361_sim sim;
+
+	if (!SIM_TEST_CHECK(ad9361_sim_init(&sim, &phy) == SUCCESS))
+		return sim_test_result("ad9361_sim_test");
+
+	printf("bring-up: %"PRIu64" us simulated\n", sim_time_ns() / 1000);
+	sim_stats_print(sim_stats_live());
+
+	test_lo(phy);
+	test_rates(phy);
+	test_gain(phy);
+	test_ensm(phy);
+	test_tx_quad_deferred(phy);
+
+	ad9361_sim_remove(&sim);
+
+	return sim_test_result("ad9361_sim_test");
+}
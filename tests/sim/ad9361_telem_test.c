@@ -0,0 +1,344 @@
+/***************************************************************************//**
+ *   @file   ad9361_telem_test.c
+ *   @brief  AD9361 telemetry sampler test on the simulated platform.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "error.h"
+#include "delay.h"
+#include "timestamp.h"
+#include "sim.h"
+#include "sim_test.h"
+#include "ad9361_sim.h"
+#include "ad9361_telem.h"
+#include "iio_ad9361_telem.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Sampling period */
+#define TELEM_PERIOD_US		1000
+/* Ring capacity */
+#define TELEM_RECORDS		32
+/* Time between two ad9361_telem_poll() calls */
+#define POLL_US			50
+/* Sampling periods run in test_timing() */
+#define NB_PERIODS		10
+/* Polling gap in test_timing(), 3 periods are missed */
+#define LATE_US			(3 * TELEM_PERIOD_US + TELEM_PERIOD_US / 2)
+/* Records packed in test_pack() */
+#define NB_SCANS		3
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Load the RSSI, gain and fast attack state registers of the model.
+ * @param dev - The register model.
+ * @param i - Seed of the register values.
+ * @param rec - The record a sample should give, filled by this function.
+ */
+static void model_set(struct sim_ad9361 *dev, uint8_t i,
+		      struct ad9361_telem_record *rec)
+{
+	dev->regs[REG_RX1_RSSI_SYMBOL] = 0x40 + i;
+	dev->regs[REG_RX2_RSSI_SYMBOL] = 0x20 + i;
+	dev->regs[REG_SYMBOL_LSB] = RSSI_LSB_MASK1 | RSSI_LSB_MASK2;
+	/* Read back through REG_GAIN_RX1/2, see sim_ad9361_read() */
+	dev->regs[REG_RX1_MANUAL_LMT_FULL_GAIN] = 0x20 + i;
+	dev->regs[REG_RX2_MANUAL_LMT_FULL_GAIN] = 0x30 + i;
+	dev->regs[REG_FAST_ATTACK_STATE] = (i & FAST_ATK_MASK) |
+					   (((i + 1) & FAST_ATK_MASK) << RX2_FAST_ATK_SHIFT);
+
+	rec->rssi[0] = ((0x40 + i) << RSSI_LSB_SHIFT) | 1;
+	rec->rssi[1] = ((0x20 + i) << RSSI_LSB_SHIFT) | 1;
+	rec->gain_index[0] = 0x20 + i;
+	rec->gain_index[1] = 0x30 + i;
+	rec->agc_state[0] = i & FAST_ATK_MASK;
+	rec->agc_state[1] = (i + 1) & FAST_ATK_MASK;
+}
+
+/**
+ * @brief Check a record against the expected register values.
+ * @param rec - The record read from the ring.
+ * @param exp - The expected record, the timestamp is not checked.
+ * @return true if the records match.
+ */
+static bool record_match(const struct ad9361_telem_record *rec,
+			 const struct ad9361_telem_record *exp)
+{
+	return rec->rssi[0] == exp->rssi[0] && rec->rssi[1] == exp->rssi[1] &&
+	       rec->gain_index[0] == exp->gain_index[0] &&
+	       rec->gain_index[1] == exp->gain_index[1] &&
+	       rec->agc_state[0] == exp->agc_state[0] &&
+	       rec->agc_state[1] == exp->agc_state[1];
+}
+
+/**
+ * @brief Poll the sampler for NB_PERIODS sampling periods: one record is
+ * taken per period, on the period grid, with two SPI bursts each. Polling
+ * late skips the elapsed periods and counts them as missed.
+ * @param telem - The sampler.
+ * @param dev - The register model.
+ */
+static void test_timing(struct ad9361_telem *telem, struct sim_ad9361 *dev)
+{
+	struct ad9361_telem_record recs[NB_PERIODS + 1], exp;
+	struct ad9361_telem_stats stats;
+	struct sim_stats *live = sim_stats_live();
+	uint32_t spi, i, n;
+	uint64_t t0, offset;
+
+	model_set(dev, 1, &exp);
+
+	SIM_TEST_CHECK(ad9361_telem_enable(telem, true) == 0);
+	t0 = timestamp_ns();
+	spi = live->spi.transactions;
+	while (timestamp_ns() - t0 < NB_PERIODS * TELEM_PERIOD_US * 1000ull) {
+		SIM_TEST_CHECK(ad9361_telem_poll(telem) >= 0);
+		udelay(POLL_US);
+	}
+
+	ad9361_telem_stats_get(telem, &stats);
+	SIM_TEST_CHECK(stats.samples == NB_PERIODS);
+	SIM_TEST_CHECK(stats.missed == 0);
+	SIM_TEST_CHECK(stats.errors == 0);
+	SIM_TEST_CHECK(live->spi.transactions - spi == 2 * stats.samples);
+	SIM_TEST_CHECK(ad9361_telem_level(telem) == NB_PERIODS);
+
+	/* Sampler polled late */
+	udelay(LATE_US);
+	SIM_TEST_CHECK(ad9361_telem_poll(telem) == 1);
+	ad9361_telem_stats_get(telem, &stats);
+	SIM_TEST_CHECK(stats.missed == 3);
+	SIM_TEST_CHECK(stats.samples == NB_PERIODS + 1);
+
+	n = ad9361_telem_read(telem, recs, NB_PERIODS + 1);
+	SIM_TEST_CHECK(n == NB_PERIODS + 1);
+	for (i = 0; i < n; i++) {
+		SIM_TEST_CHECK(record_match(&recs[i], &exp));
+		if (i == NB_PERIODS)
+			/* Taken late, when polled */
+			offset = recs[i].timestamp - t0 -
+				 (NB_PERIODS * TELEM_PERIOD_US + LATE_US) * 1000ull;
+		else
+			offset = recs[i].timestamp - t0 -
+				 i * TELEM_PERIOD_US * 1000ull;
+		if (!SIM_TEST_CHECK(recs[i].timestamp >= t0 &&
+				    offset < POLL_US * 1000ull))
+			printf("record %"PRIu32" %"PRIu64" ns late\n", i, offset);
+	}
+
+	/* Back on the period grid */
+	t0 += (NB_PERIODS + 4) * TELEM_PERIOD_US * 1000ull;
+	while (!ad9361_telem_level(telem)) {
+		SIM_TEST_CHECK(ad9361_telem_poll(telem) >= 0);
+		udelay(POLL_US);
+	}
+	SIM_TEST_CHECK(ad9361_telem_read(telem, recs, 1) == 1);
+	SIM_TEST_CHECK(recs[0].timestamp >= t0 &&
+		       recs[0].timestamp - t0 < POLL_US * 1000ull);
+	SIM_TEST_CHECK(ad9361_telem_level(telem) == 0);
+}
+
+/**
+ * @brief A full ring drops the sample without touching the SPI bus.
+ * @param telem - The sampler.
+ */
+static void test_overflow(struct ad9361_telem *telem)
+{
+	struct ad9361_telem_record rec;
+	struct ad9361_telem_stats stats;
+	struct sim_stats *live = sim_stats_live();
+	uint32_t spi, i;
+
+	ad9361_telem_stats_reset(telem);
+	for (i = 0; i < TELEM_RECORDS; i++)
+		SIM_TEST_CHECK(ad9361_telem_sample(telem) == 0);
+
+	spi = live->spi.transactions;
+	SIM_TEST_CHECK(ad9361_telem_sample(telem) == -ENOSPC);
+	SIM_TEST_CHECK(live->spi.transactions == spi);
+
+	ad9361_telem_stats_get(telem, &stats);
+	SIM_TEST_CHECK(stats.samples == TELEM_RECORDS);
+	SIM_TEST_CHECK(stats.overflows == 1);
+
+	while (ad9361_telem_read(telem, &rec, 1))
+		;
+}
+
+/**
+ * @brief Stream NB_SCANS records through the IIO device with a channel mask
+ * and check the packed scans. The data is read in two chunks that split a
+ * scan.
+ * @param iio_telem - The IIO telemetry device.
+ * @param dev - The register model.
+ * @param ch_mask - Enabled channels.
+ * @param scan_size - Expected scan size.
+ * @param pack - Pack a record the way the scan is expected to be.
+ */
+static void test_pack(struct iio_ad9361_telem *iio_telem,
+		      struct sim_ad9361 *dev, uint32_t ch_mask,
+		      uint32_t scan_size,
+		      void (*pack)(const struct ad9361_telem_record *,
+				   uint8_t *))
+{
+	struct ad9361_telem_record rec;
+	uint8_t exp[NB_SCANS * 16], buf[NB_SCANS * 16];
+	uint32_t i, size = NB_SCANS * scan_size;
+	ssize_t n;
+
+	memset(exp, 0, sizeof(exp));
+	for (i = 0; i < NB_SCANS; i++) {
+		model_set(dev, i + 2, &rec);
+		rec.timestamp = timestamp_ns();
+		SIM_TEST_CHECK(ad9361_telem_sample(iio_telem->telem) == 0);
+		pack(&rec, &exp[i * scan_size]);
+	}
+
+	memset(buf, 0xA5, sizeof(buf));
+	SIM_TEST_CHECK(iio_ad9361_telem_transfer_dev_to_mem(iio_telem, size,
+			ch_mask) == (ssize_t)size);
+	n = iio_ad9361_telem_read_dev(iio_telem, (char *)buf, 0,
+				      scan_size + 1, ch_mask);
+	SIM_TEST_CHECK(n == (ssize_t)scan_size + 1);
+	n = iio_ad9361_telem_read_dev(iio_telem, (char *)buf + n, n,
+				      size - n, ch_mask);
+	SIM_TEST_CHECK(n == (ssize_t)(size - scan_size - 1));
+	if (!SIM_TEST_CHECK(!memcmp(buf, exp, size)))
+		for (i = 0; i < size; i++)
+			printf("%02X/%02X%c", buf[i], exp[i],
+			       (i + 1) % scan_size ? ' ' : '\n');
+	SIM_TEST_CHECK(ad9361_telem_level(iio_telem->telem) == 0);
+}
+
+/**
+ * @brief rssi0 and gain1: 3 bytes, padded to the 2 bytes of rssi0.
+ * @param rec - The record.
+ * @param scan - The scan, filled by this function.
+ */
+static void pack_rssi0_gain1(const struct ad9361_telem_record *rec,
+			     uint8_t *scan)
+{
+	scan[0] = rec->rssi[0] & 0xFF;
+	scan[1] = rec->rssi[0] >> 8;
+	scan[2] = rec->gain_index[1];
+}
+
+/**
+ * @brief timestamp and agc1: 9 bytes, padded to a multiple of 8.
+ * @param rec - The record.
+ * @param scan - The scan, filled by this function.
+ */
+static void pack_timestamp_agc1(const struct ad9361_telem_record *rec,
+				uint8_t *scan)
+{
+	uint32_t i;
+
+	for (i = 0; i < 8; i++)
+		scan[i] = rec->timestamp >> (8 * i);
+	scan[8] = rec->agc_state[1];
+}
+
+/**
+ * @brief rssi1, gain0 and agc0: 4 bytes, no padding.
+ * @param rec - The record.
+ * @param scan - The scan, filled by this function.
+ */
+static void pack_rssi1_gain0_agc0(const struct ad9361_telem_record *rec,
+				  uint8_t *scan)
+{
+	scan[0] = rec->rssi[1] & 0xFF;
+	scan[1] = rec->rssi[1] >> 8;
+	scan[2] = rec->gain_index[0];
+	scan[3] = rec->agc_state[0];
+}
+
+/**
+ * @brief Bring up the part and run the telemetry sampler tests.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	struct ad9361_telem_init_param telem_param = {
+		.period_us = TELEM_PERIOD_US,
+		.nb_records = TELEM_RECORDS,
+	};
+	struct iio_ad9361_telem_init_par iio_param;
+	struct iio_ad9361_telem *iio_telem;
+	struct ad9361_telem *telem;
+	struct ad9361_rf_phy *phy = NULL;
+	struct ad9361_sim sim;
+
+	if (!SIM_TEST_CHECK(ad9361_sim_init(&sim, &phy) == SUCCESS))
+		return sim_test_result("ad9361_telem_test");
+
+	telem_param.phy = phy;
+	if (!SIM_TEST_CHECK(ad9361_telem_init(&telem, &telem_param) == 0))
+		return sim_test_result("ad9361_telem_test");
+	iio_param.telem = telem;
+	if (!SIM_TEST_CHECK(iio_ad9361_telem_init(&iio_telem, &iio_param) == 0))
+		return sim_test_result("ad9361_telem_test");
+
+	/* Disabled sampler */
+	SIM_TEST_CHECK(ad9361_telem_poll(telem) == 0);
+	SIM_TEST_CHECK(ad9361_telem_level(telem) == 0);
+
+	test_timing(telem, sim.dev);
+	test_overflow(telem);
+
+	test_pack(iio_telem, sim.dev, BIT(1) | BIT(4), 4, pack_rssi0_gain1);
+	test_pack(iio_telem, sim.dev, BIT(0) | BIT(6), 16,
+		  pack_timestamp_agc1);
+	test_pack(iio_telem, sim.dev, BIT(2) | BIT(3) | BIT(5), 4,
+		  pack_rssi1_gain0_agc0);
+
+	iio_ad9361_telem_remove(iio_telem);
+	ad9361_telem_remove(telem);
+	ad9361_sim_remove(&sim);
+
+	return sim_test_result("ad9361_telem_test");
+}
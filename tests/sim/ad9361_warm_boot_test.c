@@ -0,0 +1,279 @@
+/***************************************************************************//**
+ *   @file   ad9361_warm_boot_test.c
+ *   @brief  AD9361 warm boot test on the simulated platform.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "error.h"
+#include "spi.h"
+#include "sim.h"
+#include "sim_test.h"
+#include "ad9361_sim.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* SPI instruction word fields */
+#define SPI_WRITE		(1 << 15)
+#define SPI_ADDR(cmd)		((cmd) & 0x3FF)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* Device state that the snapshot restores */
+struct phy_state {
+	uint32_t	current_rx_bw_Hz;
+	uint32_t	current_tx_bw_Hz;
+	uint32_t	rxbbf_div;
+	uint32_t	rate_governor;
+	uint8_t		cached_rx_rfpll_div;
+	uint8_t		cached_tx_rfpll_div;
+	uint8_t		cached_synth_pd[2];
+	uint64_t	last_tx_quad_cal_freq;
+	uint32_t	last_tx_quad_cal_phase;
+	uint64_t	current_tx_lo_freq;
+	uint64_t	current_rx_lo_freq;
+	uint32_t	tx_fir_int;
+	uint32_t	tx_fir_ntaps;
+	uint32_t	rx_fir_dec;
+	uint32_t	rx_fir_ntaps;
+	uint8_t		agc_mode[2];
+	bool		flags[10];
+	uint32_t	auxdac1_value;
+	uint32_t	auxdac2_value;
+	uint32_t	tx1_atten_cached;
+	uint32_t	tx2_atten_cached;
+	uint32_t	dev_flags;
+	uint32_t	clk_rate[NUM_AD9361_CLKS];
+};
+
+/* Register model state after the cold boot */
+struct model_state {
+	uint8_t		regs[SIM_AD9361_NUM_REGS];
+	uint8_t		gain_table[2][SIM_AD9361_GT_SIZE][3];
+	int16_t		fir_coef[4][SIM_AD9361_FIR_TAPS];
+};
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+/* FIR filters of the project, from projects/ad9361/src/main.c */
+extern AD9361_RXFIRConfig rx_fir_config;
+extern AD9361_TXFIRConfig tx_fir_config;
+
+/* Register read failing in spi_fail_xfer() */
+static uint32_t spi_fail_reg;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Collect the device state restored by the snapshot.
+ * @param phy - The device.
+ * @param st - The state, filled by this function.
+ */
+static void phy_state_get(struct ad9361_rf_phy *phy, struct phy_state *st)
+{
+	uint32_t i;
+
+	memset(st, 0, sizeof(*st));
+	st->current_rx_bw_Hz = phy->current_rx_bw_Hz;
+	st->current_tx_bw_Hz = phy->current_tx_bw_Hz;
+	st->rxbbf_div = phy->rxbbf_div;
+	st->rate_governor = phy->rate_governor;
+	st->cached_rx_rfpll_div = phy->cached_rx_rfpll_div;
+	st->cached_tx_rfpll_div = phy->cached_tx_rfpll_div;
+	st->cached_synth_pd[0] = phy->cached_synth_pd[0];
+	st->cached_synth_pd[1] = phy->cached_synth_pd[1];
+	st->last_tx_quad_cal_freq = phy->last_tx_quad_cal_freq;
+	st->last_tx_quad_cal_phase = phy->last_tx_quad_cal_phase;
+	st->current_tx_lo_freq = phy->current_tx_lo_freq;
+	st->current_rx_lo_freq = phy->current_rx_lo_freq;
+	st->tx_fir_int = phy->tx_fir_int;
+	st->tx_fir_ntaps = phy->tx_fir_ntaps;
+	st->rx_fir_dec = phy->rx_fir_dec;
+	st->rx_fir_ntaps = phy->rx_fir_ntaps;
+	st->agc_mode[0] = phy->agc_mode[0];
+	st->agc_mode[1] = phy->agc_mode[1];
+	st->flags[0] = phy->current_tx_use_tdd_table;
+	st->flags[1] = phy->current_rx_use_tdd_table;
+	st->flags[2] = phy->bypass_rx_fir;
+	st->flags[3] = phy->bypass_tx_fir;
+	st->flags[4] = phy->rx_eq_2tx;
+	st->flags[5] = phy->rfdc_track_en;
+	st->flags[6] = phy->bbdc_track_en;
+	st->flags[7] = phy->quad_track_en;
+	st->flags[8] = phy->txmon_tdd_en;
+	st->flags[9] = phy->bbpll_initialized;
+	st->auxdac1_value = phy->auxdac1_value;
+	st->auxdac2_value = phy->auxdac2_value;
+	st->tx1_atten_cached = phy->tx1_atten_cached;
+	st->tx2_atten_cached = phy->tx2_atten_cached;
+	st->dev_flags = phy->flags;
+	/*
+	 * The cold boot does not cache the internal RF PLL rates, they are
+	 * only used through RX_RFPLL and TX_RFPLL.
+	 */
+	for (i = 0; i < NUM_AD9361_CLKS; i++)
+		if (i != RX_RFPLL_INT && i != TX_RFPLL_INT)
+			st->clk_rate[i] = phy->clks[i]->rate;
+}
+
+/**
+ * @brief SPI transfer handler failing the reads of one register.
+ * @param priv - The register model.
+ * @param data - The transfer buffer.
+ * @param bytes_number - Number of bytes in the transfer.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t spi_fail_xfer(void *priv, uint8_t *data, uint16_t bytes_number)
+{
+	uint16_t cmd = (data[0] << 8) | data[1];
+
+	if (!(cmd & SPI_WRITE) && SPI_ADDR(cmd) == spi_fail_reg)
+		return FAILURE;
+
+	return sim_ad9361_xfer(priv, data, bytes_number);
+}
+
+/**
+ * @brief A failing SPI read while the FIR coefficients are saved fails the
+ * snapshot and leaves the filter gain and the ENSM state as they were.
+ * @param phy - The device.
+ * @param sim - Register models.
+ */
+static void test_snapshot_error(struct ad9361_rf_phy *phy,
+				struct ad9361_sim *sim)
+{
+	struct sim_spi_desc *spi = phy->spi->extra;
+	uint8_t gain = sim->dev->regs[REG_RX_FILTER_GAIN];
+	uint8_t state = sim->dev->regs[REG_STATE];
+	uint8_t *buf = NULL;
+	uint32_t size = 0;
+
+	spi_fail_reg = REG_RX_FILTER_COEF_READ_DATA_1;
+	spi->xfer = spi_fail_xfer;
+	SIM_TEST_CHECK(ad9361_snapshot_save(phy, &buf, &size) < 0);
+	spi->xfer = sim_ad9361_xfer;
+
+	SIM_TEST_CHECK(!buf && !size);
+	SIM_TEST_CHECK(sim->dev->regs[REG_RX_FILTER_GAIN] == gain);
+	SIM_TEST_CHECK(sim->dev->regs[REG_STATE] == state);
+}
+
+/**
+ * @brief Cold boot, save a snapshot, reset the part, warm boot from the
+ * snapshot and check that the part and the driver state are restored.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	struct ad9361_rf_phy *phy = NULL;
+	struct model_state *cold;
+	struct phy_state cold_st, warm_st;
+	struct ad9361_sim sim;
+	uint64_t cold_ns, warm_ns;
+	uint32_t size, reg, diffs = 0;
+	uint8_t *buf;
+
+	cold = calloc(1, sizeof(*cold));
+	if (!SIM_TEST_CHECK(cold != NULL))
+		return sim_test_result("ad9361_warm_boot_test");
+
+	cold_ns = sim_time_ns();
+	if (!SIM_TEST_CHECK(ad9361_sim_init(&sim, &phy) == SUCCESS))
+		return sim_test_result("ad9361_warm_boot_test");
+	SIM_TEST_CHECK(ad9361_set_tx_fir_config(phy, tx_fir_config) == 0);
+	SIM_TEST_CHECK(ad9361_set_rx_fir_config(phy, rx_fir_config) == 0);
+	cold_ns = sim_time_ns() - cold_ns;
+
+	if (!SIM_TEST_CHECK(ad9361_snapshot_save(phy, &buf, &size) == 0))
+		return sim_test_result("ad9361_warm_boot_test");
+
+	memcpy(cold->regs, sim.dev->regs, sizeof(cold->regs));
+	memcpy(cold->gain_table, sim.dev->gain_table, sizeof(cold->gain_table));
+	memcpy(cold->fir_coef, sim.dev->fir_coef, sizeof(cold->fir_coef));
+	phy_state_get(phy, &cold_st);
+
+	/* Power-on state of the part, as after a power cycle */
+	SIM_TEST_CHECK(ad9361_reset(phy) == 0);
+	memset(sim.dev->gain_table, 0, sizeof(sim.dev->gain_table));
+	memset(sim.dev->fir_coef, 0, sizeof(sim.dev->fir_coef));
+	SIM_TEST_CHECK(memcmp(cold->regs, sim.dev->regs, sizeof(cold->regs)));
+
+	warm_ns = sim_time_ns();
+	SIM_TEST_CHECK(ad9361_warm_boot(phy, buf, size) == 0);
+	warm_ns = sim_time_ns() - warm_ns;
+	printf("cold boot %"PRIu64" us, warm boot %"PRIu64" us, snapshot %"PRIu32
+	       " bytes\n", cold_ns / 1000, warm_ns / 1000, size);
+
+	for (reg = 0; reg < SIM_AD9361_NUM_REGS; reg++) {
+		if (sim.dev->regs[reg] == cold->regs[reg])
+			continue;
+		printf("reg 0x%03"PRIX32": cold 0x%02X warm 0x%02X\n", reg,
+		       cold->regs[reg], sim.dev->regs[reg]);
+		diffs++;
+	}
+	SIM_TEST_CHECK(diffs == 0);
+	SIM_TEST_CHECK(!memcmp(cold->gain_table, sim.dev->gain_table,
+			       sizeof(cold->gain_table)));
+	SIM_TEST_CHECK(!memcmp(cold->fir_coef, sim.dev->fir_coef,
+			       sizeof(cold->fir_coef)));
+
+	phy_state_get(phy, &warm_st);
+	SIM_TEST_CHECK(!memcmp(&cold_st, &warm_st, sizeof(cold_st)));
+	SIM_TEST_CHECK(warm_ns < cold_ns);
+
+	test_snapshot_error(phy, &sim);
+
+	free(buf);
+	free(cold);
+	ad9361_sim_remove(&sim);
+
+	return sim_test_result("ad9361_warm_boot_test");
+}
@@ -0,0 +1,333 @@
+/***************************************************************************//**
+ *   @file   adxcvr_drp_batch_test.c
+ *   @brief  ADXCVR batched DRP write test on a simulated GTX2 DRP model.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "error.h"
+#include "util.h"
+#include "sim.h"
+#include "sim_test.h"
+#include "axi_adxcvr.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define XCVR_BASE		0x44a60000
+#define XCVR_LANES		8
+#define XCVR_REFCLK_KHZ		250000
+#define XCVR_RATE_KHZ		10000000
+
+/* ADXCVR DRP interfaces: DRP_SEL, DRP_CTRL and DRP_STATUS of each */
+#define XCVR_REG_DRP_SEL(x)	(0x0040 + (x))
+#define XCVR_REG_DRP_CTRL(x)	(0x0044 + (x))
+#define XCVR_REG_DRP_STATUS(x)	(0x0048 + (x))
+#define XCVR_DRP_COMMON		0x00
+#define XCVR_DRP_CHANNEL	0x20
+#define XCVR_DRP_CTRL_WR	(1 << 28)
+#define XCVR_BROADCAST		0xff
+
+/* DRP register written by test_merge() */
+#define TEST_REG		0x10
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* DRP registers of the commons and of the channels of the lanes */
+struct xcvr_regs {
+	uint16_t		common[XCVR_LANES][0x100];
+	uint16_t		channel[XCVR_LANES][0x200];
+};
+
+/* ADXCVR with the DRP ports of a GTX2 link */
+struct xcvr_model {
+	struct sim_axi_model	model;
+	uint32_t		drp_sel[2];
+	uint32_t		drp_rdata[2];
+	/* DRP accesses issued */
+	uint32_t		drp_reads;
+	uint32_t		drp_writes;
+	struct xcvr_regs	regs;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static int32_t xcvr_model_read(void *priv, uint32_t offset, uint32_t *data)
+{
+	struct xcvr_model *m = priv;
+
+	if (offset == XCVR_REG_DRP_STATUS(XCVR_DRP_COMMON))
+		*data = m->drp_rdata[0];
+	else if (offset == XCVR_REG_DRP_STATUS(XCVR_DRP_CHANNEL))
+		*data = m->drp_rdata[1];
+	else
+		*data = 0;
+
+	return SUCCESS;
+}
+
+static int32_t xcvr_model_write(void *priv, uint32_t offset, uint32_t data)
+{
+	struct xcvr_model *m = priv;
+	uint32_t addr = (data >> 16) & 0xfff;
+	uint32_t itf, sel, lane;
+	uint16_t *drp;
+
+	if (offset == XCVR_REG_DRP_SEL(XCVR_DRP_COMMON) ||
+	    offset == XCVR_REG_DRP_SEL(XCVR_DRP_CHANNEL)) {
+		m->drp_sel[offset == XCVR_REG_DRP_SEL(XCVR_DRP_CHANNEL)] = data;
+		return SUCCESS;
+	}
+	if (offset == XCVR_REG_DRP_CTRL(XCVR_DRP_COMMON))
+		itf = 0;
+	else if (offset == XCVR_REG_DRP_CTRL(XCVR_DRP_CHANNEL))
+		itf = 1;
+	else
+		return SUCCESS;
+
+	sel = m->drp_sel[itf];
+	if (data & XCVR_DRP_CTRL_WR)
+		m->drp_writes++;
+	else
+		m->drp_reads++;
+
+	for (lane = 0; lane < XCVR_LANES; lane++) {
+		if (sel != lane && !(itf && sel == XCVR_BROADCAST))
+			continue;
+		drp = itf ? m->regs.channel[lane] : m->regs.common[lane];
+		if (data & XCVR_DRP_CTRL_WR)
+			drp[addr & 0x1ff] = data & 0xffff;
+		m->drp_rdata[itf] = drp[addr & 0x1ff];
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Load the power-on DRP register contents.
+ * @param m - The register model.
+ * @param odd_lane - Lane whose channel registers differ from the other
+ *		     lanes, XCVR_LANES for none.
+ */
+static void xcvr_model_reset(struct xcvr_model *m, uint32_t odd_lane)
+{
+	uint32_t lane, reg;
+
+	for (lane = 0; lane < XCVR_LANES; lane++) {
+		for (reg = 0; reg < 0x100; reg++)
+			m->regs.common[lane][reg] = reg * 0x3c5b;
+		for (reg = 0; reg < 0x200; reg++)
+			m->regs.channel[lane][reg] = reg * 0x9e37 ^
+						     (lane == odd_lane ? 0x5555 : 0);
+	}
+	m->drp_reads = 0;
+	m->drp_writes = 0;
+}
+
+/**
+ * @brief Change the lane rate the way adxcvr_clk_set_rate() did before the
+ * DRP batches: each register image written lane by lane, reading the masked
+ * registers back.
+ * @param xcvr - The transceiver.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t set_rate_per_lane(struct adxcvr *xcvr)
+{
+	struct xilinx_xcvr_rate_config conf;
+	uint32_t i;
+	int32_t ret;
+
+	ret = xilinx_xcvr_calc_rate_config(&xcvr->xlx_xcvr, XCVR_REFCLK_KHZ,
+					   XCVR_RATE_KHZ, xcvr->cpll_enable,
+					   xcvr->tx_enable, xcvr->lpm_enable,
+					   &conf);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < xcvr->num_lanes; i++) {
+		if (i % 4 == 0 && conf.common.num_regs) {
+			ret = xilinx_xcvr_write_reg_image(&xcvr->xlx_xcvr,
+							  ADXCVR_DRP_PORT_COMMON(i),
+							  &conf.common);
+			if (ret < 0)
+				return ret;
+		}
+
+		ret = xilinx_xcvr_write_reg_image(&xcvr->xlx_xcvr,
+						  ADXCVR_DRP_PORT_CHANNEL(i),
+						  &conf.channel);
+		if (ret < 0)
+			return ret;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Change the lane rate lane by lane and with adxcvr_clk_set_rate(),
+ * from the same register contents, and check that both give the same
+ * contents.
+ * @param m - The register model.
+ * @param xcvr - The transceiver.
+ * @param odd_lane - Lane whose channel registers differ from the other
+ *		     lanes, XCVR_LANES for none.
+ * @param ref - Register contents after the lane by lane rate change.
+ * @param per_lane - DRP accesses of the lane by lane rate change.
+ * @param batched - DRP accesses of adxcvr_clk_set_rate().
+ */
+static void test_set_rate(struct xcvr_model *m, struct adxcvr *xcvr,
+			  uint32_t odd_lane, struct xcvr_regs *ref,
+			  uint32_t *per_lane, uint32_t *batched)
+{
+	xcvr_model_reset(m, odd_lane);
+	SIM_TEST_CHECK(set_rate_per_lane(xcvr) == SUCCESS);
+	*per_lane = m->drp_reads + m->drp_writes;
+	memcpy(ref, &m->regs, sizeof(*ref));
+
+	xcvr_model_reset(m, odd_lane);
+	SIM_TEST_CHECK(adxcvr_clk_set_rate(xcvr, XCVR_RATE_KHZ,
+					   XCVR_REFCLK_KHZ) == SUCCESS);
+	*batched = m->drp_reads + m->drp_writes;
+
+	printf("rate change: %"PRIu32" DRP accesses lane by lane, %"PRIu32
+	       " batched\n", *per_lane, *batched);
+	SIM_TEST_CHECK(!memcmp(ref, &m->regs, sizeof(*ref)));
+}
+
+/**
+ * @brief Queue writes of one register on overlapping lanes and check that
+ * each lane ends up with the last value queued for it.
+ * @param m - The register model.
+ * @param xcvr - The transceiver.
+ */
+static void test_merge(struct xcvr_model *m, struct adxcvr *xcvr)
+{
+	/* Last value queued for lanes 0 to 3 */
+	static const uint16_t last[4] = { 1, 1, 2, 1 };
+	struct adxcvr_drp_batch batch;
+	uint32_t lane;
+
+	xcvr_model_reset(m, XCVR_LANES);
+	adxcvr_drp_batch_init(&batch, xcvr);
+
+	SIM_TEST_CHECK(adxcvr_drp_batch_update(&batch, false, BIT(0), TEST_REG,
+					       0xffff, 1) == SUCCESS);
+	SIM_TEST_CHECK(adxcvr_drp_batch_update(&batch, false, BIT(1), TEST_REG,
+					       0xffff, 2) == SUCCESS);
+	/* Must not be merged into the first write, it would be overwritten */
+	SIM_TEST_CHECK(adxcvr_drp_batch_update(&batch, false, BIT(1), TEST_REG,
+					       0xffff, 1) == SUCCESS);
+	SIM_TEST_CHECK(batch.num_ops == 3);
+	/* Merged: no later write of the register on lanes 2 and 3 */
+	SIM_TEST_CHECK(adxcvr_drp_batch_update(&batch, false, BIT(2), TEST_REG,
+					       0xffff, 2) == SUCCESS);
+	SIM_TEST_CHECK(adxcvr_drp_batch_update(&batch, false, BIT(3), TEST_REG,
+					       0xffff, 1) == SUCCESS);
+	SIM_TEST_CHECK(batch.num_ops == 3);
+	/* Masked write of other bits, merged past the lane 1 writes */
+	SIM_TEST_CHECK(adxcvr_drp_batch_update(&batch, false, BIT(4), TEST_REG,
+					       0xff00, 0x300) == SUCCESS);
+	SIM_TEST_CHECK(adxcvr_drp_batch_update(&batch, false, BIT(5), TEST_REG,
+					       0xff00, 0x300) == SUCCESS);
+	SIM_TEST_CHECK(batch.num_ops == 4);
+
+	SIM_TEST_CHECK(adxcvr_drp_batch_commit(&batch) == SUCCESS);
+	SIM_TEST_CHECK(batch.num_ops == 0);
+
+	for (lane = 0; lane < 4; lane++)
+		SIM_TEST_CHECK(m->regs.channel[lane][TEST_REG] == last[lane]);
+	for (lane = 4; lane < 6; lane++)
+		SIM_TEST_CHECK(m->regs.channel[lane][TEST_REG] ==
+			       (0x300 | ((TEST_REG * 0x9e37) & 0xff)));
+	for (lane = 6; lane < XCVR_LANES; lane++)
+		SIM_TEST_CHECK(m->regs.channel[lane][TEST_REG] ==
+			       ((TEST_REG * 0x9e37) & 0xffff));
+}
+
+/**
+ * @brief Run the batched DRP write tests on an 8 lane GTX2 RX link.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	static struct xcvr_model m;
+	static struct xcvr_regs ref;
+	struct adxcvr xcvr = {
+		.name = "rx_adxcvr",
+		.base = XCVR_BASE,
+		.lpm_enable = false,
+		.num_lanes = XCVR_LANES,
+	};
+	uint32_t per_lane, batched, odd_batched;
+
+	xcvr.xlx_xcvr.type = XILINX_XCVR_TYPE_S7_GTX2;
+	xcvr.xlx_xcvr.ad_xcvr = &xcvr;
+
+	m.model = (struct sim_axi_model) {
+		.base = XCVR_BASE,
+		.size = 0x1000,
+		.read = xcvr_model_read,
+		.write = xcvr_model_write,
+		.priv = &m,
+	};
+	if (!SIM_TEST_CHECK(sim_axi_register(&m.model) == SUCCESS))
+		return sim_test_result("adxcvr_drp_batch_test");
+
+	/* Same unmasked bits on every lane: the masked writes are broadcast */
+	test_set_rate(&m, &xcvr, XCVR_LANES, &ref, &per_lane, &batched);
+	SIM_TEST_CHECK(per_lane == 96 && batched == 47);
+
+	/* One lane differs: its masked writes are issued lane by lane */
+	test_set_rate(&m, &xcvr, 5, &ref, &per_lane, &odd_batched);
+	SIM_TEST_CHECK(odd_batched > batched && odd_batched < per_lane);
+
+	test_merge(&m, &xcvr);
+
+	sim_axi_unregister(&m.model);
+
+	return sim_test_result("adxcvr_drp_batch_test");
+}
@@ -0,0 +1,260 @@
+/***************************************************************************//**
+ *   @file   adxcvr_eyescan_test.c
+ *   @brief  ADXCVR eye scan test on a simulated GTX2 DRP register model.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "error.h"
+#include "util.h"
+#include "sim.h"
+#include "sim_test.h"
+#include "axi_adxcvr.h"
+#include "axi_adxcvr_eyescan.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define XCVR_BASE		0x44a60000
+#define XCVR_LANES		3
+
+/* ADXCVR channel DRP port registers */
+#define XCVR_REG_DRP_SEL	0x0060
+#define XCVR_REG_DRP_CTRL	0x0064
+#define XCVR_REG_DRP_STATUS	0x0068
+#define XCVR_DRP_CTRL_WR	(1 << 28)
+
+/* GTX2 channel DRP registers used by the eye scan */
+#define GTX2_ES_PRESCALE_VERT	0x3b
+#define GTX2_ES_HORZ_OFFSET	0x3c
+#define GTX2_ES_CONTROL		0x3d
+#define GTX2_PMA_RSV2		0x82
+#define GTX2_ES_ERROR_COUNT	0x14f
+#define GTX2_ES_SAMPLE_COUNT	0x150
+#define GTX2_ES_STATUS		0x151
+#define GTX2_ES_RUN		(1 << 10)
+#define GTX2_ES_ENABLE		((1 << 9) | (1 << 8))
+
+/* The modeled eye is open within these offsets */
+#define EYE_HORZ_OPEN		16
+#define EYE_VERT_OPEN		64
+#define EYE_ERRORS		0x100
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* ADXCVR with the DRP registers of its channels */
+struct xcvr_model {
+	struct sim_axi_model	model;
+	uint32_t		drp_sel;
+	uint32_t		drp_rdata;
+	uint16_t		drp[XCVR_LANES][0x200];
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Run the eye scan measurement of a lane: it completes at once, with
+ * errors only outside of the open eye.
+ * @param drp - DRP registers of the lane.
+ */
+static void xcvr_model_measure(uint16_t *drp)
+{
+	int32_t horz = drp[GTX2_ES_HORZ_OFFSET] & 0x7ff;
+	int32_t vert = drp[GTX2_ES_PRESCALE_VERT] & 0x7f;
+
+	if (horz & 0x400)
+		horz -= 0x800;
+	if (drp[GTX2_ES_PRESCALE_VERT] & (1 << 7))
+		vert = -vert;
+
+	if (abs(horz) <= EYE_HORZ_OPEN && abs(vert) <= EYE_VERT_OPEN) {
+		drp[GTX2_ES_ERROR_COUNT] = 0;
+		drp[GTX2_ES_SAMPLE_COUNT] = 0xffff;
+	} else {
+		drp[GTX2_ES_ERROR_COUNT] = EYE_ERRORS;
+		drp[GTX2_ES_SAMPLE_COUNT] = 0x10;
+	}
+	drp[GTX2_ES_STATUS] = 1;
+}
+
+static int32_t xcvr_model_read(void *priv, uint32_t offset, uint32_t *data)
+{
+	struct xcvr_model *m = priv;
+
+	*data = offset == XCVR_REG_DRP_STATUS ? m->drp_rdata : 0;
+
+	return SUCCESS;
+}
+
+static int32_t xcvr_model_write(void *priv, uint32_t offset, uint32_t data)
+{
+	struct xcvr_model *m = priv;
+	uint32_t addr = (data >> 16) & 0xfff;
+	uint16_t *drp;
+
+	if (offset == XCVR_REG_DRP_SEL) {
+		m->drp_sel = data;
+		return SUCCESS;
+	}
+	if (offset != XCVR_REG_DRP_CTRL || m->drp_sel >= XCVR_LANES ||
+	    addr >= ARRAY_SIZE(m->drp[0]))
+		return SUCCESS;
+
+	drp = m->drp[m->drp_sel];
+	if (data & XCVR_DRP_CTRL_WR) {
+		drp[addr] = data & 0xffff;
+		if (addr == GTX2_ES_CONTROL) {
+			if (data & GTX2_ES_RUN)
+				xcvr_model_measure(drp);
+			else
+				drp[GTX2_ES_STATUS] = 0;
+		}
+	}
+	m->drp_rdata = drp[addr];
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Check that the eye scan is disabled on the given lanes.
+ * @param m - The register model.
+ * @param lanes - Number of lanes to check, from lane 0.
+ */
+static void check_disabled(struct xcvr_model *m, uint32_t lanes)
+{
+	uint32_t i;
+
+	for (i = 0; i < lanes; i++)
+		SIM_TEST_CHECK(!(m->drp[i][GTX2_ES_CONTROL] & GTX2_ES_ENABLE));
+}
+
+/**
+ * @brief Set the eye scan up on a lane that can't do it after lanes that can,
+ * then scan all the lanes and check the map and its export.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	static struct xcvr_model m;
+	struct adxcvr xcvr = {
+		.name = "rx_adxcvr",
+		.base = XCVR_BASE,
+		.lpm_enable = false,
+		.num_lanes = XCVR_LANES,
+		.lane_rate_khz = 10000000,
+	};
+	struct adxcvr_eyescan_init init = {
+		.xcvr = &xcvr,
+		.lane_mask = 0,
+		.data_width = 40,
+		.horz_step = 16,
+		.vert_step = 64,
+		.prescale_min = 0,
+		.prescale_max = 4,
+		.prescale_step = 2,
+	};
+	struct adxcvr_eyescan_point *pt;
+	struct adxcvr_eyescan *es;
+	uint8_t *buf;
+	int32_t len;
+
+	xcvr.xlx_xcvr.type = XILINX_XCVR_TYPE_S7_GTX2;
+	xcvr.xlx_xcvr.ad_xcvr = &xcvr;
+
+	m.model = (struct sim_axi_model) {
+		.base = XCVR_BASE,
+		.size = 0x1000,
+		.read = xcvr_model_read,
+		.write = xcvr_model_write,
+		.priv = &m,
+	};
+	if (!SIM_TEST_CHECK(sim_axi_register(&m.model) == SUCCESS))
+		return sim_test_result("adxcvr_eyescan_test");
+
+	/* The last lane has no eye scan support */
+	m.drp[0][GTX2_PMA_RSV2] = 1 << 5;
+	m.drp[1][GTX2_PMA_RSV2] = 1 << 5;
+	SIM_TEST_CHECK(adxcvr_eyescan_init(&es, &init) == FAILURE);
+	check_disabled(&m, XCVR_LANES);
+
+	m.drp[2][GTX2_PMA_RSV2] = 1 << 5;
+	if (!SIM_TEST_CHECK(adxcvr_eyescan_init(&es, &init) == SUCCESS))
+		return sim_test_result("adxcvr_eyescan_test");
+	SIM_TEST_CHECK(es->num_lanes == XCVR_LANES);
+	SIM_TEST_CHECK(es->num_horz == 5 && es->num_vert == 3);
+	SIM_TEST_CHECK(adxcvr_eyescan_run(es) == SUCCESS);
+
+	/* Open eye: measured again up to prescale_max, with both UT signs */
+	pt = adxcvr_eyescan_point_get(es, 1, 1, 2);
+	SIM_TEST_CHECK(pt->errors == 0 && pt->prescale == init.prescale_max);
+	SIM_TEST_CHECK(pt->samples == 2 * 0xffff);
+	/* Closed eye: done at prescale_min */
+	pt = adxcvr_eyescan_point_get(es, 2, 0, 0);
+	SIM_TEST_CHECK(pt->errors == 2 * EYE_ERRORS &&
+		       pt->prescale == init.prescale_min);
+	SIM_TEST_CHECK(!adxcvr_eyescan_point_get(es, XCVR_LANES, 0, 0));
+
+	len = adxcvr_eyescan_export(es, NULL, 0);
+	SIM_TEST_CHECK(len == ADXCVR_EYESCAN_EXPORT_HDR_SIZE +
+		       XCVR_LANES * 3 * 5 * ADXCVR_EYESCAN_EXPORT_PT_SIZE);
+	buf = malloc(len);
+	if (SIM_TEST_CHECK(buf != NULL)) {
+		SIM_TEST_CHECK(adxcvr_eyescan_export(es, buf, len - 1) == FAILURE);
+		SIM_TEST_CHECK(adxcvr_eyescan_export(es, buf, len) == len);
+		SIM_TEST_CHECK(!memcmp(buf, "ESCN", 4));
+		SIM_TEST_CHECK(buf[5] == XCVR_LANES && buf[7] == 2);
+		free(buf);
+	}
+
+	adxcvr_eyescan_remove(es);
+	check_disabled(&m, XCVR_LANES);
+
+	sim_axi_unregister(&m.model);
+
+	return sim_test_result("adxcvr_eyescan_test");
+}
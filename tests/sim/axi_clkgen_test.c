@@ -0,0 +1,428 @@
+/***************************************************************************//**
+ *   @file   axi_clkgen_test.c
+ *   @brief  clk_axi_clkgen MMCM solver sweep on a simulated clkgen core.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <time.h>
+#include "error.h"
+#include "util.h"
+#include "sim.h"
+#include "sim_test.h"
+#include "xilinx_transceiver.h"
+#include "clk_axi_clkgen.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define CLKGEN_BASE		0x43c00000
+
+/* clkgen core registers */
+#define CLKGEN_REG_VERSION	0x0000
+#define CLKGEN_REG_FPGA_INFO	0x001c
+#define CLKGEN_REG_STATUS	0x005c
+#define CLKGEN_REG_DRP_CNTRL	0x0070
+#define CLKGEN_REG_DRP_STATUS	0x0074
+#define CLKGEN_REG_FPGA_VOLTAGE	0x0140
+#define CLKGEN_DRP_CNTRL_READ	(1 << 28)
+
+/* Swept output rates (Hz) */
+#define SWEEP_FOUT_MIN		5000000
+#define SWEEP_FOUT_MAX		600000000
+#define SWEEP_FOUT_STEP		997003
+/* Timed sweeps per solver, the fastest one is kept */
+#define SWEEP_TIME_RUNS		5
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* clkgen core with the MMCM DRP registers */
+struct clkgen_model {
+	struct sim_axi_model	model;
+	uint32_t		drp_rdata;
+	uint16_t		drp[0x80];
+};
+
+/* Solvers compared over the sweep */
+enum sweep_solver {
+	SOLVER_OLD,
+	SOLVER_INTEGER,
+	SOLVER_FRAC,
+};
+
+/* Accumulated error of a solver over the sweep */
+struct sweep_stats {
+	double			err_sum;
+	double			err_max;
+	uint32_t		exact;
+	double			time_s;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static int32_t clkgen_model_read(void *priv, uint32_t offset, uint32_t *data)
+{
+	struct clkgen_model *m = priv;
+
+	switch (offset) {
+	case CLKGEN_REG_VERSION:
+		*data = 0x00050000;
+		break;
+	case CLKGEN_REG_FPGA_INFO:
+		*data = (AXI_FPGA_TECH_SERIES7 << 24) |
+			(AXI_FPGA_FAMILY_ZYNQ << 16) | (AXI_FPGA_SPEED_2 << 8);
+		break;
+	case CLKGEN_REG_FPGA_VOLTAGE:
+		*data = 1000;
+		break;
+	case CLKGEN_REG_STATUS:
+		*data = 1;
+		break;
+	case CLKGEN_REG_DRP_STATUS:
+		*data = m->drp_rdata;
+		break;
+	default:
+		*data = 0;
+		break;
+	}
+
+	return SUCCESS;
+}
+
+static int32_t clkgen_model_write(void *priv, uint32_t offset, uint32_t data)
+{
+	struct clkgen_model *m = priv;
+	uint32_t reg = (data >> 16) & 0x7f;
+
+	if (offset != CLKGEN_REG_DRP_CNTRL)
+		return SUCCESS;
+
+	if (data & CLKGEN_DRP_CNTRL_READ)
+		m->drp_rdata = m->drp[reg];
+	else
+		m->drp[reg] = data & 0xffff;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief The integer solver the rational one replaced, as reference.
+ *
+ * Brute force over the M and D ranges, in kHz, with the output divider
+ * rounded for each M / D. The result is in the 1/8 units of
+ * axi_clkgen_params.
+ * @param clkgen - The clkgen, for its MMCM limits.
+ * @param fin - Input rate [Hz].
+ * @param fout - Target rate [Hz].
+ * @param params - The best setting found.
+ */
+static void old_calc_params(struct axi_clkgen *clkgen, uint32_t fin,
+			    uint32_t fout, struct axi_clkgen_params *params)
+{
+	const struct axi_clkgen_limits *l = &clkgen->limits;
+	uint32_t d, d_min, d_max, _d_min, _d_max;
+	uint32_t m, m_min, m_max;
+	uint32_t dout, fvco;
+	int32_t f, best_f = 0x7fffffff;
+
+	fin /= 1000;
+	fout /= 1000;
+
+	params->d = 0;
+	params->m = 0;
+	params->dout = 0;
+
+	d_min = max(DIV_ROUND_UP(fin, l->fpfd_max), 1);
+	d_max = min(fin / l->fpfd_min, 80);
+
+	m_min = max(DIV_ROUND_UP(l->fvco_min, fin) * d_min, 1);
+	m_max = min(l->fvco_max * d_max / fin, 64);
+
+	for (m = m_min; m <= m_max; m++) {
+		_d_min = max(d_min, DIV_ROUND_UP(fin * m, l->fvco_max));
+		_d_max = min(d_max, fin * m / l->fvco_min);
+
+		for (d = _d_min; d <= _d_max; d++) {
+			fvco = fin * m / d;
+			dout = DIV_ROUND_CLOSEST(fvco, fout);
+			dout = clamp(dout, 1, 128);
+			f = fvco / dout;
+			if (abs(f - (int32_t)fout) < abs(best_f - (int32_t)fout)) {
+				best_f = f;
+				params->d = d;
+				params->m = m * 8;
+				params->dout = dout * 8;
+				if (best_f == (int32_t)fout)
+					return;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Absolute error of a setting [Hz].
+ * @param fin - Input rate [Hz].
+ * @param fout - Target rate [Hz].
+ * @param p - The setting, 1/8 units for m and dout.
+ */
+static double params_err(uint32_t fin, uint32_t fout,
+			 const struct axi_clkgen_params *p)
+{
+	double f;
+
+	if (!p->d || !p->dout)
+		return fout;
+
+	f = (double)fin * p->m / ((double)p->d * p->dout);
+
+	return f > fout ? f - fout : fout - f;
+}
+
+static double now_s(void)
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief Solve one target with a solver and account its error and time.
+ * @return The error of the setting [Hz].
+ */
+static double sweep_solve(struct axi_clkgen *clkgen, bool old, uint32_t fin,
+			  uint32_t fout, struct sweep_stats *st)
+{
+	struct axi_clkgen_params p;
+	double t0, err;
+
+	t0 = now_s();
+	if (old)
+		old_calc_params(clkgen, fin, fout, &p);
+	else
+		axi_clkgen_calc_params(clkgen, fin, fout, &p);
+	st->time_s += now_s() - t0;
+
+	err = params_err(fin, fout, &p);
+	st->err_sum += err;
+	st->err_max = max(st->err_max, err);
+	if (err < 1.0)
+		st->exact++;
+
+	return err;
+}
+
+static void sweep_print(const char *name, const struct sweep_stats *st,
+			uint32_t points)
+{
+	printf("%-9s mean err %10.1f Hz, max %10.1f Hz, %4"PRIu32" exact, "
+	       "%.2f us per solve\n", name, st->err_sum / points, st->err_max,
+	       st->exact, st->time_s * 1e6 / points);
+}
+
+/**
+ * @brief Time a solver over the whole sweep.
+ * @param clkgen - The clkgen.
+ * @param solver - The solver.
+ * @param fins - Input rates [Hz].
+ * @param nb_fins - Number of input rates.
+ * @return The time of the fastest of SWEEP_TIME_RUNS sweeps [s].
+ */
+static double sweep_time(struct axi_clkgen *clkgen, enum sweep_solver solver,
+			 const uint32_t *fins, uint32_t nb_fins)
+{
+	struct axi_clkgen_params p;
+	double t0, t, best = 0;
+	uint32_t run, i, fout;
+
+	clkgen->frac_enable = (solver == SOLVER_FRAC);
+	for (run = 0; run < SWEEP_TIME_RUNS; run++) {
+		t0 = now_s();
+		for (i = 0; i < nb_fins; i++) {
+			for (fout = SWEEP_FOUT_MIN; fout <= SWEEP_FOUT_MAX;
+			     fout += SWEEP_FOUT_STEP) {
+				if (solver == SOLVER_OLD)
+					old_calc_params(clkgen, fins[i], fout, &p);
+				else
+					axi_clkgen_calc_params(clkgen, fins[i],
+							       fout, &p);
+			}
+		}
+		t = now_s() - t0;
+		if (!run || t < best)
+			best = t;
+	}
+	clkgen->frac_enable = true;
+
+	return best;
+}
+
+/**
+ * @brief Sweep the target rates for several input rates and compare the old
+ * and the new solver. Integer dividers only must never be worse than the old
+ * solver, fractional ones never worse than integer ones, and neither may be
+ * slower than the old solver.
+ * @param clkgen - The clkgen.
+ */
+static void test_sweep(struct axi_clkgen *clkgen)
+{
+	static const uint32_t fins[] = {
+		100000000, 125000000, 200000000, 122880000, 156250000, 33333333
+	};
+	struct sweep_stats old = {0}, integer = {0}, frac = {0};
+	uint32_t worse_int = 0, worse_frac = 0, points = 0;
+	double err_old, err_int, err_frac;
+	double t_old, t_int, t_frac;
+	uint32_t i, fout;
+
+	for (i = 0; i < ARRAY_SIZE(fins); i++) {
+		for (fout = SWEEP_FOUT_MIN; fout <= SWEEP_FOUT_MAX;
+		     fout += SWEEP_FOUT_STEP) {
+			err_old = sweep_solve(clkgen, true, fins[i], fout, &old);
+			clkgen->frac_enable = false;
+			err_int = sweep_solve(clkgen, false, fins[i], fout, &integer);
+			clkgen->frac_enable = true;
+			err_frac = sweep_solve(clkgen, false, fins[i], fout, &frac);
+
+			/* The old solver rounds to kHz */
+			if (err_int > err_old + 1.0) {
+				if (!worse_int++)
+					printf("integer worse: fin %"PRIu32" fout %"PRIu32
+					       " err %.1f, old %.1f\n", fins[i], fout,
+					       err_int, err_old);
+			}
+			if (err_frac > err_int)
+				worse_frac++;
+			points++;
+		}
+	}
+
+	printf("%"PRIu32" points\n", points);
+	sweep_print("old", &old, points);
+	sweep_print("integer", &integer, points);
+	sweep_print("frac", &frac, points);
+
+	SIM_TEST_CHECK(worse_int == 0);
+	SIM_TEST_CHECK(worse_frac == 0);
+	SIM_TEST_CHECK(integer.err_sum <= old.err_sum);
+	SIM_TEST_CHECK(frac.err_sum < integer.err_sum);
+
+	/* The fractional search must not make the solver slower than the old */
+	t_old = sweep_time(clkgen, SOLVER_OLD, fins, ARRAY_SIZE(fins));
+	t_int = sweep_time(clkgen, SOLVER_INTEGER, fins, ARRAY_SIZE(fins));
+	t_frac = sweep_time(clkgen, SOLVER_FRAC, fins, ARRAY_SIZE(fins));
+	printf("best of %d sweeps: old %.2f us, integer %.2f us, frac %.2f us "
+	       "per solve\n", SWEEP_TIME_RUNS, t_old * 1e6 / points,
+	       t_int * 1e6 / points, t_frac * 1e6 / points);
+	SIM_TEST_CHECK(t_int <= t_old);
+	SIM_TEST_CHECK(t_frac <= t_old);
+}
+
+/**
+ * @brief Program rates and read them back from the MMCM registers.
+ *
+ * The rate read back must be the one of the solved setting, integer or
+ * fractional, and switching back to a rate must give the same setting.
+ * @param clkgen - The clkgen.
+ */
+static void test_round_trip(struct axi_clkgen *clkgen)
+{
+	static const uint32_t rates[] = {
+		148500000, 74250000, 122880000, 245760000, 61440000, 148500000,
+		311040000, 25000000
+	};
+	struct axi_clkgen_params p;
+	uint32_t i, rate, expected;
+
+	for (i = 0; i < ARRAY_SIZE(rates); i++) {
+		axi_clkgen_calc_params(clkgen, clkgen->parent_rate, rates[i], &p);
+		expected = (uint64_t)clkgen->parent_rate * p.m /
+			   ((uint64_t)p.d * p.dout);
+
+		SIM_TEST_CHECK(axi_clkgen_set_rate(clkgen, rates[i]) == SUCCESS);
+		SIM_TEST_CHECK(axi_clkgen_get_rate(clkgen, &rate) == SUCCESS);
+		printf("set %"PRIu32" Hz: m %"PRIu32"/8 d %"PRIu32" dout %"PRIu32
+		       "/8, read back %"PRIu32" Hz\n", rates[i], p.m, p.d, p.dout,
+		       rate);
+		SIM_TEST_CHECK(rate == expected);
+	}
+}
+
+/**
+ * @brief Compare the MMCM solver with the one it replaced over a sweep of
+ * target rates and check the programmed rates.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	static struct clkgen_model m;
+	struct axi_clkgen_init init = {
+		.name = "clkgen",
+		.base = CLKGEN_BASE,
+		.parent_rate = 100000000,
+	};
+	struct axi_clkgen *clkgen;
+
+	m.model = (struct sim_axi_model) {
+		.base = CLKGEN_BASE,
+		.size = 0x1000,
+		.read = clkgen_model_read,
+		.write = clkgen_model_write,
+		.priv = &m,
+	};
+	if (!SIM_TEST_CHECK(sim_axi_register(&m.model) == SUCCESS))
+		return sim_test_result("axi_clkgen_test");
+
+	if (!SIM_TEST_CHECK(axi_clkgen_init(&clkgen, &init) == SUCCESS))
+		return sim_test_result("axi_clkgen_test");
+	SIM_TEST_CHECK(clkgen->frac_enable);
+
+	test_sweep(clkgen);
+	test_round_trip(clkgen);
+
+	axi_clkgen_remove(clkgen);
+	sim_axi_unregister(&m.model);
+
+	return sim_test_result("axi_clkgen_test");
+}
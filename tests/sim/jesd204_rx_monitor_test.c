@@ -0,0 +1,557 @@
+/***************************************************************************//**
+ *   @file   jesd204_rx_monitor_test.c
+ *   @brief  JESD204 RX link monitor test on the simulated platform.
+ *   @author DBogdan (dragos.bogdan@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "error.h"
+#include "util.h"
+#include "delay.h"
+#include "timer.h"
+#include "timestamp.h"
+#include "scheduler.h"
+#include "sim.h"
+#include "sim_test.h"
+#include "axi_jesd204_rx.h"
+#include "axi_jesd204_rx_monitor.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define JESD_BASE		0x44a90000
+#define NB_LANES		4
+/* Core version 1.2, with the lane error counters */
+#define JESD_VERSION		0x00010261
+
+/* JESD204 RX core registers */
+#define REG_LINK_DISABLE	0x00c0
+#define REG_LINK_STATE		0x00c4
+#define REG_SYSREF_STATUS	0x0108
+#define REG_LINK_STATUS		0x0280
+#define REG_LANE_STATUS(x)	(((x) * 32) + 0x300)
+#define REG_LANE_ERRORS(x)	(((x) * 32) + 0x308)
+
+/* Lane status of a lane in the DATA CGS state, with IFS and ILAS done */
+#define LANE_STATUS_DATA	(2 | AXI_JESD204_RX_LANE_STATUS_IFS |	\
+				 AXI_JESD204_RX_LANE_STATUS_ILAS)
+
+/* Time base of the monitor and of the scheduler (Hz) */
+#define TIMER_FREQ_HZ		100000000
+/* Simulated time between two scheduler passes (us) */
+#define PASS_US			10
+/* Sampling period (us) */
+#define PERIOD_US		1000
+/* One error every ERR_PERIOD_US on the lane under test */
+#define ERR_PERIOD_US		100
+/* The same, in the error rate unit [errors / 1000 s] */
+#define ERR_RATE		(1000000000 / ERR_PERIOD_US)
+/* Samples for the averaged rate to settle, and to decay to zero */
+#define RATE_SAMPLES		64
+#define DECAY_SAMPLES		200
+/* Sampling period of the re-initialization test (us) */
+#define REINIT_PERIOD_US	100000
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* JESD204 RX core link and lane status registers */
+struct jesd_model {
+	struct sim_axi_model	model;
+	uint32_t		link_status;
+	uint32_t		link_disabled;
+	/* Writes disabling the link */
+	uint32_t		restarts;
+	uint32_t		lane_status[NB_LANES];
+	/* The error counter counts one error every err_period_us from err_t0_ns,
+	 * starting at err_base. It does not count if err_period_us is 0. */
+	uint32_t		err_base[NB_LANES];
+	uint32_t		err_period_us[NB_LANES];
+	uint64_t		err_t0_ns[NB_LANES];
+};
+
+/* Monitor sampled by its scheduler task */
+struct monitor_run {
+	struct scheduler		*sched;
+	struct sched_task		task;
+	struct jesd204_rx_monitor	*mon;
+};
+
+/* Link restarts done through the reinit callback */
+struct reinit_log {
+	uint32_t	calls;
+	uint64_t	ns[8];
+};
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+static struct jesd_model model;
+static struct axi_jesd204_rx jesd = {
+	.name = "jesd_rx",
+	.base = JESD_BASE,
+	.version = JESD_VERSION,
+	.num_lanes = NB_LANES,
+};
+static struct timer_desc *timer;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static uint32_t lane_errors(uint32_t lane)
+{
+	uint64_t count = 0;
+
+	if (model.err_period_us[lane])
+		count = (sim_time_ns() - model.err_t0_ns[lane]) /
+			(model.err_period_us[lane] * 1000ULL);
+
+	return model.err_base[lane] + count;
+}
+
+/**
+ * @brief Change the error rate of a lane, from its current count.
+ * @param lane - The lane.
+ * @param period_us - One error every period_us, 0 to stop counting.
+ */
+static void lane_errors_set(uint32_t lane, uint32_t period_us)
+{
+	model.err_base[lane] = lane_errors(lane);
+	model.err_t0_ns[lane] = sim_time_ns();
+	model.err_period_us[lane] = period_us;
+}
+
+static int32_t jesd_model_read(void *priv, uint32_t offset, uint32_t *data)
+{
+	struct jesd_model *m = priv;
+	uint32_t lane = (offset - 0x300) / 32;
+
+	if (offset >= 0x300 && lane < NB_LANES) {
+		if (offset == REG_LANE_STATUS(lane))
+			*data = m->lane_status[lane];
+		else if (offset == REG_LANE_ERRORS(lane))
+			*data = lane_errors(lane);
+		else
+			*data = 0;
+		return SUCCESS;
+	}
+
+	switch (offset) {
+	case REG_LINK_STATE:
+		*data = m->link_disabled;
+		break;
+	case REG_LINK_STATUS:
+		*data = m->link_status;
+		break;
+	case REG_SYSREF_STATUS:
+		*data = AXI_JESD204_RX_SYSREF_STATUS_CAPTURED;
+		break;
+	default:
+		*data = 0;
+		break;
+	}
+
+	return SUCCESS;
+}
+
+static int32_t jesd_model_write(void *priv, uint32_t offset, uint32_t data)
+{
+	struct jesd_model *m = priv;
+
+	if (offset != REG_LINK_DISABLE)
+		return SUCCESS;
+
+	if ((data & 1) && !m->link_disabled)
+		m->restarts++;
+	m->link_disabled = data & 1;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Put the link in the DATA state, all lanes synchronized, no errors.
+ */
+static void model_reset(void)
+{
+	uint32_t i;
+
+	model.link_status = AXI_JESD204_RX_LINK_STATUS_DATA;
+	model.link_disabled = 0;
+	model.restarts = 0;
+	for (i = 0; i < NB_LANES; i++) {
+		model.lane_status[i] = LANE_STATUS_DATA;
+		model.err_base[i] = 0;
+		model.err_period_us[i] = 0;
+	}
+}
+
+/**
+ * @brief Run the scheduler, advancing the simulated time between the passes.
+ * @param r - The monitor.
+ * @param us - Time to run for [us].
+ */
+static void run_for(struct monitor_run *r, uint64_t us)
+{
+	uint64_t end_ns = sim_time_ns() + us * 1000;
+
+	while (sim_time_ns() < end_ns) {
+		scheduler_run_once(r->sched);
+		udelay(PASS_US);
+	}
+}
+
+/**
+ * @brief Create a monitor, start sampling it from a scheduler task.
+ *
+ * Runs for half a period, so that the test steps, whole periods, end
+ * between two samples.
+ * @return true in case of success.
+ */
+static bool monitor_start(struct monitor_run *r, uint32_t period_us,
+			  bool auto_reinit, int32_t (*reinit)(void *ctx),
+			  void *reinit_ctx)
+{
+	struct scheduler_init_param param = { .timer = timer };
+	struct jesd204_rx_monitor_init init = {
+		.jesd = &jesd,
+		.period_us = period_us,
+		.auto_reinit = auto_reinit,
+		.reinit = reinit,
+		.reinit_ctx = reinit_ctx,
+	};
+
+	memset(r, 0, sizeof(*r));
+	if (!SIM_TEST_CHECK(jesd204_rx_monitor_init(&r->mon, &init) == SUCCESS))
+		return false;
+	if (!SIM_TEST_CHECK(scheduler_init(&r->sched, &param) == SUCCESS))
+		return false;
+	if (!SIM_TEST_CHECK(scheduler_task_add(r->sched, &r->task,
+					       jesd204_rx_monitor_task,
+					       r->mon) == SUCCESS))
+		return false;
+
+	if (!SIM_TEST_CHECK(jesd204_rx_monitor_enable(r->mon, true) == SUCCESS))
+		return false;
+
+	run_for(r, period_us / 2);
+
+	return true;
+}
+
+static void monitor_stop(struct monitor_run *r)
+{
+	scheduler_remove(r->sched);
+	jesd204_rx_monitor_remove(r->mon);
+}
+
+static struct jesd204_rx_monitor_stats stats_get(struct monitor_run *r)
+{
+	struct jesd204_rx_monitor_stats stats;
+
+	jesd204_rx_monitor_stats_get(r->mon, &stats);
+
+	return stats;
+}
+
+static struct jesd204_rx_monitor_lane lane_get(struct monitor_run *r,
+		uint32_t lane)
+{
+	struct jesd204_rx_monitor_lane stats = {0};
+
+	SIM_TEST_CHECK(jesd204_rx_monitor_lane_get(r->mon, lane, &stats) ==
+		       SUCCESS);
+
+	return stats;
+}
+
+/**
+ * @brief Count errors at a constant rate on one lane.
+ *
+ * The task must sample once per period, the averaged rate must settle on the
+ * injected one and decay to zero once the errors stop, and the total must
+ * be the number of errors counted while the link was up.
+ */
+static void test_rate(void)
+{
+	struct jesd204_rx_monitor_lane lane;
+	struct monitor_run r;
+	uint32_t base, samples;
+
+	model_reset();
+	if (!monitor_start(&r, PERIOD_US, false, NULL, NULL))
+		return;
+
+	run_for(&r, 2 * PERIOD_US);
+	SIM_TEST_CHECK(stats_get(&r).link_up);
+	base = lane_errors(1);
+
+	lane_errors_set(1, ERR_PERIOD_US);
+	run_for(&r, RATE_SAMPLES * PERIOD_US);
+	lane = lane_get(&r, 1);
+	printf("rate: %"PRIu32" errors / 1000 s after %d samples, injected %d\n",
+	       lane.error_rate, RATE_SAMPLES, ERR_RATE);
+	SIM_TEST_CHECK(lane.error_rate >= ERR_RATE - ERR_RATE / 20);
+	SIM_TEST_CHECK(lane.error_rate <= ERR_RATE + ERR_RATE / 20);
+	SIM_TEST_CHECK(lane_get(&r, 0).error_rate == 0);
+	SIM_TEST_CHECK(lane_get(&r, 0).errors == 0);
+
+	lane_errors_set(1, 0);
+	run_for(&r, 2 * PERIOD_US);
+	lane = lane_get(&r, 1);
+	SIM_TEST_CHECK(lane.errors == lane_errors(1) - base);
+	SIM_TEST_CHECK(lane.errors >= RATE_SAMPLES * (PERIOD_US / ERR_PERIOD_US));
+
+	/* One sample when enabled, then one per period */
+	samples = stats_get(&r).samples;
+	SIM_TEST_CHECK(samples == RATE_SAMPLES + 5);
+
+	run_for(&r, DECAY_SAMPLES * PERIOD_US);
+	SIM_TEST_CHECK(lane_get(&r, 1).error_rate == 0);
+	SIM_TEST_CHECK(lane_get(&r, 1).errors == lane_errors(1) - base);
+
+	monitor_stop(&r);
+}
+
+/**
+ * @brief The error counters are not accounted while the link is down and
+ * are re-baselined when it gets back to the DATA state.
+ */
+static void test_rebaseline(void)
+{
+	struct jesd204_rx_monitor_stats stats;
+	struct monitor_run r;
+
+	model_reset();
+	if (!monitor_start(&r, PERIOD_US, false, NULL, NULL))
+		return;
+
+	run_for(&r, 2 * PERIOD_US);
+	SIM_TEST_CHECK(stats_get(&r).link_up);
+
+	/* Errors while the link is down are not counted */
+	model.link_status = AXI_JESD204_RX_LINK_STATUS_CGS;
+	run_for(&r, PERIOD_US);
+	model.err_base[0] += 1000;
+	run_for(&r, 2 * PERIOD_US);
+	stats = stats_get(&r);
+	SIM_TEST_CHECK(!stats.link_up);
+	SIM_TEST_CHECK(stats.link_status == AXI_JESD204_RX_LINK_STATUS_CGS);
+	SIM_TEST_CHECK(stats.link_down_events == 1);
+	SIM_TEST_CHECK(stats.last_down_ns != 0);
+	SIM_TEST_CHECK(lane_get(&r, 0).errors == 0);
+	SIM_TEST_CHECK(lane_get(&r, 0).last_count == 1000);
+
+	/* Nor the jump seen when it is back up */
+	model.err_base[0] += 1000;
+	model.link_status = AXI_JESD204_RX_LINK_STATUS_DATA;
+	run_for(&r, 2 * PERIOD_US);
+	stats = stats_get(&r);
+	SIM_TEST_CHECK(stats.link_up);
+	SIM_TEST_CHECK(stats.up_since_ns > stats.last_down_ns);
+	SIM_TEST_CHECK(lane_get(&r, 0).errors == 0);
+	SIM_TEST_CHECK(lane_get(&r, 0).error_rate == 0);
+
+	/* A counter that restarted from zero counts from zero */
+	model.err_base[0] = 5;
+	run_for(&r, 2 * PERIOD_US);
+	SIM_TEST_CHECK(lane_get(&r, 0).errors == 5);
+	SIM_TEST_CHECK(stats_get(&r).link_down_events == 1);
+
+	monitor_stop(&r);
+}
+
+/**
+ * @brief A lane back in CGS while the link is up counts one desync per
+ * sample, without restarting the link if not asked to.
+ */
+static void test_desync(void)
+{
+	struct jesd204_rx_monitor_stats stats;
+	struct monitor_run r;
+	uint32_t samples;
+
+	model_reset();
+	if (!monitor_start(&r, PERIOD_US, false, NULL, NULL))
+		return;
+
+	run_for(&r, 2 * PERIOD_US);
+	SIM_TEST_CHECK(stats_get(&r).lane_desync_events == 0);
+
+	samples = stats_get(&r).samples;
+	model.lane_status[2] = AXI_JESD204_RX_LANE_STATUS_CGS_INIT;
+	run_for(&r, 3 * PERIOD_US);
+	stats = stats_get(&r);
+	SIM_TEST_CHECK(stats.samples - samples == 3);
+	SIM_TEST_CHECK(stats.lane_desync_events == 3);
+	SIM_TEST_CHECK(stats.link_up);
+	SIM_TEST_CHECK(stats.reinits == 0);
+	SIM_TEST_CHECK(model.restarts == 0);
+
+	model.lane_status[2] = LANE_STATUS_DATA;
+	run_for(&r, 2 * PERIOD_US);
+	SIM_TEST_CHECK(stats_get(&r).lane_desync_events == 3);
+
+	monitor_stop(&r);
+}
+
+static int32_t reinit_record(void *ctx)
+{
+	struct reinit_log *log = ctx;
+
+	if (log->calls < ARRAY_SIZE(log->ns))
+		log->ns[log->calls] = sim_time_ns();
+	log->calls++;
+
+	return FAILURE;
+}
+
+/**
+ * @brief Automatic re-initialization: not before the link was up once, then
+ * at most once per holdoff time while the link is down, and on a desync.
+ * Without a callback, the link is restarted through the core.
+ */
+static void test_reinit_holdoff(void)
+{
+	struct jesd204_rx_monitor_stats stats;
+	struct reinit_log log = {0};
+	struct monitor_run r;
+	uint64_t gap_ns;
+	uint32_t i, calls;
+
+	model_reset();
+	model.link_status = AXI_JESD204_RX_LINK_STATUS_CGS;
+	if (!monitor_start(&r, REINIT_PERIOD_US, true, reinit_record, &log))
+		return;
+
+	/* Never up yet */
+	run_for(&r, 5 * REINIT_PERIOD_US);
+	SIM_TEST_CHECK(log.calls == 0);
+
+	model.link_status = AXI_JESD204_RX_LINK_STATUS_DATA;
+	run_for(&r, 2 * REINIT_PERIOD_US);
+	SIM_TEST_CHECK(stats_get(&r).link_up);
+
+	/* Down for 3.5 holdoff times */
+	model.link_status = AXI_JESD204_RX_LINK_STATUS_CGS;
+	run_for(&r, JESD204_RX_MONITOR_REINIT_HOLDOFF_US * 7 / 2);
+	stats = stats_get(&r);
+	printf("reinit: %"PRIu32" restarts in 3.5 holdoff times\n", log.calls);
+	SIM_TEST_CHECK(log.calls >= 3 && log.calls <= 4);
+	SIM_TEST_CHECK(stats.reinits == log.calls);
+	SIM_TEST_CHECK(stats.reinit_errors == log.calls);
+	SIM_TEST_CHECK(stats.link_down_events == 1);
+	for (i = 1; i < log.calls; i++) {
+		gap_ns = log.ns[i] - log.ns[i - 1];
+		SIM_TEST_CHECK(gap_ns >= JESD204_RX_MONITOR_REINIT_HOLDOFF_US *
+			       1000ULL);
+		SIM_TEST_CHECK(gap_ns <= (JESD204_RX_MONITOR_REINIT_HOLDOFF_US +
+					  REINIT_PERIOD_US + PASS_US) * 1000ULL);
+	}
+
+	/* Back up past the holdoff time, then a lane desync */
+	model.link_status = AXI_JESD204_RX_LINK_STATUS_DATA;
+	run_for(&r, JESD204_RX_MONITOR_REINIT_HOLDOFF_US);
+	calls = log.calls;
+	SIM_TEST_CHECK(stats_get(&r).link_up);
+	model.lane_status[3] = AXI_JESD204_RX_LANE_STATUS_CGS_INIT;
+	run_for(&r, REINIT_PERIOD_US);
+	stats = stats_get(&r);
+	SIM_TEST_CHECK(log.calls == calls + 1);
+	SIM_TEST_CHECK(stats.lane_desync_events == 1);
+	SIM_TEST_CHECK(stats.link_down_events == 2);
+	SIM_TEST_CHECK(model.restarts == 0);
+
+	monitor_stop(&r);
+
+	/* Default restart, through the core link disable */
+	model_reset();
+	if (!monitor_start(&r, REINIT_PERIOD_US, true, NULL, NULL))
+		return;
+	run_for(&r, 2 * REINIT_PERIOD_US);
+	model.link_status = AXI_JESD204_RX_LINK_STATUS_CGS;
+	run_for(&r, REINIT_PERIOD_US);
+	stats = stats_get(&r);
+	SIM_TEST_CHECK(stats.reinits == 1);
+	SIM_TEST_CHECK(stats.reinit_errors == 0);
+	SIM_TEST_CHECK(model.restarts == 1);
+	SIM_TEST_CHECK(model.link_disabled == 0);
+
+	monitor_stop(&r);
+}
+
+/**
+ * @brief Sample a simulated JESD204 RX core from the monitor scheduler task.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	struct timer_init_param timer_param = { .freq_hz = TIMER_FREQ_HZ };
+
+	model.model = (struct sim_axi_model) {
+		.base = JESD_BASE,
+		.size = 0x1000,
+		.read = jesd_model_read,
+		.write = jesd_model_write,
+		.priv = &model,
+	};
+	if (!SIM_TEST_CHECK(sim_axi_register(&model.model) == SUCCESS))
+		return sim_test_result("jesd204_rx_monitor_test");
+
+	if (!SIM_TEST_CHECK(timer_init(&timer, &timer_param) == SUCCESS))
+		return sim_test_result("jesd204_rx_monitor_test");
+	timer_start(timer);
+	SIM_TEST_CHECK(timestamp_init(timer) == SUCCESS);
+
+	test_rate();
+	test_rebaseline();
+	test_desync();
+	test_reinit_holdoff();
+
+	timer_remove(timer);
+	sim_axi_unregister(&model.model);
+
+	return sim_test_result("jesd204_rx_monitor_test");
+}
@@ -0,0 +1,385 @@
+/***************************************************************************//**
+ *   @file   scheduler_test.c
+ *   @brief  Cooperative scheduler test on the simulated platform.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "error.h"
+#include "delay.h"
+#include "timer.h"
+#include "irq.h"
+#include "irq_extra.h"
+#include "scheduler.h"
+#include "sim.h"
+#include "sim_test.h"
+#include "ad9361_sim.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Scheduler time base frequency (Hz) */
+#define TIMER_FREQ_HZ		100000000
+/* Simulated time between two scheduler passes (us) */
+#define PASS_US			10
+/* Interrupt line of the simulated event source */
+#define EVENT_IRQ		5
+/* Event flags */
+#define EVENT_RX		(1 << 0)
+#define EVENT_TX		(1 << 1)
+/* TASK_POLL() period and timeout (us) */
+#define POLL_PERIOD_US		100
+#define POLL_TIMEOUT_US		1000
+/* REG_CALIBRATION_CTRL bit of the BB DC offset calibration */
+#define BBDC_CAL_BIT		0
+/* Ticker task period (us) */
+#define TICK_US			100
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* Task sleeping once, records when it woke up */
+struct sleeper {
+	uint32_t	id;
+	uint32_t	sleep_us;
+	uint64_t	woke_ns;
+};
+
+/* Task polling a condition that becomes true at ready_ns */
+struct poller {
+	uint64_t	ready_ns;
+	uint32_t	evals;
+	int32_t		ret;
+	uint64_t	end_ns;
+};
+
+/* Task waiting for an event */
+struct waiter {
+	struct sched_event	*ev;
+	uint32_t		mask;
+	bool			done;
+};
+
+/* Event source, the interrupt handler sets mask */
+struct event_source {
+	struct sched_event	ev;
+	uint32_t		mask;
+};
+
+/* Task running periodically until stop is set */
+struct ticker {
+	bool		stop;
+	uint32_t	ticks;
+};
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+static uint32_t wake_order[3];
+static uint32_t nb_woken;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Run the tasks, advancing the simulated time between the passes.
+ * @param sched - The scheduler.
+ * @return SUCCESS if all tasks succeeded, the first task error otherwise.
+ */
+static int32_t run_tasks(struct scheduler *sched)
+{
+	sched->error = SUCCESS;
+	while (scheduler_run_once(sched))
+		udelay(PASS_US);
+
+	return sched->error;
+}
+
+static int32_t sleeper_task(struct sched_task *t, void *ctx)
+{
+	struct sleeper *s = ctx;
+
+	TASK_BEGIN(t);
+	TASK_SLEEP_US(t, s->sleep_us);
+	s->woke_ns = sched_task_now(t);
+	wake_order[nb_woken++] = s->id;
+	TASK_END(t);
+}
+
+static bool poller_ready(struct sched_task *t, struct poller *p)
+{
+	p->evals++;
+
+	return sched_task_now(t) >= p->ready_ns;
+}
+
+static int32_t poller_task(struct sched_task *t, void *ctx)
+{
+	struct poller *p = ctx;
+
+	TASK_BEGIN(t);
+	TASK_POLL(t, poller_ready(t, p), POLL_PERIOD_US, POLL_TIMEOUT_US,
+		  p->ret);
+	p->end_ns = sched_task_now(t);
+	TASK_END(t);
+}
+
+static int32_t waiter_task(struct sched_task *t, void *ctx)
+{
+	struct waiter *w = ctx;
+
+	TASK_BEGIN(t);
+	TASK_WAIT_EVENT(t, w->ev, w->mask);
+	w->done = true;
+	TASK_END(t);
+}
+
+static int32_t ticker_task(struct sched_task *t, void *ctx)
+{
+	struct ticker *k = ctx;
+
+	TASK_BEGIN(t);
+	while (!k->stop) {
+		k->ticks++;
+		TASK_SLEEP_US(t, TICK_US);
+	}
+	TASK_END(t);
+}
+
+static int32_t cal_task(struct sched_task *t, void *ctx)
+{
+	struct ad9361_cal_wait *w = ctx;
+
+	return ad9361_check_cal_done_task(t, w);
+}
+
+static void event_irq_handler(void *data)
+{
+	struct event_source *src = data;
+
+	sched_event_set(&src->ev, src->mask);
+}
+
+/**
+ * @brief Tasks sleeping for different durations wake up in order, after
+ * their sleep time and within one scheduler pass of it.
+ * @param sched - The scheduler.
+ */
+static void test_sleep_order(struct scheduler *sched)
+{
+	struct sleeper s[3] = {
+		{ .id = 0, .sleep_us = 300 },
+		{ .id = 1, .sleep_us = 100 },
+		{ .id = 2, .sleep_us = 200 },
+	};
+	struct sched_task tasks[3] = { 0 };
+	uint64_t start_ns;
+	uint32_t i;
+
+	nb_woken = 0;
+	start_ns = scheduler_now(sched);
+	for (i = 0; i < 3; i++)
+		scheduler_task_add(sched, &tasks[i], sleeper_task, &s[i]);
+
+	SIM_TEST_CHECK(run_tasks(sched) == SUCCESS);
+	SIM_TEST_CHECK(nb_woken == 3);
+	SIM_TEST_CHECK(wake_order[0] == 1);
+	SIM_TEST_CHECK(wake_order[1] == 2);
+	SIM_TEST_CHECK(wake_order[2] == 0);
+	for (i = 0; i < 3; i++) {
+		SIM_TEST_CHECK(s[i].woke_ns - start_ns >= s[i].sleep_us * 1000ull);
+		SIM_TEST_CHECK(s[i].woke_ns - start_ns <
+			       (s[i].sleep_us + PASS_US) * 1000ull);
+		SIM_TEST_CHECK(!tasks[i].active);
+	}
+}
+
+/**
+ * @brief TASK_POLL() ends with FAILURE once the timeout elapsed, and with
+ * SUCCESS within one period of the condition becoming true.
+ * @param sched - The scheduler.
+ */
+static void test_poll(struct scheduler *sched)
+{
+	struct poller never = { .ready_ns = UINT64_MAX, .ret = -1 };
+	struct poller later = { .ret = -1 };
+	struct sched_task tasks[2] = { 0 };
+	uint64_t start_ns;
+
+	start_ns = scheduler_now(sched);
+	later.ready_ns = start_ns + 450000;
+	scheduler_task_add(sched, &tasks[0], poller_task, &never);
+	scheduler_task_add(sched, &tasks[1], poller_task, &later);
+
+	SIM_TEST_CHECK(run_tasks(sched) == SUCCESS);
+
+	printf("poll timeout after %"PRIu64" us, %"PRIu32" evaluations\n",
+	       (never.end_ns - start_ns) / 1000, never.evals);
+	SIM_TEST_CHECK(never.ret == FAILURE);
+	SIM_TEST_CHECK(never.end_ns - start_ns >= POLL_TIMEOUT_US * 1000ull);
+	SIM_TEST_CHECK(never.end_ns - start_ns <
+		       (POLL_TIMEOUT_US + POLL_PERIOD_US + PASS_US) * 1000ull);
+	SIM_TEST_CHECK(never.evals <= POLL_TIMEOUT_US / POLL_PERIOD_US + 2);
+
+	SIM_TEST_CHECK(later.ret == SUCCESS);
+	SIM_TEST_CHECK(later.end_ns >= later.ready_ns);
+	SIM_TEST_CHECK(later.end_ns - later.ready_ns <
+		       (POLL_PERIOD_US + PASS_US) * 1000ull);
+}
+
+/**
+ * @brief A task waiting for an event is woken by the flag set from an
+ * interrupt handler, other flags do not wake it and are left pending.
+ * @param sched - The scheduler.
+ */
+static void test_irq_event(struct scheduler *sched)
+{
+	struct irq_init_param irq_param = { 0 };
+	struct event_source src = { 0 };
+	struct waiter w = { .ev = &src.ev, .mask = EVENT_RX };
+	struct sched_task task = { 0 };
+	struct irq_desc *irq;
+	uint32_t i;
+
+	if (!SIM_TEST_CHECK(irq_ctrl_init(&irq, &irq_param) == SUCCESS))
+		return;
+	irq_register(irq, EVENT_IRQ, event_irq_handler, &src);
+	irq_source_enable(irq, EVENT_IRQ);
+	irq_global_enable(irq);
+
+	scheduler_task_add(sched, &task, waiter_task, &w);
+	for (i = 0; i < 3; i++)
+		SIM_TEST_CHECK(scheduler_run_once(sched) == 1);
+
+	src.mask = EVENT_TX;
+	sim_irq_trigger(irq, EVENT_IRQ);
+	SIM_TEST_CHECK(scheduler_run_once(sched) == 1);
+	SIM_TEST_CHECK(!w.done);
+
+	src.mask = EVENT_RX;
+	sim_irq_trigger(irq, EVENT_IRQ);
+	SIM_TEST_CHECK(scheduler_run_once(sched) == 0);
+	SIM_TEST_CHECK(w.done);
+	SIM_TEST_CHECK(task.ret == SUCCESS);
+	SIM_TEST_CHECK(src.ev.flags == EVENT_TX);
+
+	irq_ctrl_remove(irq);
+}
+
+/**
+ * @brief ad9361_check_cal_done_task() waits for a calibration while another
+ * task keeps running.
+ * @param sched - The scheduler.
+ */
+static void test_ad9361_cal(struct scheduler *sched)
+{
+	struct ad9361_sim sim;
+	struct ad9361_rf_phy *phy;
+	struct ad9361_cal_wait w = { 0 };
+	struct ticker k = { 0 };
+	struct sched_task tasks[2] = { 0 };
+	uint64_t cal_ns, start_ns;
+
+	if (!SIM_TEST_CHECK(ad9361_sim_init(&sim, &phy) == SUCCESS))
+		return;
+
+	cal_ns = sim.dev->cal_time_ns[BBDC_CAL_BIT];
+	w.phy = phy;
+	w.reg = REG_CALIBRATION_CTRL;
+	w.mask = BBDC_CAL;
+	w.done_state = 0;
+
+	start_ns = scheduler_now(sched);
+	ad9361_spi_write(phy->spi, REG_CALIBRATION_CTRL, BBDC_CAL);
+	scheduler_task_add(sched, &tasks[0], cal_task, &w);
+	scheduler_task_add(sched, &tasks[1], ticker_task, &k);
+	while (tasks[0].active) {
+		scheduler_run_once(sched);
+		udelay(PASS_US);
+	}
+	k.stop = true;
+	run_tasks(sched);
+
+	printf("BB DC cal %"PRIu64" us, waited %"PRIu64" us, %"PRIu32" ticks\n",
+	       cal_ns / 1000, (scheduler_now(sched) - start_ns) / 1000,
+	       k.ticks);
+	SIM_TEST_CHECK(w.ret == 0);
+	SIM_TEST_CHECK(tasks[0].ret == SUCCESS);
+	SIM_TEST_CHECK(!(ad9361_spi_read(phy->spi, REG_CALIBRATION_CTRL) &
+			 BBDC_CAL));
+	SIM_TEST_CHECK(k.ticks >= cal_ns / 1000 / (TICK_US + PASS_US));
+
+	ad9361_sim_remove(&sim);
+}
+
+/**
+ * @brief Run the scheduler tests.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+	struct timer_init_param timer_param = { .freq_hz = TIMER_FREQ_HZ };
+	struct scheduler_init_param param;
+	struct scheduler *sched;
+	struct timer_desc *timer;
+
+	if (!SIM_TEST_CHECK(timer_init(&timer, &timer_param) == SUCCESS))
+		return sim_test_result("scheduler_test");
+	timer_start(timer);
+
+	param.timer = timer;
+	if (!SIM_TEST_CHECK(scheduler_init(&sched, &param) == SUCCESS))
+		return sim_test_result("scheduler_test");
+
+	test_sleep_order(sched);
+	test_poll(sched);
+	test_irq_event(sched);
+	test_ad9361_cal(sched);
+
+	scheduler_remove(sched);
+	timer_remove(timer);
+
+	return sim_test_result("scheduler_test");
+}
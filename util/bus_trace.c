@@ -0,0 +1,459 @@
+/***************************************************************************//**
+ *   @file   bus_trace.c
+ *   @brief  Bus transaction tracing of SPI, AXI and delay calls.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifdef BUS_TRACE
+
+/* Use the plain platform functions in this file. */
+#define BUS_TRACE_IMPL
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "spi.h"
+#include "axi_io.h"
+#include "delay.h"
+#include "timestamp.h"
+#include "bus_trace.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct bus_trace_state
+ * @brief Tracer state.
+ */
+struct bus_trace_state {
+	/** Time base */
+	struct timestamp_counter clock;
+	/** Active boot phase */
+	const char		*phase;
+	/** Trace ring */
+	struct bus_trace_event	ring[BUS_TRACE_RING_SIZE];
+	/** Total number of events recorded */
+	uint32_t		nb_events;
+	/** Call site statistics, hashed by function and line */
+	struct bus_trace_site	sites[BUS_TRACE_MAX_SITES];
+	/** Number of used entries in sites */
+	uint32_t		nb_sites;
+	/** Calls whose site did not fit in the statistics table */
+	uint32_t		dropped;
+};
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+static struct bus_trace_state bus_trace;
+
+static const char *const bus_trace_type_name[BUS_TRACE_TYPE_NUM] = {
+	[BUS_TRACE_SPI] = "spi",
+	[BUS_TRACE_AXI_READ] = "axi rd",
+	[BUS_TRACE_AXI_WRITE] = "axi wr",
+	[BUS_TRACE_DELAY] = "delay",
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Get the time elapsed since bus_trace_init().
+ * @return Time in nanoseconds, 0 if no time base is set.
+ */
+static uint64_t bus_trace_now(void)
+{
+	return timestamp_counter_ns(&bus_trace.clock);
+}
+
+/**
+ * @brief Find or allocate the statistics entry of a call site.
+ * @param func - Calling function.
+ * @param line - Calling line.
+ * @param type - Traced operation.
+ * @return The entry, NULL if the table is full.
+ */
+static struct bus_trace_site *bus_trace_site_get(const char *func,
+		uint32_t line,
+		enum bus_trace_type type)
+{
+	struct bus_trace_site *site;
+	uint32_t i, h;
+
+	h = (uint32_t)((uintptr_t)func ^ (line * 31) ^ type);
+	for (i = 0; i < BUS_TRACE_MAX_SITES; i++) {
+		site = &bus_trace.sites[(h + i) % BUS_TRACE_MAX_SITES];
+		if (!site->func) {
+			site->func = func;
+			site->line = line;
+			site->type = type;
+			bus_trace.nb_sites++;
+			return site;
+		}
+		if (site->func == func && site->line == line &&
+		    site->type == type)
+			return site;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Record one traced operation.
+ * @param func - Calling function.
+ * @param line - Calling line.
+ * @param type - Traced operation.
+ * @param bytes - Bytes transferred, or requested delay in microseconds.
+ * @param start_ns - Start of the operation.
+ */
+static void bus_trace_record(const char *func, uint32_t line,
+			     enum bus_trace_type type, uint32_t bytes,
+			     uint64_t start_ns)
+{
+	struct bus_trace_event *ev;
+	struct bus_trace_site *site;
+	uint64_t end_ns;
+
+	end_ns = bus_trace_now();
+
+	ev = &bus_trace.ring[bus_trace.nb_events % BUS_TRACE_RING_SIZE];
+	ev->func = func;
+	ev->line = line;
+	ev->type = type;
+	ev->bytes = bytes;
+	ev->start_ns = start_ns;
+	ev->elapsed_ns = end_ns - start_ns;
+	ev->phase = bus_trace.phase;
+	bus_trace.nb_events++;
+
+	site = bus_trace_site_get(func, line, type);
+	if (!site) {
+		bus_trace.dropped++;
+		return;
+	}
+
+	if (!site->count)
+		site->first_ns = start_ns;
+	site->count++;
+	site->bytes += bytes;
+	site->time_ns += end_ns - start_ns;
+	site->last_ns = end_ns;
+}
+
+/**
+ * @brief Start tracing, using an up-counting timer as time base.
+ *
+ * The timer must be started by the caller and must not wrap more than once
+ * between two traced calls. Without a timer only counts and bytes are
+ * recorded.
+ * @param timer - Time base, may be NULL.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t bus_trace_init(struct timer_desc *timer)
+{
+	static bool registered;
+
+	bus_trace_reset();
+	if (timestamp_counter_init(&bus_trace.clock, timer) != SUCCESS)
+		return FAILURE;
+
+	if (!registered) {
+		if (atexit(bus_trace_report))
+			return FAILURE;
+		registered = true;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Clear the trace ring and the call site statistics.
+ */
+void bus_trace_reset(void)
+{
+	struct timestamp_counter clock = bus_trace.clock;
+
+	memset(&bus_trace, 0, sizeof(bus_trace));
+	bus_trace.clock = clock;
+}
+
+/**
+ * @brief Tag the following bus accesses with a boot phase name.
+ * @param name - Phase name, must stay valid while tracing. NULL ends the
+ *               current phase.
+ */
+void bus_trace_phase(const char *name)
+{
+	bus_trace.phase = name;
+}
+
+/**
+ * @brief Get the accumulated statistics of all call sites.
+ *
+ * The table is hashed, unused entries have a NULL func.
+ * @param nb_sites - Number of entries in the returned table.
+ * @return The statistics table.
+ */
+const struct bus_trace_site *bus_trace_sites(uint32_t *nb_sites)
+{
+	*nb_sites = BUS_TRACE_MAX_SITES;
+
+	return bus_trace.sites;
+}
+
+/**
+ * @brief Get an event from the trace ring, 0 being the oldest one kept.
+ * @param index - Event index.
+ * @return The event, NULL if index is out of range.
+ */
+const struct bus_trace_event *bus_trace_event_get(uint32_t index)
+{
+	uint32_t kept, first;
+
+	kept = bus_trace.nb_events < BUS_TRACE_RING_SIZE ?
+	       bus_trace.nb_events : BUS_TRACE_RING_SIZE;
+	if (index >= kept)
+		return NULL;
+
+	first = bus_trace.nb_events - kept;
+
+	return &bus_trace.ring[(first + index) % BUS_TRACE_RING_SIZE];
+}
+
+/**
+ * @brief Order call sites by function first appearance, then by line.
+ * @param a - First site.
+ * @param b - Second site.
+ * @return Negative, zero or positive, as required by qsort().
+ */
+static int bus_trace_site_cmp(const void *a, const void *b)
+{
+	const struct bus_trace_site *sa = *(const struct bus_trace_site **)a;
+	const struct bus_trace_site *sb = *(const struct bus_trace_site **)b;
+
+	if (sa->first_ns != sb->first_ns)
+		return sa->first_ns < sb->first_ns ? -1 : 1;
+	if (sa->line != sb->line)
+		return sa->line < sb->line ? -1 : 1;
+
+	return sa->type - sb->type;
+}
+
+/**
+ * @brief Print the per-function timeline and the per-call-site statistics.
+ *
+ * Functions are listed in the order they first accessed the bus, with the
+ * span between their first and last access and the time spent in each kind
+ * of operation.
+ */
+void bus_trace_report(void)
+{
+	const struct bus_trace_site *order[BUS_TRACE_MAX_SITES];
+	const struct bus_trace_site *s;
+	uint64_t first, last, t[BUS_TRACE_TYPE_NUM];
+	uint32_t n[BUS_TRACE_TYPE_NUM];
+	uint32_t i, j, k, nb = 0;
+	bool done[BUS_TRACE_MAX_SITES] = { false };
+
+	for (i = 0; i < BUS_TRACE_MAX_SITES; i++)
+		if (bus_trace.sites[i].func)
+			order[nb++] = &bus_trace.sites[i];
+	qsort(order, nb, sizeof(order[0]), bus_trace_site_cmp);
+
+	printf("bus trace: %"PRIu32" calls, %"PRIu32" sites, %"PRIu32
+	       " dropped\n", bus_trace.nb_events, nb, bus_trace.dropped);
+	printf("%12s %12s  %-32s %8s %8s %8s %8s %12s\n", "start(us)",
+	       "span(us)", "function", "spi", "axi rd", "axi wr", "delay",
+	       "busy(us)");
+
+	for (i = 0; i < nb; i++) {
+		if (done[i])
+			continue;
+
+		first = order[i]->first_ns;
+		last = order[i]->last_ns;
+		memset(n, 0, sizeof(n));
+		memset(t, 0, sizeof(t));
+		for (j = i; j < nb; j++) {
+			s = order[j];
+			if (done[j] || strcmp(s->func, order[i]->func))
+				continue;
+			done[j] = true;
+			if (s->last_ns > last)
+				last = s->last_ns;
+			n[s->type] += s->count;
+			t[s->type] += s->time_ns;
+		}
+
+		for (k = 1; k < BUS_TRACE_TYPE_NUM; k++)
+			t[0] += t[k];
+		printf("%12"PRIu64" %12"PRIu64"  %-32s %8"PRIu32" %8"PRIu32
+		       " %8"PRIu32" %8"PRIu32" %12"PRIu64"\n", first / 1000,
+		       (last - first) / 1000, order[i]->func,
+		       n[BUS_TRACE_SPI], n[BUS_TRACE_AXI_READ],
+		       n[BUS_TRACE_AXI_WRITE], n[BUS_TRACE_DELAY], t[0] / 1000);
+	}
+
+	/* The size of a delay is the requested time, of the others the data */
+	printf("\n%-32s %6s %-6s %8s %12s %12s\n", "call site", "line", "op",
+	       "calls", "size", "time(us)");
+	printf("size: bytes for spi, axi rd and axi wr; us for delay\n");
+	for (i = 0; i < nb; i++) {
+		s = order[i];
+		printf("%-32s %6"PRIu32" %-6s %8"PRIu32" %12"PRIu64" %12"PRIu64
+		       "\n", s->func, s->line, bus_trace_type_name[s->type],
+		       s->count, s->bytes, s->time_ns / 1000);
+	}
+}
+
+/**
+ * @brief Print the events kept in the trace ring.
+ */
+void bus_trace_dump(void)
+{
+	const struct bus_trace_event *ev;
+	uint32_t i;
+
+	for (i = 0; (ev = bus_trace_event_get(i)); i++)
+		printf("%12"PRIu64" %8"PRIu32" %-6s %6"PRIu32" %s:%"PRIu32
+		       " %s\n", ev->start_ns / 1000, ev->elapsed_ns / 1000,
+		       bus_trace_type_name[ev->type], ev->bytes, ev->func,
+		       ev->line, ev->phase ? ev->phase : "");
+}
+
+/**
+ * @brief Traced spi_write_and_read().
+ * @param desc - The SPI descriptor.
+ * @param data - The buffer with the transmitted/received data.
+ * @param bytes_number - Number of bytes to write/read.
+ * @param func - Calling function.
+ * @param line - Calling line.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t bus_trace_spi_write_and_read(struct spi_desc *desc, uint8_t *data,
+				     uint16_t bytes_number,
+				     const char *func, uint32_t line)
+{
+	uint64_t start = bus_trace_now();
+	int32_t ret;
+
+	ret = spi_write_and_read(desc, data, bytes_number);
+	bus_trace_record(func, line, BUS_TRACE_SPI, bytes_number, start);
+
+	return ret;
+}
+
+/**
+ * @brief Traced axi_io_read().
+ * @param base - Base address.
+ * @param offset - Register offset.
+ * @param data - Register value.
+ * @param func - Calling function.
+ * @param line - Calling line.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t bus_trace_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data,
+			      const char *func, uint32_t line)
+{
+	uint64_t start = bus_trace_now();
+	int32_t ret;
+
+	ret = axi_io_read(base, offset, data);
+	bus_trace_record(func, line, BUS_TRACE_AXI_READ, 4, start);
+
+	return ret;
+}
+
+/**
+ * @brief Traced axi_io_write().
+ * @param base - Base address.
+ * @param offset - Register offset.
+ * @param data - Register value.
+ * @param func - Calling function.
+ * @param line - Calling line.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t bus_trace_axi_io_write(uint32_t base, uint32_t offset, uint32_t data,
+			       const char *func, uint32_t line)
+{
+	uint64_t start = bus_trace_now();
+	int32_t ret;
+
+	ret = axi_io_write(base, offset, data);
+	bus_trace_record(func, line, BUS_TRACE_AXI_WRITE, 4, start);
+
+	return ret;
+}
+
+/**
+ * @brief Traced udelay().
+ * @param usecs - Delay in microseconds.
+ * @param func - Calling function.
+ * @param line - Calling line.
+ */
+void bus_trace_udelay(uint32_t usecs, const char *func, uint32_t line)
+{
+	uint64_t start = bus_trace_now();
+
+	udelay(usecs);
+	bus_trace_record(func, line, BUS_TRACE_DELAY, usecs, start);
+}
+
+/**
+ * @brief Traced mdelay().
+ * @param msecs - Delay in milliseconds.
+ * @param func - Calling function.
+ * @param line - Calling line.
+ */
+void bus_trace_mdelay(uint32_t msecs, const char *func, uint32_t line)
+{
+	uint64_t start = bus_trace_now();
+
+	mdelay(msecs);
+	bus_trace_record(func, line, BUS_TRACE_DELAY, msecs * 1000, start);
+}
+
+#endif // BUS_TRACE
@@ -0,0 +1,147 @@
+/***************************************************************************//**
+ *   @file   profile.c
+ *   @brief  Code section timing with latency histograms.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "profile.h"
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+/** Sections timed so far */
+static struct prof_section *prof_sections;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Get the histogram bin of a duration.
+ * @param ns - Duration.
+ * @return Index of the highest bit set, clamped to the histogram size.
+ */
+static uint32_t prof_bin(uint64_t ns)
+{
+	uint32_t bin = 0;
+
+	while (ns >>= 1)
+		bin++;
+
+	return bin < PROF_HIST_BINS ? bin : PROF_HIST_BINS - 1;
+}
+
+/**
+ * @brief Account one run of a section.
+ * @param sec - The section.
+ * @param elapsed_ns - Run time.
+ */
+void prof_section_add(struct prof_section *sec, uint64_t elapsed_ns)
+{
+	if (!sec->listed) {
+		sec->listed = true;
+		sec->next = prof_sections;
+		prof_sections = sec;
+	}
+
+	if (!sec->count || elapsed_ns < sec->min_ns)
+		sec->min_ns = elapsed_ns;
+	if (elapsed_ns > sec->max_ns)
+		sec->max_ns = elapsed_ns;
+	sec->total_ns += elapsed_ns;
+	sec->count++;
+	sec->hist[prof_bin(elapsed_ns)]++;
+}
+
+/**
+ * @brief Clear the statistics of a section.
+ * @param sec - The section.
+ */
+void prof_section_reset(struct prof_section *sec)
+{
+	sec->count = 0;
+	sec->total_ns = 0;
+	sec->min_ns = 0;
+	sec->max_ns = 0;
+	memset(sec->hist, 0, sizeof(sec->hist));
+}
+
+/**
+ * @brief End of a PROF_SCOPE() block.
+ * @param scope - The scope.
+ */
+void prof_scope_end(struct prof_scope *scope)
+{
+	prof_section_add(scope->section, timestamp_ns() - scope->start_ns);
+}
+
+/**
+ * @brief Print the statistics of every section timed so far.
+ *
+ * Times are printed in microseconds. Histogram bins are printed as
+ * "<upper bound in us>:<count>" for the non-empty bins.
+ */
+void prof_report(void)
+{
+	struct prof_section *sec;
+	uint32_t i;
+
+	printf("%-24s %10s %12s %12s %12s\n", "section", "count", "min(us)",
+	       "avg(us)", "max(us)");
+	for (sec = prof_sections; sec; sec = sec->next) {
+		if (!sec->count)
+			continue;
+
+		printf("%-24s %10"PRIu32" %12"PRIu64" %12"PRIu64" %12"PRIu64
+		       "\n", sec->name, sec->count, sec->min_ns / 1000,
+		       sec->total_ns / sec->count / 1000, sec->max_ns / 1000);
+		printf("  ");
+		for (i = 0; i < PROF_HIST_BINS; i++)
+			if (sec->hist[i])
+				printf(" <%"PRIu64":%"PRIu32,
+				       (uint64_t)((2ull << i) + 999) / 1000,
+				       sec->hist[i]);
+		printf("\n");
+	}
+}
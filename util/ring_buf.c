@@ -0,0 +1,185 @@
+/***************************************************************************//**
+ *   @file   ring_buf.c
+ *   @brief  Lock-free single-producer single-consumer byte ring buffer.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include "error.h"
+#include "ring_buf.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/*
+ * Order the data accesses against the index update, also across cores and
+ * against interrupt handlers.
+ */
+#define ring_buf_barrier()	__sync_synchronize()
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize a ring over caller provided storage.
+ * @param ring - The ring.
+ * @param buff - Storage of size bytes.
+ * @param size - Capacity, must be a power of two.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t ring_buf_init(struct ring_buf *ring, uint8_t *buff, uint32_t size)
+{
+	if (!ring || !buff || !size || (size & (size - 1)))
+		return FAILURE;
+
+	ring->buff = buff;
+	ring->size = size;
+	ring_buf_reset(ring);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Drop the ring contents and clear the overflow counters.
+ *
+ * Not to be used while the producer or the consumer may access the ring.
+ * @param ring - The ring.
+ */
+void ring_buf_reset(struct ring_buf *ring)
+{
+	ring->head = 0;
+	ring->tail = 0;
+	ring->overflow_count = 0;
+	ring->overflow_bytes = 0;
+}
+
+/**
+ * @brief Get the number of bytes available for reading.
+ * @param ring - The ring.
+ * @return Number of bytes.
+ */
+uint32_t ring_buf_level(struct ring_buf *ring)
+{
+	return ring->head - ring->tail;
+}
+
+/**
+ * @brief Get the number of bytes that can be written.
+ * @param ring - The ring.
+ * @return Number of bytes.
+ */
+uint32_t ring_buf_space(struct ring_buf *ring)
+{
+	return ring->size - (ring->head - ring->tail);
+}
+
+/**
+ * @brief Write bytes to the ring (producer side).
+ *
+ * Bytes that do not fit are dropped and accounted in the overflow counters.
+ * @param ring - The ring.
+ * @param data - Bytes to write.
+ * @param len - Number of bytes to write.
+ * @return Number of bytes written.
+ */
+uint32_t ring_buf_write(struct ring_buf *ring, const uint8_t *data,
+			uint32_t len)
+{
+	uint32_t head = ring->head;
+	uint32_t off = head & (ring->size - 1);
+	uint32_t n, first;
+
+	n = ring->size - (head - ring->tail);
+	if (len > n) {
+		ring->overflow_count++;
+		ring->overflow_bytes += len - n;
+	} else {
+		n = len;
+	}
+
+	first = ring->size - off;
+	if (first > n)
+		first = n;
+	memcpy(ring->buff + off, data, first);
+	memcpy(ring->buff, data + first, n - first);
+
+	/* Data must be visible before the consumer sees the new head */
+	ring_buf_barrier();
+	ring->head = head + n;
+
+	return n;
+}
+
+/**
+ * @brief Read bytes from the ring (consumer side).
+ * @param ring - The ring.
+ * @param data - Buffer for the read bytes.
+ * @param len - Maximum number of bytes to read.
+ * @return Number of bytes read, 0 if the ring is empty.
+ */
+uint32_t ring_buf_read(struct ring_buf *ring, uint8_t *data, uint32_t len)
+{
+	uint32_t tail = ring->tail;
+	uint32_t off = tail & (ring->size - 1);
+	uint32_t n, first;
+
+	n = ring->head - tail;
+	if (len < n)
+		n = len;
+	if (!n)
+		return 0;
+
+	/* Do not read the data before the head that covers it */
+	ring_buf_barrier();
+
+	first = ring->size - off;
+	if (first > n)
+		first = n;
+	memcpy(data, ring->buff + off, first);
+	memcpy(data + first, ring->buff, n - first);
+
+	/* The copy must be done before the producer may reuse the space */
+	ring_buf_barrier();
+	ring->tail = tail + n;
+
+	return n;
+}
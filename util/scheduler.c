@@ -0,0 +1,232 @@
+/***************************************************************************//**
+ *   @file   scheduler.c
+ *   @brief  Cooperative task scheduler and non-blocking wait primitives.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include "error.h"
+#include "timer.h"
+#include "timestamp.h"
+#include "scheduler.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize the scheduler.
+ * @param sched - The scheduler descriptor.
+ * @param param - The scheduler initialization parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t scheduler_init(struct scheduler **sched,
+		       struct scheduler_init_param *param)
+{
+	struct scheduler *s;
+
+	if (!param->timer || !param->timer->freq_hz)
+		return FAILURE;
+
+	s = (struct scheduler *)calloc(1, sizeof(*s));
+	if (!s)
+		return FAILURE;
+
+	if (timestamp_counter_init(&s->clock, param->timer) != SUCCESS) {
+		free(s);
+		return FAILURE;
+	}
+
+	*sched = s;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by scheduler_init().
+ * @param sched - The scheduler descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t scheduler_remove(struct scheduler *sched)
+{
+	if (!sched)
+		return FAILURE;
+
+	free(sched);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the time elapsed since scheduler_init().
+ *
+ * The time base must not wrap more than once between two calls.
+ * @param sched - The scheduler descriptor.
+ * @return Time in nanoseconds.
+ */
+uint64_t scheduler_now(struct scheduler *sched)
+{
+	return timestamp_counter_ns(&sched->clock);
+}
+
+/**
+ * @brief Add a task to the scheduler.
+ * @param sched - The scheduler descriptor.
+ * @param task - Task state, must stay valid until the task ends.
+ * @param run - Task body.
+ * @param ctx - Task context.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t scheduler_task_add(struct scheduler *sched, struct sched_task *task,
+			   sched_task_fn run, void *ctx)
+{
+	if (!sched || !task || !run || task->active)
+		return FAILURE;
+
+	task->run = run;
+	task->ctx = ctx;
+	task->resume = 0;
+	task->wake_ns = 0;
+	task->deadline_ns = 0;
+	task->ret = SUCCESS;
+	task->active = true;
+	task->sched = sched;
+	task->next = sched->tasks;
+	sched->tasks = task;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Run every ready task once.
+ *
+ * Tasks that are sleeping are skipped. Tasks that end are removed from the
+ * scheduler, their result is left in the ret field.
+ * @param sched - The scheduler descriptor.
+ * @return Number of tasks that did not end yet.
+ */
+uint32_t scheduler_run_once(struct scheduler *sched)
+{
+	struct sched_task **p = &sched->tasks;
+	struct sched_task *task;
+	uint32_t active = 0;
+	uint64_t now;
+	int32_t ret;
+
+	now = scheduler_now(sched);
+	while ((task = *p)) {
+		if (now < task->wake_ns) {
+			active++;
+			p = &task->next;
+			continue;
+		}
+
+		ret = task->run(task, task->ctx);
+		if (ret == TASK_WAITING) {
+			active++;
+			p = &task->next;
+			continue;
+		}
+
+		task->ret = ret < 0 ? ret : SUCCESS;
+		if (task->ret != SUCCESS && sched->error == SUCCESS)
+			sched->error = task->ret;
+		task->active = false;
+		*p = task->next;
+		task->next = NULL;
+	}
+
+	return active;
+}
+
+/**
+ * @brief Run the tasks until all of them ended.
+ * @param sched - The scheduler descriptor.
+ * @return SUCCESS if all tasks succeeded, the first task error otherwise.
+ */
+int32_t scheduler_run(struct scheduler *sched)
+{
+	sched->error = SUCCESS;
+	while (scheduler_run_once(sched))
+		;
+
+	return sched->error;
+}
+
+/**
+ * @brief Get the time elapsed since scheduler_init(), from a task.
+ * @param task - The task.
+ * @return Time in nanoseconds.
+ */
+uint64_t sched_task_now(struct sched_task *task)
+{
+	return scheduler_now(task->sched);
+}
+
+/**
+ * @brief Do not run the task for the given number of microseconds.
+ * @param task - The task.
+ * @param usecs - Sleep time.
+ */
+void sched_task_sleep(struct sched_task *task, uint32_t usecs)
+{
+	task->wake_ns = scheduler_now(task->sched) + (uint64_t)usecs * 1000;
+}
+
+/**
+ * @brief Set event flags. Can be called from interrupt handlers.
+ * @param ev - The event.
+ * @param mask - Flags to set.
+ */
+void sched_event_set(struct sched_event *ev, uint32_t mask)
+{
+	__sync_fetch_and_or(&ev->flags, mask);
+}
+
+/**
+ * @brief Clear and return the event flags selected by mask.
+ * @param ev - The event.
+ * @param mask - Flags to take.
+ * @return The flags that were set, 0 if none.
+ */
+uint32_t sched_event_take(struct sched_event *ev, uint32_t mask)
+{
+	return __sync_fetch_and_and(&ev->flags, ~mask) & mask;
+}
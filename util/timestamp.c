@@ -0,0 +1,185 @@
+/***************************************************************************//**
+ *   @file   timestamp.c
+ *   @brief  64-bit monotonic timestamps.
+ *   @author Andrei Drimbarean (andrei.drimbarean@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stddef.h>
+#include "error.h"
+#include "timer.h"
+#include "timestamp.h"
+#ifdef __linux__
+#include <time.h>
+#endif
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+/** Time base, no timer until timestamp_init() */
+static struct timestamp_counter timestamp_counter;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Start extending the counter of a timer to 64 bits.
+ *
+ * The timer must be started, count up and be read through
+ * timestamp_counter_ns() at least once per counter wrap period.
+ * @param tc - The counter state.
+ * @param timer - Time base, NULL if none.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t timestamp_counter_init(struct timestamp_counter *tc,
+			       struct timer_desc *timer)
+{
+	if (timer && !timer->freq_hz)
+		return FAILURE;
+
+	tc->timer = NULL;
+	tc->ticks = 0;
+	if (timer && timer_counter_get(timer, &tc->last_count) != SUCCESS)
+		return FAILURE;
+
+	tc->timer = timer;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the time elapsed since timestamp_counter_init().
+ *
+ * Not reentrant: do not use the same counter from both interrupt handlers
+ * and the main loop.
+ * @param tc - The counter state.
+ * @return Time in nanoseconds, 0 if there is no time base.
+ */
+uint64_t timestamp_counter_ns(struct timestamp_counter *tc)
+{
+	struct timer_desc *timer = tc->timer;
+	uint32_t count;
+
+	if (!timer)
+		return 0;
+
+	if (timer_counter_get(timer, &count) == SUCCESS) {
+		/* Unsigned difference handles the counter wrap */
+		tc->ticks += (uint32_t)(count - tc->last_count);
+		tc->last_count = count;
+	}
+
+	return (tc->ticks / timer->freq_hz) * 1000000000ull +
+	       (tc->ticks % timer->freq_hz) * 1000000000ull / timer->freq_hz;
+}
+
+/**
+ * @brief Select the timer used as time base.
+ *
+ * The timer must be started, count up and be read by timestamp_ns() at least
+ * once per counter wrap period. On Linux, CLOCK_MONOTONIC is used while no
+ * timer is selected.
+ * @param timer - Time base, NULL to release it.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t timestamp_init(struct timer_desc *timer)
+{
+	return timestamp_counter_init(&timestamp_counter, timer);
+}
+
+/**
+ * @brief Check if a time base is available.
+ *
+ * Without one, timestamp_ns() always returns 0. 0 is also a valid time, so
+ * callers must use this check rather than compare a reading against 0.
+ * @return true if timestamp_ns() measures time, false otherwise.
+ */
+bool timestamp_available(void)
+{
+#ifdef __linux__
+	return true;
+#else
+	return timestamp_counter.timer != NULL;
+#endif
+}
+
+/**
+ * @brief Get the monotonic time in nanoseconds.
+ *
+ * The 32-bit counter of the time base is extended to 64 bits, so the value
+ * does not wrap. Not reentrant: do not call from both interrupt handlers and
+ * the main loop.
+ * @return Time since timestamp_init(), 0 if no time base is available.
+ */
+uint64_t timestamp_ns(void)
+{
+#ifdef __linux__
+	if (!timestamp_counter.timer) {
+		struct timespec ts;
+
+		if (clock_gettime(CLOCK_MONOTONIC, &ts))
+			return 0;
+
+		return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+	}
+#endif
+
+	return timestamp_counter_ns(&timestamp_counter);
+}
+
+/**
+ * @brief Get the monotonic time in microseconds.
+ * @return Time since timestamp_init().
+ */
+uint64_t timestamp_us(void)
+{
+	return timestamp_ns() / 1000;
+}
+
+/**
+ * @brief Get the time elapsed since a previous timestamp_ns() value.
+ * @param start_ns - Previous timestamp_ns() value.
+ * @return Elapsed time in nanoseconds.
+ */
+uint64_t timestamp_elapsed_ns(uint64_t start_ns)
+{
+	return timestamp_ns() - start_ns;
+}
@@ -97,18 +97,24 @@ int32_t log_base_2(uint32_t x)
 uint32_t greatest_common_divisor(uint32_t a,
 				 uint32_t b)
 {
-	uint32_t div;
-	uint32_t common_div = 1;
+	uint32_t r;
 
-	for (div = 1; (div <= a) && (div <= b); div++)
-		if (!(a % div) && !(b % div))
-			common_div = div;
+	/* Euclid's algorithm */
+	while (b) {
+		r = a % b;
+		a = b;
+		b = r;
+	}
 
-	return common_div;
+	return a;
 }
 
 /**
  * Calculate best rational approximation for a given fraction.
+ *
+ * Walks the continued fraction expansion of the given fraction and stops at
+ * the last convergent that fits the limits, or at the closest semi-convergent
+ * past it. The result is the reduced fraction itself when it fits.
  */
 void rational_best_approximation(uint32_t given_numerator,
 				 uint32_t given_denominator,
@@ -117,18 +123,50 @@ void rational_best_approximation(uint32_t given_numerator,
 				 uint32_t *best_numerator,
 				 uint32_t *best_denominator)
 {
-	uint32_t gcd;
+	uint32_t n, d, n0, d0, n1, d1, n2, d2;
+	uint32_t a, dp, t;
+
+	n = given_numerator;
+	d = given_denominator;
+	n0 = d1 = 0;
+	n1 = d0 = 1;
 
-	gcd = greatest_common_divisor(given_numerator, given_denominator);
+	while (d) {
+		/* Next term of the continued fraction */
+		dp = d;
+		a = n / d;
+		d = n % d;
+		n = dp;
 
-	*best_numerator = given_numerator / gcd;
-	*best_denominator = given_denominator / gcd;
+		/* Next convergent */
+		n2 = n0 + a * n1;
+		d2 = d0 + a * d1;
 
-	if ((*best_numerator > max_numerator) ||
-	    (*best_denominator > max_denominator)) {
-		*best_numerator = 0;
-		*best_denominator = 0;
+		if ((n2 > max_numerator) || (d2 > max_denominator)) {
+			/* Largest semi-convergent that fits */
+			t = 0xffffffff;
+			if (d1)
+				t = (max_denominator - d0) / d1;
+			if (n1)
+				t = min(t, (max_numerator - n0) / n1);
+
+			/* Keep it if it is closer than the previous convergent */
+			if (!d1 || 2ULL * t > a ||
+			    (2ULL * t == a && (uint64_t)d0 * dp > (uint64_t)d1 * d)) {
+				n1 = n0 + t * n1;
+				d1 = d0 + t * d1;
+			}
+			break;
+		}
+
+		n0 = n1;
+		n1 = n2;
+		d0 = d1;
+		d1 = d2;
 	}
+
+	*best_numerator = n1;
+	*best_denominator = d1;
 }
 
 /**